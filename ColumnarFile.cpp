@@ -0,0 +1,221 @@
+/** @file ColumnarFile.cpp
+ * Contains the implementation of the ColumnarFile class.
+ */
+#include "ColumnarFile.h"
+#include <string.h>
+#include <algorithm>
+
+//constants to define the file layout
+const char CF_MAGIC[] = "RNXCOLS1";		//the file identifier
+const uint32_t CF_ENDIAN = 0x01020304;	//the endianness mark
+const char CF_TABLE[] = "TABL";			//the tag starting a table
+const char CF_END[] = "END ";			//the tag ending the file
+const size_t CF_NAMELEN = 16;			//the length of table and column names
+const size_t CF_ALIGN = 8;				//data in the file are aligned to this size
+
+/**Constructs an empty ColumnarFile object.
+ */
+ColumnarFile::ColumnarFile() {
+	outFile = NULL;
+	rowsToWrite = 0;
+	colsToWrite = 0;
+}
+
+/**Destructor.
+ */
+ColumnarFile::~ColumnarFile() {
+}
+
+/**beginWrite starts writing a columnar file: writes the file header.
+ *
+ * @param out the already open output file (in binary mode)
+ * @return true if the header was written, false otherwise
+ */
+bool ColumnarFile::beginWrite(FILE* out) {
+	uint32_t reserved = 0;
+	outFile = out;
+	colsToWrite = 0;
+	return (fwrite(CF_MAGIC, 1, 8, outFile) == 8)
+		&& (fwrite(&CF_ENDIAN, sizeof(CF_ENDIAN), 1, outFile) == 1)
+		&& (fwrite(&reserved, sizeof(reserved), 1, outFile) == 1);
+}
+
+/**beginTable starts writing a new table in the columnar file. Following calls to writeColumn will write its columns.
+ *
+ * @param name the table name (up to 16 chars)
+ * @param nRows the number of rows in the table
+ * @param nCols the number of columns in the table
+ * @return true if the table header was written, false otherwise (the former table is not complete or write error)
+ */
+bool ColumnarFile::beginTable(const char* name, unsigned long nRows, unsigned int nCols) {
+	if ((outFile == NULL) || (colsToWrite != 0)) return false;
+	uint64_t rows = nRows;
+	uint32_t cols = nCols;
+	uint32_t reserved = 0;
+	rowsToWrite = nRows;
+	colsToWrite = nCols;
+	return (fwrite(CF_TABLE, 1, 4, outFile) == 4)
+		&& (fwrite(&reserved, sizeof(reserved), 1, outFile) == 1)
+		&& writeName(name)
+		&& (fwrite(&rows, sizeof(rows), 1, outFile) == 1)
+		&& (fwrite(&cols, sizeof(cols), 1, outFile) == 1)
+		&& (fwrite(&reserved, sizeof(reserved), 1, outFile) == 1);
+}
+
+/**writeColumn writes a column of the current table: its header and the data for all table rows.
+ *
+ * @param name the column name (up to 16 chars)
+ * @param type the type of column data
+ * @param elemSize the size in bytes of each element
+ * @param data a pointer to the data of the column (the table number of rows times elemSize bytes)
+ * @return true if the column was written, false otherwise (no more columns in the table, or write error)
+ */
+bool ColumnarFile::writeColumn(const char* name, colType type, unsigned int elemSize, const void* data) {
+	if ((outFile == NULL) || (colsToWrite == 0)) return false;
+	colsToWrite--;
+	char typeField[4] = {(char) type, 0, 0, 0};
+	uint32_t size = elemSize;
+	uint64_t dataSize = (uint64_t) rowsToWrite * elemSize;
+	if (!writeName(name)
+		|| (fwrite(typeField, 1, 4, outFile) != 4)
+		|| (fwrite(&size, sizeof(size), 1, outFile) != 1)
+		|| (fwrite(&dataSize, sizeof(dataSize), 1, outFile) != 1)) return false;
+	if ((dataSize > 0) && (fwrite(data, 1, (size_t) dataSize, outFile) != dataSize)) return false;
+	return writePadding((size_t) dataSize);
+}
+
+/**endWrite ends writing the columnar file.
+ * The output file is not closed.
+ *
+ * @return true if the file was ended, false otherwise (the last table is not complete or write error)
+ */
+bool ColumnarFile::endWrite() {
+	if ((outFile == NULL) || (colsToWrite != 0)) return false;
+	uint32_t reserved = 0;
+	bool ok = (fwrite(CF_END, 1, 4, outFile) == 4) && (fwrite(&reserved, sizeof(reserved), 1, outFile) == 1);
+	outFile = NULL;
+	return ok;
+}
+
+/**load reads into memory all the content of a columnar file, from its current position to the end.
+ * Data can be later accessed using getColumn.
+ *
+ * @param input the already open input file (in binary mode)
+ * @return true if the file has the expected layout, false otherwise
+ */
+bool ColumnarFile::load(FILE* input) {
+	content.clear();
+	columns.clear();
+	//read all file content
+	long start = ftell(input);
+	if ((start < 0) || (fseek(input, 0, SEEK_END) != 0)) return false;
+	long end = ftell(input);
+	if ((end < start) || (fseek(input, start, SEEK_SET) != 0)) return false;
+	size_t fileSize = (size_t) (end - start);
+	content.resize((fileSize + CF_ALIGN - 1) / CF_ALIGN);
+	if (fread(content.data(), 1, fileSize, input) != fileSize) return false;
+	const char* base = (const char*) content.data();
+	size_t pos = 0;
+	//check file header
+	if ((fileSize < 16) || (memcmp(base, CF_MAGIC, 8) != 0) || (memcmp(base + 8, &CF_ENDIAN, sizeof(CF_ENDIAN)) != 0)) return false;
+	pos = 16;
+	//get the description of all table columns
+	while (pos + 8 <= fileSize) {
+		if (memcmp(base + pos, CF_END, 4) == 0) return true;
+		if ((memcmp(base + pos, CF_TABLE, 4) != 0) || (pos + 40 > fileSize)) return false;
+		string table(base + pos + 8, strnlen(base + pos + 8, CF_NAMELEN));
+		uint64_t nRows;
+		uint32_t nCols;
+		memcpy(&nRows, base + pos + 24, sizeof(nRows));
+		memcpy(&nCols, base + pos + 32, sizeof(nCols));
+		pos += 40;
+		for (uint32_t i = 0; i < nCols; i++) {
+			if (pos + 32 > fileSize) return false;
+			string name(base + pos, strnlen(base + pos, CF_NAMELEN));
+			colType type = (colType) base[pos + 16];
+			uint32_t elemSize;
+			uint64_t dataSize;
+			memcpy(&elemSize, base + pos + 20, sizeof(elemSize));
+			memcpy(&dataSize, base + pos + 24, sizeof(dataSize));
+			pos += 32;
+			//data size shall be the one of the rows, computed without overflow, and data shall be inside the file
+			if ((elemSize == 0) || (nRows > UINT64_MAX / elemSize) || (dataSize != nRows * elemSize)
+				|| (dataSize > (uint64_t) (fileSize - pos))) return false;
+			columns.push_back(COLdesc(table, name, type, elemSize, (unsigned long) nRows, pos));
+			pos += (size_t) ((dataSize + CF_ALIGN - 1) / CF_ALIGN * CF_ALIGN);
+		}
+	}
+	return false;
+}
+
+/**hasTable checks if a table with the given name exists in the file loaded.
+ *
+ * @param table the table name
+ * @return true if the table exists, false otherwise
+ */
+bool ColumnarFile::hasTable(const char* table) const {
+	for (vector<COLdesc>::const_iterator it = columns.begin(); it != columns.end(); ++it)
+		if (it->table.compare(table) == 0) return true;
+	return false;
+}
+
+/**getNumRows gets the number of rows of the given table in the file loaded.
+ *
+ * @param table the table name
+ * @return the number of rows, or 0 if the table does not exist or has no columns
+ */
+unsigned long ColumnarFile::getNumRows(const char* table) const {
+	for (vector<COLdesc>::const_iterator it = columns.begin(); it != columns.end(); ++it)
+		if (it->table.compare(table) == 0) return it->nRows;
+	return 0;
+}
+
+/**getColumn gets a pointer to the data of the given table column in the file loaded.
+ * Data are not copied: the pointer is valid while this object exists and no other file is loaded.
+ *
+ * @param table the table name
+ * @param column the column name
+ * @param type the expected column type
+ * @param elemSize the expected size of each element
+ * @return a pointer to the column data (getNumRows elements), or NULL if the column does not exist or has other type or size
+ */
+const void* ColumnarFile::getColumn(const char* table, const char* column, colType type, unsigned int elemSize) const {
+	const COLdesc* col = findColumn(table, column);
+	if ((col == NULL) || (col->type != type) || (col->elemSize != elemSize)) return NULL;
+	return (const char*) content.data() + col->offset;
+}
+
+/**writeName writes a table or column name in a fixed length field, padded with zeros.
+ *
+ * @param name the name to write
+ * @return true if the name was written, false otherwise
+ */
+bool ColumnarFile::writeName(const char* name) {
+	char field[CF_NAMELEN];
+	memset(field, 0, CF_NAMELEN);
+	memcpy(field, name, min(strlen(name), CF_NAMELEN));
+	return fwrite(field, 1, CF_NAMELEN, outFile) == CF_NAMELEN;
+}
+
+/**writePadding writes the zeros needed to align to CF_ALIGN data of the given size.
+ *
+ * @param size the size of the data written
+ * @return true if the padding was written, false otherwise
+ */
+bool ColumnarFile::writePadding(size_t size) {
+	const char zeros[CF_ALIGN] = {0};
+	size_t padding = (CF_ALIGN - size % CF_ALIGN) % CF_ALIGN;
+	return (padding == 0) || (fwrite(zeros, 1, padding, outFile) == padding);
+}
+
+/**findColumn finds the description of the given table column.
+ *
+ * @param table the table name
+ * @param column the column name
+ * @return a pointer to the column description, or NULL if it does not exist
+ */
+const ColumnarFile::COLdesc* ColumnarFile::findColumn(const char* table, const char* column) const {
+	for (vector<COLdesc>::const_iterator it = columns.begin(); it != columns.end(); ++it)
+		if ((it->table.compare(table) == 0) && (it->name.compare(column) == 0)) return &(*it);
+	return NULL;
+}
@@ -0,0 +1,95 @@
+/** @file ColumnarFile.h
+ * Contains the definition of the ColumnarFile class.
+ * A ColumnarFile object allows writing and reading binary files containing tables of data arranged by columns.
+ *
+ *Copyright 2015, 2021 by Francisco Cancillo & Luis Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *See the GNU General Public License for more details.
+ *<p>
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *<p>Ver.	|Date	|Reason for change
+ *<p>---------------------------------
+ *<p>V1.0	|10/2026|First release
+ */
+#ifndef COLUMNARFILE_H
+#define COLUMNARFILE_H
+
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <stdint.h>
+
+using namespace std;
+
+/**ColumnarFile class allows writing and reading self-describing binary files containing tables of data stored by columns.
+ *<p>The file layout is:
+ * - A file header with the magic identifier "RNXCOLS1" and an endianness mark (the uint32 0x01020304 as written by the host).
+ * - One or more tables. Each table has a header with the tag "TABL", its name (16 chars), number of rows and number of columns,
+ *   followed by its columns.
+ * - Each column has a header with its name (16 chars), type, element size and data size in bytes, followed by its data, the
+ *   values of all rows, padded with zeros to a multiple of 8 bytes.
+ * - The tag "END " stating the end of file.
+ *<p>All numbers are written in the host byte order, which can be checked using the endianness mark.
+ *<p>To write a file: beginWrite, then for each table beginTable and writeColumn for each of its columns, and finally endWrite.
+ *<p>To read a file: load (all file content is read into memory), and then getNumRows and getColumn to access data of each table
+ *column without copying them.
+ */
+class ColumnarFile {
+public:
+	/// The types of data that columns can have
+	enum colType {
+		FLOAT64 = 'd',	///< double
+		INT32 = 'i',	///< int32_t
+		UINT16 = 'w',	///< uint16_t
+		UINT8 = 'u',	///< uint8_t
+		CHAR = 'c',		///< char
+		FIXSTR = 's'	///< string of fixed length (the element size)
+	};
+	ColumnarFile();
+	~ColumnarFile();
+	//methods to write files
+	bool beginWrite(FILE* out);
+	bool beginTable(const char* name, unsigned long nRows, unsigned int nCols);
+	bool writeColumn(const char* name, colType type, unsigned int elemSize, const void* data);
+	bool endWrite();
+	//methods to read files
+	bool load(FILE* input);
+	bool hasTable(const char* table) const;
+	unsigned long getNumRows(const char* table) const;
+	const void* getColumn(const char* table, const char* column, colType type, unsigned int elemSize) const;
+
+private:
+	struct COLdesc {	//describes a column loaded
+		string table;		//the table name
+		string name;		//the column name
+		colType type;		//the column data type
+		unsigned int elemSize;	//the size in bytes of each element
+		unsigned long nRows;	//the number of rows
+		size_t offset;		//position of data in content
+		//constructor
+		COLdesc(const string &tbl, const string &nm, colType tp, unsigned int es, unsigned long nr, size_t off) {
+			table = tbl;
+			name = nm;
+			type = tp;
+			elemSize = es;
+			nRows = nr;
+			offset = off;
+		}
+	};
+	FILE* outFile;				//the file being written
+	unsigned long rowsToWrite;	//the number of rows of the table being written
+	unsigned int colsToWrite;	//the number of columns pending to write in the table being written
+	vector <uint64_t> content;	//the content of the file loaded (uint64_t elements assure alignment of data)
+	vector <COLdesc> columns;	//the description of the columns loaded
+
+	bool writeName(const char* name);
+	bool writePadding(size_t size);
+	const COLdesc* findColumn(const char* table, const char* column) const;
+};
+#endif
@@ -0,0 +1,358 @@
+/** @file ConversionCache.cpp
+ * Contains the implementation of the ConversionCache class.
+ */
+#include "ConversionCache.h"
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <algorithm>
+#include <dirent.h>
+#include <unistd.h>
+#include <utime.h>
+#include <sys/stat.h>
+
+//constants used to compute keys using the 64 bits FNV-1a hash
+const uint64_t CC_HASHBASIS = 0xcbf29ce484222325ULL;	//the FNV offset basis
+const uint64_t CC_HASHPRIME = 0x100000001b3ULL;			//the FNV prime
+const size_t CC_BUFSIZE = 1 << 16;	//size of the buffer used to read files
+const char CC_TMPMARK[] = ".tmp";	//a mark in the name of files and directories being written or removed
+const char CC_SIZEFILE[] = "size";	//the name of the file in each entry with the size of the inputs
+
+/**Constructs a ConversionCache object using parameters passed.
+ *
+ *@param dir the cache directory. It is created if it does not exist
+ *@param maxBytes the maximum size of the cache in bytes, 0 if unlimited
+ *@param pl a pointer to the Logger to be used to record logging messages
+ */
+ConversionCache::ConversionCache(const string &dir, uint64_t maxBytes, Logger* pl) {
+	plog = pl;
+	dynamicLog = false;
+	setInitValues(dir, maxBytes);
+}
+
+/**Constructs a ConversionCache object logging data into the stderr.
+ *
+ *@param dir the cache directory. It is created if it does not exist
+ *@param maxBytes the maximum size of the cache in bytes, 0 if unlimited
+ */
+ConversionCache::ConversionCache(const string &dir, uint64_t maxBytes) {
+	plog = new Logger();
+	dynamicLog = true;
+	setInitValues(dir, maxBytes);
+}
+
+/**Destroys a ConversionCache object.
+ */
+ConversionCache::~ConversionCache() {
+	if (dynamicLog) delete plog;
+}
+
+/**makeParams gives the string stating the effective parameters of a conversion, to compute its key (see computeKey).
+ * Parameters are given in a fixed order, separated by semicolons, and lists of values separated by commas.
+ *
+ * @param program the name and version of the converting program
+ * @param version the RINEX version generated
+ * @param selSat the satellites selected (empty if all)
+ * @param selObs the observables selected (empty if all)
+ * @param applyBias true if the receiver clock bias is applied to observables
+ * @param clkOffset the receiver clock offset mode (RCV CLOCK OFFS APPL)
+ * @return the string with the parameters
+ */
+string ConversionCache::makeParams(const string &program, RinexData::RINEXversion version, const vector<string> &selSat,
+		const vector<string> &selObs, bool applyBias, int clkOffset) {
+	string params = program + ";" + to_string((int) version) + ";";
+	for (vector<string>::const_iterator it = selSat.begin(); it != selSat.end(); ++it) {
+		if (it != selSat.begin()) params += ",";
+		params += *it;
+	}
+	params += ";";
+	for (vector<string>::const_iterator it = selObs.begin(); it != selObs.end(); ++it) {
+		if (it != selObs.begin()) params += ",";
+		params += *it;
+	}
+	return params + ";" + (applyBias? "1" : "0") + ";" + to_string(clkOffset);
+}
+
+/**computeKey computes the key identifying a conversion from the content of its input files and its parameters.
+ * The key is the 64 bits FNV-1a hash of the inputs content (and size of each one) and parameters, in hexadecimal.
+ *
+ * @param inputs the full path names of the input files of the conversion
+ * @param params a string stating the effective conversion parameters
+ * @param key the key computed
+ * @param inputSize the total size in bytes of the input files
+ * @return true if the key was computed, false otherwise (an input cannot be read)
+ */
+bool ConversionCache::computeKey(const vector<string> &inputs, const string &params, string &key, uint64_t &inputSize) {
+	vector<unsigned char> buffer(CC_BUFSIZE);
+	uint64_t hash = CC_HASHBASIS;
+	uint64_t total = 0;
+	unsigned char sizeBytes[8];
+	size_t n;
+	for (vector<string>::const_iterator it = inputs.begin(); it != inputs.end(); ++it) {
+		FILE* in = fopen(it->c_str(), "rb");
+		if (in == NULL) {
+			plog->warning(LOG_MSG_CCERRIN + *it);
+			return false;
+		}
+		uint64_t size = 0;
+		while ((n = fread(buffer.data(), 1, CC_BUFSIZE, in)) > 0) {
+			hash = hashBytes(hash, buffer.data(), n);
+			size += n;
+		}
+		bool readError = ferror(in) != 0;
+		fclose(in);
+		if (readError) {
+			plog->warning(LOG_MSG_CCERRIN + *it);
+			return false;
+		}
+		//the size is hashed byte by byte, least significant first, to get the same key in any platform
+		for (int i = 0; i < 8; i++) sizeBytes[i] = (unsigned char) (size >> (8 * i));
+		hash = hashBytes(hash, sizeBytes, sizeof sizeBytes);
+		total += size;
+	}
+	hash = hashBytes(hash, (const unsigned char*) params.data(), params.size());
+	inputSize = total;
+	char hex[17];
+	snprintf(hex, sizeof hex, "%016llx", (unsigned long long) hash);
+	key = string(hex);
+	return true;
+}
+
+/**fetch gets from the cache the outputs of the conversion identified by the given key, copying them to the given paths.
+ * The number of outputs requested shall be the one stored, and the size of the inputs the one stored in the entry. Output
+ * files are written with temporary names, and renamed only when all of them have been copied: on failure no output is changed.
+ *
+ * @param key the key of the conversion (see computeKey)
+ * @param inputSize the total size in bytes of the input files (see computeKey)
+ * @param outputs the full path names where output files shall be copied, in the order they were stored
+ * @return true if the outputs were in the cache and have been copied, false otherwise
+ */
+bool ConversionCache::fetch(const string &key, uint64_t inputSize, const vector<string> &outputs) {
+	string entryDir = cacheDir + key + "/";
+	struct stat st;
+	//the entry shall exist and have exactly the requested number of files
+	if ((stat(entryDir.c_str(), &st) != 0) || !S_ISDIR(st.st_mode)
+		|| (stat((entryDir + to_string(outputs.size())).c_str(), &st) == 0)) {
+		plog->fine(LOG_MSG_CCMISS + key);
+		return false;
+	}
+	//the entry shall be for inputs of the same size
+	unsigned long long entryInputSize = 0;
+	FILE* sizeFile = fopen((entryDir + CC_SIZEFILE).c_str(), "r");
+	bool sizeRead = (sizeFile != NULL) && (fscanf(sizeFile, "%llu", &entryInputSize) == 1);
+	if (sizeFile != NULL) fclose(sizeFile);
+	if (!sizeRead || (entryInputSize != inputSize)) {
+		plog->warning(LOG_MSG_CCSIZE + key);
+		return false;
+	}
+	//all stored files shall exist before copying any of them
+	for (unsigned int i = 0; i < outputs.size(); i++) {
+		if (stat((entryDir + to_string(i)).c_str(), &st) != 0) {
+			plog->fine(LOG_MSG_CCMISS + key);
+			return false;
+		}
+	}
+	vector<string> tmpOutputs;
+	bool copied = true;
+	for (unsigned int i = 0; copied && (i < outputs.size()); i++) {
+		tmpOutputs.push_back(tmpName(outputs[i]));
+		copied = copyFile(entryDir + to_string(i), tmpOutputs.back());
+	}
+	for (unsigned int i = 0; copied && (i < outputs.size()); i++) {
+		copied = rename(tmpOutputs[i].c_str(), outputs[i].c_str()) == 0;
+		if (!copied) plog->warning(LOG_MSG_CCERRCPY + tmpOutputs[i]);
+	}
+	if (!copied) {
+		for (vector<string>::iterator it = tmpOutputs.begin(); it != tmpOutputs.end(); ++it) remove(it->c_str());
+		plog->fine(LOG_MSG_CCMISS + key);
+		return false;
+	}
+	//set the entry as the most recently used
+	utime(entryDir.c_str(), NULL);
+	plog->info(LOG_MSG_CCHIT + key);
+	return true;
+}
+
+/**store saves in the cache a copy of the outputs of the conversion identified by the given key, and the size of its inputs.
+ * The entry is written in a temporary directory and renamed when complete. If the entry already exists (f.e. stored by other
+ * process) it is not changed. After storing, entries are evicted if the cache size exceeds its maximum.
+ *
+ * @param key the key of the conversion (see computeKey)
+ * @param inputSize the total size in bytes of the input files (see computeKey)
+ * @param outputs the full path names of the output files of the conversion
+ * @return true if the outputs are in the cache, false otherwise
+ */
+bool ConversionCache::store(const string &key, uint64_t inputSize, const vector<string> &outputs) {
+	string entryDir = cacheDir + key;
+	struct stat st;
+	if (stat(entryDir.c_str(), &st) == 0) return true;
+	string tmpDir = tmpName(entryDir);
+	if (mkdir(tmpDir.c_str(), 0755) != 0) {
+		plog->warning(LOG_MSG_CCERRDIR + tmpDir);
+		return false;
+	}
+	FILE* sizeFile = fopen((tmpDir + "/" + CC_SIZEFILE).c_str(), "w");
+	bool sizeWritten = (sizeFile != NULL) && (fprintf(sizeFile, "%llu\n", (unsigned long long) inputSize) > 0);
+	if ((sizeFile == NULL) || (fclose(sizeFile) != 0) || !sizeWritten) {
+		plog->warning(LOG_MSG_CCERRCPY + tmpDir + "/" + CC_SIZEFILE);
+		removeEntry(tmpDir);
+		return false;
+	}
+	for (unsigned int i = 0; i < outputs.size(); i++) {
+		if (!copyFile(outputs[i], tmpDir + "/" + to_string(i))) {
+			removeEntry(tmpDir);
+			return false;
+		}
+	}
+	if (rename(tmpDir.c_str(), entryDir.c_str()) != 0) {
+		//other process stored the entry at the same time
+		removeEntry(tmpDir);
+		return stat(entryDir.c_str(), &st) == 0;
+	}
+	plog->info(LOG_MSG_CCSTORED + key);
+	evict();
+	return true;
+}
+
+/**evict removes the least recently used entries of the cache until its size is not greater than the maximum stated.
+ * Entries are renamed before removing their files, to avoid them being fetched partially.
+ *
+ * @return the size in bytes of the cache after evicting entries
+ */
+uint64_t ConversionCache::evict() {
+	vector<ENTRYinfo> entries;
+	ENTRYinfo entry;
+	uint64_t total = 0;
+	struct stat st;
+	DIR* dir = opendir(cacheDir.c_str());
+	if (dir == NULL) return 0;
+	struct dirent* de;
+	while ((de = readdir(dir)) != NULL) {
+		entry.name = string(de->d_name);
+		if ((entry.name[0] == '.') || (entry.name.find(CC_TMPMARK) != string::npos)) continue;
+		if ((stat((cacheDir + entry.name).c_str(), &st) != 0) || !S_ISDIR(st.st_mode)) continue;
+		entry.used = (long long) st.st_mtime;
+		entry.size = entrySize(cacheDir + entry.name + "/");
+		total += entry.size;
+		entries.push_back(entry);
+	}
+	closedir(dir);
+	if ((maxSize == 0) || (total <= maxSize)) return total;
+	sort(entries.begin(), entries.end());
+	for (vector<ENTRYinfo>::iterator it = entries.begin(); (it != entries.end()) && (total > maxSize); ++it) {
+		string tmpDir = tmpName(cacheDir + it->name);
+		if (rename((cacheDir + it->name).c_str(), tmpDir.c_str()) != 0) continue;	//already removed by other process
+		removeEntry(tmpDir);
+		total -= it->size;
+		plog->fine(LOG_MSG_CCEVICT + it->name);
+	}
+	return total;
+}
+
+//Class private methods
+//=====================
+/**setInitValues sets the cache directory and size, creating the directory if it does not exist.
+ *
+ * @param dir the cache directory
+ * @param maxBytes the maximum size of the cache in bytes, 0 if unlimited
+ */
+void ConversionCache::setInitValues(const string &dir, uint64_t maxBytes) {
+	cacheDir = dir;
+	if (cacheDir.empty() || (cacheDir.back() != '/')) cacheDir += "/";
+	maxSize = maxBytes;
+	struct stat st;
+	if ((stat(cacheDir.c_str(), &st) != 0) && (mkdir(cacheDir.c_str(), 0755) != 0)) {
+		plog->warning(LOG_MSG_CCERRDIR + cacheDir);
+	}
+}
+
+/**hashBytes updates a 64 bits FNV-1a hash with the given bytes.
+ *
+ * @param hash the hash of the former bytes, or CC_HASHBASIS if none
+ * @param bytes the bytes to hash
+ * @param n the number of bytes
+ * @return the hash updated
+ */
+uint64_t ConversionCache::hashBytes(uint64_t hash, const unsigned char* bytes, size_t n) {
+	for (size_t i = 0; i < n; i++) hash = (hash ^ bytes[i]) * CC_HASHPRIME;
+	return hash;
+}
+
+/**tmpName gives a name for a temporary file or directory, unique among processes and threads, derived from the given path.
+ *
+ * @param path the path of the final file or directory
+ * @return the temporary name
+ */
+string ConversionCache::tmpName(const string &path) {
+	static atomic<unsigned int> serial(0);
+	return path + CC_TMPMARK + to_string((long long) getpid()) + "_" + to_string(serial++);
+}
+
+/**copyFile copies a file. On failure the destination file is removed.
+ * Callers write to temporary destination names, renamed when all their copies are complete.
+ *
+ * @param from the source file path
+ * @param to the destination file path
+ * @return true if the file has been copied, false otherwise
+ */
+bool ConversionCache::copyFile(const string &from, const string &to) {
+	FILE* in = fopen(from.c_str(), "rb");
+	if (in == NULL) {
+		plog->warning(LOG_MSG_CCERRCPY + from);
+		return false;
+	}
+	FILE* out = fopen(to.c_str(), "wb");
+	if (out == NULL) {
+		fclose(in);
+		plog->warning(LOG_MSG_CCERRCPY + to);
+		return false;
+	}
+	vector<char> buffer(CC_BUFSIZE);
+	size_t n;
+	bool ok = true;
+	while (ok && ((n = fread(buffer.data(), 1, CC_BUFSIZE, in)) > 0)) ok = fwrite(buffer.data(), 1, n, out) == n;
+	ok = ok && (ferror(in) == 0);
+	fclose(in);
+	ok = (fclose(out) == 0) && ok;
+	if (!ok) {
+		remove(to.c_str());
+		plog->warning(LOG_MSG_CCERRCPY + from);
+	}
+	return ok;
+}
+
+/**entrySize computes the size of the files in a cache entry.
+ *
+ * @param entryDir the entry directory path, ended with a /
+ * @return the sum of the sizes of its files
+ */
+uint64_t ConversionCache::entrySize(const string &entryDir) {
+	uint64_t size = 0;
+	struct stat st;
+	DIR* dir = opendir(entryDir.c_str());
+	if (dir == NULL) return 0;
+	struct dirent* de;
+	while ((de = readdir(dir)) != NULL) {
+		if (de->d_name[0] == '.') continue;
+		if (stat((entryDir + de->d_name).c_str(), &st) == 0) size += (uint64_t) st.st_size;
+	}
+	closedir(dir);
+	return size;
+}
+
+/**removeEntry removes an entry directory and the files in it.
+ *
+ * @param entryDir the entry directory path
+ */
+void ConversionCache::removeEntry(const string &entryDir) {
+	DIR* dir = opendir(entryDir.c_str());
+	if (dir != NULL) {
+		struct dirent* de;
+		while ((de = readdir(dir)) != NULL) {
+			if ((strcmp(de->d_name, ".") == 0) || (strcmp(de->d_name, "..") == 0)) continue;
+			remove((entryDir + "/" + de->d_name).c_str());
+		}
+		closedir(dir);
+	}
+	rmdir(entryDir.c_str());
+}
@@ -0,0 +1,97 @@
+/** @file ConversionCache.h
+ * Contains the definition of the ConversionCache class.
+ * A ConversionCache object keeps in a local directory the outputs of conversions, to reuse them when the same inputs are
+ * converted again with the same parameters.
+ *
+ *Copyright 2015, 2021 by Francisco Cancillo & Luis Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *See the GNU General Public License for more details.
+ *<p>
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *<p>Ver.	|Date	|Reason for change
+ *<p>---------------------------------
+ *<p>V1.0	|10/2026|First release
+ */
+#ifndef CONVERSIONCACHE_H
+#define CONVERSIONCACHE_H
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "Logger.h"		//from CommonClasses
+#include "RinexData.h"	//from CommonClasses
+
+using namespace std;
+
+//@cond DUMMY
+const string LOG_MSG_CCHIT("Cache hit ");
+const string LOG_MSG_CCMISS("Cache miss ");
+const string LOG_MSG_CCSTORED("Cache stored ");
+const string LOG_MSG_CCEVICT("Cache evicted ");
+const string LOG_MSG_CCERRDIR("Cannot use cache directory ");
+const string LOG_MSG_CCERRIN("Cannot read input to hash ");
+const string LOG_MSG_CCERRCPY("Cannot copy cache file ");
+const string LOG_MSG_CCSIZE("Cache entry for other input size ");
+//@endcond
+
+/**ConversionCache class implements a local on-disk cache of conversion outputs (RINEX files, for example), to skip conversions of
+ *inputs already converted with the same parameters.
+ *<p>Each conversion is identified by a key computed with computeKey from the bytes of its input files and a string with the effective
+ *conversion parameters (RINEX version, filters, applyBias, clock offset mode, ...). The string should include also the version of the
+ *converting program, to avoid reusing outputs generated by former versions. makeParams gives such string in a common format.
+ *computeKey gives also the total size of the inputs,
+ *which is saved in the entry and checked when fetching it, to detect the unlikely case of different inputs having the same key.
+ *<p>A program using ConversionCache would perform the following steps:
+ *	-# Declare a ConversionCache object stating the cache directory and its maximum size
+ *	-# Compute the key of the conversion using computeKey
+ *	-# Use fetch to get the outputs from the cache. If they are there, the conversion is not needed
+ *	-# Otherwise, perform the conversion and store its outputs in the cache using store
+ *<p>Each cache entry is a subdirectory, named with the key, containing a copy of each output file (named 0, 1, ...) and a file
+ *with the size of the inputs (named size).
+ *Entries are written in temporary names and renamed when complete, so several processes can share the same cache
+ *directory: an entry is found complete or not found. Outputs fetched are also copied to temporary names, and renamed only when
+ *all of them have been copied. A ConversionCache object shall not be used by several threads at once.
+ *<p>When the size of the cache exceeds its maximum, the entries least recently used (stored or fetched) are removed.
+ */
+class ConversionCache {
+public:
+	ConversionCache(const string &dir, uint64_t maxBytes, Logger* pl);
+	ConversionCache(const string &dir, uint64_t maxBytes);
+	~ConversionCache();
+	static string makeParams(const string &program, RinexData::RINEXversion version, const vector<string> &selSat,
+		const vector<string> &selObs, bool applyBias, int clkOffset);
+	bool computeKey(const vector<string> &inputs, const string &params, string &key, uint64_t &inputSize);
+	bool fetch(const string &key, uint64_t inputSize, const vector<string> &outputs);
+	bool store(const string &key, uint64_t inputSize, const vector<string> &outputs);
+	uint64_t evict();
+
+private:
+	struct ENTRYinfo {	//the data of a cache entry used to select the ones to evict
+		string name;		//the entry subdirectory name (the key)
+		uint64_t size;		//the size in bytes of its files
+		long long used;		//the last time the entry was used (its modification time)
+		//the less recently used entries are sorted first
+		bool operator < (const ENTRYinfo &param) const {
+			return used < param.used;
+		}
+	};
+	string cacheDir;		//the cache directory, ended with a /
+	uint64_t maxSize;		//the maximum size in bytes of the cache (0 if unlimited)
+	Logger* plog;			//the place to send logging messages
+	bool dynamicLog;		//true when created dynamically here, false when provided externally
+
+	void setInitValues(const string &dir, uint64_t maxBytes);
+	static uint64_t hashBytes(uint64_t hash, const unsigned char* bytes, size_t n);
+	string tmpName(const string &path);
+	bool copyFile(const string &from, const string &to);
+	uint64_t entrySize(const string &entryDir);
+	void removeEntry(const string &entryDir);
+};
+#endif
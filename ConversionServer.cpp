@@ -0,0 +1,458 @@
+/** @file ConversionServer.cpp
+ * Contains the implementation of the ConversionServer class.
+ */
+#include "ConversionServer.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <chrono>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+//constants used by the socket server
+const int CS_POLLTIMEOUT = 200;		//milliseconds between checks of stopServing
+const size_t CS_MAXREQUEST = 8192;	//maximum length of a request line
+const int CS_REQFIELDS = 6;			//number of fields in a request line
+const string CS_PROGRAM("ConversionServer V1.0");	//the converter identification in conversion cache keys
+
+/**Constructs a ConversionServer object, starting the given number of workers.
+ *
+ *@param nWorkers the number of worker threads. If 0, the number of processor cores is used
+ *@param pl a pointer to the Logger to be used to record logging messages. It is shared by all workers
+ */
+ConversionServer::ConversionServer(unsigned int nWorkers, Logger* pl) {
+	plog = pl;
+	dynamicLog = false;
+	setInitValues(nWorkers, string(), 0);
+}
+
+/**Constructs a ConversionServer object logging data into the stderr, starting the given number of workers.
+ *
+ *@param nWorkers the number of worker threads. If 0, the number of processor cores is used
+ */
+ConversionServer::ConversionServer(unsigned int nWorkers) {
+	plog = new Logger();
+	dynamicLog = true;
+	setInitValues(nWorkers, string(), 0);
+}
+
+/**Constructs a ConversionServer object using a conversion cache, starting the given number of workers.
+ *
+ *@param nWorkers the number of worker threads. If 0, the number of processor cores is used
+ *@param cacheDir the directory of the conversion cache. It is created if it does not exist
+ *@param cacheMaxBytes the maximum size of the conversion cache in bytes, 0 if unlimited
+ *@param pl a pointer to the Logger to be used to record logging messages. It is shared by all workers
+ */
+ConversionServer::ConversionServer(unsigned int nWorkers, const string &cacheDir, uint64_t cacheMaxBytes, Logger* pl) {
+	plog = pl;
+	dynamicLog = false;
+	setInitValues(nWorkers, cacheDir, cacheMaxBytes);
+}
+
+/**Constructs a ConversionServer object using a conversion cache and logging data into the stderr, starting the given number of workers.
+ *
+ *@param nWorkers the number of worker threads. If 0, the number of processor cores is used
+ *@param cacheDir the directory of the conversion cache. It is created if it does not exist
+ *@param cacheMaxBytes the maximum size of the conversion cache in bytes, 0 if unlimited
+ */
+ConversionServer::ConversionServer(unsigned int nWorkers, const string &cacheDir, uint64_t cacheMaxBytes) {
+	plog = new Logger();
+	dynamicLog = true;
+	setInitValues(nWorkers, cacheDir, cacheMaxBytes);
+}
+
+/**Destroys a ConversionServer object, after completing the jobs in the queue.
+ */
+ConversionServer::~ConversionServer() {
+	stop();
+	if (dynamicLog) delete plog;
+}
+
+/**submit adds a job to the queue of jobs to be converted by the workers.
+ *
+ * @param job the conversion to perform
+ * @param callback the function to be called with the job status when it starts and when it ends. It is called from the
+ *	worker thread performing the job
+ * @return true if the job has been queued, false if the server is stopping
+ */
+bool ConversionServer::submit(const CONVjob &job, StatusCallback callback) {
+	PENDINGjob pending;
+	pending.job = job;
+	pending.callback = callback;
+	{
+		lock_guard<mutex> lock(queueLock);
+		if (stopping) return false;
+		queue.push_back(pending);
+	}
+	jobReady.notify_one();
+	return true;
+}
+
+/**waitIdle waits until all queued jobs have been converted.
+ */
+void ConversionServer::waitIdle() {
+	unique_lock<mutex> lock(queueLock);
+	while (!queue.empty() || (busy > 0)) jobsDone.wait(lock);
+}
+
+/**serve receives conversion requests through a Unix domain socket, and replies the status of each one (see class description).
+ * The method returns when a STOP request is received or stop is called from other thread, after completing pending jobs.
+ *
+ * @param socketPath the path of the socket to create. Any existing file with this path is removed
+ * @return true if requests were served, false if the socket could not be created
+ */
+bool ConversionServer::serve(const string &socketPath) {
+	struct sockaddr_un addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	if (socketPath.size() >= sizeof(addr.sun_path)) {
+		plog->severe(LOG_MSG_CSERRSOCK + socketPath);
+		return false;
+	}
+	strcpy(addr.sun_path, socketPath.c_str());
+	int listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+	unlink(socketPath.c_str());
+	if ((listenFd < 0) || (bind(listenFd, (struct sockaddr*) &addr, sizeof(addr)) != 0) || (listen(listenFd, SOMAXCONN) != 0)) {
+		if (listenFd >= 0) close(listenFd);
+		plog->severe(LOG_MSG_CSERRSOCK + socketPath);
+		return false;
+	}
+	plog->info(LOG_MSG_CSSERVE + socketPath);
+	vector < shared_ptr<CONNdata> > conns;
+	vector <struct pollfd> fds;
+	char buffer[4096];
+	stopServing = false;
+	while (!stopServing) {
+		fds.clear();
+		fds.push_back({listenFd, POLLIN, 0});
+		for (unsigned int i = 0; i < conns.size(); i++) fds.push_back({conns[i]->fd, POLLIN, 0});
+		if (poll(fds.data(), fds.size(), CS_POLLTIMEOUT) <= 0) continue;
+		//data from clients
+		for (unsigned int i = 0; i < conns.size(); i++) {
+			if ((fds[i + 1].revents & (POLLIN | POLLHUP | POLLERR)) == 0) continue;
+			ssize_t n;
+			do n = recv(conns[i]->fd, buffer, sizeof buffer, 0); while ((n < 0) && (errno == EINTR));
+			if (n > 0) {
+				conns[i]->received.append(buffer, n);
+				processRequests(conns[i]);
+			} else {
+				//the client closed the connection: replies of its pending jobs are discarded
+				lock_guard<mutex> lock(conns[i]->writeLock);
+				conns[i]->open = false;
+				close(conns[i]->fd);
+			}
+		}
+		for (unsigned int i = 0; i < conns.size(); ) {
+			if (conns[i]->open) i++;
+			else conns.erase(conns.begin() + i);
+		}
+		//new clients
+		if ((fds[0].revents & POLLIN) != 0) {
+			int fd = accept(listenFd, NULL, NULL);
+			if (fd >= 0) {
+				shared_ptr<CONNdata> conn(new CONNdata());
+				conn->fd = fd;
+				conn->open = true;
+				conns.push_back(conn);
+			}
+		}
+	}
+	close(listenFd);
+	unlink(socketPath.c_str());
+	//replies of pending jobs are sent before closing connections
+	waitIdle();
+	for (unsigned int i = 0; i < conns.size(); i++) {
+		lock_guard<mutex> lock(conns[i]->writeLock);
+		conns[i]->open = false;
+		close(conns[i]->fd);
+	}
+	plog->info(LOG_MSG_CSSERVEND + socketPath);
+	return true;
+}
+
+/**stop ends serving requests (if serve is running) and ends the workers after completing the jobs in the queue.
+ * After stop, new jobs are not accepted.
+ */
+void ConversionServer::stop() {
+	stopServing = true;
+	{
+		lock_guard<mutex> lock(queueLock);
+		stopping = true;
+	}
+	jobReady.notify_all();
+	for (vector<thread>::iterator it = workers.begin(); it != workers.end(); ++it) if (it->joinable()) it->join();
+}
+
+/**parseJob extracts job data from a request line in the format: id;version;ORD file;observation file;NRD file;navigation file
+ *
+ * @param request the request line (without end of line)
+ * @param job the job where data are placed
+ * @return true if the request is well formed, false otherwise
+ */
+bool ConversionServer::parseJob(const string &request, CONVjob &job) {
+	string fields[CS_REQFIELDS];
+	size_t start = 0, end;
+	for (int i = 0; i < CS_REQFIELDS; i++) {
+		end = (i == CS_REQFIELDS - 1)? request.size() : request.find(';', start);
+		if (end == string::npos) return false;
+		fields[i] = request.substr(start, end - start);
+		start = end + 1;
+	}
+	if (fields[0].empty() || (fields[2].empty() && fields[4].empty())) return false;
+	if (!fields[2].empty() && fields[3].empty()) return false;
+	if (!fields[4].empty() && fields[5].empty()) return false;
+	if (fields[1] == "2") job.version = RinexData::V210;
+	else if (fields[1] == "3") job.version = RinexData::V304;
+	else if (fields[1].empty()) job.version = RinexData::VTBD;
+	else return false;
+	job.id = fields[0];
+	job.ordFile = fields[2];
+	job.obsFile = fields[3];
+	job.nrdFile = fields[4];
+	job.navFile = fields[5];
+	return true;
+}
+
+/**formatStatus gives the reply line (without end of line) for the given job status (see class description).
+ *
+ * @param status the job status
+ * @return the reply line
+ */
+string ConversionServer::formatStatus(const JOBstatus &status) {
+	if (!status.done) return status.id + ";" + LOG_MSG_CSSTART + ";" + to_string(status.worker);
+	if (!status.ok) return status.id + ";" + LOG_MSG_CSERR + ";" + status.message;
+	char millis[32];
+	snprintf(millis, sizeof millis, "%.3f", status.millis);
+	return status.id + ";" + LOG_MSG_CSOK + ";" + to_string(status.epochs) + ";" + string(millis);
+}
+
+//Class private methods
+//=====================
+/**setInitValues sets initial state and starts the workers.
+ *
+ * @param nWorkers the number of worker threads. If 0, the number of processor cores is used
+ * @param cacheDir the directory of the conversion cache, empty if not used
+ * @param cacheMaxBytes the maximum size of the conversion cache in bytes, 0 if unlimited
+ */
+void ConversionServer::setInitValues(unsigned int nWorkers, const string &cacheDir, uint64_t cacheMaxBytes) {
+	cacheDirectory = cacheDir;
+	cacheMaxSize = cacheMaxBytes;
+	busy = 0;
+	stopping = false;
+	stopServing = false;
+	if (nWorkers == 0) nWorkers = thread::hardware_concurrency();
+	if (nWorkers == 0) nWorkers = 1;
+	for (unsigned int i = 0; i < nWorkers; i++) workers.push_back(thread(&ConversionServer::workerLoop, this, i));
+}
+
+/**workerLoop is the body of each worker thread: takes jobs from the queue and converts them, until the server is stopping and
+ * the queue is empty. The GNSSdataFromGRD decoder of the worker is constructed once and reset before each conversion.
+ * Each worker has its own ConversionCache, if the cache is used, as they cannot be used by several threads at once.
+ *
+ * @param workerNum the number of this worker
+ */
+void ConversionServer::workerLoop(int workerNum) {
+	GNSSdataFromGRD grd(plog);
+	unique_ptr<ConversionCache> cache;
+	if (!cacheDirectory.empty()) cache.reset(new ConversionCache(cacheDirectory, cacheMaxSize, plog));
+	PENDINGjob pending;
+	JOBstatus status;
+	while (true) {
+		{
+			unique_lock<mutex> lock(queueLock);
+			while (queue.empty() && !stopping) jobReady.wait(lock);
+			if (queue.empty()) return;
+			pending = queue.front();
+			queue.pop_front();
+			busy++;
+		}
+		status.id = pending.job.id;
+		status.done = false;
+		status.ok = false;
+		status.message.clear();
+		status.worker = workerNum;
+		status.epochs = 0;
+		status.cached = false;
+		status.millis = 0.0;
+		if (pending.callback) pending.callback(status);
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+		status.ok = (pending.job.ordFile.empty() || convertObs(grd, cache.get(), pending.job, status))
+				&& (pending.job.nrdFile.empty() || convertNav(grd, cache.get(), pending.job, status));
+		status.millis = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+		status.done = true;
+		if (pending.callback) pending.callback(status);
+		{
+			lock_guard<mutex> lock(queueLock);
+			busy--;
+		}
+		jobsDone.notify_all();
+	}
+}
+
+/**convertObs converts the ORD file of the job to a RINEX observation file, or fetches it from the cache, if used.
+ *
+ * @param grd the decoder to use
+ * @param cache the conversion cache to use, or NULL if none
+ * @param job the job to perform
+ * @param status the job status where the number of epochs printed, if it was cached, or the error message are set
+ * @return true if the conversion was performed, false otherwise
+ */
+bool ConversionServer::convertObs(GNSSdataFromGRD &grd, ConversionCache* cache, const CONVjob &job, JOBstatus &status) {
+	string key;
+	uint64_t inputSize = 0;
+	if ((cache != NULL) && fetchCached(cache, "OBS", job.ordFile, job.obsFile, job.version, key, inputSize)) {
+		status.cached = true;
+		return true;
+	}
+	grd.resetConversion();
+	if (!grd.openInputGRD(string(), job.ordFile)) {
+		status.message = LOG_MSG_CSERROPEN + job.ordFile;
+		return false;
+	}
+	FILE* out = NULL;
+	bool ok = false;
+	try {
+		RinexData rinex(job.version, plog);
+		if (!grd.collectHeaderData(rinex, 0, 0)) status.message = LOG_MSG_CSERRHD + job.ordFile;
+		else if ((out = fopen(job.obsFile.c_str(), "w")) == NULL) status.message = LOG_MSG_CSERROPEN + job.obsFile;
+		else {
+			grd.rewindInputGRD();
+			rinex.printObsHeader(out);
+			while (grd.collectEpochObsData(rinex)) {
+				rinex.printObsEpoch(out);
+				rinex.clearObsData();
+				status.epochs++;
+			}
+			ok = true;
+		}
+	} catch (string error) {
+		status.message = error;
+	} catch (...) {
+		status.message = LOG_MSG_CSERRUNK + job.ordFile;
+	}
+	if ((out != NULL) && (fclose(out) != 0)) ok = false;
+	grd.closeInputGRD();
+	if (ok && !key.empty()) cache->store(key, inputSize, vector<string>(1, job.obsFile));
+	return ok;
+}
+
+/**convertNav converts the NRD file of the job to a RINEX navigation file, or fetches it from the cache, if used.
+ *
+ * @param grd the decoder to use
+ * @param cache the conversion cache to use, or NULL if none
+ * @param job the job to perform
+ * @param status the job status where the error message is set
+ * @return true if the conversion was performed, false otherwise
+ */
+bool ConversionServer::convertNav(GNSSdataFromGRD &grd, ConversionCache* cache, const CONVjob &job, JOBstatus &status) {
+	string key;
+	uint64_t inputSize = 0;
+	if ((cache != NULL) && fetchCached(cache, "NAV", job.nrdFile, job.navFile, job.version, key, inputSize)) {
+		//the job is cached only when all its outputs were fetched
+		status.cached = job.ordFile.empty() || status.cached;
+		return true;
+	}
+	status.cached = false;
+	grd.resetConversion();
+	if (!grd.openInputGRD(string(), job.nrdFile)) {
+		status.message = LOG_MSG_CSERROPEN + job.nrdFile;
+		return false;
+	}
+	FILE* out = NULL;
+	bool ok = false;
+	try {
+		RinexData rinex(job.version, plog);
+		if (!grd.collectHeaderData(rinex, 0, 0)) status.message = LOG_MSG_CSERRHD + job.nrdFile;
+		else if ((out = fopen(job.navFile.c_str(), "w")) == NULL) status.message = LOG_MSG_CSERROPEN + job.navFile;
+		else {
+			grd.rewindInputGRD();
+			grd.collectNavData(rinex);
+			rinex.printNavHeader(out);
+			rinex.printNavEpochs(out);
+			ok = true;
+		}
+	} catch (string error) {
+		status.message = error;
+	} catch (...) {
+		status.message = LOG_MSG_CSERRUNK + job.nrdFile;
+	}
+	if ((out != NULL) && (fclose(out) != 0)) ok = false;
+	grd.closeInputGRD();
+	if (ok && !key.empty()) cache->store(key, inputSize, vector<string>(1, job.navFile));
+	return ok;
+}
+
+/**fetchCached computes the cache key of converting the given input to the given output, and fetches the output from the cache.
+ * The conversion parameters in the key are the kind of conversion and the RINEX version: the rest are read from the input.
+ *
+ * @param cache the conversion cache
+ * @param kind the kind of conversion (OBS or NAV)
+ * @param input the input raw data file
+ * @param output the RINEX file to generate
+ * @param version the RINEX version to generate
+ * @param key the key computed, to store the output after converting it, or empty if it cannot be computed
+ * @param inputSize the size of the input (see ConversionCache::computeKey)
+ * @return true if the output was fetched from the cache, false otherwise
+ */
+bool ConversionServer::fetchCached(ConversionCache* cache, const string &kind, const string &input, const string &output,
+		RinexData::RINEXversion version, string &key, uint64_t &inputSize) {
+	string params = ConversionCache::makeParams(CS_PROGRAM + " " + kind, version, vector<string>(), vector<string>(), false, 0);
+	if (!cache->computeKey(vector<string>(1, input), params, key, inputSize)) {
+		key.clear();
+		return false;
+	}
+	return cache->fetch(key, inputSize, vector<string>(1, output));
+}
+
+/**processRequests submits the jobs of the complete request lines received from a client connection.
+ * Replies are sent to the connection from the worker threads.
+ *
+ * @param conn the client connection
+ */
+void ConversionServer::processRequests(const shared_ptr<CONNdata> &conn) {
+	size_t eol;
+	CONVjob job;
+	while ((eol = conn->received.find('\n')) != string::npos) {
+		string request = conn->received.substr(0, eol);
+		conn->received.erase(0, eol + 1);
+		if (!request.empty() && (request.back() == '\r')) request.pop_back();
+		if (request.empty()) continue;
+		if (request == LOG_MSG_CSSTOP) {
+			stopServing = true;
+			return;
+		}
+		if (!parseJob(request, job)) {
+			reply(conn, request.substr(0, request.find(';')) + ";" + LOG_MSG_CSERR + ";" + LOG_MSG_CSERRREQ);
+			continue;
+		}
+		if (!submit(job, [conn](const JOBstatus &status) {reply(conn, formatStatus(status));})) {
+			reply(conn, job.id + ";" + LOG_MSG_CSERR + ";" + LOG_MSG_CSSTOP);
+		}
+	}
+	if (conn->received.size() > CS_MAXREQUEST) {
+		reply(conn, string(LOG_MSG_CSERR) + ";" + LOG_MSG_CSERRREQ);
+		conn->received.clear();
+	}
+}
+
+/**reply writes a line to a client connection, if it is still open.
+ *
+ * @param conn the client connection
+ * @param line the line to write (without end of line)
+ */
+void ConversionServer::reply(const shared_ptr<CONNdata> &conn, const string &line) {
+	string toSend = line + "\n";
+	lock_guard<mutex> lock(conn->writeLock);
+	if (!conn->open) return;
+	const char* data = toSend.c_str();
+	size_t pending = toSend.size();
+	while (pending > 0) {
+		ssize_t n = send(conn->fd, data, pending, MSG_NOSIGNAL);
+		if ((n < 0) && (errno == EINTR)) continue;
+		if (n <= 0) break;
+		data += n;
+		pending -= n;
+	}
+}
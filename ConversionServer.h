@@ -0,0 +1,138 @@
+/** @file ConversionServer.h
+ * Contains the definition of the ConversionServer class.
+ * A ConversionServer object keeps a pool of converter workers ready to convert GRD raw data files to RINEX files.
+ *
+ *Copyright 2015, 2021 by Francisco Cancillo & Luis Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *See the GNU General Public License for more details.
+ *<p>
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *<p>Ver.	|Date	|Reason for change
+ *<p>---------------------------------
+ *<p>V1.0	|10/2026|First release
+ */
+#ifndef CONVERSIONSERVER_H
+#define CONVERSIONSERVER_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+
+#include "Logger.h"				//from CommonClasses
+#include "RinexData.h"			//from CommonClasses
+#include "GNSSdataFromGRD.h"	//from CommonClasses
+#include "ConversionCache.h"	//from CommonClasses
+
+using namespace std;
+
+//@cond DUMMY
+const string LOG_MSG_CSSERVE("Serving requests on ");
+const string LOG_MSG_CSSERVEND("Serving ended on ");
+const string LOG_MSG_CSERRSOCK("Cannot serve on socket ");
+const string LOG_MSG_CSERRREQ("Wrong request");
+const string LOG_MSG_CSERROPEN("Cannot open file ");
+const string LOG_MSG_CSERRHD("Cannot collect header data from ");
+const string LOG_MSG_CSERRUNK("Unexpected error converting ");
+const string LOG_MSG_CSSTART("STARTED");
+const string LOG_MSG_CSOK("OK");
+const string LOG_MSG_CSERR("ERROR");
+const string LOG_MSG_CSSTOP("STOP");
+//@endcond
+
+/**ConversionServer class implements a persistent conversion service: a pool of worker threads, each one with a GNSSdataFromGRD
+ *decoder constructed once and reused for all its conversions, converting jobs taken from a queue.
+ *Each job states the ORD and/or NRD input files to convert, the RINEX observation and/or navigation files to generate, and the
+ *RINEX version. Conversions are performed as per the GNSSdataFromGRD documentation, using header data and filters from the input files.
+ *<p>Jobs can be submitted in-process using submit, stating a callback that receives the job status when it starts and when it ends,
+ *with its result and metrics (epochs printed and elapsed time).
+ *<p>When a cache directory is given, each worker uses a ConversionCache on it: outputs of inputs already converted to the same
+ *version are fetched from the cache instead of converting them again, and new outputs are stored in it. Other conversion
+ *parameters (filters, clock offset mode, ...) are read from the input files, thus their content is part of the key.
+ *<p>Jobs can be received also from other processes through a Unix domain socket using serve. Each request is a text line:
+ *	id;version;ORD file;observation file;NRD file;navigation file
+ *<p>where version is 2 (V2.10), 3 (V3.04) or empty (as stated in the input files), and unused files are empty. For each request
+ *the server writes back through the same connection the lines:
+ *	id;STARTED;worker
+ *	id;OK;epochs;milliseconds
+ *<p>or id;ERROR;message if the job fails. Requests of a connection are converted concurrently, thus replies of different jobs
+ *can be mixed. The request line STOP ends serving, after completing the pending jobs.
+ */
+class ConversionServer {
+public:
+	struct CONVjob {	//defines a conversion to perform
+		string id;				//the job identification given by the requester
+		RinexData::RINEXversion version;	//the RINEX version to generate (VTBD to use the one in input files)
+		string ordFile;			//the observation raw data file to convert (empty if none)
+		string obsFile;			//the RINEX observation file to generate
+		string nrdFile;			//the navigation raw data file to convert (empty if none)
+		string navFile;			//the RINEX navigation file to generate
+	};
+	struct JOBstatus {	//the status of a job given to the requester
+		string id;				//the job identification
+		bool done;				//false when the job starts, true when it ends
+		bool ok;				//true if the job ended without errors
+		string message;			//the error message, if any
+		int worker;				//the worker performing the job
+		unsigned int epochs;	//the number of observation epochs printed (0 if outputs were fetched from the cache)
+		bool cached;			//true if all outputs were fetched from the conversion cache
+		double millis;			//the elapsed time in milliseconds
+	};
+	typedef function<void(const JOBstatus &)> StatusCallback;
+
+	ConversionServer(unsigned int nWorkers, Logger* pl);
+	ConversionServer(unsigned int nWorkers);
+	ConversionServer(unsigned int nWorkers, const string &cacheDir, uint64_t cacheMaxBytes, Logger* pl);
+	ConversionServer(unsigned int nWorkers, const string &cacheDir, uint64_t cacheMaxBytes);
+	~ConversionServer();
+	bool submit(const CONVjob &job, StatusCallback callback);
+	void waitIdle();
+	bool serve(const string &socketPath);
+	void stop();
+	static bool parseJob(const string &request, CONVjob &job);
+	static string formatStatus(const JOBstatus &status);
+
+private:
+	struct PENDINGjob {	//a job in the queue and where to report its status
+		CONVjob job;
+		StatusCallback callback;
+	};
+	struct CONNdata {	//a client connection of the socket server
+		int fd;					//the connection socket
+		bool open;				//false when the client closed the connection
+		string received;		//data received not yet processed (an incomplete request line)
+		mutex writeLock;		//to write replies from several workers
+	};
+	vector <thread> workers;		//the worker threads
+	deque <PENDINGjob> queue;		//the jobs waiting for a worker
+	mutex queueLock;				//to access queue and busy
+	condition_variable jobReady;	//signals new jobs or stopping to workers
+	condition_variable jobsDone;	//signals workers becoming idle
+	unsigned int busy;				//the number of workers converting
+	bool stopping;					//true when workers shall end after completing queued jobs
+	atomic<bool> stopServing;		//true when serve shall end
+	string cacheDirectory;			//the directory of the conversion cache (empty if not used)
+	uint64_t cacheMaxSize;			//the maximum size in bytes of the conversion cache (0 if unlimited)
+	Logger* plog;					//the place to send logging messages
+	bool dynamicLog;				//true when created dynamically here, false when provided externally
+
+	void setInitValues(unsigned int nWorkers, const string &cacheDir, uint64_t cacheMaxBytes);
+	void workerLoop(int workerNum);
+	bool convertObs(GNSSdataFromGRD &grd, ConversionCache* cache, const CONVjob &job, JOBstatus &status);
+	bool convertNav(GNSSdataFromGRD &grd, ConversionCache* cache, const CONVjob &job, JOBstatus &status);
+	bool fetchCached(ConversionCache* cache, const string &kind, const string &input, const string &output,
+		RinexData::RINEXversion version, string &key, uint64_t &inputSize);
+	void processRequests(const shared_ptr<CONNdata> &conn);
+	static void reply(const shared_ptr<CONNdata> &conn, const string &line);
+};
+#endif
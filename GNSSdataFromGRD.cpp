@@ -38,6 +38,8 @@ GNSSdataFromGRD::~GNSSdataFromGRD(void) {
  */
 bool GNSSdataFromGRD::openInputGRD(string inputFilePath, string inputFileName) {
     msgCount = 0;
+    resumeOffset = 0;
+    resumeMsgCount = 0;
     //open input raw data file
     bool retVal = true;
     string inFileName = inputFilePath + inputFileName;
@@ -52,6 +54,9 @@ bool GNSSdataFromGRD::openInputGRD(string inputFilePath, string inputFileName) {
  */
 void GNSSdataFromGRD::rewindInputGRD() {
     msgCount = 0;
+    resumeOffset = 0;
+    resumeMsgCount = 0;
+    resumeClkDiscont = clockDiscontinuityCount;
     rewind(grdFile);
 }
 
@@ -138,9 +143,11 @@ bool GNSSdataFromGRD::collectHeaderData(RinexData &rinex, int inFileNum = 0, int
                 memset(smallBuffer, 0, sizeof smallBuffer);     //signal identification to be stored here
                 if (fscanf(grdFile, "%c%d;%c%c;%d;%*lld;%*lf;%d;%*lf;%*lf;%lf", &constId, &satNum, smallBuffer, smallBuffer+1, &trackState, &phaseState, &carrierFrequencyMHz) == 7) {
                     if (constId == 'R') satNum = gloOSN(satNum, *smallBuffer, carrierFrequencyMHz, true);
+                    //signals already found are skipped
                     //ignore unknown measurements or not having at least a valid pseudorrange or carrier phase
-                    if (isKnownMeasur(constId, satNum, *smallBuffer, *(smallBuffer+1))) {
+                    if (!isSignalFound(constId, smallBuffer) && isKnownMeasur(constId, satNum, *smallBuffer, *(smallBuffer+1))) {
                         if (!isPsAmbiguous(constId, smallBuffer, trackState, dvoid, dvoid2, llvoid) || !isCarrierPhInvalid(constId, smallBuffer, phaseState)) {
+                            setSignalFound(constId, smallBuffer);
                             if (addSignal(constId, string(smallBuffer)))
                                 plog->config(logMsg + " added signal " + string(1, constId) + MSG_SPACE + string(smallBuffer));
                         }
@@ -149,7 +156,7 @@ bool GNSSdataFromGRD::collectHeaderData(RinexData &rinex, int inFileNum = 0, int
                 break;
             case MT_EPOCH:
                 //it includes data used in time related header lines
-                collectAndSetEpochTime(rinex, dvoid, ivoid, logMsg + msgEpoch);
+                collectAndSetEpochTime(rinex, dvoid, ivoid, msgEpoch.c_str());
                 if (tofoUnset && inFileNum == 0) {
                     //set Time of Firts and Last Observation
                     rinex.setHdLnData(rinex.TOFO);
@@ -168,40 +175,40 @@ bool GNSSdataFromGRD::collectHeaderData(RinexData &rinex, int inFileNum = 0, int
             case MT_SATNAV_GPS_L1_CA:
                 //it includes data used in corrections (ionospheric, time, etc.) header lines
                 if (collectGPSL1CACorrections(rinex, msgType)) {
-                    rinex.setHdLnData(RinexData::SYS, 'G', aVectorStr);
+                    addNavSystem('G');
                 }
                 break;
             case MT_SATNAV_GPS_L5_C:
             case MT_SATNAV_GPS_C2:
             case MT_SATNAV_GPS_L2_C:
                 //TODO extract data for header lines from these navigation message signals
-                rinex.setHdLnData(RinexData::SYS, 'G', aVectorStr);
+                addNavSystem('G');
                 break;
             case MT_SATNAV_GLONASS_L1_CA:
                 //it includes data used in corrections (ionospheric, time, etc.) header lines, and identify satellite OSN
                 if (collectGLOL1CACorrections(rinex, msgType)) {
-                    rinex.setHdLnData(RinexData::SYS, 'R', aVectorStr);
+                    addNavSystem('R');
                 }
                 break;
             case MT_SATNAV_GALILEO_INAV:
                 //it includes data used in corrections (ionospheric, time, etc.) header lines
                 if (collectGALINCorrections(rinex, msgType)) {
-                    rinex.setHdLnData(RinexData::SYS, 'E', aVectorStr);
+                    addNavSystem('E');
                 }
                 break;
             case MT_SATNAV_GALILEO_FNAV:
                 //TODO extract data for header lines from this navigation message signal
-                rinex.setHdLnData(RinexData::SYS, 'E', aVectorStr);
+                addNavSystem('E');
                 break;
             case MT_SATNAV_BEIDOU_D1:
                 //it includes data used in corrections (ionospheric, time, etc.) header lines
                 if (collectBDSD1Corrections(rinex, msgType)) {
-                    rinex.setHdLnData(RinexData::SYS, 'C', aVectorStr);
+                    addNavSystem('C');
                 }
                 break;
             case MT_SATNAV_BEIDOU_D2:
                 //TODO extract data for header lines from this navigation message signal
-                rinex.setHdLnData(RinexData::SYS, 'C', aVectorStr);
+                addNavSystem('C');
                 break;
             default:
                 plog->warning(logMsg + to_string(msgType));
@@ -295,7 +302,7 @@ bool GNSSdataFromGRD::collectEpochObsData(RinexData &rinex) {
         switch(msgType) {
             case MT_EPOCH:
                 if (numMeasur > 0) plog->warning(getMsgDescription(msgType) + "Few MT_SATOBS in epoch");
-                tRx = collectAndSetEpochTime(rinex, tow, numMeasur, getMsgDescription(msgType) + "Epoch");
+                tRx = collectAndSetEpochTime(rinex, tow, numMeasur, "Epoch");
                 break;
             case MT_SATOBS:
                 if (numMeasur <= 0) {
@@ -348,18 +355,23 @@ bool GNSSdataFromGRD::collectEpochObsData(RinexData &rinex) {
                         //set signal to noise values
                         signalId[0] = 'S';
                         rinex.saveObsData(constellId, satNum, string(signalId), cn0db, 0, sn_rnx, tow);
-                        plog->finer(getMsgDescription(msgType) + string(1, constellId) + to_string(satNum) + MSG_SPACE +
-                                   string(signalId+1) + MSG_SPACE +
-                                   to_string(pseudorange) + MSG_SPACE + to_string(carrierPhase) + MSG_SPACE +
-                                   to_string(dopplerShift) + MSG_SPACE + to_string(cn0db));
+                        if (plog->isLevel(Logger::FINER))
+                            plog->finer(getMsgDescription(msgType) + string(1, constellId) + to_string(satNum) + MSG_SPACE +
+                                       string(signalId+1) + MSG_SPACE +
+                                       to_string(pseudorange) + MSG_SPACE + to_string(carrierPhase) + MSG_SPACE +
+                                       to_string(dopplerShift) + MSG_SPACE + to_string(cn0db));
                     } else {
-                        plog->fine(getMsgDescription(msgType) + string(1, constellId) + to_string(satNum) + MSG_SPACE +
-                                   string(signalId+1) + LOG_MSG_INVM);
+                        if (plog->isLevel(Logger::FINE))
+                            plog->fine(getMsgDescription(msgType) + string(1, constellId) + to_string(satNum) + MSG_SPACE +
+                                       string(signalId+1) + LOG_MSG_INVM);
                     }
                 } else plog->warning(getMsgDescription(msgType) + string(1, constellId) + to_string(satNum) + MSG_SPACE +
                                      string(signalId+1) + MSG_SPACE + LOG_MSG_UNK);
                 if (numMeasur <= 0) {
                     skipToEOM();
+                    resumeOffset = ftell(grdFile);
+                    resumeMsgCount = msgCount;
+                    resumeClkDiscont = clockDiscontinuityCount;
                     return true;
                 }
                 break;
@@ -377,6 +389,29 @@ bool GNSSdataFromGRD::collectEpochObsData(RinexData &rinex) {
     return false;
 }
 
+/**collectHeaderAndNavData extracts from the current NRD file, in a single pass, the data for the RINEX navigation file header
+ * and the ephemeris for its epochs. It performs the same processing than collectHeaderData followed by collectNavData, but each
+ * navigation message is read and decoded only once: the message data are used to complete the satellite frames for ephemeris
+ * and are also copied to a separate set of frames used to get corrections (ionospheric, time, leap seconds), because
+ * ephemeris and corrections use different sets of subframes / strings / words and clear them at different moments.
+ * Ephemeris are kept in the RinexData object until the header is printed and then navigation epochs.
+ *
+ * @param rinex the RinexData object where header and navigation data will be saved
+ * @param inFileNum the number of the current input raw data file from a total of inFileTotal. First value = 0
+ * @param inFileLast the last number of input file to be processed
+ * @return true if header data have been extracted, false otherwise (file cannot be processed)
+ */
+bool GNSSdataFromGRD::collectHeaderAndNavData(RinexData &rinex, int inFileNum, int inFileLast) {
+    navWithHeader = true;
+    memset(gpsCorrFrame, 0, sizeof(gpsCorrFrame));
+    memset(gloCorrFrame, 0, sizeof(gloCorrFrame));
+    memset(galInavCorrFrame, 0, sizeof(galInavCorrFrame));
+    memset(bdsCorrFrame, 0, sizeof(bdsCorrFrame));
+    bool hdData = collectHeaderData(rinex, inFileNum, inFileLast);
+    navWithHeader = false;
+    return hdData;
+}
+
 /**collectNavData iterates over the input raw data file extracting navigation messages to process their data.
  * Data extracted are saved in a RinexData object for futher printing in a navigation RINEX file.
  * It is assumed that grdFile file type and version are the correct ones.
@@ -418,6 +453,10 @@ bool GNSSdataFromGRD::collectNavData(RinexData &rinex) {
                 break;
         }
         skipToEOM();
+        if (!feof(grdFile)) {
+            resumeOffset = ftell(grdFile);
+            resumeMsgCount = msgCount;
+        }
     }
     return acquiredNavData;
 }
@@ -434,17 +473,20 @@ bool GNSSdataFromGRD::processHdData(RinexData &rinex, int msgType, string msgCon
     double da, db, dc;
     double x, y, z;
     string msgError;
-    vector<string> selElements;
-    size_t position;
+    const char* cursor = msgContent.c_str();
+    const char* end = cursor + msgContent.size();
+    StrView token;
     double dvoid = 0.0;
     string svoid = string();
     plog->config(getMsgDescription(msgType) + msgContent);
     try {
         switch(msgType) {
             case MT_GRDVER:
-                position = msgContent.find(';');
-                if ((position != string::npos)
-                    && isGoodGRDver(msgContent.substr(0, position), stoi(msgContent.substr(position+1, string::npos)))) return true;
+                if (nextToken(cursor, end, ";", token) && (cursor < end)) {
+                    char* endp;
+                    long ver = strtol(cursor + 1, &endp, 10);
+                    if ((endp != cursor + 1) && isGoodGRDver(token.str(), (int) ver)) return true;
+                }
                 break;
             case MT_SITE:
                 plog->finer(getMsgDescription(msgType) + " currently ignored");
@@ -500,27 +542,22 @@ bool GNSSdataFromGRD::processHdData(RinexData &rinex, int msgType, string msgCon
                 plog->setLevel(msgContent);
                 return true;
             case MT_CONSTELLATIONS:
-                selElements = getElements(msgContent, "[], ");
-                for (vector<string>::iterator it = selElements.begin(); it != selElements.end(); ++it) {
-                    if ((*it).compare("GPS") == 0) *it = "G";
-                    else if ((*it).compare("GLONASS") == 0) *it = "R";
-                    else if ((*it).compare("GALILEO") == 0) *it = "E";
-                    else if ((*it).compare("BEIDOU") == 0) *it = "C";
-                    else if ((*it).compare("SBAS") == 0) *it = "S";
-                    else if ((*it).compare("QZSS") == 0) *it = "J";
-                    else {
-                        plog->warning(getMsgDescription(msgType) + LOG_MSG_UNKSELSYS + (*it));
-                        selElements.erase(it);
-                    }
+                while (nextToken(cursor, end, "[], ", token)) {
+                    if (token.equals("GPS")) selSatellites.push_back("G");
+                    else if (token.equals("GLONASS")) selSatellites.push_back("R");
+                    else if (token.equals("GALILEO")) selSatellites.push_back("E");
+                    else if (token.equals("BEIDOU")) selSatellites.push_back("C");
+                    else if (token.equals("SBAS")) selSatellites.push_back("S");
+                    else if (token.equals("QZSS")) selSatellites.push_back("J");
+                    else plog->warning(getMsgDescription(msgType) + LOG_MSG_UNKSELSYS + token.str());
                 }
-                selSatellites.insert(selSatellites.end(), selElements.begin(), selElements.end());
                 return true;
             case MT_SATELLITES:
-                selElements = getElements(msgContent, "[],;.:- ");
-                selSatellites.insert(selSatellites.end(), selElements.begin(), selElements.end());
+                while (nextToken(cursor, end, "[],;.:- ", token)) selSatellites.push_back(token.str());
                 return true;
             case MT_OBSERVABLES:
-                selObservables = getElements(msgContent, "[], ");
+                selObservables.clear();
+                while (nextToken(cursor, end, "[], ", token)) selObservables.push_back(token.str());
                 return true;
             default:
                 plog->warning(getMsgDescription(msgType) + to_string(msgType));
@@ -541,24 +578,311 @@ void GNSSdataFromGRD::processFilterData(RinexData &rinex) {
     rinex.setFilter(selSatellites, selObservables);
 }
 
-//PRIVATE METHODS
-//===============
+/**collectApproxPosition computes the approximate receiver position from pseudoranges in the first epochs of the current ORD file,
+ * and sets it in the RINEX header record APPROX POSITION XYZ, when it has not been set from a MT_LLA message.
+ * <p>For each epoch having pseudoranges of satellites with ephemerides in the given evaluator, a single point solution is computed
+ * (see solvePosition). Solutions from up to maxEpochs epochs are averaged. Only GPS, Galileo, BeiDou and QZSS satellites are used.
+ * At most maxEpochs * APPXYZ_SCANFACTOR epochs are read, thus only a small prefix of the file is processed.
+ * <p>Epoch data are acquired using collectEpochObsData into a temporary RinexData object created from a snapshot of the given one.
+ * Therefore this method shall be called after collectHeaderData, when systems and observables have been defined, and before
+ * printing the header. The ORD file is rewound before return.
+ *
+ * @param rinex the RinexData object with header data where the approximate position will be set
+ * @param nav the evaluator with the ephemerides for the period of the ORD file (f.e. collected from the NRD file using collectNavData)
+ * @param maxEpochs the maximum number of epoch solutions to average
+ * @return true if the approximate position has been set (from MT_LLA or computed), false otherwise
+ */
+bool GNSSdataFromGRD::collectApproxPosition(RinexData &rinex, const NavEvaluator &nav, int maxEpochs) {
+    double pos[3];
+    double sum[3] = {0.0, 0.0, 0.0};
+    if (rinex.getHdLnData(RinexData::APPXYZ, pos[0], pos[1], pos[2])) return true;
+    //epoch data are collected in a temporary object to keep unchanged the given one
+    RinexData epochRinex(RinexData::VTBD, rinex.getHeaderSnapshot(), plog);
+    int savedMsgCount = msgCount;
+    int savedClkDiscont = clockDiscontinuityCount;
+    //data for the satellites in the epoch
+    vector <char> satSys;
+    vector <int> satNum;
+    vector <char> satBand;
+    vector <double> psRange;
+    vector <double> times;
+    vector <int> ephIdx;
+    NavEvaluator::SATstates states;
+    //variables to get epoch data
+    char sys;
+    int sat, lli, ssi, week, eFlag;
+    string obsType;
+    double value, tow, bias, tRx;
+    unsigned int n;
+    int nSolutions = 0;
+    rewind(grdFile);
+    for (int nEpochs = 0; (nSolutions < maxEpochs) && (nEpochs < maxEpochs * APPXYZ_SCANFACTOR); nEpochs++) {
+        epochRinex.clearObsData();
+        if (!collectEpochObsData(epochRinex)) break;
+        tRx = epochRinex.getEpochTime(week, tow, bias, eFlag);
+        //select for each satellite the pseudorange in the lowest band
+        satSys.clear();
+        satNum.clear();
+        satBand.clear();
+        psRange.clear();
+        for (unsigned int i = 0; epochRinex.getObsData(sys, sat, obsType, value, lli, ssi, i); i++) {
+            if ((obsType[0] != 'C') || (value <= 0.0)) continue;
+            if ((sys != 'G') && (sys != 'E') && (sys != 'C') && (sys != 'J')) continue;
+            for (n = 0; (n < satSys.size()) && ((satSys[n] != sys) || (satNum[n] != sat)); n++);
+            if (n == satSys.size()) {
+                satSys.push_back(sys);
+                satNum.push_back(sat);
+                satBand.push_back(obsType[1]);
+                psRange.push_back(value);
+            } else if (obsType[1] < satBand[n]) {
+                satBand[n] = obsType[1];
+                psRange[n] = value;
+            }
+        }
+        //compute satellite states at transmission time, in the time scale of each system
+        n = satSys.size();
+        times.resize(n);
+        ephIdx.resize(n);
+        for (unsigned int i = 0; i < n; i++) {
+            times[i] = tRx - psRange[i] / SPEED_OF_LIGTH_MxNS * 1E-9;
+            if (satSys[i] == 'C') times[i] -= BDST_OFFSET;
+            ephIdx[i] = nav.findEphemeris(satSys[i], satNum[i], times[i]);
+        }
+        nav.evaluate(times.data(), ephIdx.data(), n, states);
+        for (unsigned int i = 0; i < n; i++) times[i] -= states.clk[i];
+        nav.evaluate(times.data(), ephIdx.data(), n, states);
+        if (solvePosition(satSys, psRange, states, pos)) {
+            for (int j = 0; j < 3; j++) sum[j] += pos[j];
+            nSolutions++;
+            plog->fine(LOG_MSG_APPXYZ + "epoch " + to_string(tow) + MSG_COLON + to_string(pos[0]) + MSG_COMMA
+                       + to_string(pos[1]) + MSG_COMMA + to_string(pos[2]));
+        }
+    }
+    rewind(grdFile);
+    msgCount = savedMsgCount;
+    clockDiscontinuityCount = savedClkDiscont;
+    if (nSolutions == 0) {
+        plog->warning(LOG_MSG_APPXYZ + "not computed: no epoch solutions");
+        return false;
+    }
+    for (int j = 0; j < 3; j++) pos[j] = sum[j] / nSolutions;
+    plog->info(LOG_MSG_APPXYZ + "from " + to_string(nSolutions) + " epochs" + MSG_COLON + to_string(pos[0]) + MSG_COMMA
+               + to_string(pos[1]) + MSG_COMMA + to_string(pos[2]));
+    return rinex.setHdLnData(RinexData::APPXYZ, pos[0], pos[1], pos[2]);
+}
 
-/**setInitValues set initial values in class variables and tables containig f.e. conversion parameters
- * used to translate scaled normalized GPS message data to values in actual units.
- * <b>Called by the construtors
+/**saveCheckpoint writes to a binary file the current state of the raw data decoder: the position in the input file of the
+ * message following the last epoch (or navigation message) fully processed, parameters collected from the header data, and
+ * the navigation message frames being assembled. The checkpoint can be restored using restoreCheckpoint to resume later the
+ * conversion of the input file from this position.
+ * <p>Note that frame data are written as they are stored in memory: a checkpoint can be restored only by a build having the same
+ * layout (see getCkpLayout).
+ *
+ * @param out the binary file, already open, where the checkpoint is written
+ * @return true if the checkpoint has been written, false otherwise
  */
-void GNSSdataFromGRD::setInitValues() {
+bool GNSSdataFromGRD::saveCheckpoint(FILE* out) {
+///macros to write checkpoint data items and vectors of strings. ok becomes false on error
+    #define CKP_PUT(VALUE) ok = ok && (fwrite(&(VALUE), sizeof(VALUE), 1, out) == 1)
+    #define CKP_PUTSTRS(VALUE) ok = ok && writeBinStrings(out, VALUE)
+
+    bool ok = fwrite(GRD_CKP_TAG, sizeof GRD_CKP_TAG, 1, out) == 1;
+    unsigned int layout[GRD_CKP_LAYOUTSIZE];
+    getCkpLayout(layout);
+    CKP_PUT(layout);
+    unsigned int n = systems.size();
+    CKP_PUT(resumeOffset);
+    CKP_PUT(resumeMsgCount);
+    CKP_PUT(resumeClkDiscont);
+    CKP_PUT(ordVersion);
+    CKP_PUT(nrdVersion);
+    CKP_PUT(fitInterval);
+    CKP_PUT(clkoffset);
+    CKP_PUT(applyBias);
+    CKP_PUT(nGPSrollOver);
+    CKP_PUT(nGALrollOver);
+    CKP_PUT(nBDSrollOver);
+    CKP_PUTSTRS(selSatellites);
+    CKP_PUTSTRS(selObservables);
+    CKP_PUT(n);
+    for (vector<GNSSsystem>::iterator it = systems.begin(); it != systems.end(); ++it) {
+        CKP_PUT(it->sysId);
+        CKP_PUTSTRS(it->obsType);
+    }
+    CKP_PUT(gpsSatFrame);
+    CKP_PUT(gloSatFrame);
+    CKP_PUT(glonassOSN_FCN);
+    CKP_PUT(nAhnA);
+    CKP_PUT(galInavSatFrame);
+    CKP_PUT(bdsSatFrame);
+    if (!ok) plog->warning(LOG_MSG_CKPSAVE);
+    return ok;
+    #undef CKP_PUT
+    #undef CKP_PUTSTRS
+}
+
+/**restoreCheckpoint reads from a binary file the decoder state saved using saveCheckpoint, and positions the input GRD file
+ * (already open) at the message from where processing shall continue.
+ * Data are read in temporary storage and the decoder state is changed only if the whole checkpoint is valid and the input file
+ * has at least the size processed when it was saved.
+ *
+ * @param in the binary file, already open, from where the checkpoint is read
+ * @return true if the checkpoint has been restored, false otherwise
+ */
+bool GNSSdataFromGRD::restoreCheckpoint(FILE* in) {
+///macros to read checkpoint data items and vectors of strings. ok becomes false on error
+    #define CKP_GET(VALUE) ok = ok && (fread(&(VALUE), sizeof(VALUE), 1, in) == 1)
+    #define CKP_GETSTRS(VALUE) ok = ok && readBinStrings(in, VALUE)
+
+    char tag[sizeof GRD_CKP_TAG];
+    bool ok = (fread(tag, sizeof tag, 1, in) == 1) && (memcmp(tag, GRD_CKP_TAG, sizeof tag) == 0);
+    if (!ok) {
+        plog->warning(LOG_MSG_CKPREST + "unknown format");
+        return false;
+    }
+    unsigned int layout[GRD_CKP_LAYOUTSIZE], ckpLayout[GRD_CKP_LAYOUTSIZE];
+    getCkpLayout(layout);
+    CKP_GET(ckpLayout);
+    if (!ok || (memcmp(layout, ckpLayout, sizeof layout) != 0)) {
+        plog->warning(LOG_MSG_CKPREST + "other format version or build");
+        return false;
+    }
+    long offset;
+    int count, clkDiscont, ordVer, nrdVer, clkoff, rollOver[3];
+    bool fitInt, bias;
+    unsigned int n = 0;
+    vector<string> selSat, selObs, obsT;
+    vector<GNSSsystem> sys;
+    char sysId = ' ';
+    CKP_GET(offset);
+    CKP_GET(count);
+    CKP_GET(clkDiscont);
+    CKP_GET(ordVer);
+    CKP_GET(nrdVer);
+    CKP_GET(fitInt);
+    CKP_GET(clkoff);
+    CKP_GET(bias);
+    CKP_GET(rollOver);
+    CKP_GETSTRS(selSat);
+    CKP_GETSTRS(selObs);
+    CKP_GET(n);
+    ok = ok && (n <= RINEX_CKP_MAXITEMS);
+    for (unsigned int i = 0; ok && i < n; i++) {
+        CKP_GET(sysId);
+        CKP_GETSTRS(obsT);
+        sys.push_back(GNSSsystem(sysId, obsT));
+    }
+    GPSFrameData gpsFrame[GPS_MAXSATELLITES];
+    GLOFrameData gloFrame[GLO_MAXSATELLITES];
+    GLONASSosnfcn gloOsnFcn[GLO_MAXSATELLITES];
+    GLONASSfreq gloNAHnA[GLO_MAXOSN];
+    GALINAVFrameData galFrame[GAL_MAXSATELLITES];
+    BDSD1FrameData bdsFrame[BDS_MAXSATELLITES];
+    CKP_GET(gpsFrame);
+    CKP_GET(gloFrame);
+    CKP_GET(gloOsnFcn);
+    CKP_GET(gloNAHnA);
+    CKP_GET(galFrame);
+    CKP_GET(bdsFrame);
+    if (!ok) {
+        plog->warning(LOG_MSG_CKPREST + "wrong data");
+        return false;
+    }
+    //check that the input file contains at least the data already processed
+    long size = -1;
+    if (fseek(grdFile, 0L, SEEK_END) == 0) size = ftell(grdFile);
+    if (offset < 0 || size < offset || fseek(grdFile, offset, SEEK_SET) != 0) {
+        plog->warning(LOG_MSG_CKPREST + "input file smaller than data processed");
+        return false;
+    }
+    resumeOffset = offset;
+    msgCount = resumeMsgCount = count;
+    clockDiscontinuityCount = resumeClkDiscont = clkDiscont;
+    ordVersion = ordVer;
+    nrdVersion = nrdVer;
+    fitInterval = fitInt;
+    clkoffset = clkoff;
+    applyBias = bias;
+    nGPSrollOver = rollOver[0];
+    nGALrollOver = rollOver[1];
+    nBDSrollOver = rollOver[2];
+    selSatellites = selSat;
+    selObservables = selObs;
+    systems = sys;
+    memset(sgnlFound, 0, sizeof(sgnlFound));
+    for (vector<GNSSsystem>::iterator it = systems.begin(); it != systems.end(); ++it)
+        for (vector<string>::iterator itt = it->obsType.begin(); itt != it->obsType.end(); ++itt) setSignalFound(it->sysId, itt->c_str());
+    memcpy(gpsSatFrame, gpsFrame, sizeof(gpsSatFrame));
+    memcpy(gloSatFrame, gloFrame, sizeof(gloSatFrame));
+    memcpy(glonassOSN_FCN, gloOsnFcn, sizeof(glonassOSN_FCN));
+    memcpy(nAhnA, gloNAHnA, sizeof(nAhnA));
+    memcpy(galInavSatFrame, galFrame, sizeof(galInavSatFrame));
+    memcpy(bdsSatFrame, bdsFrame, sizeof(bdsSatFrame));
+    return true;
+    #undef CKP_GET
+    #undef CKP_GETSTRS
+}
+
+/**getCkpLayout gives the layout of checkpoint data: the format version and the sizes of data written as they are stored in memory.
+ * A checkpoint can be restored only if its layout is the current one.
+ *
+ * @param layout the array where the layout is given
+ */
+void GNSSdataFromGRD::getCkpLayout(unsigned int (&layout)[GRD_CKP_LAYOUTSIZE]) {
+    unsigned int items[GRD_CKP_LAYOUTSIZE] = {GRD_CKP_VERSION, sizeof(int), sizeof(long), sizeof(bool),
+        sizeof(gpsSatFrame), sizeof(gloSatFrame), sizeof(glonassOSN_FCN), sizeof(nAhnA), sizeof(galInavSatFrame), sizeof(bdsSatFrame)};
+    memcpy(layout, items, sizeof items);
+}
+
+/**resetConversion sets the initial state for a new conversion: clears data collected from former input files (parameters from header
+ * messages, selected systems and observables, navigation message frames being assembled, ...), keeping the constant tables set when
+ * the object was constructed. It allows reusing the same object to convert several files, one after the other.
+ */
+void GNSSdataFromGRD::resetConversion() {
     ordVersion = 0;
     nrdVersion = 0;
     msgCount = 0;
+    resumeOffset = 0;
+    resumeMsgCount = 0;
+    clockDiscontinuityCount = 0;
+    resumeClkDiscont = 0;
     clkoffset = 0;
     applyBias = false;
     fitInterval = false;
+    systems.clear();
+    memset(sgnlFound, 0, sizeof(sgnlFound));
+    navSysFound = 0;
+    navSystems.clear();
+    selSatellites.clear();
+    selObservables.clear();
     //default values for roll overs
     nGPSrollOver = 2;
     nGALrollOver = 0;
     nBDSrollOver = 0;
+    //set tables to 0
+    memset(gpsSatFrame, 0, sizeof(gpsSatFrame));
+    memset(gloSatFrame, 0, sizeof(gloSatFrame));
+    memset(glonassOSN_FCN, 0, sizeof(glonassOSN_FCN));
+    for(int i=0; i<GLO_MAXSATELLITES; i++) glonassOSN_FCN[i].fcnSet = false;
+    memset(nAhnA, 0, sizeof(nAhnA));
+    memset(galInavSatFrame, 0, sizeof(galInavSatFrame));
+    memset(bdsSatFrame, 0, sizeof(bdsSatFrame));
+    navWithHeader = false;
+    memset(gpsCorrFrame, 0, sizeof(gpsCorrFrame));
+    memset(gloCorrFrame, 0, sizeof(gloCorrFrame));
+    memset(galInavCorrFrame, 0, sizeof(galInavCorrFrame));
+    memset(bdsCorrFrame, 0, sizeof(bdsCorrFrame));
+}
+
+//PRIVATE METHODS
+//===============
+
+/**setInitValues set initial values in class variables and tables containig f.e. conversion parameters
+ * used to translate scaled normalized GPS message data to values in actual units.
+ * <b>Called by the construtors
+ */
+void GNSSdataFromGRD::setInitValues() {
+    resetConversion();
     //scale factors to apply to ephemeris
     //set default values
     double COMMON_SCALEFACTOR[BO_LINSTOTAL][BO_MAXCOLS]; //the scale factors to apply to GPS, GAL and BDS broadcast orbit data to obtain ephemeris
@@ -742,13 +1066,6 @@ void GNSSdataFromGRD::setInitValues() {
     BDS_URA[13] = 3072.0;
     BDS_URA[14] = 6144.0;
     BDS_URA[15] = 6144.0;
-    //set tables to 0
-    memset(gpsSatFrame, 0, sizeof(gpsSatFrame));
-    memset(gloSatFrame, 0, sizeof(gloSatFrame));
-    memset(glonassOSN_FCN, 0, sizeof(glonassOSN_FCN));
-    for(int i=0; i<GLO_MAXSATELLITES; i++) glonassOSN_FCN[i].fcnSet = false;
-    memset(nAhnA, 0, sizeof(nAhnA));
-    memset(galInavSatFrame, 0, sizeof(galInavSatFrame));
 }
 
 
@@ -777,14 +1094,25 @@ bool GNSSdataFromGRD::collectGPSL1CAEphemeris(RinexData &rinex, int msgType) {
     int satNum;		//the satellite number this navigation message belongssatt
     int sfrmNum;    //navigation message subframe number
     int pageNum;    //navigation message page number
-    int bom[BO_LINSTOTAL][BO_MAXCOLS];		//a RINEX broadcats orbit like arrangement for satellite ephemeris mantissa
-    double bo[BO_LINSTOTAL][BO_MAXCOLS];	//the RINEX broadcats orbit arrangement for satellite ephemeris
-    double tTag;		//the time tag for ephemeris data
-    GPSFrameData *pframe;
     string logMsg = getMsgDescription(msgType);
     //read MT_SATNAV_GPS_L1_CA message data
     if (!readGPSL1CANavMsg(constId, satNum, sfrmNum, pageNum, logMsg)) return false;
-    pframe = &gpsSatFrame[satNum - 1];
+    saveGPSL1CAEphemeris(rinex, satNum, logMsg);
+    return true;
+}
+
+/**saveGPSL1CAEphemeris checks if all subframes with ephemeris of the given GPS satellite have been received and, when completed,
+ * extracts and stores the ephemeris into the RinexData object, clearing the satellite frame storage.
+ *
+ * @param rinex	the class instance where data are stored
+ * @param satNum the satellite number
+ * @param logMsg the logging message of the last navigation message read
+ */
+void GNSSdataFromGRD::saveGPSL1CAEphemeris(RinexData &rinex, int satNum, string &logMsg) {
+    int bom[BO_LINSTOTAL][BO_MAXCOLS];		//a RINEX broadcats orbit like arrangement for satellite ephemeris mantissa
+    double bo[BO_LINSTOTAL][BO_MAXCOLS];	//the RINEX broadcats orbit arrangement for satellite ephemeris
+    double tTag;		//the time tag for ephemeris data
+    GPSFrameData *pframe = &gpsSatFrame[satNum - 1];
     //check if all ephemeris have been received, that is:
     //-subframes 1, 2, and 3 have data
     //-and their data belong belong to the same Issue Of Data (IOD)
@@ -808,7 +1136,6 @@ bool GNSSdataFromGRD::collectGPSL1CAEphemeris(RinexData &rinex, int msgType) {
             for (int i = 0; i < GPS_MAXSUBFRS; ++i) pframe->gpsSatSubframes[i].hasData = false;
         } else plog->fine(logMsg + " and IODs different.");
     } else plog->finer(logMsg);
-    return true;
 }
 
 /**collectGPSL1CACorrections gets from GPS L1 C/A navigation raw data message the ionospheric, clock and leap corrections data
@@ -831,6 +1158,14 @@ bool GNSSdataFromGRD::collectGPSL1CACorrections(RinexData &rinex, int msgType) {
     string logMsg = getMsgDescription(msgType);
     //read MT_SATNAV_GPS_L1_CA message data
     if (!readGPSL1CANavMsg(constId, satNum, sfrmNum, pageNum, logMsg)) return false;
+    if (navWithHeader) {
+        //the subframe read is also copied to the frames used for corrections, and ephemeris are saved from the frames read
+        gpsCorrFrame[satNum - 1].gpsSatSubframes[sfrmNum - 1] = gpsSatFrame[satNum - 1].gpsSatSubframes[sfrmNum - 1];
+        gpsCorrFrame[satNum - 1].hasData = true;
+        string ephLogMsg = logMsg;
+        saveGPSL1CAEphemeris(rinex, satNum, ephLogMsg);
+        swap(gpsSatFrame[satNum - 1], gpsCorrFrame[satNum - 1]);
+    }
     GPSFrameData* pframe = &gpsSatFrame[satNum - 1];
     //check if corrections have been received, that is, subframes 1 and 4 have data
     if (pframe->hasData && pframe->gpsSatSubframes[0].hasData && pframe->gpsSatSubframes[3].hasData) {
@@ -847,6 +1182,7 @@ bool GNSSdataFromGRD::collectGPSL1CACorrections(RinexData &rinex, int msgType) {
         pframe->hasData = false;
         for (int i = 0; i < GPS_MAXSUBFRS; ++i) pframe->gpsSatSubframes[i].hasData = false;
     } else plog->finer(logMsg);
+    if (navWithHeader) swap(gpsSatFrame[satNum - 1], gpsCorrFrame[satNum - 1]);
     return true;
 }
 
@@ -1063,15 +1399,26 @@ bool GNSSdataFromGRD::collectGLOL1CAEphemeris(RinexData &rinex, int msgType) {
     int satNum, satIdx;		//the satellite number this navigation message belongssatt
     int strNum;     //navigation message string number
     int frmNum;      //navigation message frame number
+    string logmsg = getMsgDescription(msgType);			//a place to build log messages
+    //read MT_SATNAV_GLONASS_L1_CA message data
+    if (!readGLOL1CANavMsg(constId, satNum, satIdx, strNum, frmNum, logmsg)) return false;
+    saveGLOL1CAEphemeris(rinex, satIdx, logmsg);
+    return true;
+}
+
+/**saveGLOL1CAEphemeris checks if all strings with ephemeris of the given GLONASS satellite have been received and, when completed,
+ * extracts and stores the ephemeris into the RinexData object, clearing the satellite string storage.
+ *
+ * @param rinex	the class instance where data are stored
+ * @param satIdx the satellite index
+ * @param logmsg the logging message of the last navigation message read
+ */
+void GNSSdataFromGRD::saveGLOL1CAEphemeris(RinexData &rinex, int satIdx, string &logmsg) {
     //needed for RINEX
     int bom[BO_LINSTOTAL][BO_MAXCOLS];			//the RINEX broadcats orbit like arrangement for satellite ephemeris mantissa (as extracted from nav message)
     double bo[BO_LINSTOTAL][BO_MAXCOLS];		//the RINEX broadcats orbit arrangement for satellite ephemeris (after applying scale factors)
-    uint32_t wd[GLO_STRWORDS]; //a place to store the 84 bits of a GLONASS string
     double tTag;    //the time tag for ephemeris data
     int sltnum;     //the GLONASS slot number extracted from navigation message
-    string logmsg = getMsgDescription(msgType);			//a place to build log messages
-    //read MT_SATNAV_GLONASS_L1_CA message data
-    if (!readGLOL1CANavMsg(constId, satNum, satIdx, strNum, frmNum, logmsg)) return false;
     //check if all ephemerides have been received (all strings received)
     GLOFrameData* pFrame = &gloSatFrame[satIdx];
     bool allRec = pFrame->frmNum != 0;
@@ -1091,7 +1438,6 @@ bool GNSSdataFromGRD::collectGLOL1CAEphemeris(RinexData &rinex, int msgType) {
         pFrame->frmNum = 0;
         for (int i = 0; i < GLO_MAXSTRS; ++i) pFrame->gloSatStrings[i].hasData = false;
     } else plog->finer(logmsg);
-    return true;
 }
 
 /**collectGLOL1CACorrections gets from GLONASS L1 C/A navigation messages contained in the navigation raw data file the clock and leap
@@ -1117,6 +1463,19 @@ bool GNSSdataFromGRD::collectGLOL1CACorrections(RinexData &rinex, int msgType) {
     string logMsg = getMsgDescription(msgType);
     //read MT_SATNAV_GLO_L1_CA message data
     if (!readGLOL1CANavMsg(constId, satNum, satIdx, strNum, frmNum, logMsg)) return false;
+    bool withEph = navWithHeader && (strNum >= 1) && (strNum <= GLO_MAXSTRS);
+    if (withEph) {
+        //the string read is also copied to the frames used for corrections, and ephemeris are saved from the frames read
+        GLOFrameData* pCorrFrame = &gloCorrFrame[satIdx];
+        if (pCorrFrame->frmNum != frmNum) {
+            pCorrFrame->frmNum = frmNum;
+            for (int i = 0; i < GLO_MAXSTRS; ++i) pCorrFrame->gloSatStrings[i].hasData = false;
+        }
+        pCorrFrame->gloSatStrings[strNum - 1] = gloSatFrame[satIdx].gloSatStrings[strNum - 1];
+        string ephLogMsg = logMsg;
+        saveGLOL1CAEphemeris(rinex, satIdx, ephLogMsg);
+        swap(gloSatFrame[satIdx], gloCorrFrame[satIdx]);
+    }
     //check if all strings (4 & 5) with corrections have been received
     GLOFrameData* pFrame = &gloSatFrame[satIdx];
     if (pFrame->frmNum != 0
@@ -1147,6 +1506,7 @@ bool GNSSdataFromGRD::collectGLOL1CACorrections(RinexData &rinex, int msgType) {
         pFrame->frmNum = 0;
         for (int i = 0; i < GLO_MAXSTRS; ++i) pFrame->gloSatStrings[i].hasData = false;
     } else plog->finer(logMsg);
+    if (withEph) swap(gloSatFrame[satIdx], gloCorrFrame[satIdx]);
     return true;
 }
 
@@ -1446,12 +1806,24 @@ bool GNSSdataFromGRD::collectGALINEphemeris(RinexData &rinex, int msgType) {
     int satNum;		//the satellite number this navigation message belongssatt
     int sfrmNum;    //navigation message subframe number
     int wordNum;    //navigation message page number
-    int bom[BO_LINSTOTAL][BO_MAXCOLS];	//a RINEX broadcats orbit like arrangement for satellite ephemeris mantissa
-    double bo[BO_LINSTOTAL][BO_MAXCOLS];	//the RINEX broadcats orbit arrangement for satellite ephemeris
-    double tTag;		//the time tag for ephemeris data
     string logMsg = getMsgDescription(msgType);
     //read MT_SATNAV_GALIN message data
     if (!readGALINNavMsg(constId, satNum, sfrmNum, wordNum, logMsg)) return false;
+    saveGALINEphemeris(rinex, satNum, logMsg);
+    return true;
+}
+
+/**saveGALINEphemeris checks if all message words with ephemeris of the given Galileo satellite have been received and, when completed,
+ * extracts and stores the ephemeris into the RinexData object, clearing the satellite message words storage.
+ *
+ * @param rinex	the class instance where data are stored
+ * @param satNum the satellite number
+ * @param logMsg the logging message of the last navigation message read
+ */
+void GNSSdataFromGRD::saveGALINEphemeris(RinexData &rinex, int satNum, string &logMsg) {
+    int bom[BO_LINSTOTAL][BO_MAXCOLS];	//a RINEX broadcats orbit like arrangement for satellite ephemeris mantissa
+    double bo[BO_LINSTOTAL][BO_MAXCOLS];	//the RINEX broadcats orbit arrangement for satellite ephemeris
+    double tTag;		//the time tag for ephemeris data
     //check if all ephemerides have been received, that is:
     //-message word types 1, 2, 3, 4 & 5 have data
     //-and data in words 1 to 4 have the same IODnav (Issue Of Data)
@@ -1476,7 +1848,6 @@ bool GNSSdataFromGRD::collectGALINEphemeris(RinexData &rinex, int msgType) {
         for (int i = 0; i < GALINAV_MAXWORDS; ++i) psatFrame->pageWord[i].hasData = false;
     }
     else plog->finer(logMsg);
-    return true;
 }
 
 /**collectGALINCorrections gets from a GALILEO I/NAV raw data message the ionospheric, clock and leap corrections data
@@ -1501,6 +1872,14 @@ bool GNSSdataFromGRD::collectGALINCorrections(RinexData &rinex, int msgType) {
     string logMsg = getMsgDescription(msgType);
     //read MT_SATNAV_GALIN message data
     if (!readGALINNavMsg(constId, satNum, sfrmNum, wordNum, logMsg)) return false;
+    if (navWithHeader) {
+        //the word read is also copied to the frames used for corrections, and ephemeris are saved from the frames read
+        galInavCorrFrame[satNum - 1].pageWord[wordNum - 1] = galInavSatFrame[satNum - 1].pageWord[wordNum - 1];
+        galInavCorrFrame[satNum - 1].hasData = true;
+        string ephLogMsg = logMsg;
+        saveGALINEphemeris(rinex, satNum, ephLogMsg);
+        swap(galInavSatFrame[satNum - 1], galInavCorrFrame[satNum - 1]);
+    }
     //check if corrections have been received, that is page words 5, 6 or 10 have data
     GALINAVFrameData *psatFrame = &galInavSatFrame[satNum - 1];
     if (psatFrame->hasData && (psatFrame->pageWord[4].hasData || psatFrame->pageWord[5].hasData || psatFrame->pageWord[9].hasData)) {
@@ -1526,6 +1905,7 @@ bool GNSSdataFromGRD::collectGALINCorrections(RinexData &rinex, int msgType) {
         for (int i = 0; i < GALINAV_MAXWORDS; ++i) psatFrame->pageWord[i].hasData = false;
     }
     else plog->finer(logMsg);
+    if (navWithHeader) swap(galInavSatFrame[satNum - 1], galInavCorrFrame[satNum - 1]);
     return true;
 }
 
@@ -1740,15 +2120,26 @@ bool GNSSdataFromGRD::collectBDSD1Ephemeris(RinexData &rinex, int msgType) {
     int satNum;		//the satellite number this navigation message belongssatt
     int sfrmNum;    //navigation message subframe number
     int pageNum;    //navigation message page number
-    int bom[BO_LINSTOTAL][BO_MAXCOLS];		//a RINEX broadcats orbit like arrangement for satellite ephemeris mantissa
-    double bo[BO_LINSTOTAL][BO_MAXCOLS];	//the RINEX broadcats orbit arrangement for satellite ephemeris
-    double tTag;		//the time tag for ephemeris data
-    BDSD1FrameData *pframe;
     string logMsg = getMsgDescription(msgType);
     //read MT_SATNAV_BEIDOU_D1 message data
     if (!readBDSD1NavMsg(constId, satNum, sfrmNum, pageNum, logMsg)) return false;
+    saveBDSD1Ephemeris(rinex, satNum, logMsg);
+    return true;
+}
+
+/**saveBDSD1Ephemeris checks if all subframes with ephemeris of the given BDS satellite have been received and, when completed,
+ * extracts and stores the ephemeris into the RinexData object, clearing the satellite frame storage.
+ *
+ * @param rinex	the class instance where data are stored
+ * @param satNum the satellite number
+ * @param logMsg the logging message of the last navigation message read
+ */
+void GNSSdataFromGRD::saveBDSD1Ephemeris(RinexData &rinex, int satNum, string &logMsg) {
+    int bom[BO_LINSTOTAL][BO_MAXCOLS];		//a RINEX broadcats orbit like arrangement for satellite ephemeris mantissa
+    double bo[BO_LINSTOTAL][BO_MAXCOLS];	//the RINEX broadcats orbit arrangement for satellite ephemeris
+    double tTag;		//the time tag for ephemeris data
     //check if all ephemerides have been received, that is, all subframes have data
-    pframe = &bdsSatFrame[satNum - 1];
+    BDSD1FrameData *pframe = &bdsSatFrame[satNum - 1];
     bool allRec = pframe->bdsSatSubframes[0].hasData;
     for (int i = 1; i < BDSD1_MAXSUBFRS; ++i) allRec = allRec && pframe->bdsSatSubframes[i].hasData;
     if (allRec) {
@@ -1762,7 +2153,6 @@ bool GNSSdataFromGRD::collectBDSD1Ephemeris(RinexData &rinex, int msgType) {
         pframe->hasData = false;
         for (int i = 0; i < BDSD1_MAXSUBFRS; ++i) pframe->bdsSatSubframes[i].hasData = false;
     } else plog->finer(logMsg);
-    return true;
 }
 
 /**collectBDSD1Corrections gets BDS D1 navigation data from raw data message the ionospheric, clock and leap corrections data
@@ -1791,6 +2181,15 @@ bool GNSSdataFromGRD::collectBDSD1Corrections(RinexData &rinex, int msgType) {
     string logMsg = getMsgDescription(msgType);
     //read MT_SATNAV_BEIDOU_D1 message data
     if (!readBDSD1NavMsg(constId, satNum, sfrmNum, pageNum, logMsg)) return false;
+    if (navWithHeader) {
+        //the subframe read is also copied to the frames used for corrections, and ephemeris are saved from the frames read
+        int sfrmIdx = (sfrmNum == 5 && pageNum == 9)? 3 : sfrmNum - 1;
+        bdsCorrFrame[satNum - 1].bdsSatSubframes[sfrmIdx] = bdsSatFrame[satNum - 1].bdsSatSubframes[sfrmIdx];
+        bdsCorrFrame[satNum - 1].hasData = true;
+        string ephLogMsg = logMsg;
+        saveBDSD1Ephemeris(rinex, satNum, ephLogMsg);
+        swap(bdsSatFrame[satNum - 1], bdsCorrFrame[satNum - 1]);
+    }
     //check if corrections have been received
     pframe = &bdsSatFrame[satNum - 1];
     if (pframe->hasData &&
@@ -1822,6 +2221,7 @@ bool GNSSdataFromGRD::collectBDSD1Corrections(RinexData &rinex, int msgType) {
         //clear satellite frame storage. Note that subframe flags are note reset because LEAPS needs subframes 1 and 5 page 10
         pframe->hasData = false;
     } else plog->finer(logMsg);
+    if (navWithHeader) swap(bdsSatFrame[satNum - 1], bdsCorrFrame[satNum - 1]);
     return true;
 }
 
@@ -2053,9 +2453,44 @@ bool GNSSdataFromGRD::addSignal(char sys, string sgnl) {
     return true;
 }
 
+/**isSignalFound checks if the given signal of the given system has been already found in the header scan.
+ *
+ * @param sys is the system identification
+ * @param sgnl is the signal name (band and attribute)
+ * @return true if the signal has been found, false otherwise (or identifiers are out of range)
+ */
+bool GNSSdataFromGRD::isSignalFound(char sys, const char* sgnl) {
+    if ((sys < 'A') || (sys > 'Z') || (sgnl[0] < '0') || (sgnl[0] > '9') || (sgnl[1] < 'A') || (sgnl[1] > 'Z')) return false;
+    return (sgnlFound[(sys - 'A') * SGNL_BANDS + sgnl[0] - '0'] & (0x01U << (sgnl[1] - 'A'))) != 0;
+}
+
+/**setSignalFound records that the given signal of the given system has been found in the header scan.
+ * Identifiers out of range are not recorded.
+ *
+ * @param sys is the system identification
+ * @param sgnl is the signal name (band and attribute)
+ */
+void GNSSdataFromGRD::setSignalFound(char sys, const char* sgnl) {
+    if ((sys < 'A') || (sys > 'Z') || (sgnl[0] < '0') || (sgnl[0] > '9') || (sgnl[1] < 'A') || (sgnl[1] > 'Z')) return;
+    sgnlFound[(sys - 'A') * SGNL_BANDS + sgnl[0] - '0'] |= 0x01U << (sgnl[1] - 'A');
+}
+
+/**addNavSystem records that navigation messages from the given system have been found in the header scan.
+ * The SYS record for these systems is set later by setHdSys.
+ *
+ * @param sys is the system identification
+ */
+void GNSSdataFromGRD::addNavSystem(char sys) {
+    uint32_t sysBit = 0x01U << (sys - 'A');
+    if ((navSysFound & sysBit) == 0) {
+        navSysFound |= sysBit;
+        navSystems += sys;
+    }
+}
+
 /**setHdSys using existing data on systems and signals obtained from raw data files
  * sets in the rinex object the SYS header record with systems and observation codes
- * available.
+ * available. Systems with navigation messages are set first, in the order they were found.
  * <p>Note that data available in raw data files would allow computation of pseudorange,
  * carrier phase and doppler observables (not signal stength).
  *
@@ -2064,6 +2499,7 @@ bool GNSSdataFromGRD::addSignal(char sys, string sgnl) {
 void GNSSdataFromGRD::setHdSys(RinexData &rinex) {
     vector<string> sgnl;
     try {
+        for (string::iterator it = navSystems.begin(); it != navSystems.end(); ++it) rinex.setHdLnData(rinex.SYS, *it, sgnl);
         for (vector<GNSSsystem>::iterator it = systems.begin(); it != systems.end(); ++it) {
             sgnl.clear();
             for (vector<string>::iterator itt = it->obsType.begin(); itt != it->obsType.end(); ++itt) {
@@ -2123,6 +2559,104 @@ void GNSSdataFromGRD::llaTOxyz( const double lat, const double lon, const double
     z = (rn * (1.0 - ECEF_E2) + alt) * sinlat;  //ECEF z
 }
 
+/**solvePosition computes a single point solution from the pseudoranges and satellite states of an epoch.
+ * Receiver position and a clock offset for each system (GPS and QZSS share the same) are estimated by iterated least squares,
+ * starting from the earth center. Satellite positions are rotated to take into account earth rotation during signal transit.
+ * Ionospheric and tropospheric delays are not modelled: the solution is only approximate.
+ * <p>The solution is accepted if there are more valid satellites than unknowns, the iteration converges, the residuals RMS is
+ * below APPXYZ_MAXRMS and the position is near the earth surface.
+ *
+ * @param satSys the system of each satellite
+ * @param psRange the pseudorange of each satellite in meters
+ * @param states the states of each satellite at transmission time
+ * @param pos the ECEF position computed in meters
+ * @return true if the solution has been accepted, false otherwise
+ */
+bool GNSSdataFromGRD::solvePosition(const vector<char> &satSys, const vector<double> &psRange, const NavEvaluator::SATstates &states, double (&pos)[3]) {
+    const double c = SPEED_OF_LIGTH_MxNS * 1E9;
+    double sol[APPXYZ_MAXUNK] = {0.0};  //X, Y, Z and clock offset (m) of each system
+    double nm[APPXYZ_MAXUNK][APPXYZ_MAXUNK + 1];   //the normal equations augmented matrix
+    double row[APPXYZ_MAXUNK];
+    int satCol[64];     //the clock column of each satellite
+    char clkSys[APPXYZ_MAXUNK - 3];
+    int nClk = 0;
+    int nSats = 0;
+    unsigned int n = satSys.size();
+    if (n > sizeof satCol / sizeof satCol[0]) n = sizeof satCol / sizeof satCol[0];
+    for (unsigned int i = 0; i < n; i++) {
+        satCol[i] = -1;
+        if (!states.valid[i]) continue;
+        char sys = (satSys[i] == 'J')? 'G' : satSys[i];
+        int k;
+        for (k = 0; (k < nClk) && (clkSys[k] != sys); k++);
+        if (k == nClk) {
+            if (nClk == APPXYZ_MAXUNK - 3) continue;
+            clkSys[nClk++] = sys;
+        }
+        satCol[i] = 3 + k;
+        nSats++;
+    }
+    int nUnk = 3 + nClk;
+    if (nSats <= nUnk) return false;
+    double rms = 0.0;
+    bool converged = false;
+    for (int iter = 0; (iter < APPXYZ_MAXITER) && !converged; iter++) {
+        memset(nm, 0, sizeof nm);
+        rms = 0.0;
+        for (unsigned int i = 0; i < n; i++) {
+            if (satCol[i] < 0) continue;
+            //satellite position rotated to the ECEF frame at reception time
+            double dx = states.x[i] - sol[0];
+            double dy = states.y[i] - sol[1];
+            double dz = states.z[i] - sol[2];
+            double theta = OMEGAE_WGS84 * sqrt(dx * dx + dy * dy + dz * dz) / c;
+            dx = states.x[i] * cos(theta) + states.y[i] * sin(theta) - sol[0];
+            dy = - states.x[i] * sin(theta) + states.y[i] * cos(theta) - sol[1];
+            double range = sqrt(dx * dx + dy * dy + dz * dz);
+            memset(row, 0, sizeof row);
+            row[0] = - dx / range;
+            row[1] = - dy / range;
+            row[2] = - dz / range;
+            row[satCol[i]] = 1.0;
+            double residual = psRange[i] + c * states.clk[i] - range - sol[satCol[i]];
+            rms += residual * residual;
+            for (int j = 0; j < nUnk; j++) {
+                for (int k = 0; k < nUnk; k++) nm[j][k] += row[j] * row[k];
+                nm[j][nUnk] += row[j] * residual;
+            }
+        }
+        //solve normal equations by Gauss elimination with partial pivoting
+        for (int j = 0; j < nUnk; j++) {
+            int p = j;
+            for (int k = j + 1; k < nUnk; k++) if (fabs(nm[k][j]) > fabs(nm[p][j])) p = k;
+            if (fabs(nm[p][j]) < 1E-12) return false;
+            if (p != j) for (int k = 0; k <= nUnk; k++) swap(nm[j][k], nm[p][k]);
+            for (int k = j + 1; k < nUnk; k++) {
+                double f = nm[k][j] / nm[j][j];
+                for (int l = j; l <= nUnk; l++) nm[k][l] -= f * nm[j][l];
+            }
+        }
+        double corr = 0.0;
+        for (int j = nUnk - 1; j >= 0; j--) {
+            double d = nm[j][nUnk];
+            for (int k = j + 1; k < nUnk; k++) d -= nm[j][k] * nm[k][nUnk];
+            nm[j][nUnk] = d / nm[j][j];
+            sol[j] += nm[j][nUnk];
+            if (j < 3) corr += nm[j][nUnk] * nm[j][nUnk];
+        }
+        converged = corr < 1E-6;
+    }
+    //residuals RMS computed in the last iteration, before the final (small) correction
+    rms = sqrt(rms / (nSats - nUnk));
+    double radius = sqrt(sol[0] * sol[0] + sol[1] * sol[1] + sol[2] * sol[2]);
+    if (!converged || (rms > APPXYZ_MAXRMS) || (radius < APPXYZ_MINRADIUS) || (radius > APPXYZ_MAXRADIUS)) {
+        plog->finer(LOG_MSG_APPXYZ + "solution rejected. RMS=" + to_string(rms) + " radius=" + to_string(radius));
+        return false;
+    }
+    for (int j = 0; j < 3; j++) pos[j] = sol[j];
+    return true;
+}
+
 /**collectAndSetEpochTime is called just after reading message identifier MT_EPOCH to read data
  * in the rest of the message.
  * Data contained in the message are used to compute the epoch time, which is given as the week number
@@ -2138,10 +2672,10 @@ void GNSSdataFromGRD::llaTOxyz( const double lat, const double lon, const double
  * @param rinex the RinexData class where curren epoch ti9me will be set
  * @param tow the time of week, that is, the seconds from the beginning of the current week
  * @param numObs number of MT_SATOBS messages that will follow this one
- * @param logMsg a message to log
+ * @param logMsg a text to append to the message description in log messages
  * @return time of week in nanoseconds from the begining of the current week
  */
-double GNSSdataFromGRD::collectAndSetEpochTime(RinexData& rinex, double& tow, int& numObs, string logMsg) {
+double GNSSdataFromGRD::collectAndSetEpochTime(RinexData& rinex, double& tow, int& numObs, const char* logMsg) {
     long long timeNanos = 0;        //the receiver hardware clock time
     long long fullBiasNanos = 0;    //difference between hardware clock and GPS time (tGPS = timeNanos - fullBiasNanos - biasNanos
     double biasNanos = 0.0;         //hardware clock sub-nano bias
@@ -2154,7 +2688,7 @@ double GNSSdataFromGRD::collectAndSetEpochTime(RinexData& rinex, double& tow, in
     numObs = 0;
     if (fscanf(grdFile, "%lld;%lld;%lf;%lf;%d;%d;%d", &timeNanos, &fullBiasNanos, &biasNanos, &driftNanos,
                &clkDiscont, &leapSeconds, &numObs) != 7) {
-        plog->warning(logMsg + LOG_MSG_PARERR);
+        plog->warning(getMsgDescription(MT_EPOCH) + logMsg + LOG_MSG_PARERR);
     }
     //Compute time references and set epoch time
     //Note that a double has a 15 digits mantisa. It is not sufficient for time nanos computation when counting
@@ -2176,7 +2710,8 @@ double GNSSdataFromGRD::collectAndSetEpochTime(RinexData& rinex, double& tow, in
         clockDiscontinuityCount = clkDiscont;
     }
     rinex.setEpochTime(week, tow, biasNanos * 1E-9, eflag);
-    plog->fine(logMsg + " w=" + to_string(week) + " tow=" + to_string(tow)  + " applyBias:" + (applyBias?string("TRUE"):string("FALSE")));
+    if (plog->isLevel(Logger::FINE))
+        plog->fine(getMsgDescription(MT_EPOCH) + logMsg + " w=" + to_string(week) + " tow=" + to_string(tow)  + " applyBias:" + (applyBias?string("TRUE"):string("FALSE")));
     return tRx;
 }
 
@@ -2193,27 +2728,6 @@ string GNSSdataFromGRD::getMsgDescription(int msgt) {
     return msgTblTypes[i].description + LOG_MSG_COUNT + ":";
 }
 
-/**getElements extracts lexical elements (tokens) contained in "toExtract" and delimited
- * by any character in "delimiters".
- *
- * @param toExtract the string containing the elements to extract
- * @param delimiters the string containing the characteres used to delimit elements
- * @return a vector with elements found
- */
-vector<string> GNSSdataFromGRD::getElements(string toExtract, string delimiters) {
-    vector<string> elementsFound;
-    size_t eBegin = 0;
-    size_t eEnd = 0;
-    for (;;) {
-        eBegin = toExtract.find_first_not_of(delimiters, eEnd);
-        eEnd = toExtract.find_first_of(delimiters, eBegin);
-        if (eBegin < eEnd) {
-            elementsFound.push_back(toExtract.substr(eBegin, eEnd - eBegin));
-        } else break;
-    }
-    return elementsFound;
-}
-
 /**isPsAmbiguous determines if the measurement associated to the provided synchState is ambiguous or not.
  * Also, if it is not ambiguous, recomputes the related values for receiver and received time clock depending on
  * constellation and synchronisation state. They are recomputed when the tracking state deduced from the
@@ -21,13 +21,14 @@
  *                  |will be cnsidered.
  * <p>V1.2  |11/2019|Added the functionality to extract iono and time corrections to be included in RINEX header
  */
-#ifndef GNSSDATAFROMOSP_H
-#define GNSSDATAFROMOSP_H
+#ifndef GNSSDATAFROMGRD_H
+#define GNSSDATAFROMGRD_H
 
 #include <math.h>
 //from CommonClasses
 #include "Logger.h"
 #include "RinexData.h"
+#include "NavEvaluator.h"
 #include "Utilities.h"
 
 //@cond DUMMY
@@ -163,6 +164,19 @@ const long long NUMBER_NANOSECONDS_100MS =  100LL * 1000000LL;
 const double ECEF_A = 6378137.0;			//WGS-84 semi-major axis
 const double ECEF_E2 = 6.69437999014e-3;	//WGS-84 first eccentricity squared
 const double dgrToRads = ThisPI / 180.0;    //a factor to convert degrees to radiands
+const double OMEGAE_WGS84 = 7.2921151467E-5;    //WGS-84 earth rotation rate (rad/s)
+const double BDST_OFFSET = 14.0;    //seconds BDS time is behind GPS time
+//Parameters for the single point solution used to compute approximate position
+const int APPXYZ_EPOCHS = 10;       //default number of epoch solutions to average
+const int APPXYZ_SCANFACTOR = 10;   //maximum epochs to scan = number of solutions to average * this factor
+const int APPXYZ_MAXUNK = 7;        //maximum number of unknowns: position and a clock for G(+J), E and C systems
+const int APPXYZ_MAXITER = 10;      //maximum number of least squares iterations
+const double APPXYZ_MAXRMS = 100.0;     //maximum residuals RMS (m) to accept a solution
+const double APPXYZ_MINRADIUS = 6.2E6;  //geocentric radius limits (m) to accept a solution
+const double APPXYZ_MAXRADIUS = 6.6E6;
+//Size of the bit sets used to record systems and signals found in the header scan
+const int SGNL_SYSIDS = 26;     //system identifiers are upper case letters
+const int SGNL_BANDS = 10;      //band identifiers are digits. Attributes (upper case letters) are bits of a 32 bits word
 //Log messages
 const string LOG_MSG_PARERR("Params error");
 const string LOG_MSG_ERROPEN("Error opening GRD file ");
@@ -186,6 +200,14 @@ const string MSG_COMMA(", ");
 const string MSG_SLASH("/");
 const string MSG_COLON(": ");
 const string MSG_NOT_IMPL("NOT IMPLEMENTED");
+const string LOG_MSG_APPXYZ("Approx position from pseudoranges ");
+const string LOG_MSG_CKPSAVE("Cannot save GRD checkpoint");
+const string LOG_MSG_CKPREST("Cannot restore GRD checkpoint: ");
+//Identification of GNSSdataFromGRD checkpoint data (see saveCheckpoint), format version, and number of items in its layout
+//(the version and the sizes of data written as stored in memory)
+const char GRD_CKP_TAG[] = "GRDDATA CKP";
+const unsigned int GRD_CKP_VERSION = 2;
+const int GRD_CKP_LAYOUTSIZE = 10;
 
 ///GPS definitions related to navigation messages
 #define GPS_L1_CA_MSGSIZE 40
@@ -257,6 +279,8 @@ const double GLO_SLOT_FRQ2 = 0.4375; //L2 frequency factor frq = 1246 + fcn * GL
  *	-# Declare a GNSSdataFromGRD object stating the receiver, the file name with the raw data, and
  *		optionally the logger to be used
  *	-# Collect header data and save them into an object of RinexData class using collectHeaderData methods
+ *	-# Optionally, if raw data do not include a MT_LLA message, compute the approximate position from pseudoranges of the first
+ *		epochs using collectApproxPosition and the ephemerides collected from the NRD file
  *	-# Header data acquired can be used to generate / print RINEX or RTK files (see available methods
  *		in RinexData and RTKobservation classes for that)
  *	-# As header data may be sparse among the raw data file, rewind it before performing any other data acquisition
@@ -264,6 +288,17 @@ const double GLO_SLOT_FRQ2 = 0.4375; //L2 frequency factor frq = 1246 + fcn * GL
  *	-# Epoch data acquired can be used to generate / print RINEX file epoch (see available methods in
  *		RinexData classes)
  *	-# Repeat above steps 5 and 6 while epoch data are available in the input file.
+ *	-# For NRD files, the ephemeris can be collected in the same pass over the file than header data using collectHeaderAndNavData,
+ *		instead of using collectHeaderData, rewinding, and using collectNavData.
+ *	-# Optionally, to allow resuming the conversion when the input file grows, save the decoder and RinexData state using
+ *		saveCheckpoint methods of both objects.
+ *<p>
+ * To resume a conversion, a later process would open the input file and restore both checkpoints, instead of collecting
+ * header data. Then it would open the existing RINEX output file for update, positioned at its end, collect and print the new
+ * epochs (setting TIME OF LAST OBS for each one), call RinexData::updateObsTimes, and save again the checkpoints.
+ * Conversion continues from the message following the last epoch fully collected (or the last navigation message processed).
+ *<p>
+ * The same object can be used to convert several files, one after the other, calling resetConversion before opening each one.
  *<p>
  * This version implements processing of ...TODO
  * Each ORD message starts with ...TODO
@@ -279,6 +314,11 @@ public:
     bool collectHeaderData(RinexData &, int, int);
     bool collectEpochObsData(RinexData &);
     bool collectNavData(RinexData &);
+    bool collectHeaderAndNavData(RinexData &, int, int);
+    bool collectApproxPosition(RinexData &, const NavEvaluator &, int maxEpochs = APPXYZ_EPOCHS);
+    bool saveCheckpoint(FILE* out);
+    bool restoreCheckpoint(FILE* in);
+    void resetConversion();
     bool processHdData(RinexData &, int, string);
     void processFilterData(RinexData &);
     string getMsgDescription(int );
@@ -289,6 +329,10 @@ private:
 	int ordVersion;	//GNSS observation raw data version
 	int nrdVersion;	//GNSS navigation raw data version
     int msgCount;   //a counter of messages read from the file
+    long resumeOffset;      //position in the file of the message following the last epoch or nav message fully processed
+    int resumeClkDiscont;   //the clock discontinuity count at resumeOffset
+    int resumeMsgCount;     //the message counter at resumeOffset
+    bool navWithHeader;     //true when ephemeris are collected in the same pass than header data (see collectHeaderAndNavData)
     struct GNSSsystem {	//Defines data for each GNSS system that can provide data to the RINEX file. Used for all versions
         char sysId;	//system identification: G (GPS), R (GLONASS), S (SBAS), E (Galileo). See RINEX V302 document: 3.5 Satellite numbers
         vector <string> obsType;	//identifier of each obsType type: C1C, L1C, D1C, S1C... (see RINEX V302 document: 5.1 Observation codes)
@@ -299,6 +343,10 @@ private:
         };
     };
     vector <GNSSsystem> systems;
+    //bit sets of signals and navigation message systems found in the header scan, to update systems and SYS records only once
+    uint32_t sgnlFound[SGNL_SYSIDS * SGNL_BANDS];  //bit (attribute - 'A') of word (system - 'A') * SGNL_BANDS + band set if signal found
+    uint32_t navSysFound;   //bit (system - 'A') set if navigation messages from the system have been found
+    string navSystems;      //systems with navigation messages, in the order they were found
 	bool fitInterval;
     int clkoffset;      //0: obs not corrected; 1: obs corrected
 	bool applyBias;		//true if clkoffet = 1: apply clock bias to pseudoranges and print it in epoch clock record
@@ -315,6 +363,7 @@ private:
 		GPSSubframeData gpsSatSubframes[GPS_MAXSUBFRS];
 	};
 	GPSFrameData gpsSatFrame[GPS_MAXSATELLITES];
+	GPSFrameData gpsCorrFrame[GPS_MAXSATELLITES];	//frames used to get corrections when ephemeris are collected in the same pass
 	//number of GPS weeks roll over
 	int nGPSrollOver;
 	//Data structures to capture GLONASS navigation messages
@@ -327,6 +376,7 @@ private:
 		GLOStrData gloSatStrings[GLO_MAXSTRS];
 	};
 	GLOFrameData gloSatFrame[GLO_MAXSATELLITES];
+	GLOFrameData gloCorrFrame[GLO_MAXSATELLITES];	//frames used to get corrections when ephemeris are collected in the same pass
 	//A table to stablish OSN (Orbital Slot Number) - FCN (Frequency Channel Number) for GLONASS satellites
     //OSN values are in the range 1 to 24. FCN are in the range -7 to + 6
     //Values are extracted directly from string 4 (OSN), from observation carrier frequency data (FCN),
@@ -361,6 +411,7 @@ private:
         GALINAVpageData pageWord[GALINAV_MAXWORDS];
     };
     GALINAVFrameData galInavSatFrame[GAL_MAXSATELLITES];
+    GALINAVFrameData galInavCorrFrame[GAL_MAXSATELLITES];	//frames used to get corrections when ephemeris are collected in the same pass
     //number of GAL weeks roll over
     int nGALrollOver;
     //Data structures to capture BDS navigation messages
@@ -374,6 +425,7 @@ private:
         BDSD1SubframeData bdsSatSubframes[BDSD1_MAXSUBFRS];
     };
     BDSD1FrameData bdsSatFrame[BDS_MAXSATELLITES];
+    BDSD1FrameData bdsCorrFrame[BDS_MAXSATELLITES];	//frames used to get corrections when ephemeris are collected in the same pass
     //number of BDS weeks roll over
     int nBDSrollOver;
     //Constant data used to convert to RINEX broadcast orbit ephemeris values the broadcast orbit navigation data from satellite messages which contains only mantissas
@@ -388,14 +440,17 @@ private:
     Logger* plog;		//the place to send logging messages
     bool dynamicLog;	//true when created dynamically here, false when provided externally
     void setInitValues();
+    void getCkpLayout(unsigned int (&layout)[GRD_CKP_LAYOUTSIZE]);
 
     bool collectGPSL1CAEphemeris(RinexData &rinex, int msgType);
+    void saveGPSL1CAEphemeris(RinexData &rinex, int satNum, string &logMsg);
     bool collectGPSL1CACorrections(RinexData &rinex, int msgType);
     bool readGPSL1CANavMsg(char &constId, int &satNum, int &strnum, int &frame, string &logMsg);
     void extractGPSL1CAEphemeris(int sv, int (&bom)[BO_LINSTOTAL][BO_MAXCOLS]);
     double scaleGPSEphemeris(int (&bom)[BO_LINSTOTAL][BO_MAXCOLS], double (&bo)[BO_LINSTOTAL][BO_MAXCOLS]);
 
     bool collectGLOL1CAEphemeris(RinexData &rinex, int msgType);
+    void saveGLOL1CAEphemeris(RinexData &rinex, int satIdx, string &logMsg);
     bool collectGLOL1CACorrections(RinexData &rinex, int msgType);
     bool readGLOL1CANavMsg(char &constId, int &satNum, int &satIdx, int &strnum, int &frame, string &logMsg);
     void extractGLOL1CAEphemeris(int sat, int (&bom)[BO_LINSTOTAL][BO_MAXCOLS], int& slot);
@@ -404,12 +459,14 @@ private:
     int gloOSN(int satNum, char band = '1', double carrFrq = 0.0, bool updTbl = false);
 
     bool collectGALINEphemeris(RinexData &rinex, int msgType);
+    void saveGALINEphemeris(RinexData &rinex, int satNum, string &logMsg);
     bool collectGALINCorrections(RinexData &rinex, int msgType);
 	bool readGALINNavMsg(char &constId, int &satNum, int &strnum, int &frame, string &logMsg);
 	void extractGALINEphemeris(int sv, int (&bom)[BO_LINSTOTAL][BO_MAXCOLS]);
     double scaleGALEphemeris(int (&bom)[BO_LINSTOTAL][BO_MAXCOLS], double (&bo)[BO_LINSTOTAL][BO_MAXCOLS]);
 
     bool collectBDSD1Ephemeris(RinexData &rinex, int msgType);
+    void saveBDSD1Ephemeris(RinexData &rinex, int satNum, string &logMsg);
     bool collectBDSD1Corrections(RinexData &rinex, int msgType);
     bool readBDSD1NavMsg(char &constId, int &satNum, int &strnum, int &frame, string &logMsg);
     void extractBDSD1Ephemeris(int sv, int (&bom)[BO_LINSTOTAL][BO_MAXCOLS]);
@@ -417,12 +474,15 @@ private:
 
     bool isGoodGRDver(string extension, int version);
     bool addSignal(char system, string signal);
+    bool isSignalFound(char system, const char* signal);
+    void setSignalFound(char system, const char* signal);
+    void addNavSystem(char system);
     void skipToEOM();
     void setHdSys(RinexData &);
     bool trimBuffer(char*, const char*);
     void llaTOxyz( const double, const double, const double, double &, double &, double &);
-    double collectAndSetEpochTime(RinexData& rinex, double& tow, int& numObs, string msg);
-    vector<string> getElements(string, string);
+    bool solvePosition(const vector<char> &satSys, const vector<double> &psRange, const NavEvaluator::SATstates &states, double (&pos)[3]);
+    double collectAndSetEpochTime(RinexData& rinex, double& tow, int& numObs, const char* msg);
     bool isPsAmbiguous(char constellId, char* signalId, int synchState, double tRx, double &tRxGNSS, long long &tTx);
     bool isCarrierPhInvalid (char constellId, char* signalId, int carrierPhaseState);
     bool isKnownMeasur(char constellId, int satNum, char frqId, char attribute);
@@ -3,11 +3,14 @@
  *
  */
 #include <stdio.h>
+#include <math.h>
 
 #include "GNSSdataFromOSP.h"
 //from CommonClasses
 #include "Utilities.h"
 
+const double ThisPI = 3.1415926535898;	//the PI value used in the GPS ICD to scale ephemeris angles
+
 ///Macro to check message payload length and to log an error message if not correct 
 #define CHECK_PAYLOADLEN(LENGTH, ERROR_MSG) \
 	if (message.payloadLen() != LENGTH) { \
@@ -195,66 +198,21 @@ bool GNSSdataFromOSP::acqHeaderData(RTKobservation &rtko) {
  * @return true when observation data from an epoch messages have been acquired, false otherwise (End Of File reached)
  */
 bool GNSSdataFromOSP::acqEpochData(RinexData &rinex, bool useMID8G, bool useMID8R) {
-	int mid, ch, sv;
-	bool sameEpoch;
-	double anObservable;
+	int mid;
 	while (message.fill(ospFile)) {	//one message has been read from the binary file
 		mid = message.get();		//get first byte (MID) from message
 		switch(mid) {
 		case 7:		//the Rx sends MID7 when position for current epoch is computed (after sending MID28 msgs)
-			if (getMID7TimeData(rinex)) {
-				plog->fine("Epoch " + to_string((long double) epochGPStow) + " sats=" + to_string((long long) chSatObs.size()));
-				if(!chSatObs.empty()) {
-					for (vector<ChannelObs>::iterator it = chSatObs.begin(); it != chSatObs.end(); it++) {
-						//convert observables from the OSP units to RINEX units when necessary
-						//and apply corrections due to clock bias, when requested
-						anObservable = it->psedrng;		//unit are m
-						if (applyBias && (anObservable != 0.0)) anObservable -= epochClkBias * C1CADJ;
-						rinex.saveObsData(it->system, it->satPrn, "C1C", anObservable, it->limitOl, it->strgIdx, it->timeT);
-						anObservable = it->carrPh * L1WLINV;	//convert from initial unit (m) to cycles
-						if (applyBias && (anObservable != 0.0)) anObservable -= epochClkBias * L1CADJ;
-						rinex.saveObsData(it->system, it->satPrn, "L1C", anObservable, it->limitOl, it->strgIdx, it->timeT);
-						anObservable = it->carrFq * L1WLINV;	//convert from initial unit (m/s) to Hz
-						if (applyBias && (anObservable != 0.0)) anObservable -=  epochClkDrift;
-						rinex.saveObsData(it->system, it->satPrn, "D1C", anObservable, it->limitOl, it->strgIdx, it->timeT);
-						rinex.saveObsData(it->system, it->satPrn, "S1C", it->signalStrg, it->limitOl, it->strgIdx, it->timeT);
-					}
-					chSatObs.clear();
-					return true;
-				}
-			}
+			if (setEpochObsData(rinex)) return true;
 			break;
 		case 8:		//collect 50BPS ephemerides data in MID8
-			if (useMID8G || useMID8R) {
-				try {
-					//extract channel number an satellite number from the OSP message
-					ch = (int) message.get();
-					if (ch>=0 && ch<MAXCHANNELS) {	//channel in range, continue data extraction
-						sv = (int) message.get();	//the satellite number
-						if ((sv >= FIRSTGPSSAT) && (sv <= LASTGPSSAT)) {
-							if (useMID8G) getMID8GPSNavData(ch, sv, rinex);
-						} else if ((sv >= FIRSTGLOSAT) && (sv <= LASTGLOSAT)) {	//it is a GLONASS satellite SirfV
-							if (useMID8R) getMID8GLONavData(ch, sv, rinex);
-						} else {
-							plog->warning(msgMID8Ign + " satellite number out of GPS, GLONASS ranges:" + to_string((long long) sv));
-						}
-					} else plog->warning(msgMID8Ign + "channel not in range");
-				} catch (int error) {
-					plog->severe(msgMID8Ign + msgEOM + to_string((long long) error));
-				}
-			}
+			getMID8NavData(rinex, useMID8G, useMID8R);
 			break;
 		case 15:	//collect complete GPS ephemerides data in MID15
 			if (!useMID8G) getMID15NavData(rinex);
 			break;
 		case 28:	//collect satellite measurements from a channel in MID28
-			if (getMID28ObsData(rinex, sameEpoch)) {	//message data are correct and have been stored
-				if (!sameEpoch) {	//last data stored belong to a new epoch, and no MID7 has arrived!
-					//as no MID7 has been received, the epoch time is not availble and current epoch observables shall be discarded 
-					plog->warning("Epoch " + to_string((long double)chSatObs[0].timeT) + " ignored: MID7 lost");
-					chSatObs.erase(chSatObs.begin(), chSatObs.end() - 1);
-				}
-			}
+			checkMID28ObsData(rinex);
 			break;
 		case 70:	//collect complete GLONASS ephemerides data in MID70
 			if (!useMID8R) getMID70NavData(rinex);
@@ -376,6 +334,134 @@ bool GNSSdataFromOSP::acqEpochData(RTKobservation &rtko) {
 	return  false;
 }
 
+/**acqHeaderData extracts data from the binary OSP file for the RINEX file header and for the RTK file header, reading the file once.
+ * Data extracted are the ones described in the acqHeaderData methods for each product. Data of each MID2 message are decoded once
+ * and used for both of them.
+ *<p>The method iterates over the input file extracting messages until it reaches the end of file.
+ *
+ * @param rinex the RinexData object where RINEX header data will be placed
+ * @param rtko the RTKobservation object where RTK header data will be placed
+ * @return true if all RINEX and RTK header data are properly extracted, false otherwise
+ */
+bool GNSSdataFromOSP::acqHeaderData(RinexData &rinex, RTKobservation &rtko) {
+	bool rxIdSet = false;	//identification of receiver not set
+	bool apxSet = false;	//approximate position not set
+	bool frsEphSet = false;	//epoch data not received
+	bool intrvBegin = false; //time for the 1st epoch (having correct time) not stated
+	bool intrvSet = false;	//observations interval not set
+	bool maskSet = false;	//mask data set
+	bool fetSet = false;	//first solution time set
+	bool tofoSet = false;	//time of first observation set
+	float x, y, z;
+	int nsv, week, mid;
+	double tow;
+	plog->info("RINEX and RTK header data acquisition:");
+	while (message.fill(ospFile)) {	//there are messages in the binary file
+		mid = message.get();		//get first byte (MID)
+		switch(mid) {
+		case 2:		//solution data: approximate position for RINEX, and first and last solution times for RTK
+			//MID2 time shall not change the one of the first MID7, used to compute the observation interval
+			week = epochGPSweek;
+			tow = epochGPStow;
+			if (getMID2xyz(x, y, z, nsv)) {
+				rtko.setPosition(epochGPSweek, epochGPStow, (double) x, (double) y, (double) z, 5, nsv);
+				if (!fetSet)	{
+					rtko.setStartTime();
+					fetSet = true;
+				}
+				rtko.setEndTime();
+				try {
+					if (!apxSet) apxSet = rinex.setHdLnData(RinexData::APPXYZ, x, y, z);
+				} catch (string error) {
+					plog->severe(error + " in getMID2");
+				}
+			}
+			epochGPSweek = week;
+			epochGPStow = tow;
+			break;
+		case 6:		//extract the software version
+			if (!rxIdSet) rxIdSet = getMID6RxData(rinex);
+			break;
+		case 7:		//computer time interval from two consecutive epochs with correct time data
+			//all the file is read: once the interval is set, later MID7 shall not change it, nor the time of first observation
+			if (frsEphSet && !intrvSet) {
+				if (intrvBegin) frsEphSet = intrvBegin = intrvSet = getMID7Interval(rinex);
+				else {
+					frsEphSet = intrvBegin = getMID7TimeData(rinex);
+					if (intrvBegin && !tofoSet) tofoSet = rinex.setHdLnData(rinex.TOFO);
+				}
+			}
+			break;
+		case 19:	//collect MID19 with masks
+			maskSet = getMID19Masks(rtko);
+			break;
+		case 28:	//epoch data measurements. They precede the MID7 for the epoch
+			frsEphSet = true;
+			break;
+		default:
+			break;
+		}
+	}
+	//log data sources available or not
+	string logMessage = "Header data acquired:";
+	logMessage += apxSet? " Aprox. position;" : ";";
+	logMessage += intrvBegin? " 1st epoch time;" : ";";
+	logMessage += intrvSet? " Observation interval;" : ";";
+	logMessage += rxIdSet? " Receiver version;" : ";";
+	logMessage += fetSet? " 1st solution time;" : ";";
+	logMessage += maskSet? " Mask data" : "";
+	plog->info(logMessage);
+	return (apxSet && intrvBegin && rxIdSet && intrvSet && maskSet && fetSet);
+}
+
+/**acqEpochData acquires from binary OSP file messages, reading them once, the observation data for RINEX epochs,
+ * the navigation data for the RINEX navigation file, and the position solutions for the RTK file.
+ *<p>Each message is decoded once and its data placed in the object of the product it belongs:
+ * - MID28 and MID7 observation and time data are placed in the rinex object, as per acqEpochData for RinexData.
+ * - MID8, MID15 and MID70 ephemeris data are stored in the nav object, for further printing of the RINEX navigation file.
+ *	It can be the same object used for observations.
+ * - MID2 position solution data are placed in the rtko object, as per acqEpochData for RTKobservation.
+ *<p>The method returns when an observation epoch or a solution has been acquired, stating which one, to allow printing it
+ * in its own output file. Other messages in the input binary file are ignored.
+ *
+ * @param rinex the RinexData object where observation data will be placed
+ * @param nav the RinexData object where navigation data will be placed
+ * @param rtko the RTKobservation object where solution data will be placed
+ * @param useMID8G when true GPS navigation data will be acquired from MID8 messages, when false these data would be acquired from MID15
+ * @param useMID8R when true GLONASS navigation data will be acquired from MID8 messages , when false these data would be acquired from MID70
+ * @return OSP_ACQOBS when observation data from an epoch have been acquired, OSP_ACQSOL when a position solution has been acquired,
+ *	or OSP_ACQEOF when End Of File is reached
+ */
+int GNSSdataFromOSP::acqEpochData(RinexData &rinex, RinexData &nav, RTKobservation &rtko, bool useMID8G, bool useMID8R) {
+	int mid;
+	while (message.fill(ospFile)) {	//one message has been read from the binary file
+		mid = message.get();		//get first byte (MID) from message
+		switch(mid) {
+		case 2:		//position solution
+			if (getMID2PosData(rtko)) return OSP_ACQSOL;
+			break;
+		case 7:		//the Rx sends MID7 when position for current epoch is computed (after sending MID28 msgs)
+			if (setEpochObsData(rinex)) return OSP_ACQOBS;
+			break;
+		case 8:		//collect 50BPS ephemerides data in MID8
+			getMID8NavData(nav, useMID8G, useMID8R);
+			break;
+		case 15:	//collect complete GPS ephemerides data in MID15
+			if (!useMID8G) getMID15NavData(nav);
+			break;
+		case 28:	//collect satellite measurements from a channel in MID28
+			checkMID28ObsData(rinex);
+			break;
+		case 70:	//collect complete GLONASS ephemerides data in MID70
+			if (!useMID8R) getMID70NavData(nav);
+			break;
+		default:
+			break;
+		}
+	}
+	return OSP_ACQEOF;
+}
+
 //PRIVATE METHODS
 //===============
 /**setTblValues set conversion parameter tables used to translate scaled normalized GPS message data to values in actual units.
@@ -601,8 +687,10 @@ bool GNSSdataFromOSP::getMID7TimeData(RinexData &rinex) {
 		return false;
 	}
 	rinex.setEpochTime(epochGPSweek, epochGPStow, epochClkBias, 0);
-	sprintf(msgBuf, "MID7 time week=%d tow=%g bias=%g", epochGPSweek, epochGPStow, epochClkBias);
-	plog->finer(string(msgBuf));
+	if (plog->isLevel(Logger::FINER)) {
+		sprintf(msgBuf, "MID7 time week=%d tow=%g bias=%g", epochGPSweek, epochGPStow, epochClkBias);
+		plog->finer(string(msgBuf));
+	}
 	return true;
 }
 
@@ -889,7 +977,8 @@ bool GNSSdataFromOSP::getMID28ObsData(RinexData &rinex, bool &sameEpoch) {
 		plog->severe("MID28 " + msgEOM + to_string((long long) error));
 		return false;
 	}
-	sprintf(msgBuf,"MID28 tTag=%g ch=%2d sv=%2d sat=%c%02d psr=%g SynFlg=%02X ", gpsSWtime, channel, sv, sys, satID, pseudorange, syncFlags);
+	bool logIt = plog->isLevel(Logger::FINER);
+	if (logIt) sprintf(msgBuf,"MID28 tTag=%g ch=%2d sv=%2d sat=%c%02d psr=%g SynFlg=%02X ", gpsSWtime, channel, sv, sys, satID, pseudorange, syncFlags);
 	//compute strengthIndex as per RINEX spec (5.7): min(max(strength / 6, 1), 9)
 	strengthIndex = strength / 6;
 	if (strengthIndex < 1) strengthIndex = 1;
@@ -900,13 +989,88 @@ bool GNSSdataFromOSP::getMID28ObsData(RinexData &rinex, bool &sameEpoch) {
 		if ((syncFlags & 0x10) == 0) carrierFrequency = 0.0;
 		chSatObs.push_back(ChannelObs(sys, satID, pseudorange, carrierPhase, carrierFrequency, (double) strength, 0, strengthIndex, gpsSWtime));
 		sameEpoch = gpsSWtime == chSatObs[0].timeT;
-		plog->finer(string(msgBuf) + "SAVED");
+		if (logIt) plog->finer(string(msgBuf) + "SAVED");
 		return true;
 	}
-	plog->finer(string(msgBuf) + "IGNORED");
+	if (logIt) plog->finer(string(msgBuf) + "IGNORED");
 	return false;
 }
 
+/**checkMID28ObsData gets satellite measurements from a MID28 message, as per getMID28ObsData, and checks if they belong to the
+ * current epoch. If they belong to a new epoch, the current epoch observables are discarded, because no MID7 has been received
+ * for it and its time is unknown.
+ *
+ * @param rinex	the RinexData class instance where data are to be stored
+ */
+void GNSSdataFromOSP::checkMID28ObsData(RinexData &rinex) {
+	bool sameEpoch;
+	if (getMID28ObsData(rinex, sameEpoch)) {	//message data are correct and have been stored
+		if (!sameEpoch) {	//last data stored belong to a new epoch, and no MID7 has arrived!
+			//as no MID7 has been received, the epoch time is not availble and current epoch observables shall be discarded 
+			plog->warning("Epoch " + to_string((long double)chSatObs[0].timeT) + " ignored: MID7 lost");
+			chSatObs.erase(chSatObs.begin(), chSatObs.end() - 1);
+		}
+	}
+}
+
+/**setEpochObsData gets the epoch time from a MID7 message and, if observables from MID28 messages have been collected for the epoch,
+ * converts them to RINEX units (applying clock bias corrections when requested) and stores them into the RinexData object.
+ *
+ * @param rinex	the RinexData class instance where data are to be stored
+ * @return true when observation data of the epoch have been stored, false otherwise
+ */
+bool GNSSdataFromOSP::setEpochObsData(RinexData &rinex) {
+	double anObservable;
+	if (!getMID7TimeData(rinex)) return false;
+	if (plog->isLevel(Logger::FINE))
+		plog->fine("Epoch " + to_string((long double) epochGPStow) + " sats=" + to_string((long long) chSatObs.size()));
+	if (chSatObs.empty()) return false;
+	for (vector<ChannelObs>::iterator it = chSatObs.begin(); it != chSatObs.end(); it++) {
+		//convert observables from the OSP units to RINEX units when necessary
+		//and apply corrections due to clock bias, when requested
+		anObservable = it->psedrng;		//unit are m
+		if (applyBias && (anObservable != 0.0)) anObservable -= epochClkBias * C1CADJ;
+		rinex.saveObsData(it->system, it->satPrn, "C1C", anObservable, it->limitOl, it->strgIdx, it->timeT);
+		anObservable = it->carrPh * L1WLINV;	//convert from initial unit (m) to cycles
+		if (applyBias && (anObservable != 0.0)) anObservable -= epochClkBias * L1CADJ;
+		rinex.saveObsData(it->system, it->satPrn, "L1C", anObservable, it->limitOl, it->strgIdx, it->timeT);
+		anObservable = it->carrFq * L1WLINV;	//convert from initial unit (m/s) to Hz
+		if (applyBias && (anObservable != 0.0)) anObservable -=  epochClkDrift;
+		rinex.saveObsData(it->system, it->satPrn, "D1C", anObservable, it->limitOl, it->strgIdx, it->timeT);
+		rinex.saveObsData(it->system, it->satPrn, "S1C", it->signalStrg, it->limitOl, it->strgIdx, it->timeT);
+	}
+	chSatObs.clear();
+	return true;
+}
+
+/**getMID8NavData gets from a MID8 message the channel and satellite numbers and, depending on the satellite system and on the
+ * source of navigation data requested, gets GPS or GLONASS navigation data from it.
+ *
+ * @param rinex	the RinexData class instance where data are to be stored
+ * @param useMID8G when true GPS navigation data are acquired from MID8 messages
+ * @param useMID8R when true GLONASS navigation data are acquired from MID8 messages
+ */
+void GNSSdataFromOSP::getMID8NavData(RinexData &rinex, bool useMID8G, bool useMID8R) {
+	int ch, sv;
+	if (!useMID8G && !useMID8R) return;
+	try {
+		//extract channel number an satellite number from the OSP message
+		ch = (int) message.get();
+		if (ch>=0 && ch<MAXCHANNELS) {	//channel in range, continue data extraction
+			sv = (int) message.get();	//the satellite number
+			if ((sv >= FIRSTGPSSAT) && (sv <= LASTGPSSAT)) {
+				if (useMID8G) getMID8GPSNavData(ch, sv, rinex);
+			} else if ((sv >= FIRSTGLOSAT) && (sv <= LASTGLOSAT)) {	//it is a GLONASS satellite SirfV
+				if (useMID8R) getMID8GLONavData(ch, sv, rinex);
+			} else {
+				plog->warning(msgMID8Ign + " satellite number out of GPS, GLONASS ranges:" + to_string((long long) sv));
+			}
+		} else plog->warning(msgMID8Ign + "channel not in range");
+	} catch (int error) {
+		plog->severe(msgMID8Ign + msgEOM + to_string((long long) error));
+	}
+}
+
 /**getMID70NavData gets GLONASS ephemeris data from a MID 70 SID 12 message
  * 
  * @param rinex	the class instance where data are stored
@@ -58,7 +58,6 @@ const double LSPEED = 299792458.0;	//the speed of light
 const double C1CADJ = 299792458.0;	//to adjust C1C (pseudorrange L1 in meters) = C1CADJ (the speed of light) * clkOff
 const double L1CADJ = 1575420000.0;	//to adjust L1C (carrier phase in cycles) =  L1CADJ (L1 carrier frequency) * clkOff
 const double L1WLINV = 1575420000.0 / 299792458.0; //the inverse of L1 wave length to convert m/s to Hz.
-const double ThisPI = 3.1415926535898;
 
 //a bit mask definition for the bits participating in the computation of parity (see GPS ICD)
 //bit mask order: D29 D30 d1 d2 d3 ... d24 ... d29 d30
@@ -71,6 +70,11 @@ const string msgMID8Ign ("MID8 ignored: ");
 const string msgFew (" ignored: few SVs in solution");
 //@endcond
 
+//Values returned by the combined epoch data acquisition (see GNSSdataFromOSP::acqEpochData)
+const int OSP_ACQEOF = 0;	//end of file reached
+const int OSP_ACQOBS = 1;	//observation data of an epoch acquired
+const int OSP_ACQSOL = 2;	//a position solution acquired
+
 /**GNSSdataFromOSP class defines data and methods used to acquire RINEX or RTK header and epoch data from a binary OSP file containing receiver messages.
  * Such header and epoch data can be used to generate and print RINEX or RTK files.
  *<p>
@@ -84,6 +88,13 @@ const string msgFew (" ignored: few SVs in solution");
  *	-# Epoch data acquired can be used to generate / print RINEX or RTK file epoch (see available methods in RinexData and RTKobservation classes)
  *	-# Repeat above steps 5 and 6 while epoch data are available in the input file.
  *<p>
+ * RINEX observation, RINEX navigation and RTK solution products can be obtained reading the binary file only once for header
+ * data and once for epoch data, using the combined acquisition methods: acqHeaderData with RinexData and RTKobservation objects,
+ * and acqEpochData with the objects where observations, navigation data and solutions will be placed. Each message is
+ * decoded once and its data dispatched to the product it belongs: MID28 and MID7 to observations, MID8, MID15 and MID70 to
+ * navigation data, and MID2 to solutions. acqEpochData returns each time an observation epoch or a solution is acquired,
+ * stating which one, to allow printing it in its own output file.
+ *<p>
  * This version implements acquisition from binary files containing OSP messages collected from SiRFIV receivers.
  * Each OSP message starts with the payload length (2 bytes) and follows the n bytes of the message payload.
  *<p>
@@ -102,6 +113,8 @@ public:
 	bool acqHeaderData(RTKobservation &);
 	bool acqEpochData(RinexData &, bool, bool);
 	bool acqEpochData(RTKobservation &);
+	bool acqHeaderData(RinexData &, RTKobservation &);
+	int acqEpochData(RinexData &, RinexData &, RTKobservation &, bool, bool);
 	bool acqGLOparams();
 
 private:
@@ -187,6 +200,9 @@ private:
 	bool getMID15NavData(RinexData &);
 	bool getMID19Masks(RTKobservation &);
 	bool getMID28ObsData(RinexData &, bool &);
+	void checkMID28ObsData(RinexData &);
+	bool setEpochObsData(RinexData &);
+	void getMID8NavData(RinexData &, bool, bool);
 	bool getMID70NavData(RinexData &);
 };
 #endif
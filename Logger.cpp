@@ -90,7 +90,7 @@ void Logger::setLevel(string levelDescription) {
  *@return true when messages at the given level would be logged, false otherwise.
  */
 bool Logger::isLevel(logLevel level) {
-	if (levelSet <= level) return true;
+	if (level <= levelSet) return true;
 	return false;
 }
 
@@ -106,7 +106,7 @@ bool Logger::isLevel(logLevel level) {
  *@param levelDescription the word describing the log level to set
  */
 bool Logger::isLevel(string levelDescription) {
-	if (levelSet <= identifyLevel(levelDescription)) return true;
+	if (identifyLevel(levelDescription) <= levelSet) return true;
 	return false;
 }
 
@@ -187,25 +187,17 @@ void Logger::finest(string toLog) {
  *@param message contains its description
  */
 void Logger::logMsg(logLevel msgLevel, string msg) {
+	const char* levelTags[] = {"(SVR) ", "(WRN) ", "(INF) ", "(CFG) ", "(FNE) ", "(FNR) ", "(FNS) "};
 	time_t rawtime;
-	struct tm * timeinfo;
+	struct tm timeinfo;		//local storage for the time, as the Logger can be used from several threads
 	char txtBuf[80];
 
 	time (&rawtime);
-	timeinfo = localtime (&rawtime);
-	if (msgLevel == SEVERE) strftime(txtBuf, sizeof txtBuf, " %Y-%m-%d %H:%M:%S ", timeinfo);
-	else strftime(txtBuf, sizeof txtBuf, " %H:%M:%S ", timeinfo);
-	fprintf(fileLog, "%s%s", program.c_str(), txtBuf);
-	switch (msgLevel) {
-	case SEVERE: fprintf(fileLog, "(SVR) "); break;
-	case WARNING: fprintf(fileLog, "(WRN) "); break;
-	case INFO: fprintf(fileLog, "(INF) "); break;
-	case CONFIG: fprintf(fileLog, "(CFG) "); break;
-	case FINE:  fprintf(fileLog, "(FNE) "); break;
-	case FINER:  fprintf(fileLog, "(FNR) "); break;
-	case FINEST: fprintf(fileLog, "(FNS) "); break;
-	}
-	fprintf(fileLog, "%s\n", msg.c_str());
+	localtime_r(&rawtime, &timeinfo);
+	if (msgLevel == SEVERE) strftime(txtBuf, sizeof txtBuf, " %Y-%m-%d %H:%M:%S ", &timeinfo);
+	else strftime(txtBuf, sizeof txtBuf, " %H:%M:%S ", &timeinfo);
+	//the message is written with only one call to avoid mixing lines when several threads log at the same time
+	fprintf(fileLog, "%s%s%s%s\n", program.c_str(), txtBuf, levelTags[msgLevel], msg.c_str());
 	fflush(fileLog);
 }
 
@@ -220,14 +212,17 @@ void Logger::logMsg(logLevel msgLevel, string msg) {
  */
 Logger::logLevel Logger::identifyLevel(string levelDescription) {
 	logLevel levelId;
-	string lvlUpp = strToUpper(levelDescription);
-	if (lvlUpp.front() == 'S') levelId = SEVERE;
-	else if (lvlUpp.front() == 'W') levelId = WARNING;
-	else if (lvlUpp.front() == 'I') levelId = INFO;
-	else if (lvlUpp.front() == 'C') levelId = CONFIG;
-	else if (lvlUpp.back() == 'E') levelId = FINE;
-	else if (lvlUpp.back() == 'R') levelId = FINER;
-	else if (lvlUpp.back() == 'T') levelId = FINEST;
+	if (levelDescription.empty()) return INFO;
+	//only first and last chars are needed to identify the level
+	char first = (char) toupper((unsigned char) levelDescription.front());
+	char last = (char) toupper((unsigned char) levelDescription.back());
+	if (first == 'S') levelId = SEVERE;
+	else if (first == 'W') levelId = WARNING;
+	else if (first == 'I') levelId = INFO;
+	else if (first == 'C') levelId = CONFIG;
+	else if (last == 'E') levelId = FINE;
+	else if (last == 'R') levelId = FINER;
+	else if (last == 'T') levelId = FINEST;
 	else levelId = INFO;
 	return levelId;
 }
@@ -0,0 +1,495 @@
+/** @file NavEvaluator.cpp
+ * Contains the implementation of the NavEvaluator class.
+ */
+#include "NavEvaluator.h"
+#include <math.h>
+#include <algorithm>
+#include <limits.h>
+
+//constants for the systems using Keplerian elements (GPS and QZSS, Galileo, BeiDou)
+const double GPS_MU = 3.986005e14;			//gravitational constant (m3/s2)
+const double GPS_OMEGAE = 7.2921151467e-5;	//earth rotation rate (rad/s)
+const double GPS_F = -4.442807633e-10;		//relativistic correction constant (s/m^1/2)
+const double GAL_MU = 3.986004418e14;
+const double GAL_OMEGAE = 7.2921151467e-5;
+const double GAL_F = -4.442807309e-10;
+const double BDS_MU = 3.986004418e14;
+const double BDS_OMEGAE = 7.2921150e-5;
+const double BDS_F = -4.442807309e-10;
+const double BDS_GEOINC = -5.0 * M_PI / 180.0;	//inclination of the frame used for BeiDou GEO satellites
+const int KEPLER_ITER = 5;			//the number of Newton iterations to solve the Kepler equation (enough for e < 0.1)
+//the maximum distance in seconds to the time of ephemeris for each system (GPS uses its fit interval if greater)
+const double GPS_MAXAGE = 7200.0;
+const double QZS_MAXAGE = 7200.0;
+const double GAL_MAXAGE = 14400.0;
+const double BDS_MAXAGE = 21600.0;
+//constants for GLONASS (PZ-90)
+const double GLO_MU = 3.9860044e14;
+const double GLO_OMEGAE = 7.292115e-5;
+const double GLO_AE = 6378136.0;		//earth equatorial radius (m)
+const double GLO_J2 = 1.0826257e-3;		//second zonal harmonic
+const double GLO_STEP = 60.0;			//the maximum integration step in seconds
+const double GLO_MAXAGE = 1800.0;		//the maximum distance in seconds to the reference time
+const double WEEK_SECS = 604800.0;
+
+/**Constructs an empty NavEvaluator object.
+ */
+NavEvaluator::NavEvaluator() {
+}
+
+/**Destructor.
+ */
+NavEvaluator::~NavEvaluator() {
+}
+
+/**clear removes all ephemerides added.
+ */
+void NavEvaluator::clear() {
+	ephemerides.clear();
+	keplerEph.clear();
+	gloEph.clear();
+	satIndex.clear();
+	satMaxAge.clear();
+}
+
+/**addEphemeris adds a satellite ephemeris to the evaluator. Data are given as stored in RinexData (see getNavData).
+ * The ephemeris is inserted in the index of its satellite, and can be selected by findEphemeris just after being added.
+ *
+ * @param sys the system identification (G, J, E, C, R)
+ * @param sat the satellite PRN
+ * @param bo the broadcast orbit data
+ * @param tTag the time tag of the ephemeris (its time of clock) as seconds from the GPS epoch
+ * @return true if the ephemeris has been added, false if the system is not supported
+ */
+bool NavEvaluator::addEphemeris(char sys, int sat, const double (&bo)[BO_MAXLINS][BO_MAXCOLS], double tTag) {
+	EPHref ref;
+	ref.system = sys;
+	ref.satellite = sat;
+	ref.toc = tTag;
+	if (sys == 'R') {
+		GLOeph eph;
+		eph.toc = tTag;
+		eph.clkBias = bo[0][1];
+		eph.clkRate = bo[0][2];
+		for (int i = 0; i < 3; i++) {
+			//RINEX data are given in km
+			eph.pos[i] = bo[i + 1][0] * 1000.0;
+			eph.vel[i] = bo[i + 1][1] * 1000.0;
+			eph.acc[i] = bo[i + 1][2] * 1000.0;
+		}
+		ref.refTime = tTag;
+		ref.maxAge = GLO_MAXAGE;
+		ref.healthy = bo[1][3] == 0.0;
+		ref.kepler = false;
+		ref.pos = gloEph.size();
+		gloEph.push_back(eph);
+		ephemerides.push_back(ref);
+		addToIndex(ephemerides.size() - 1);
+		return true;
+	}
+	KEPLEReph eph;
+	switch (sys) {
+	case 'G':
+		eph.mu = GPS_MU;
+		eph.omegaE = GPS_OMEGAE;
+		eph.relF = GPS_F;
+		//the fit interval is given in hours
+		eph.maxAge = max(GPS_MAXAGE, bo[7][1] * 1800.0);
+		break;
+	case 'J':
+		eph.mu = GPS_MU;
+		eph.omegaE = GPS_OMEGAE;
+		eph.relF = GPS_F;
+		eph.maxAge = QZS_MAXAGE;
+		break;
+	case 'E':
+		eph.mu = GAL_MU;
+		eph.omegaE = GAL_OMEGAE;
+		eph.relF = GAL_F;
+		eph.maxAge = GAL_MAXAGE;
+		break;
+	case 'C':
+		eph.mu = BDS_MU;
+		eph.omegaE = BDS_OMEGAE;
+		eph.relF = BDS_F;
+		eph.maxAge = BDS_MAXAGE;
+		break;
+	default:
+		return false;
+	}
+	eph.geo = ((sys == 'C') && ((sat <= 5) || (sat >= 59)))? 1.0 : 0.0;
+	eph.toc = tTag;
+	eph.af0 = bo[0][1];
+	eph.af1 = bo[0][2];
+	eph.af2 = bo[0][3];
+	eph.crs = bo[1][1];
+	eph.deltaN = bo[1][2];
+	eph.m0 = bo[1][3];
+	eph.cuc = bo[2][0];
+	eph.e = bo[2][1];
+	eph.cus = bo[2][2];
+	eph.sqrtA = bo[2][3];
+	eph.toe = bo[3][0];
+	eph.cic = bo[3][1];
+	eph.omega0 = bo[3][2];
+	eph.cis = bo[3][3];
+	eph.i0 = bo[4][0];
+	eph.crc = bo[4][1];
+	eph.omega = bo[4][2];
+	eph.omegaDot = bo[4][3];
+	eph.iDot = bo[5][0];
+	//the time of ephemeris is placed in the week of the time of clock, or in the nearest one
+	eph.toeAbs = floor(tTag / WEEK_SECS) * WEEK_SECS + eph.toe;
+	if (eph.toeAbs - tTag > WEEK_SECS / 2) eph.toeAbs -= WEEK_SECS;
+	else if (eph.toeAbs - tTag < -WEEK_SECS / 2) eph.toeAbs += WEEK_SECS;
+	ref.refTime = eph.toeAbs;
+	ref.maxAge = eph.maxAge;
+	ref.healthy = bo[6][1] == 0.0;
+	ref.kepler = true;
+	ref.pos = keplerEph.size();
+	keplerEph.push_back(eph);
+	ephemerides.push_back(ref);
+	addToIndex(ephemerides.size() - 1);
+	return true;
+}
+
+/**addEphemerides adds to the evaluator all ephemerides stored in the given RinexData object.
+ *
+ * @param rinex the object containing navigation data
+ * @return the number of ephemerides added (ephemerides of systems not supported are ignored)
+ */
+unsigned int NavEvaluator::addEphemerides(RinexData &rinex) {
+	char sys;
+	int sat;
+	double bo[BO_MAXLINS][BO_MAXCOLS];
+	double tTag;
+	unsigned int n = 0;
+	for (unsigned int i = 0; rinex.getNavData(sys, sat, bo, tTag, i); i++)
+		if (addEphemeris(sys, sat, bo, tTag)) n++;
+	return n;
+}
+
+/**getNumEphemerides gets the number of ephemerides added.
+ *
+ * @return the number of ephemerides
+ */
+unsigned int NavEvaluator::getNumEphemerides() const {
+	return ephemerides.size();
+}
+
+/**getEphemerisId gets the identification data of the given ephemeris.
+ *
+ * @param ephIdx the ephemeris index (in the order they were added)
+ * @param sys the system identification
+ * @param sat the satellite PRN
+ * @param tTag the time tag of the ephemeris
+ * @return true if the ephemeris exists, false otherwise
+ */
+bool NavEvaluator::getEphemerisId(int ephIdx, char &sys, int &sat, double &tTag) const {
+	if ((ephIdx < 0) || ((unsigned int) ephIdx >= ephemerides.size())) return false;
+	sys = ephemerides[ephIdx].system;
+	sat = ephemerides[ephIdx].satellite;
+	tTag = ephemerides[ephIdx].toc;
+	return true;
+}
+
+/**findEphemeris finds the best ephemeris of the given satellite for the given time: the healthy one with reference time (time of
+ * ephemeris, or time of clock for GLONASS) nearest to the given time, and inside its validity interval. When several ephemerides have
+ * the same reference time, the last added is selected.
+ * The ephemeris is searched in the satellite index, in logarithmic time.
+ *
+ * @param sys the system identification
+ * @param sat the satellite PRN
+ * @param time the time as seconds from the GPS epoch
+ * @return the index of the ephemeris found, or -1 if there is not a valid ephemeris for the satellite at this time
+ */
+int NavEvaluator::findEphemeris(char sys, int sat, double time) const {
+	unordered_map< int, vector< pair<double, unsigned int> > >::const_iterator itsat = satIndex.find(((int) sys << 8) + sat);
+	if (itsat == satIndex.end()) return -1;
+	const vector< pair<double, unsigned int> > &sorted = itsat->second;
+	double maxAge = satMaxAge.find(itsat->first)->second;
+	//the first ephemeris with reference time after the given time
+	vector< pair<double, unsigned int> >::const_iterator next = upper_bound(sorted.begin(), sorted.end(), make_pair(time, UINT_MAX));
+	int found = -1;
+	double minDist = 0.0;
+	//search backwards and forwards the nearest healthy ephemeris valid at the given time. Ephemerides further than the
+	//largest validity interval of the satellite cannot be valid
+	for (vector< pair<double, unsigned int> >::const_iterator it = next; it != sorted.begin(); ) {
+		--it;
+		const EPHref &ref = ephemerides[it->second];
+		double dist = time - it->first;
+		if (dist > maxAge) break;
+		if (dist > ref.maxAge) continue;
+		if (ref.healthy) {
+			found = (int) it->second;
+			minDist = dist;
+			break;
+		}
+	}
+	for (vector< pair<double, unsigned int> >::const_iterator it = next; it != sorted.end(); ++it) {
+		const EPHref &ref = ephemerides[it->second];
+		double dist = it->first - time;
+		if ((dist > maxAge) || ((found >= 0) && (dist >= minDist))) break;
+		if (dist > ref.maxAge) continue;
+		if (ref.healthy) {
+			found = (int) it->second;
+			//among healthy ephemerides with the same reference time, the last added
+			double refTime = it->first;
+			while ((++it != sorted.end()) && (it->first == refTime))
+				if (ephemerides[it->second].healthy) found = (int) it->second;
+			break;
+		}
+	}
+	return found;
+}
+
+/**evaluate computes the satellite states for the given pairs of time and ephemeris.
+ * States are stored in the given object, in the same order of the pairs.
+ *
+ * @param times the times as seconds from the GPS epoch (in the time scale of each ephemeris system)
+ * @param ephIdx the index of the ephemeris to use for each time (a negative value if there is not ephemeris)
+ * @param n the number of pairs
+ * @param states the object where states computed are stored
+ */
+void NavEvaluator::evaluate(const double* times, const int* ephIdx, unsigned int n, SATstates &states) const {
+	states.x.assign(n, 0.0);
+	states.y.assign(n, 0.0);
+	states.z.assign(n, 0.0);
+	states.clk.assign(n, 0.0);
+	states.valid.assign(n, 0);
+	//Keplerian elements are evaluated together. GLONASS orbits are integrated one by one
+	vector <unsigned int> keplerItems;
+	keplerItems.reserve(n);
+	for (unsigned int i = 0; i < n; i++) {
+		if ((ephIdx[i] < 0) || ((unsigned int) ephIdx[i] >= ephemerides.size())) continue;
+		const EPHref &ref = ephemerides[ephIdx[i]];
+		if (ref.kepler) keplerItems.push_back(i);
+		else {
+			//orbits are integrated only for times where the ephemeris is valid
+			const GLOeph &eph = gloEph[ref.pos];
+			if (fabs(times[i] - eph.toc) > GLO_MAXAGE) continue;
+			evaluateGlonass(times[i], eph, states.x[i], states.y[i], states.z[i], states.clk[i]);
+			states.valid[i] = 1;
+		}
+	}
+	evaluateKepler(times, keplerItems.data(), ephIdx, keplerItems.size(), states);
+}
+
+/**evaluateSat computes the states of the given satellite at the given times, using for each time the best ephemeris (see findEphemeris).
+ *
+ * @param sys the system identification
+ * @param sat the satellite PRN
+ * @param times the times as seconds from the GPS epoch (in the time scale of the system)
+ * @param states the object where states computed are stored, in the order of times
+ * @return the number of valid states computed
+ */
+unsigned int NavEvaluator::evaluateSat(char sys, int sat, const vector<double> &times, SATstates &states) const {
+	vector <int> ephIdx(times.size());
+	for (unsigned int i = 0; i < times.size(); i++) ephIdx[i] = findEphemeris(sys, sat, times[i]);
+	evaluate(times.data(), ephIdx.data(), times.size(), states);
+	unsigned int n = 0;
+	for (unsigned int i = 0; i < times.size(); i++) n += states.valid[i];
+	return n;
+}
+
+/**addToIndex inserts the given ephemeris in the index of its satellite, keeping it sorted by reference time, and updates the
+ * largest maxAge of the satellite ephemerides.
+ * Ephemerides with the same reference time are kept in the order they were added.
+ *
+ * @param ephIdx the index of the ephemeris in ephemerides
+ */
+void NavEvaluator::addToIndex(unsigned int ephIdx) {
+	const EPHref &ref = ephemerides[ephIdx];
+	int satKey = ((int) ref.system << 8) + ref.satellite;
+	vector< pair<double, unsigned int> > &sorted = satIndex[satKey];
+	pair<double, unsigned int> item(ref.refTime, ephIdx);
+	sorted.insert(upper_bound(sorted.begin(), sorted.end(), item), item);
+	double &satAge = satMaxAge[satKey];		//0 when the satellite is new
+	satAge = max(satAge, ref.maxAge);
+}
+
+/**evaluateKepler computes the satellite states for the given items using Keplerian elements.
+ * The data of the items are gathered in structure of arrays form, their states computed by evaluateKeplerBatch, and then
+ * stored in the given object.
+ *
+ * @param times the times of all pairs
+ * @param items the position in times and ephIdx of each pair to evaluate
+ * @param ephIdx the ephemeris of all pairs
+ * @param n the number of items
+ * @param states the object where states computed are stored
+ */
+void NavEvaluator::evaluateKepler(const double* times, const unsigned int* items, const int* ephIdx, unsigned int n, SATstates &states) const {
+	KEPLERbatch batch(n);
+	for (unsigned int k = 0; k < n; k++) {
+		unsigned int i = items[k];
+		const KEPLEReph &eph = keplerEph[ephemerides[ephIdx[i]].pos];
+		batch.tk[k] = times[i] - eph.toeAbs;
+		batch.dt[k] = times[i] - eph.toc;
+		batch.af0[k] = eph.af0;
+		batch.af1[k] = eph.af1;
+		batch.af2[k] = eph.af2;
+		batch.toe[k] = eph.toe;
+		batch.sqrtA[k] = eph.sqrtA;
+		batch.e[k] = eph.e;
+		batch.m0[k] = eph.m0;
+		batch.deltaN[k] = eph.deltaN;
+		batch.omega0[k] = eph.omega0;
+		batch.i0[k] = eph.i0;
+		batch.omega[k] = eph.omega;
+		batch.omegaDot[k] = eph.omegaDot;
+		batch.iDot[k] = eph.iDot;
+		batch.cuc[k] = eph.cuc;
+		batch.cus[k] = eph.cus;
+		batch.crc[k] = eph.crc;
+		batch.crs[k] = eph.crs;
+		batch.cic[k] = eph.cic;
+		batch.cis[k] = eph.cis;
+		batch.mu[k] = eph.mu;
+		batch.omegaE[k] = eph.omegaE;
+		batch.relF[k] = eph.relF;
+		batch.geo[k] = eph.geo;
+		batch.maxAge[k] = eph.maxAge;
+	}
+	evaluateKeplerBatch(batch, n);
+	for (unsigned int k = 0; k < n; k++) {
+		unsigned int i = items[k];
+		states.x[i] = batch.x[k];
+		states.y[i] = batch.y[k];
+		states.z[i] = batch.z[k];
+		states.clk[i] = batch.clk[k];
+		states.valid[i] = batch.valid[k];
+	}
+}
+
+/**evaluateKeplerBatch computes the satellite states for the pairs in the given batch.
+ * The loop has only unit stride accesses and no data dependent branches: the Kepler equation is solved with a fixed number
+ * of Newton iterations (enough for the eccentricity of navigation satellites), and the BeiDou GEO rotation is applied using
+ * its flag as a factor. Vectorizing it also needs the compiler to have vector versions of the math functions used.
+ *
+ * @param batch the data of the pairs, where their states are stored
+ * @param n the number of pairs
+ */
+void NavEvaluator::evaluateKeplerBatch(KEPLERbatch &batch, unsigned int n) {
+	const double cosGeoInc = cos(BDS_GEOINC);
+	const double sinGeoInc = sin(BDS_GEOINC);
+	const double* tks = batch.tk.data();
+	const double* dts = batch.dt.data();
+	const double* af0s = batch.af0.data();
+	const double* af1s = batch.af1.data();
+	const double* af2s = batch.af2.data();
+	const double* toes = batch.toe.data();
+	const double* sqrtAs = batch.sqrtA.data();
+	const double* es = batch.e.data();
+	const double* m0s = batch.m0.data();
+	const double* deltaNs = batch.deltaN.data();
+	const double* omega0s = batch.omega0.data();
+	const double* i0s = batch.i0.data();
+	const double* omegas = batch.omega.data();
+	const double* omegaDots = batch.omegaDot.data();
+	const double* iDots = batch.iDot.data();
+	const double* cucs = batch.cuc.data();
+	const double* cuss = batch.cus.data();
+	const double* crcs = batch.crc.data();
+	const double* crss = batch.crs.data();
+	const double* cics = batch.cic.data();
+	const double* ciss = batch.cis.data();
+	const double* mus = batch.mu.data();
+	const double* omegaEs = batch.omegaE.data();
+	const double* relFs = batch.relF.data();
+	const double* geos = batch.geo.data();
+	const double* maxAges = batch.maxAge.data();
+	double* xs = batch.x.data();
+	double* ys = batch.y.data();
+	double* zs = batch.z.data();
+	double* clks = batch.clk.data();
+	unsigned char* valids = batch.valid.data();
+	for (unsigned int k = 0; k < n; k++) {
+		double tk = tks[k];
+		double e = es[k];
+		double a = sqrtAs[k] * sqrtAs[k];
+		//mean anomaly and eccentric anomaly
+		double m = m0s[k] + (sqrt(mus[k] / (a * a * a)) + deltaNs[k]) * tk;
+		double ea = m;
+		for (int j = 0; j < KEPLER_ITER; j++) ea -= (ea - e * sin(ea) - m) / (1.0 - e * cos(ea));
+		double sinE = sin(ea);
+		double cosE = cos(ea);
+		//argument of latitude, radius and inclination, with their corrections
+		double phi = atan2(sqrt(1.0 - e * e) * sinE, cosE - e) + omegas[k];
+		double sin2Phi = sin(2.0 * phi);
+		double cos2Phi = cos(2.0 * phi);
+		double u = phi + cuss[k] * sin2Phi + cucs[k] * cos2Phi;
+		double r = a * (1.0 - e * cosE) + crss[k] * sin2Phi + crcs[k] * cos2Phi;
+		double inc = i0s[k] + iDots[k] * tk + ciss[k] * sin2Phi + cics[k] * cos2Phi;
+		double xp = r * cos(u);
+		double yp = r * sin(u);
+		//longitude of ascending node: GEO satellites are computed in an inertial frame and rotated later
+		double node = omega0s[k] + (omegaDots[k] - omegaEs[k] * (1.0 - geos[k])) * tk - omegaEs[k] * toes[k];
+		double sinNode = sin(node);
+		double cosNode = cos(node);
+		double cosInc = cos(inc);
+		double x = xp * cosNode - yp * cosInc * sinNode;
+		double y = xp * sinNode + yp * cosInc * cosNode;
+		double z = yp * sin(inc);
+		//rotation for GEO satellites (identity when geo is 0)
+		double rot = omegaEs[k] * tk * geos[k];
+		double cosIncG = 1.0 + (cosGeoInc - 1.0) * geos[k];
+		double sinIncG = sinGeoInc * geos[k];
+		double y1 = y * cosIncG + z * sinIncG;
+		double z1 = -y * sinIncG + z * cosIncG;
+		xs[k] = x * cos(rot) + y1 * sin(rot);
+		ys[k] = -x * sin(rot) + y1 * cos(rot);
+		zs[k] = z1;
+		//clock correction, including the relativistic term
+		double dt = dts[k];
+		clks[k] = af0s[k] + (af1s[k] + af2s[k] * dt) * dt + relFs[k] * e * sqrtAs[k] * sinE;
+		valids[k] = fabs(tk) <= maxAges[k];
+	}
+}
+
+/**evaluateGlonass computes the state of a GLONASS satellite integrating its orbit from the ephemeris reference time.
+ * It is used a 4th order Runge-Kutta method with steps of GLO_STEP seconds at most.
+ *
+ * @param time the time as seconds from the GPS epoch (UTC)
+ * @param eph the ephemeris
+ * @param x the ECEF position computed (meters)
+ * @param y
+ * @param z
+ * @param clk the satellite clock correction (seconds)
+ */
+void NavEvaluator::evaluateGlonass(double time, const GLOeph &eph, double &x, double &y, double &z, double &clk) const {
+	///a macro to compute the derivative DER of the state ST
+	#define GLO_DERIV(ST, DER) { \
+			double r2 = ST[0] * ST[0] + ST[1] * ST[1] + ST[2] * ST[2]; \
+			double r = sqrt(r2); \
+			double muR3 = GLO_MU / (r2 * r); \
+			double j2Term = 1.5 * GLO_J2 * GLO_MU * GLO_AE * GLO_AE / (r2 * r2 * r); \
+			double z2r2 = 5.0 * ST[2] * ST[2] / r2; \
+			DER[0] = ST[3]; \
+			DER[1] = ST[4]; \
+			DER[2] = ST[5]; \
+			DER[3] = -muR3 * ST[0] - j2Term * ST[0] * (1.0 - z2r2) + GLO_OMEGAE * GLO_OMEGAE * ST[0] + 2.0 * GLO_OMEGAE * ST[4] + eph.acc[0]; \
+			DER[4] = -muR3 * ST[1] - j2Term * ST[1] * (1.0 - z2r2) + GLO_OMEGAE * GLO_OMEGAE * ST[1] - 2.0 * GLO_OMEGAE * ST[3] + eph.acc[1]; \
+			DER[5] = -muR3 * ST[2] - j2Term * ST[2] * (3.0 - z2r2) + eph.acc[2]; \
+		}
+
+	double state[6] = {eph.pos[0], eph.pos[1], eph.pos[2], eph.vel[0], eph.vel[1], eph.vel[2]};
+	double k1[6], k2[6], k3[6], k4[6], tmp[6];
+	double span = time - eph.toc;
+	int nSteps = (int) ceil(fabs(span) / GLO_STEP);
+	double h = (nSteps > 0)? span / nSteps : 0.0;
+	for (int s = 0; s < nSteps; s++) {
+		GLO_DERIV(state, k1)
+		for (int j = 0; j < 6; j++) tmp[j] = state[j] + h / 2.0 * k1[j];
+		GLO_DERIV(tmp, k2)
+		for (int j = 0; j < 6; j++) tmp[j] = state[j] + h / 2.0 * k2[j];
+		GLO_DERIV(tmp, k3)
+		for (int j = 0; j < 6; j++) tmp[j] = state[j] + h * k3[j];
+		GLO_DERIV(tmp, k4)
+		for (int j = 0; j < 6; j++) state[j] += h / 6.0 * (k1[j] + 2.0 * k2[j] + 2.0 * k3[j] + k4[j]);
+	}
+	x = state[0];
+	y = state[1];
+	z = state[2];
+	clk = eph.clkBias + eph.clkRate * span;
+	#undef GLO_DERIV
+}
@@ -0,0 +1,168 @@
+/** @file NavEvaluator.h
+ * Contains the definition of the NavEvaluator class.
+ * A NavEvaluator object computes satellite positions and clock corrections from broadcast ephemerides.
+ *
+ *Copyright 2015, 2021 by Francisco Cancillo & Luis Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *See the GNU General Public License for more details.
+ *<p>
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *<p>Ver.	|Date	|Reason for change
+ *<p>---------------------------------
+ *<p>V1.0	|10/2026|First release
+ */
+#ifndef NAVEVALUATOR_H
+#define NAVEVALUATOR_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include "RinexData.h"	//from CommonClasses
+
+using namespace std;
+
+/**NavEvaluator class computes in batch ECEF satellite positions and clock corrections from broadcast ephemerides, as stored
+ *by RinexData in broadcastOrbit arrays (see getNavData).
+ *<p>Ephemerides of GPS, QZSS, Galileo and BeiDou (Keplerian elements) and GLONASS (state vectors) can be added to the evaluator
+ *one by one using addEphemeris, or all the ones stored in a RinexData object using addEphemerides.
+ *<p>The evaluate method computes the satellite states for a set of pairs time / ephemeris. Results are given in a SATstates object,
+ *a structure of arrays with the X, Y, Z position (meters) and clock correction (seconds) of each pair. Data of pairs with Keplerian
+ *elements are gathered in structure of arrays form, and their states computed in a loop with unit stride accesses and without data
+ *dependent branches (the Kepler equation is solved with a fixed number of iterations). Whether the compiler vectorizes this loop
+ *depends on its support of vector math functions: GCC 12, for example, merges sines and cosines of the same angle into sincos
+ *calls that it does not vectorize.
+ *GLONASS orbits are integrated from the ephemeris reference time using a 4th order Runge-Kutta method, only for times where the
+ *ephemeris is valid.
+ *<p>Ephemerides are indexed by satellite and sorted by their reference time (time of ephemeris, or time of clock for GLONASS) when
+ *added, even during a live pass. findEphemeris uses this index to select, in logarithmic time, the best ephemeris of a satellite for a
+ *given time: the healthy one with reference time nearest to it and inside its validity interval (from the fit interval, when given).
+ *<p>Times are seconds from the GPS epoch, in the time scale of the ephemeris system as in the RINEX navigation files: GPS time for
+ *GPS, QZSS and Galileo, BeiDou time for BeiDou, and UTC for GLONASS. Clock corrections include the relativistic term, but not
+ *group delays.
+ */
+class NavEvaluator {
+public:
+	struct SATstates {	//satellite states computed, in structure of arrays form
+		vector <double> x;		//the ECEF position in meters
+		vector <double> y;
+		vector <double> z;
+		vector <double> clk;	//the satellite clock correction in seconds
+		vector <unsigned char> valid;	//1 if the state was computed, 0 if the ephemeris does not exist or is too old for the time
+	};
+	NavEvaluator();
+	~NavEvaluator();
+	void clear();
+	bool addEphemeris(char sys, int sat, const double (&bo)[BO_MAXLINS][BO_MAXCOLS], double tTag);
+	unsigned int addEphemerides(RinexData &rinex);
+	unsigned int getNumEphemerides() const;
+	bool getEphemerisId(int ephIdx, char &sys, int &sat, double &tTag) const;
+	int findEphemeris(char sys, int sat, double time) const;
+	void evaluate(const double* times, const int* ephIdx, unsigned int n, SATstates &states) const;
+	unsigned int evaluateSat(char sys, int sat, const vector<double> &times, SATstates &states) const;
+
+private:
+	struct EPHref {		//identifies each ephemeris added and where its data are
+		char system;		//the system identification (G, E, C, R, ...)
+		int satellite;		//the satellite PRN
+		double toc;			//the time tag of the ephemeris
+		double refTime;		//the reference time of the ephemeris: time of ephemeris, or time of clock for GLONASS
+		double maxAge;		//the maximum distance in seconds to refTime for the ephemeris to be valid
+		bool healthy;		//true if the satellite health is OK
+		bool kepler;		//true for Keplerian elements, false for GLONASS state vector
+		unsigned int pos;	//the position of its data in keplerEph or gloEph
+	};
+	struct KEPLEReph {	//Keplerian elements and clock parameters
+		double toc;			//time of clock, as seconds from the GPS epoch
+		double af0;			//clock bias, drift and drift rate
+		double af1;
+		double af2;
+		double toeAbs;		//time of ephemeris, as seconds from the GPS epoch
+		double toe;			//time of ephemeris, as seconds of week
+		double sqrtA;		//square root of the semi-major axis
+		double e;			//eccentricity
+		double m0;			//mean anomaly at reference time
+		double deltaN;		//mean motion difference
+		double omega0;		//longitude of ascending node at weekly epoch
+		double i0;			//inclination at reference time
+		double omega;		//argument of perigee
+		double omegaDot;	//rate of right ascension
+		double iDot;		//rate of inclination
+		double cuc;			//harmonic correction terms
+		double cus;
+		double crc;
+		double crs;
+		double cic;
+		double cis;
+		double mu;			//gravitational constant of the system
+		double omegaE;		//earth rotation rate of the system
+		double relF;		//relativistic correction constant of the system
+		double geo;			//1.0 for BeiDou GEO satellites, 0.0 otherwise
+		double maxAge;		//the maximum distance in seconds to toe for the ephemeris to be valid
+	};
+	struct KEPLERbatch {	//the data of the pairs time / ephemeris evaluated together, in structure of arrays form
+		vector <double> tk;		//the time from the time of ephemeris
+		vector <double> dt;		//the time from the time of clock
+		vector <double> af0;	//the Keplerian elements and constants of each pair, as in KEPLEReph
+		vector <double> af1;
+		vector <double> af2;
+		vector <double> toe;
+		vector <double> sqrtA;
+		vector <double> e;
+		vector <double> m0;
+		vector <double> deltaN;
+		vector <double> omega0;
+		vector <double> i0;
+		vector <double> omega;
+		vector <double> omegaDot;
+		vector <double> iDot;
+		vector <double> cuc;
+		vector <double> cus;
+		vector <double> crc;
+		vector <double> crs;
+		vector <double> cic;
+		vector <double> cis;
+		vector <double> mu;
+		vector <double> omegaE;
+		vector <double> relF;
+		vector <double> geo;
+		vector <double> maxAge;
+		vector <double> x;		//the states computed for each pair
+		vector <double> y;
+		vector <double> z;
+		vector <double> clk;
+		vector <unsigned char> valid;
+		//constructor
+		KEPLERbatch(unsigned int n) : tk(n), dt(n), af0(n), af1(n), af2(n), toe(n), sqrtA(n), e(n), m0(n), deltaN(n), omega0(n), i0(n),
+			omega(n), omegaDot(n), iDot(n), cuc(n), cus(n), crc(n), crs(n), cic(n), cis(n), mu(n), omegaE(n), relF(n), geo(n), maxAge(n),
+			x(n), y(n), z(n), clk(n), valid(n) {
+		}
+	};
+	struct GLOeph {		//GLONASS state vector and clock parameters
+		double toc;			//reference time, as seconds from the GPS epoch
+		double clkBias;		//-TauN
+		double clkRate;		//+GammaN
+		double pos[3];		//position, velocity and lunisolar acceleration in meters
+		double vel[3];
+		double acc[3];
+	};
+	vector <EPHref> ephemerides;
+	vector <KEPLEReph> keplerEph;
+	vector <GLOeph> gloEph;
+	//for each satellite (system * 256 + PRN), the refTime and index in ephemerides of its ephemerides, sorted by refTime and index
+	unordered_map < int, vector< pair<double, unsigned int> > > satIndex;
+	//for each satellite, the largest maxAge of its ephemerides, which bounds the search in its index
+	unordered_map < int, double > satMaxAge;
+
+	void addToIndex(unsigned int ephIdx);
+	void evaluateKepler(const double* times, const unsigned int* items, const int* ephIdx, unsigned int n, SATstates &states) const;
+	static void evaluateKeplerBatch(KEPLERbatch &batch, unsigned int n);
+	void evaluateGlonass(double time, const GLOeph &eph, double &x, double &y, double &z, double &clk) const;
+};
+#endif
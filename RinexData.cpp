@@ -7,9 +7,85 @@
 #include <stdio.h>
 #include <math.h>
 #include <cstdio>
+#include <thread>
+#include <sys/stat.h>
 //from CommonClasses
 #include "Utilities.h"
 
+/**labelDef contains the definitions of all RINEX header labels: identifier, value in columns 61-80, RINEX version where
+ * it is defined, and type of record.
+ * Entries are sorted as their RINEXlabel identifiers, which is also the order of records in the header.
+ */
+const RinexData::LABELdata RinexData::labelDef[RinexData::LASTONE + 1] = {
+	{NOLABEL,	"No label detected",	VALL, NAP},
+	{VERSION,	"RINEX VERSION / TYPE",	VALL, OBSOBL + NAVOBL},
+	{RUNBY,	"PGM / RUN BY / DATE",	VALL, OBSOBL + NAVOBL},
+	{COMM,	"COMMENT",	VALL, OBSOPT + NAVOPT},
+	{MRKNAME,	"MARKER NAME",	VALL, OBSOBL + NAVNAP},
+	{MRKNUMBER,	"MARKER NUMBER",	VALL, OBSOPT + NAVNAP},
+	{MRKTYPE,	"MARKER TYPE",	V304, OBSOBL + NAVNAP},
+	{AGENCY,	"OBSERVER / AGENCY",	VALL, OBSOBL + NAVNAP},
+	{RECEIVER,	"REC # / TYPE / VERS",	VALL, OBSOBL + NAVNAP},
+	{ANTTYPE,	"ANT # / TYPE",	VALL, OBSOBL + NAVNAP},
+	{APPXYZ,	"APPROX POSITION XYZ",	VALL, OBSOBL + NAVNAP},
+	{ANTHEN,	"ANTENNA: DELTA H/E/N",	VALL, OBSOBL + NAVNAP},
+	{ANTXYZ,	"ANTENNA: DELTA X/Y/Z",	V304, OBSOPT + NAVNAP},
+	{ANTPHC,	"ANTENNA: PHASECENTER",	V304, OBSOPT + NAVNAP},
+	{ANTBS,	"ANTENNA: B.SIGHT XYZ",	V304, OBSOPT + NAVNAP},
+	{ANTZDAZI,	"ANTENNA: ZERODIR AZI",	V304, OBSOPT + NAVNAP},
+	{ANTZDXYZ,	"ANTENNA: ZERODIR XYZ",	V304, OBSOPT + NAVNAP},
+	{COFM,	"CENTER OF MASS XYZ",	V304, OBSOPT + NAVNAP},
+	{WVLEN,	"WAVELENGTH FACT L1/2",	V210, OBSOBL + NAVNAP},
+	{TOBS,	"# / TYPES OF OBSERV",	V210, OBSOBL + NAVNAP},
+	{SYS,	"SYS / # / OBS TYPES",	V304, OBSOBL + NAVNAP},
+	{SIGU,	"SIGNAL STRENGTH UNIT",	V304, OBSOPT + NAVNAP},
+	{INT,	"INTERVAL",	VALL, OBSOPT + NAVNAP},
+	{TOFO,	"TIME OF FIRST OBS",	VALL, OBSOBL + NAVNAP},
+	{TOLO,	"TIME OF LAST OBS",	VALL, OBSOPT + NAVNAP},
+	{CLKOFFS,	"RCV CLOCK OFFS APPL",	VALL, OBSOPT + NAVNAP},
+	{DCBS,	"SYS / DCBS APPLIED",	V304, OBSOPT + NAVNAP},
+	{PCVS,	"SYS / PCVS APPLIED",	V304, OBSOPT + NAVNAP},
+	{SCALE,	"SYS / SCALE FACTOR",	V304, OBSOPT + NAVNAP},
+	{PHSH,	"SYS / PHASE SHIFTS",	V304, OBSOBL + NAVNAP},
+	{GLSLT,	"GLONASS SLOT / FRQ #",	V304, OBSOBL + NAVNAP},
+	{GLPHS,	"GLONASS COD/PHS/BIS",	V304, OBSOBL + NAVNAP},
+	{SATS,	"# OF SATELLITES",	VALL, OBSOPT + NAVNAP},
+	{PRNOBS,	"PRN / # OF OBS",	VALL, OBSOPT + NAVNAP},
+	{IONA,	"ION ALPHA",	V210, OBSNAP + NAVOPT},
+	{IONB,	"ION BETA",	V210, OBSNAP + NAVOPT},
+	{IONC,	"IONOSPHERIC CORR",	V304, OBSNAP + NAVOPT},
+	{DUTC,	"DELTA-UTC: A0,A1,T,W",	V210, OBSNAP + NAVOPT},
+	{CORRT,	"CORR TO SYSTEM TIME",	V210, OBSNAP + NAVOPT},
+	{GEOT,	"D-UTC A0,A1,T,W,S,U",	V210, OBSNAP + NAVOPT},
+	{TIMC,	"TIME SYSTEM CORR",	V304, OBSNAP + NAVOPT},
+	{LEAP,	"LEAP SECONDS",	VALL, OBSOPT + NAVOPT},
+	{EOH,	"END OF HEADER",	VALL, OBSOBL + NAVOBL},
+	{IONC_GAL,	"GAL ",	VALL, NAP},
+	{IONC_GPSA,	"GPSA",	VALL, NAP},
+	{IONC_GPSB,	"GPSB",	VALL, NAP},
+	{IONC_QZSA,	"QZSA",	VALL, NAP},
+	{IONC_QZSB,	"QZSB",	VALL, NAP},
+	{IONC_BDSA,	"BDSA",	VALL, NAP},
+	{IONC_BDSB,	"BDSB",	VALL, NAP},
+	{IONC_IRNA,	"IRNA",	VALL, NAP},
+	{IONC_IRNB,	"IRNB",	VALL, NAP},
+	{TIMC_GPUT,	"GPUT",	VALL, NAP},
+	{TIMC_GLUT,	"GLUT",	VALL, NAP},
+	{TIMC_GAUT,	"GAUT",	VALL, NAP},
+	{TIMC_BDUT,	"BDUT",	VALL, NAP},
+	{TIMC_QZUT,	"QZUT",	VALL, NAP},
+	{TIMC_IRUT,	"IRUT",	VALL, NAP},
+	{TIMC_SBUT,	"SBUT",	VALL, NAP},
+	{TIMC_GLGP,	"GLGP",	VALL, NAP},
+	{TIMC_GAGP,	"GAGP",	VALL, NAP},
+	{TIMC_BDGP,	"BDGP",	VALL, NAP},
+	{TIMC_QZGP,	"QZGP",	VALL, NAP},
+	{TIMC_IRGP,	"IRGP",	VALL, NAP},
+	{INFILEVER,	NULL,	VALL, NAP},
+	{DONTMATCH,	"Incorrect label for this RINEX version",	VALL, NAP},
+	{LASTONE,	"Last item",	VALL, NAP}
+};
+
 /**RinexData constructor providing only the minimum data required: the RINEX file version to be generated.
  *
  * Version parameter is needed in the header record RINEX VERSION / TYPE: which is mandatory in any RINEX file. Note that version
@@ -56,8 +132,8 @@ RinexData::RinexData(RINEXversion ver, string prg, string rby) {
 	dynamicLog = true;
 	setDefValues(ver, plog);
 	//assign values to class data members from arguments passed 
-	pgm = prg;
-	runby = rby;
+	hdr.pgm = prg;
+	hdr.runby = rby;
 	setLabelFlag(RUNBY);
 }
 
@@ -77,17 +153,62 @@ RinexData::RinexData(RINEXversion ver, string prg, string rby, Logger* plogger)
 	dynamicLog = false;
 	setDefValues(ver, plogger);
 	//assign values to class data members from arguments passed 
-	pgm = prg;
-	runby = rby;
+	hdr.pgm = prg;
+	hdr.runby = rby;
 	setLabelFlag(RUNBY);
 }
 
+/**RinexData constructor providing the RINEX file version to be generated, a snapshot of header data, and the Logger for logging messages.
+ *
+ * Header data are taken from the snapshot (see getHeaderSnapshot). Epoch data are empty.
+ * <p>A VTBD in version means that the version in the snapshot is used.
+ *
+ * @param ver the RINEX version to be generated
+ * @param snapshot the header data snapshot
+ * @param plogger a pointer to a Logger to be used to record logging messages
+ */
+RinexData::RinexData(RINEXversion ver, const shared_ptr<const HDRdata> &snapshot, Logger* plogger) {
+	dynamicLog = false;
+	setDefValues(ver, plogger);
+	hdr = *snapshot;
+	if (ver != VTBD) hdr.version = ver;
+}
+
+/**RinexData constructor providing the RINEX file version to be generated and a snapshot of header data.
+ *
+ * Header data are taken from the snapshot (see getHeaderSnapshot). Epoch data are empty.
+ * <p>A VTBD in version means that the version in the snapshot is used.
+ * <p>Logging data are sent to the stderr.
+ *
+ * @param ver the RINEX version to be generated
+ * @param snapshot the header data snapshot
+ */
+RinexData::RinexData(RINEXversion ver, const shared_ptr<const HDRdata> &snapshot) {
+	plog = new Logger();
+	dynamicLog = true;
+	setDefValues(ver, plog);
+	hdr = *snapshot;
+	if (ver != VTBD) hdr.version = ver;
+}
+
 /**Destructor.
  */
 RinexData::~RinexData(void) {
+	closeObsMerge();
+	closeObsSplit();
 	if (dynamicLog) delete plog;
 }
 
+/**getHeaderSnapshot captures the current header data in an immutable object that can be shared among several writers,
+ * even in different threads. It contains only header data: epoch data and the Logger of this object are not included.
+ * Writers are created from the snapshot using the constructors having a snapshot parameter, each one with its own Logger.
+ *
+ * @return the snapshot of header data
+ */
+shared_ptr<const RinexData::HDRdata> RinexData::getHeaderSnapshot() const {
+	return shared_ptr<const HDRdata>(new HDRdata(hdr));
+}
+
 //PUBLIC METHODS
 
 ///a macro to assign in setHdLnData the value of the method parameter a to the given member
@@ -138,12 +259,13 @@ RinexData::~RinexData(void) {
 bool RinexData::setHdLnData(RINEXlabel rl, RINEXlabel a, const string &b) {
 	switch(rl) {
 	case COMM:
-		for (vector<LABELdata>::iterator it = labelDef.begin() ; it != labelDef.end(); ++it)
-			if((it->labelID == a) || (it->labelID == EOH)) {
-				lastRecordSet = labelDef.insert(it, LABELdata(b));
-				return true;
-			}
-		return false;
+		if ((a == COMM) && !hdr.hdComments.empty() && (hdr.hdComments.front().pos <= COMM)) {
+			//insert before the first comment
+			hdr.hdComments.insert(hdr.hdComments.begin(), HDcomment(hdr.hdComments.front().pos, b));
+			return true;
+		}
+		insertComment(((a > NOLABEL) && (a < EOH))? a : EOH, b);
+		return true;
 	default:
 		throw errorLabelMis + idTOlbl(rl) + msgSetHdLn;
 	}
@@ -241,14 +363,14 @@ bool RinexData::setHdLnData(RINEXlabel rl, RINEXlabel a, const double (&b)[4], i
 		case IONC:
         case TIMC:
 			//check if these data have been already stored
-			for (vector<CORRECTION>::iterator it = corrections.begin(); it != corrections.end(); it++) {
+			for (vector<CORRECTION>::iterator it = hdr.corrections.begin(); it != hdr.corrections.end(); it++) {
 				if ((it->corrType == a)
                     && (it->corrValues[0] == b[0])
                     && (it->corrValues[1] == b[1])
                     && (it->corrValues[2] == b[2])
                     && (it->corrValues[3] == b[3])) return false;
 			}
-			corrections.push_back(CORRECTION(a, b, c, d));
+			hdr.corrections.push_back(CORRECTION(a, b, c, d));
 			setLabelFlag(rl);
             return true;
 		default:
@@ -271,14 +393,14 @@ bool RinexData::setHdLnData(RINEXlabel rl, RINEXlabel a, const double (&b)[4], i
 bool RinexData::setHdLnData(RINEXlabel rl, char a) {
     switch(rl) {
         case TOFO:
-            firstObsWeek = epochWeek;
-            firstObsTOW = epochTOW;
-            obsTimeSys = a;
+            hdr.firstObsWeek = epochWeek;
+            hdr.firstObsTOW = epochTOW;
+            hdr.obsTimeSys = a;
             setLabelFlag(TOFO);
             return true;
         case TOLO:
-            lastObsWeek = epochWeek;
-            lastObsTOW = epochTOW;
+            hdr.lastObsWeek = epochWeek;
+            hdr.lastObsTOW = epochTOW;
             setLabelFlag(TOLO);
             return true;
         default:
@@ -303,7 +425,7 @@ bool RinexData::setHdLnData(RINEXlabel rl, char a) {
 bool RinexData::setHdLnData(RINEXlabel rl, char a, int b, const vector<int> &c) {
 	switch(rl) {
 	case PRNOBS:
-		prnObsNum.push_back(PRNobsnum(a, b, c));
+		hdr.prnObsNum.push_back(PRNobsnum(a, b, c));
 		setLabelFlag(PRNOBS);
 		return true;
 	default:
@@ -328,7 +450,7 @@ bool RinexData::setHdLnData(RINEXlabel rl, char a, int b, const vector<string> &
 	switch(rl) {
 	case SCALE:
 		if ((n = systemIndex(a)) < 0) return false;
-		obsScaleFact.push_back(OSCALEfact(n, b, c));
+		hdr.obsScaleFact.push_back(OSCALEfact(n, b, c));
 		setLabelFlag(SCALE);
 		return true;
 	default:
@@ -353,9 +475,9 @@ bool RinexData::setHdLnData(RINEXlabel rl, char a, int b, const vector<string> &
 bool RinexData::setHdLnData(RINEXlabel rl, char a, const string &b, double c, double d, double e) {
 	switch(rl) {
 	case ANTPHC:
-		antPhEoY = d;
-		antPhUoZ = e;
-		SET_3PARAM(ANTPHC, antPhSys, antPhCode, antPhNoX)
+		hdr.antPhEoY = d;
+		hdr.antPhUoZ = e;
+		SET_3PARAM(ANTPHC, hdr.antPhSys, hdr.antPhCode, hdr.antPhNoX)
 	default:
 		throw errorLabelMis + idTOlbl(rl) + msgSetHdLn;
 	}
@@ -379,7 +501,7 @@ bool RinexData::setHdLnData(RINEXlabel rl, char a, const string &b, double c, co
     switch(rl) {
         case PHSH:
             if ((sysInx = systemIndex(a)) >= 0) {
-                phshCorrection.push_back(PHSHcorr(sysInx, b, c, d));
+                hdr.phshCorrection.push_back(PHSHcorr(sysInx, b, c, d));
                 setLabelFlag(PHSH);
             } else return false;
             break;
@@ -406,7 +528,7 @@ bool RinexData::setHdLnData(RINEXlabel rl, char a, const string &b, const string
 	switch(rl) {
 	case DCBS:
 		if ((n = systemIndex(a)) < 0) return false;
-		dcbsApp.push_back(DCBSPCVSapp(n, b, c));
+		hdr.dcbsApp.push_back(DCBSPCVSapp(n, b, c));
 		setLabelFlag(DCBS);
 		return true;
 	default:
@@ -436,21 +558,21 @@ bool RinexData::setHdLnData(RINEXlabel rl, char a,  vector<string> &b) {
         sysIndex = systemIndex(a);
         if (sysIndex < 0) {
         	//a new system and its observables is inserted
-            systems.push_back(GNSSsystem(a, b));
+            hdr.systems.push_back(GNSSsystem(a, b));
             setLabelFlag(SYS);
             setLabelFlag(TOBS);
         } else {
         	//the system already exists, insert the new observables
             for (vector<string>::iterator itNewObs = b.begin(); itNewObs != b.end(); itNewObs++) {
                 isNew = true;
-                for (vector<OBSmeta>::iterator itObs = systems[sysIndex].obsTypes.begin(); itObs != systems[sysIndex].obsTypes.end(); itObs++) {
+                for (vector<OBSmeta>::iterator itObs = hdr.systems[sysIndex].obsTypes.begin(); itObs != hdr.systems[sysIndex].obsTypes.end(); itObs++) {
                     if ((*itNewObs).compare(itObs->id) == 0) {
                         isNew = false;
                         break;
                     }
                 }
                 if (isNew) {
-					systems[sysIndex].obsTypes.push_back(OBSmeta(*itNewObs, true, false));
+					hdr.systems[sysIndex].obsTypes.push_back(OBSmeta(*itNewObs, true, false));
                 }
             }
         }
@@ -488,25 +610,25 @@ bool RinexData::setHdLnData(RINEXlabel rl, char a,  vector<string> &b) {
 bool RinexData::setHdLnData(RINEXlabel rl, double a, double b, double c) {
 	switch(rl) {
 	case ANTZDAZI:
-		SET_1PARAM(ANTZDAZI, antZdAzi)
+		SET_1PARAM(ANTZDAZI, hdr.antZdAzi)
 	case INT:
-		SET_1PARAM(INT, obsInterval)
+		SET_1PARAM(INT, hdr.obsInterval)
 	case ANTHEN:
-		SET_3PARAM(ANTHEN, antHigh, eccEast, eccNorth)
+		SET_3PARAM(ANTHEN, hdr.antHigh, hdr.eccEast, hdr.eccNorth)
 	case APPXYZ:
-		SET_3PARAM(APPXYZ, aproxX, aproxY, aproxZ)
+		SET_3PARAM(APPXYZ, hdr.aproxX, hdr.aproxY, hdr.aproxZ)
 	case ANTXYZ:
-		SET_3PARAM(ANTXYZ, antX, antY, antZ)
+		SET_3PARAM(ANTXYZ, hdr.antX, hdr.antY, hdr.antZ)
 	case ANTBS:
-		SET_3PARAM(ANTBS, antBoreX, antBoreY, antBoreZ)
+		SET_3PARAM(ANTBS, hdr.antBoreX, hdr.antBoreY, hdr.antBoreZ)
 	case ANTZDXYZ:
-		SET_3PARAM(ANTZDXYZ, antZdX, antZdY, antZdZ)
+		SET_3PARAM(ANTZDXYZ, hdr.antZdX, hdr.antZdY, hdr.antZdZ)
 	case COFM:
-		SET_3PARAM(COFM, centerX, centerY, centerZ)
+		SET_3PARAM(COFM, hdr.centerX, hdr.centerY, hdr.centerZ)
 	case VERSION:
-		version = VTBD;
-		if (a > 2.0) version = V210;
-		if (a > 3.0) version = V304;
+		hdr.version = VTBD;
+		if (a > 2.0) hdr.version = V210;
+		if (a > 3.0) hdr.version = V304;
 		return true;
 	default:
 		throw errorLabelMis + idTOlbl(rl) + msgSetHdLn;
@@ -549,10 +671,10 @@ bool RinexData::setHdLnData(RINEXlabel rl, double a, double b, double c) {
 bool RinexData::setHdLnData(RINEXlabel rl, int a, int b, int c, int d, char e) {
 	switch(rl) {
 	case CLKOFFS:
-		SET_1PARAM(CLKOFFS, rcvClkOffs)
+		SET_1PARAM(CLKOFFS, hdr.rcvClkOffs)
 	case LEAP:
 		if (e == ' ') e = 'G';	//by default GPS
-		for (vector<LEAPsecs>::iterator it = leapSecs.begin(); it != leapSecs.end(); it++) {
+		for (vector<LEAPsecs>::iterator it = hdr.leapSecs.begin(); it != hdr.leapSecs.end(); it++) {
 		    //check if values already set
 			if ((it->sysId == e)
                 && (it->secs == a)
@@ -560,23 +682,23 @@ bool RinexData::setHdLnData(RINEXlabel rl, int a, int b, int c, int d, char e) {
                 && (it->weekLSF == c)
                 && (it->dayLSF == d)) return false;
 		}
-		leapSecs.push_back(LEAPsecs(a, b, c, d, e));
+		hdr.leapSecs.push_back(LEAPsecs(a, b, c, d, e));
 		setLabelFlag(LEAP);
 		return true;
 	case SATS:
-		SET_1PARAM(SATS, numOfSat)
+		SET_1PARAM(SATS, hdr.numOfSat)
 	case WVLEN:
-		if (wvlenFactor.empty()) wvlenFactor.push_back(WVLNfactor(a, b));   //insert default record
-		else if (wvlenFactor[0].satNums.empty()) {    //replace current values of factors
-			wvlenFactor[0].wvlenFactorL1 = a;
-			wvlenFactor[0].wvlenFactorL2 = b;
+		if (hdr.wvlenFactor.empty()) hdr.wvlenFactor.push_back(WVLNfactor(a, b));   //insert default record
+		else if (hdr.wvlenFactor[0].satNums.empty()) {    //replace current values of factors
+			hdr.wvlenFactor[0].wvlenFactorL1 = a;
+			hdr.wvlenFactor[0].wvlenFactorL2 = b;
 		} else {    //insert the default values in the first position
-		    wvlenFactor.insert(wvlenFactor.begin(), WVLNfactor(a, b));
+		    hdr.wvlenFactor.insert(hdr.wvlenFactor.begin(), WVLNfactor(a, b));
 		}
 	 	setLabelFlag(WVLEN);
 		return true;
 	case GLSLT:
-        gloSltFrq.push_back(GLSLTfrq(a,b));
+        hdr.gloSltFrq.push_back(GLSLTfrq(a,b));
         setLabelFlag(GLSLT);
         return true;
 	default:
@@ -600,7 +722,7 @@ bool RinexData::setHdLnData(RINEXlabel rl, int a, int b, int c, int d, char e) {
 bool RinexData::setHdLnData(RINEXlabel rl, int a, int b, const vector<string> &c) {
 	switch(rl) {
 	case WVLEN:
-		wvlenFactor.push_back(WVLNfactor(a, b, c));
+		hdr.wvlenFactor.push_back(WVLNfactor(a, b, c));
 	 	setLabelFlag(WVLEN);
 		return true;
 	default:
@@ -638,21 +760,21 @@ bool RinexData::setHdLnData(RINEXlabel rl, int a, int b, const vector<string> &c
 bool RinexData::setHdLnData(RINEXlabel rl, const string &a, const string &b, const string &c) {
 	switch(rl) {
 	case RECEIVER:
-		SET_3STRPARAM(RECEIVER, rxNumber, rxType, rxVersion);
+		SET_3STRPARAM(RECEIVER, hdr.rxNumber, hdr.rxType, hdr.rxVersion);
 	case AGENCY:
-		SET_2STRPARAM(AGENCY, observer, agency)
+		SET_2STRPARAM(AGENCY, hdr.observer, hdr.agency)
 	case ANTTYPE:
-		SET_2PARAM(ANTTYPE, antNumber, antType)
+		SET_2PARAM(ANTTYPE, hdr.antNumber, hdr.antType)
 	case RUNBY:
-		SET_3STRPARAM(RUNBY, pgm, runby, date)
+		SET_3STRPARAM(RUNBY, hdr.pgm, hdr.runby, hdr.date)
 	case SIGU:
-		SET_1PARAM(SIGU, signalUnit)
+		SET_1PARAM(SIGU, hdr.signalUnit)
 	case MRKNAME:
-		SET_1PARAM(MRKNAME, markerName)
+		SET_1PARAM(MRKNAME, hdr.markerName)
 	case MRKNUMBER:
-		SET_1PARAM(MRKNUMBER, markerNumber)
+		SET_1PARAM(MRKNUMBER, hdr.markerNumber)
 	case MRKTYPE:
-		SET_1PARAM(MRKTYPE, markerType)
+		SET_1PARAM(MRKTYPE, hdr.markerType)
 	default:
 		throw errorLabelMis + idTOlbl(rl) + msgSetHdLn;
 	}
@@ -674,7 +796,7 @@ bool RinexData::setHdLnData(RINEXlabel rl, const string &a, const string &b, con
 bool RinexData::setHdLnData(RINEXlabel rl, const string &a, double b) {
 	switch(rl) {
 	case GLPHS:
-		gloPhsBias.push_back(GLPHSbias(a, b));
+		hdr.gloPhsBias.push_back(GLPHSbias(a, b));
 		setLabelFlag(GLPHS);
 		return true;
 	default:
@@ -725,9 +847,9 @@ bool RinexData::setHdLnData(RINEXlabel rl, const string &a, double b) {
 bool RinexData::getHdLnData(RINEXlabel rl, int &a, double &b, char &c) {
 	switch(rl) {
 	case TOFO:
-		GET_3PARAM(TOFO, firstObsWeek, firstObsTOW, obsTimeSys)
+		GET_3PARAM(TOFO, hdr.firstObsWeek, hdr.firstObsTOW, hdr.obsTimeSys)
 	case TOLO:
-		GET_3PARAM(TOLO, lastObsWeek, lastObsTOW, obsTimeSys)
+		GET_3PARAM(TOLO, hdr.lastObsWeek, hdr.lastObsTOW, hdr.obsTimeSys)
 	default:
 		throw errorLabelMis + idTOlbl(rl) + msgGetHdLn;
 	}
@@ -788,7 +910,7 @@ bool  RinexData::getHdLnData(RINEXlabel rl, RINEXlabel &a, double (&b)[4], int &
     switch(rl) {
         case IONC:
             //check if data requested exists; index is here the position in the list of a given type position
-            for (vector<CORRECTION>::iterator it = corrections.begin(); it != corrections.end(); it++) {
+            for (vector<CORRECTION>::iterator it = hdr.corrections.begin(); it != hdr.corrections.end(); it++) {
                 if ((it->corrType == a) || (a == NOLABEL)) order++;
                 if (order == index) {
                     a = it->corrType;
@@ -820,18 +942,11 @@ bool  RinexData::getHdLnData(RINEXlabel rl, RINEXlabel &a, double (&b)[4], int &
 bool RinexData::getHdLnData(RINEXlabel rl, RINEXlabel &a, string &b, unsigned int index) {
 	switch(rl) {
 	case COMM:
-		for (vector<LABELdata>::iterator it = labelDef.begin() ; it != labelDef.end(); ++it) {
-			if(it->labelID == EOH) return false;
-			if(it->hasData && (it->labelID == COMM)) {
-				if (index == 0) {
-					b = it->comment;
-					it++;
-					a = it->labelID;
-					return true;
-				} else index--;
-			}
-		}
-		return false;
+		if ((index >= hdr.hdComments.size()) || (hdr.hdComments[index].pos > EOH)) return false;
+		b = hdr.hdComments[index].text;
+		if ((index + 1 < hdr.hdComments.size()) && (hdr.hdComments[index + 1].pos == hdr.hdComments[index].pos)) a = COMM;
+		else a = (RINEXlabel) hdr.hdComments[index].pos;
+		return true;
 	default:
 		throw errorLabelMis + idTOlbl(rl) + msgGetHdLn;
 	}
@@ -854,8 +969,8 @@ bool RinexData::getHdLnData(RINEXlabel rl, RINEXlabel &a, string &b, unsigned in
 bool RinexData::getHdLnData(RINEXlabel rl, char &a, int &b, vector <int> &c, unsigned int index) {
 	switch(rl) {
 	case PRNOBS:
-		if (index < prnObsNum.size()) {
-			GET_3PARAM(PRNOBS, prnObsNum[index].sysPrn, prnObsNum[index].satPrn, prnObsNum[index].obsNum)
+		if (index < hdr.prnObsNum.size()) {
+			GET_3PARAM(PRNOBS, hdr.prnObsNum[index].sysPrn, hdr.prnObsNum[index].satPrn, hdr.prnObsNum[index].obsNum)
 		}
 		return false;
 	default:
@@ -884,8 +999,8 @@ bool RinexData::getHdLnData(RINEXlabel rl, char &a, int &b, vector <int> &c, uns
 bool RinexData::getHdLnData(RINEXlabel rl, char &a, int &b, vector <string> &c, unsigned int index) {
 	switch(rl) {
 	case SCALE:
-		if (index < obsScaleFact.size()) {
-			GET_3PARAM(SCALE, systems[obsScaleFact[index].sysIndex].system, obsScaleFact[index].factor, obsScaleFact[index].obsType)
+		if (index < hdr.obsScaleFact.size()) {
+			GET_3PARAM(SCALE, hdr.systems[hdr.obsScaleFact[index].sysIndex].system, hdr.obsScaleFact[index].factor, hdr.obsScaleFact[index].obsType)
 		}
 		return false;
 	default:
@@ -911,8 +1026,8 @@ bool RinexData::getHdLnData(RINEXlabel rl, char &a, int &b, vector <string> &c,
 bool RinexData::getHdLnData(RINEXlabel rl, char &a, string &b, double &c, double &d, double &e) {
 	switch(rl) {
 	case ANTPHC:
-		e = antPhUoZ;
-		GET_4PARAM(ANTPHC,	antPhSys, antPhCode, antPhNoX, antPhEoY)
+		e = hdr.antPhUoZ;
+		GET_4PARAM(ANTPHC,	hdr.antPhSys, hdr.antPhCode, hdr.antPhNoX, hdr.antPhEoY)
 	default:
 		throw errorLabelMis + idTOlbl(rl) + msgGetHdLn;
 	}
@@ -935,8 +1050,8 @@ bool RinexData::getHdLnData(RINEXlabel rl, char &a, string &b, double &c, double
 bool RinexData::getHdLnData(RINEXlabel rl, char &a, string &b, string &c, unsigned int index) {
 	switch(rl) {
 	case DCBS:
-		if (index < prnObsNum.size()) {
-			GET_3PARAM(PRNOBS, systems[dcbsApp[index].sysIndex].system, dcbsApp[index].corrProg, dcbsApp[index].corrSource)
+		if (index < hdr.prnObsNum.size()) {
+			GET_3PARAM(PRNOBS, hdr.systems[hdr.dcbsApp[index].sysIndex].system, hdr.dcbsApp[index].corrProg, hdr.dcbsApp[index].corrSource)
 		}
 		return false;
 	default:
@@ -963,9 +1078,9 @@ bool RinexData::getHdLnData(RINEXlabel rl, char &a, string &b, double &c, vector
     vector<PHSHcorr>::iterator aPHSHit;
 	switch(rl) {
 	case PHSH:
-		if (index < phshCorrection.size()) {
-		    aPHSHit = phshCorrection.begin() + index;
-			GET_4PARAM(SYS, systems[aPHSHit->sysIndex].system, aPHSHit->obsCode, aPHSHit->correction, aPHSHit->obsSats)
+		if (index < hdr.phshCorrection.size()) {
+		    aPHSHit = hdr.phshCorrection.begin() + index;
+			GET_4PARAM(SYS, hdr.systems[aPHSHit->sysIndex].system, aPHSHit->obsCode, aPHSHit->correction, aPHSHit->obsSats)
 		}
 		return false;
 	default:
@@ -992,11 +1107,11 @@ bool RinexData::getHdLnData(RINEXlabel rl, char &a,  vector <string> &b, unsigne
     switch(rl) {
         case SYS:
         case TOBS:
-            if (index < systems.size()) {
+            if (index < hdr.systems.size()) {
                 //fill the vector string with obsTypes identifiers selected
-                for(vector<OBSmeta>::iterator it = systems[index].obsTypes.begin(); it < systems[index].obsTypes.end(); it++)
+                for(vector<OBSmeta>::iterator it = hdr.systems[index].obsTypes.begin(); it < hdr.systems[index].obsTypes.end(); it++)
                     if (it->sel) aVectorStr.push_back(it->id);
-                        GET_2PARAM(SYS, systems[index].system, aVectorStr)
+                        GET_2PARAM(SYS, hdr.systems[index].system, aVectorStr)
             }
             return false;
         default:
@@ -1021,9 +1136,9 @@ bool RinexData::getHdLnData(RINEXlabel rl, char &a,  vector <string> &b, unsigne
 bool RinexData::getHdLnData(RINEXlabel rl, double &a) {
 	switch(rl) {
 	case ANTZDAZI:
-		GET_1PARAM(ANTZDAZI, antZdAzi)
+		GET_1PARAM(ANTZDAZI, hdr.antZdAzi)
 	case INT:
-		GET_1PARAM(INT, obsInterval)
+		GET_1PARAM(INT, hdr.obsInterval)
 	default:
 		throw errorLabelMis + idTOlbl(rl) + msgGetHdLn;
 	}
@@ -1046,9 +1161,9 @@ bool RinexData::getHdLnData(RINEXlabel rl, double &a) {
 bool RinexData::getHdLnData(RINEXlabel rl, double &a, char &b, char &c) {
 	switch(rl) {
 	case VERSION:
-		b = fileType;
-		c = sysToPrintId;
-		switch (version) {
+		b = hdr.fileType;
+		c = hdr.sysToPrintId;
+		switch (hdr.version) {
 		case V210: a = 2.10; break;
 		case V304: a = 3.04; break;
 		case VTBD: a = 0.0; break;
@@ -1056,9 +1171,9 @@ bool RinexData::getHdLnData(RINEXlabel rl, double &a, char &b, char &c) {
 		}
 		return getLabelFlag(VERSION);
 	case INFILEVER:
-		b = fileType;
-		c = sysToPrintId;
-		switch (inFileVer) {
+		b = hdr.fileType;
+		c = hdr.sysToPrintId;
+		switch (hdr.inFileVer) {
 		case V210: a = 2.10; break;
 		case V304: a = 3.04; break;
 		case VTBD:
@@ -1100,17 +1215,17 @@ bool RinexData::getHdLnData(RINEXlabel rl, double &a, char &b, char &c) {
 bool RinexData::getHdLnData(RINEXlabel rl, double &a, double &b, double &c) {
 	switch(rl) {
 	case ANTHEN:
-		GET_3PARAM(ANTHEN, antHigh, eccEast, eccNorth)
+		GET_3PARAM(ANTHEN, hdr.antHigh, hdr.eccEast, hdr.eccNorth)
 	case APPXYZ:
-		GET_3PARAM(APPXYZ, aproxX, aproxY, aproxZ)
+		GET_3PARAM(APPXYZ, hdr.aproxX, hdr.aproxY, hdr.aproxZ)
 	case ANTXYZ:
-		GET_3PARAM(ANTXYZ, antX, antY, antZ)
+		GET_3PARAM(ANTXYZ, hdr.antX, hdr.antY, hdr.antZ)
 	case ANTBS:
-		GET_3PARAM(ANTBS, antBoreX, antBoreY, antBoreZ)
+		GET_3PARAM(ANTBS, hdr.antBoreX, hdr.antBoreY, hdr.antBoreZ)
 	case ANTZDXYZ:
-		GET_3PARAM(ANTZDXYZ, antZdX, antZdY, antZdZ)
+		GET_3PARAM(ANTZDXYZ, hdr.antZdX, hdr.antZdY, hdr.antZdZ)
 	case COFM:
-		GET_3PARAM(COFM, centerX, centerY, centerZ)
+		GET_3PARAM(COFM, hdr.centerX, hdr.centerY, hdr.centerZ)
 	default:
 		throw errorLabelMis + idTOlbl(rl) + msgGetHdLn;
 	}
@@ -1135,12 +1250,12 @@ bool RinexData::getHdLnData(RINEXlabel rl, double &a, double &b, double &c) {
 bool RinexData::getHdLnData(RINEXlabel rl, int &a) {
 	switch(rl) {
 	case CLKOFFS:
-		GET_1PARAM(CLKOFFS, rcvClkOffs)
+		GET_1PARAM(CLKOFFS, hdr.rcvClkOffs)
 	case LEAP:
 		//to get values as per V210. GPS is allways the 1st element of the vector
-		GET_1PARAM(LEAP, leapSecs[0].secs)
+		GET_1PARAM(LEAP, hdr.leapSecs[0].secs)
 	case SATS:
-		GET_1PARAM(SATS, numOfSat)
+		GET_1PARAM(SATS, hdr.numOfSat)
 	default:
 		throw errorLabelMis + idTOlbl(rl) + msgGetHdLn;
 	}
@@ -1162,8 +1277,8 @@ bool RinexData::getHdLnData(RINEXlabel rl, int &a) {
 bool RinexData::getHdLnData(RINEXlabel rl, int &a, int &b, unsigned int index) {
     switch(rl) {
         case GLSLT:
-            if (index < gloSltFrq.size()) {
-                GET_2PARAM(GLSLT, gloSltFrq[index].slot, gloSltFrq[index].frqNum)
+            if (index < hdr.gloSltFrq.size()) {
+                GET_2PARAM(GLSLT, hdr.gloSltFrq[index].slot, hdr.gloSltFrq[index].frqNum)
             }
             return false;
         default:
@@ -1192,8 +1307,8 @@ bool RinexData::getHdLnData(RINEXlabel rl, int &a, int &b, unsigned int index) {
 bool RinexData::getHdLnData(RINEXlabel rl, int &a, int &b, vector <string> &c, unsigned int index) {
     switch(rl) {
         case WVLEN:
-            if (index < wvlenFactor.size()) {
-                GET_3PARAM(WVLEN, wvlenFactor[index].wvlenFactorL1, wvlenFactor[index].wvlenFactorL2, wvlenFactor[index].satNums)
+            if (index < hdr.wvlenFactor.size()) {
+                GET_3PARAM(WVLEN, hdr.wvlenFactor[index].wvlenFactorL1, hdr.wvlenFactor[index].wvlenFactorL2, hdr.wvlenFactor[index].satNums)
             }
             return false;
         default:
@@ -1225,9 +1340,9 @@ bool RinexData::getHdLnData(RINEXlabel rl, int &a, int &b, vector <string> &c, u
 bool RinexData::getHdLnData(RINEXlabel rl, int &a, int &b, int &c, int &d, char &e, unsigned int index) {
 	switch(rl) {
 		case LEAP:
-			if (index < leapSecs.size()) {
-			    e = leapSecs[0].sysId;
-			    GET_4PARAM(LEAP, leapSecs[0].secs, leapSecs[0].deltaLSF, leapSecs[0].weekLSF, leapSecs[0].dayLSF)
+			if (index < hdr.leapSecs.size()) {
+			    e = hdr.leapSecs[0].sysId;
+			    GET_4PARAM(LEAP, hdr.leapSecs[0].secs, hdr.leapSecs[0].deltaLSF, hdr.leapSecs[0].weekLSF, hdr.leapSecs[0].dayLSF)
 			}
 			return false;
 		default:
@@ -1256,13 +1371,13 @@ bool RinexData::getHdLnData(RINEXlabel rl, int &a, int &b, int &c, int &d, char
 bool RinexData::getHdLnData(RINEXlabel rl, string &a) {
 	switch(rl) {
 	case SIGU:
-		GET_1PARAM(SIGU, signalUnit)
+		GET_1PARAM(SIGU, hdr.signalUnit)
 	case MRKNAME:
-		GET_1PARAM(MRKNAME, markerName)
+		GET_1PARAM(MRKNAME, hdr.markerName)
 	case MRKNUMBER:
-		GET_1PARAM(MRKNUMBER, markerNumber)
+		GET_1PARAM(MRKNUMBER, hdr.markerNumber)
 	case MRKTYPE:
-		GET_1PARAM(MRKTYPE, markerType)
+		GET_1PARAM(MRKTYPE, hdr.markerType)
 	default:
 		throw errorLabelMis + idTOlbl(rl) + msgGetHdLn;
 	}
@@ -1286,9 +1401,9 @@ bool RinexData::getHdLnData(RINEXlabel rl, string &a) {
 bool RinexData::getHdLnData(RINEXlabel rl, string &a, string &b) {
 	switch(rl) {
 	case AGENCY:
-		GET_2PARAM(AGENCY, observer, agency)
+		GET_2PARAM(AGENCY, hdr.observer, hdr.agency)
 	case ANTTYPE:
-		GET_2PARAM(ANTTYPE, antNumber, antType)
+		GET_2PARAM(ANTTYPE, hdr.antNumber, hdr.antType)
 	default:
 		throw errorLabelMis + idTOlbl(rl) + msgGetHdLn;
 	}
@@ -1313,9 +1428,9 @@ bool RinexData::getHdLnData(RINEXlabel rl, string &a, string &b) {
 bool RinexData::getHdLnData(RINEXlabel rl, string &a, string &b, string &c) {
 	switch(rl) {
 	case RECEIVER:
-		GET_3PARAM(RECEIVER, rxNumber, rxType, rxVersion)
+		GET_3PARAM(RECEIVER, hdr.rxNumber, hdr.rxType, hdr.rxVersion)
 	case RUNBY:
-		GET_3PARAM(RUNBY, pgm, runby, date)
+		GET_3PARAM(RUNBY, hdr.pgm, hdr.runby, hdr.date)
 	default:
 		throw errorLabelMis + idTOlbl(rl) + msgGetHdLn;
 	}
@@ -1340,8 +1455,8 @@ bool RinexData::getHdLnData(RINEXlabel rl, string &a, string &b, string &c) {
 bool RinexData::getHdLnData(RINEXlabel rl, string &a, double &b, unsigned int index) {
 	switch(rl) {
 		case GLPHS:
-			if (index < gloPhsBias.size()) {
-				GET_2PARAM(GLPHS, gloPhsBias[index].obsCode, gloPhsBias[index].obsCodePhaseBias)
+			if (index < hdr.gloPhsBias.size()) {
+				GET_2PARAM(GLPHS, hdr.gloPhsBias[index].obsCode, hdr.gloPhsBias[index].obsCodePhaseBias)
 			}
 			return false;
 		default:
@@ -1361,8 +1476,11 @@ bool RinexData::getHdLnData(RINEXlabel rl, string &a, double &b, unsigned int in
  * @return the label identification corresponding to the label name passed 
 */
 RinexData::RINEXlabel RinexData::lblTOid(string label) {
-	for (vector<LABELdata>::iterator it = labelDef.begin() ; it != labelDef.end(); ++it)
-		if (strncmp(label.c_str(), it->labelVal, label.size()) == 0) return it->labelID;
+	RINEXlabel id = labelIndex().find(label.c_str(), label.size());
+	if (id != NOLABEL) return id;
+	//incomplete label names are searched in the table
+	for (unsigned int i = VERSION; i < INFILEVER; i++)
+		if (strncmp(label.c_str(), labelDef[i].labelVal, label.size()) == 0) return (RINEXlabel) i;
 	return DONTMATCH;
 }
 
@@ -1372,9 +1490,8 @@ RinexData::RINEXlabel RinexData::lblTOid(string label) {
  * @return the label name corresponding to the identifier passed, or an empty string if does not exist
 */
 string RinexData::idTOlbl(RINEXlabel id) {
-	for (vector<LABELdata>::iterator it = labelDef.begin() ; it != labelDef.end(); ++it)
-		if (it->labelID == id) return string(it->labelVal);
-	return string();
+	if ((id < NOLABEL) || (id > LASTONE) || (labelDef[id].labelVal == NULL)) return string();
+	return string(labelDef[id].labelVal);
 }
 
 /**get1stLabelId gives the first label identifier of the first record in the RINEX header having data (should be VERSION).
@@ -1385,10 +1502,9 @@ string RinexData::idTOlbl(RINEXlabel id) {
  * @return the label identifier of the first record having data, or LASTONE when all records are empty
 */
 RinexData::RINEXlabel RinexData::get1stLabelId() {
-	for (labelIdIdx = 0; labelIdIdx != labelDef.size(); labelIdIdx++) {
-		if (labelDef[labelIdIdx].hasData) return labelDef[labelIdIdx].labelID;
-	}
-	return LASTONE;
+	labelIdIdx = 0;
+	commentIdx = 0;
+	return getNextLabelId();
 }
 
 /**getNextLabelId gives the label identifier of the next record in the RINEX header having data (after the one previously extracted).
@@ -1399,8 +1515,13 @@ RinexData::RINEXlabel RinexData::get1stLabelId() {
  * @return the label identifier of the next record having data, or LASTONE when there is not a next record having data
 */
 RinexData::RINEXlabel RinexData::getNextLabelId() {
-	while (++labelIdIdx < labelDef.size()) {
-		if (labelDef[labelIdIdx].hasData) return labelDef[labelIdIdx].labelID;
+	//comments placed before a record are given before it
+	while (labelIdIdx <= LASTONE) {
+		if ((commentIdx < hdr.hdComments.size()) && (hdr.hdComments[commentIdx].pos <= labelIdIdx)) {
+			commentIdx++;
+			return COMM;
+		}
+		if (hdr.labelHasData[labelIdIdx++]) return (RINEXlabel) (labelIdIdx - 1);
 	}
 	return LASTONE;
 }
@@ -1416,10 +1537,11 @@ RinexData::RINEXlabel RinexData::getNextLabelId() {
  * -# printObsEpoch to print RINEX epoch data
  */
 void RinexData::clearHeaderData() {
-	for (vector<LABELdata>::iterator it = labelDef.begin(); it != labelDef.end(); it++) it->hasData = false;
-	wvlenFactor.clear();
-	dcbsApp.clear();
-	obsScaleFact.clear();
+	hdr.labelHasData.reset();
+	hdr.hdComments.clear();
+	hdr.wvlenFactor.clear();
+	hdr.dcbsApp.clear();
+	hdr.obsScaleFact.clear();
 }
 
 /*methods to process and collect current epoch data
@@ -1483,15 +1605,14 @@ double RinexData::getEpochTime(int &weeks, double &secs, double &bias, int &eFla
  * @return true if data belong to the current epoch, false otherwise
  */
 bool RinexData::saveObsData(char sys, int sat, string obsTp, double value, int lli, int strg, double tTag) {
-    const string msgSysObs(" the system, in observable=");
 	int sx = systemIndex(sys);	//system index
 	if (epochObs.empty()) epochTimeTag = tTag;
 	bool sameEpoch = epochTimeTag == tTag;
 	//check if this observable type for this system shall be stored
 	if (sameEpoch) {
 		if (sx >= 0) {
-			for (unsigned int ox = 0; ox < systems[sx].obsTypes.size(); ox++)
-				if (obsTp.compare(systems[sx].obsTypes[ox].id) == 0) {
+			for (unsigned int ox = 0; ox < hdr.systems[sx].obsTypes.size(); ox++)
+				if (obsTp.compare(hdr.systems[sx].obsTypes[ox].id) == 0) {
 					epochObs.push_back(SatObsData(tTag, sx, sat, ox, value, lli, strg));
 					return true;
 				}
@@ -1515,9 +1636,9 @@ bool RinexData::saveObsData(char sys, int sat, string obsTp, double value, int l
 bool RinexData::getObsData(char &sys, int &sat, string &obsTp, double &value, int &lli, int &strg, unsigned int index) {
 	if (epochObs.size() <= index) return false;
 	vector<SatObsData>::iterator it = epochObs.begin() + index;
-	sys = systems[it->sysIndex].system;
+	sys = hdr.systems[it->sysIndex].system;
 	sat = it->satellite;
-	obsTp = systems[it->sysIndex].obsTypes[it->obsTypeIndex].id;
+	obsTp = hdr.systems[it->sysIndex].obsTypes[it->obsTypeIndex].id;
 	value = it->obsValue;
 	lli = it->lossOfLock;
 	strg = it->strength;
@@ -1544,8 +1665,8 @@ bool RinexData::getObsData(char &sys, int &sat, string &obsTp, double &value, in
  */
 bool RinexData::setFilter(vector<string> selSat, vector<string> selObs) {
 #define SET_OBS_SELECTED \
-    for (obsIdx = 0; obsIdx < systems[sysIdx].obsTypes.size(); obsIdx++) { \
-        if (systems[sysIdx].obsTypes[obsIdx].id.compare((*itSelObs).substr(1)) == 0) { \
+    for (obsIdx = 0; obsIdx < hdr.systems[sysIdx].obsTypes.size(); obsIdx++) { \
+        if (hdr.systems[sysIdx].obsTypes[obsIdx].id.compare(itSelObs->c_str() + 1) == 0) { \
             selectedObs.push_back(SELobs(sysIdx, obsIdx)); \
             found = true; \
             break; \
@@ -1581,7 +1702,7 @@ bool RinexData::setFilter(vector<string> selSat, vector<string> selObs) {
     vector<GNSSsystem>::iterator itsys;
     vector<int> inxSysObs;
     vector<int> inxObsSys;
-    char s, b[5];
+    char b[5], *endNum;
     int sysIdx, obsIdx, n, o;
     bool found;
     string aStr;
@@ -1589,15 +1710,11 @@ bool RinexData::setFilter(vector<string> selSat, vector<string> selObs) {
     //1st: Verify input data in selSat. Save system identification and satellite number of correct ones
     bool areCoherent = true;
     for (vector<string>::iterator it = selSat.begin(); it != selSat.end(); it++) {
-        switch (sscanf((*it).c_str(), "%c%d", &s, &n)) {
-            case 1:
-                if ((sysIdx = systemIndex(s)) >= 0) selectedSats.push_back(SELsats(sysIdx, -1));
-                break;
-            case 2:
-                if ((sysIdx = systemIndex(s)) >= 0) selectedSats.push_back(SELsats(sysIdx, n));
-                break;
-            default:
-                sysIdx = -1;
+        //each item is the system char optionally followed by the satellite number
+        sysIdx = -1;
+        if (!it->empty() && ((sysIdx = systemIndex(it->at(0))) >= 0)) {
+            n = (int) strtol(it->c_str() + 1, &endNum, 10);
+            selectedSats.push_back(SELsats(sysIdx, endNum == it->c_str() + 1? -1 : n));
         }
         if (sysIdx < 0) {
             plog->warning(msgWrongSysSat + (*it));
@@ -1610,7 +1727,7 @@ bool RinexData::setFilter(vector<string> selSat, vector<string> selObs) {
         if ((sysIdx = systemIndex((*itSelObs).at(0))) >= 0) {
             SET_OBS_SELECTED
         } else if ((*itSelObs).at(0) == 'M') {
-            for (sysIdx = 0; sysIdx < systems.size(); sysIdx++) {
+            for (sysIdx = 0; sysIdx < hdr.systems.size(); sysIdx++) {
                 SET_OBS_SELECTED
             }
         }
@@ -1621,34 +1738,34 @@ bool RinexData::setFilter(vector<string> selSat, vector<string> selObs) {
     }
     if (selectedSats.empty()) {
         //reset system status as ALL SYSTEMS AND SATELLITES SELECTED
-        for (vector<GNSSsystem>::iterator it = systems.begin(); it != systems.end(); it++) {
+        for (vector<GNSSsystem>::iterator it = hdr.systems.begin(); it != hdr.systems.end(); it++) {
             it->selSystem = true;
             it->selSat.clear();
         }
     } else {
         //there is at least a system selected to filter data. Reset select data in systems
-        for (vector<GNSSsystem>::iterator it = systems.begin(); it != systems.end(); it++) {
+        for (vector<GNSSsystem>::iterator it = hdr.systems.begin(); it != hdr.systems.end(); it++) {
             it->selSystem = false;
             it->selSat.clear();
         }
         //update select data in systems for satelite selected
         for (vector<SELsats>::iterator it = selectedSats.begin(); it!= selectedSats.end(); it++) {
-            systems[it->sysIndex].selSystem = true;
-            if (it->satNumber != -1) systems[it->sysIndex].selSat.push_back(it->satNumber);
+            hdr.systems[it->sysIndex].selSystem = true;
+            if (it->satNumber != -1) hdr.systems[it->sysIndex].selSat.push_back(it->satNumber);
         }
     }
     //update observation data in systems for observations selected
     if (!selectedObs.empty()) {
-        for (vector<GNSSsystem>::iterator it = systems.begin(); it != systems.end(); it++) {
+        for (vector<GNSSsystem>::iterator it = hdr.systems.begin(); it != hdr.systems.end(); it++) {
             it->selSystem = false;
             for (vector<OBSmeta>::iterator itobs = it->obsTypes.begin(); itobs != it->obsTypes.end(); itobs++) itobs->sel = false;
         }
         for (vector<SELobs>::iterator it = selectedObs.begin(); it != selectedObs.end(); it++) {
-            systems[it->sysIndex].selSystem = true;
-            systems[it->sysIndex].obsTypes[it->obsIndex].sel = true;
+            hdr.systems[it->sysIndex].selSystem = true;
+            hdr.systems[it->sysIndex].obsTypes[it->obsIndex].sel = true;
         }
     }
-    for (vector<GNSSsystem>::iterator it = systems.begin(); it != systems.end(); it++) {
+    for (vector<GNSSsystem>::iterator it = hdr.systems.begin(); it != hdr.systems.end(); it++) {
         if (it->selSystem) {
             aStr = msgSelSys + string(1, it->system) + msgComma;
             for (vector<int>::iterator itsat = it->selSat.begin(); itsat != it->selSat.end(); itsat++) {
@@ -1677,10 +1794,10 @@ bool RinexData::filterObsData(bool removeNotPrt) {
 	it = epochObs.begin();
 	while (it != epochObs.end()) {
         //check if its system, observable or satellite is not selected, or if requested, the observable will not be printed
-		if (!systems[it->sysIndex].selSystem ||
-					!systems[it->sysIndex].obsTypes[it->obsTypeIndex].sel ||
+		if (!hdr.systems[it->sysIndex].selSystem ||
+					!hdr.systems[it->sysIndex].obsTypes[it->obsTypeIndex].sel ||
 					!isSatSelected(it->sysIndex, it->satellite) ||
-                    (removeNotPrt && !systems[it->sysIndex].obsTypes[it->obsTypeIndex].prt)) {
+                    (removeNotPrt && !hdr.systems[it->sysIndex].obsTypes[it->obsTypeIndex].prt)) {
 			it = epochObs.erase(it);
 		} else it++;
 	}
@@ -1688,7 +1805,7 @@ bool RinexData::filterObsData(bool removeNotPrt) {
 }
 
 /**clearObsData clears all epoch observation data on satellites and observables previously saved.
- *
+ * The storage is kept allocated to be reused by the next epoch.
  */
 void RinexData::clearObsData() {
 	epochObs.clear();
@@ -1779,11 +1896,11 @@ string RinexData::getObsFileName(string prefix, string country) {
         plog->warning(msgBadFileName + errorMsg);
         return "BadObsName.txt";
     }
-	switch(version) {
+	switch(hdr.version) {
 	case V304:
-		return fmtRINEXv3name(prefix, firstObsWeek, firstObsTOW, country);
+		return fmtRINEXv3name(prefix, hdr.firstObsWeek, hdr.firstObsTOW, country);
 	default:
-		return fmtRINEXv2name(prefix, firstObsWeek, firstObsTOW);
+		return fmtRINEXv2name(prefix, hdr.firstObsWeek, hdr.firstObsTOW);
 	}
 }
 
@@ -1807,15 +1924,15 @@ string RinexData::getNavFileName(string prefix, string country) {
 	int week = epochWeek;
 	double tow = epochTOW;
 	if (getLabelFlag(TOFO)) {
-		week = firstObsWeek;
-		tow = firstObsTOW;
+		week = hdr.firstObsWeek;
+		tow = hdr.firstObsTOW;
 	}
 	if (!epochNav.empty()) {
 		sort(epochNav.begin(), epochNav.end());
 		week = getWeekGNSSinstant(epochNav[0].navTimeTag);
 		tow = getTowGNSSinstant(epochNav[0].navTimeTag);
 	}
-	switch(version) {
+	switch(hdr.version) {
 	case V304:
 		return fmtRINEXv3name(prefix, week, tow, country);
 	default:
@@ -1831,8 +1948,8 @@ string RinexData::getNavFileName(string prefix, string country) {
  */
 void RinexData::printObsHeader(FILE* out) {
 	///Before printing, set and verify VERSION data record:
-	if (version == VTBD) version = inFileVer;
-	if (version == VTBD) throw msgVerTBD;
+	if (hdr.version == VTBD) hdr.version = hdr.inFileVer;
+	if (hdr.version == VTBD) throw msgVerTBD;
 	/// - Set file type for Observation.
     try {
         setFileDataType('O', true);
@@ -1843,13 +1960,13 @@ void RinexData::printObsHeader(FILE* out) {
 	/// - Set the system identification for the one to be printed.
 	setLabelFlag(VERSION);
 	/// - Depending on version to be printed, set "# / TYPES OF OBSERV" or "SYS / # / OBS TYPES" data record.
-	if(version == V210) {
+	if(hdr.version == V210) {
         //in V210 all systems shall have the same observables to print
         //compute aVectorBool setting to true the corresponding obsTypes that shall be printed
         //Note that only V210 obsTypes are taken into account
         vector<bool> aVectorBool;
         aVectorBool.insert(aVectorBool.begin(), numberV2ObsTypes, false);
-        for (vector<GNSSsystem>::iterator itsys = systems.begin(); itsys != systems.end(); itsys++) {
+        for (vector<GNSSsystem>::iterator itsys = hdr.systems.begin(); itsys != hdr.systems.end(); itsys++) {
             for (int i = 0; i < numberV2ObsTypes; i++) {
                 itsys->obsTypes[i].prt = itsys->obsTypes[i].sel;
                 aVectorBool[i] = aVectorBool[i] || itsys->obsTypes[i].prt;
@@ -1857,7 +1974,7 @@ void RinexData::printObsHeader(FILE* out) {
         }
         //set in systems the obTypes data related to printing
         bool isAny;
-        for (vector<GNSSsystem>::iterator itsys = systems.begin(); itsys != systems.end(); itsys++) {
+        for (vector<GNSSsystem>::iterator itsys = hdr.systems.begin(); itsys != hdr.systems.end(); itsys++) {
             //check if this system has any obsType to print
             isAny = false;
             for (int i = 0; i < numberV2ObsTypes; i++) if (itsys->obsTypes[i].prt) { isAny = true; break; }
@@ -1871,7 +1988,7 @@ void RinexData::printObsHeader(FILE* out) {
 		setLabelFlag(TOBS);
 	} else {	//version will be V304
         //determine de obsTypes to print in this version (all selected)
-        for (vector<GNSSsystem>::iterator itsys = systems.begin(); itsys != systems.end(); itsys++) {
+        for (vector<GNSSsystem>::iterator itsys = hdr.systems.begin(); itsys != hdr.systems.end(); itsys++) {
             for (vector<OBSmeta>::iterator itobs = itsys->obsTypes.begin(); itobs != itsys->obsTypes.end(); itobs++) {
                 itobs->prt = itobs->sel;
             }
@@ -1881,13 +1998,21 @@ void RinexData::printObsHeader(FILE* out) {
 	}
     setLabelFlag(EOH);	//END OF HEADER record shall allways be printed
 	///Finally, for each observation header record belonging to the current version and having data defined, print it.
-	for (vector<LABELdata>::iterator it = labelDef.begin(); it != labelDef.end(); it++) {
-		if (((it->type & OBSMSK) != OBSNAP) && (it->ver == VALL || it->ver == version)) {
-			if (it->hasData) printHdLineData(out, it);
+	hdTofoOffset = hdToloOffset = -1;
+	unsigned int comm = 0;
+	for (unsigned int i = 0; i <= LASTONE; i++) {
+		//print comments placed before this record
+		for (; (comm < hdr.hdComments.size()) && (hdr.hdComments[comm].pos <= i); comm++) printHdLineData(out, COMM, hdr.hdComments[comm].text);
+		if (((labelDef[i].type & OBSMSK) != OBSNAP) && (labelDef[i].ver == VALL || labelDef[i].ver == hdr.version)) {
+			if (i == TOFO) hdTofoOffset = ftell(out);
+			else if (i == TOLO) hdToloOffset = ftell(out);
+			if (hdr.labelHasData[i]) printHdLineData(out, (RINEXlabel) i);
             ///Log a warning message when the record to be printed is obligatory, but has not data.
-			else if ((it->type & OBSMSK) == OBSOBL) plog->warning(valueLabel(it->labelID, msgHdRecNoData));
+			else if ((labelDef[i].type & OBSMSK) == OBSOBL) plog->warning(valueLabel((RINEXlabel) i, msgHdRecNoData));
 		}
 	}
+	///Set the print plan for epoch records with the observables printed in the header.
+	setPrintPlan();
 }
 
 /**printObsEpoch prints the data lines for one epoch using the current stored observation data.
@@ -1915,13 +2040,13 @@ void RinexData::printObsEpoch(FILE* out) {
 	bool clkOffsetPrinted = false;	//a flag to know if clock offset has been printed or not
 	clkOffsetBuffer[0] = 0;		//set an empty string in the buffer
 	//set the printable epoch time and clock offset using format of the version to be printed.
-	switch (version) {
+	switch (hdr.version) {
 	case V210:	//RINEX version 2.10
-		formatGPStime (timeBuffer, 80, " %y %m %d %H %M", "%11.7f", epochWeek, epochTOW);
+		timeFormatter.format(timeBuffer, GPStimeFormatter::V2OBS, epochWeek, epochTOW);
 		if((epochClkOffset < 99.999999999) && (epochClkOffset > -9.999999999)) sprintf(clkOffsetBuffer, "%12.9f", epochClkOffset);
 		break;
 	case V304:	//RINEX version 3.04
-		formatGPStime (timeBuffer, 80, "> %Y %m %d %H %M", "%11.7f", epochWeek, epochTOW);
+		timeFormatter.format(timeBuffer, GPStimeFormatter::V3OBS, epochWeek, epochTOW);
 		if((epochClkOffset < 99.999999999999) && (epochClkOffset > -9.999999999999)) sprintf(clkOffsetBuffer, "%15.12f", epochClkOffset);
 		break;
 	default:
@@ -1935,22 +2060,29 @@ void RinexData::printObsEpoch(FILE* out) {
 		// Even the whole epoch could be removed if it is outside of a selected time period.
 		// Ends if it does not remain any data to print.
 		if (!filterObsData(true)) return;
-        stable_sort(epochObs.begin(), epochObs.end());
+        //sort observables in place by system, satellite and type keeping their order when equal. Data usually arrive nearly
+        //sorted, and epochObs is reused from epoch to epoch, thus no temporary storage is allocated
+        for (unsigned int i = 1; i < epochObs.size(); i++) {
+            SatObsData item = epochObs[i];
+            unsigned int j = i;
+            for (; (j > 0) && !(epochObs[j-1] < item); j--) epochObs[j] = epochObs[j-1];
+            epochObs[j] = item;
+        }
         //count the number of different satellites with data in this epoch (at least one)
         nSatsEpoch = 1;
         for (it = epochObs.begin()+1; it != epochObs.end(); it++) if (DIFFERENT_SAT(it)) nSatsEpoch++;
-		switch (version) {
+		switch (hdr.version) {
 		case V210:	//RINEX version 2.10
             //start printing epoch 1st line
 	 		fprintf(out, "%s  %1d%3d", timeBuffer, epochFlag, nSatsEpoch);
 			//append the different systems and satellites existing in this epoch.
 			//if number of satellites is greather than 12, use continuation lines. Clock offset is printed only in the 1st one
-			fprintf(out, "%1c%02d", systems[epochObs[0].sysIndex].system, epochObs[0].satellite);
+			fprintf(out, "%1c%02d", hdr.systems[epochObs[0].sysIndex].system, epochObs[0].satellite);
 			anInt = 1;		//currently, the number of satellites already printed
 			for (it = epochObs.begin()+1; it != epochObs.end(); it++)
 				if (DIFFERENT_SAT(it)) {
 					if ((anInt % 12) == 0) fprintf(out, "\n%32c", ' '); //print the begining of a continuation line
-					fprintf(out, "%1c%02d", systems[it->sysIndex].system, it->satellite);
+					fprintf(out, "%1c%02d", hdr.systems[it->sysIndex].system, it->satellite);
 					anInt++;
 					if (anInt == 12) {		//printed last sat in the 1st line
 						fprintf(out, "%s", clkOffsetBuffer);
@@ -1964,15 +2096,15 @@ void RinexData::printObsEpoch(FILE* out) {
 			if (clkOffsetPrinted) fprintf(out, "\n");
 			else fprintf(out, "%s\n", clkOffsetBuffer);
 			//for each satellite in this epoch, print their observables and remove them from epochObs
-			while (printSatObsValues(out, V210))
+			while (printSatObsValues(out))
 			    ;
 	 		break;
 		case V304:	//RINEX version 3.04
             fprintf(out, "%s  %1d%3d%5c%s%3c\n", timeBuffer, epochFlag, nSatsEpoch, ' ', clkOffsetBuffer, ' ');
 			//for each satellite in this epoch,  print a line with their measurements (they are removed just after printed)
 			do {
-				fprintf(out, "%1c%02d", systems[epochObs[0].sysIndex].system, epochObs[0].satellite);
- 			} while (printSatObsValues(out, V304));
+				fprintf(out, "%1c%02d", hdr.systems[epochObs[0].sysIndex].system, epochObs[0].satellite);
+ 			} while (printSatObsValues(out));
  			break;
 		default:
 		     break;
@@ -1983,19 +2115,20 @@ void RinexData::printObsEpoch(FILE* out) {
 	case 4:	//header information event
     case 5:	//external event
 		//count the number of special records (header lines) to print
-		nSatsEpoch = 0;
-		for (vector<LABELdata>::iterator lit = labelDef.begin(); lit != labelDef.end(); lit++) {
-			if (lit->hasData && ((lit->type & OBSMSK) != OBSNAP) && (lit->ver == VALL || lit->ver == version))
+		nSatsEpoch = hdr.hdComments.size();
+		for (unsigned int i = 0; i <= LASTONE; i++) {
+			if (hdr.labelHasData[i] && ((labelDef[i].type & OBSMSK) != OBSNAP) && (labelDef[i].ver == VALL || labelDef[i].ver == hdr.version))
 				nSatsEpoch++;
 		}
 		//print epoch 1st line. Note that nSatsEpoch contains the number of special records that follow
  		fprintf(out, "%s  %1d%3d\n", timeBuffer, epochFlag, nSatsEpoch);
 		if (nSatsEpoch > 0) {
 			//print the header lines that follow
-			for (vector<LABELdata>::iterator lit = labelDef.begin(); lit != labelDef.end(); lit++) {
-                //*if (lit->hasData && lit->labelID != EOH && ((lit->type & OBSMSK) != OBSNAP) && (lit->ver == VALL || lit->ver == version))
-				if (lit->hasData && ((lit->type & OBSMSK) != OBSNAP) && (lit->ver == VALL || lit->ver == version))
-					printHdLineData(out, lit);
+			unsigned int comm = 0;
+			for (unsigned int i = 0; i <= LASTONE; i++) {
+				for (; (comm < hdr.hdComments.size()) && (hdr.hdComments[comm].pos <= i); comm++) printHdLineData(out, COMM, hdr.hdComments[comm].text);
+				if (hdr.labelHasData[i] && ((labelDef[i].type & OBSMSK) != OBSNAP) && (labelDef[i].ver == VALL || labelDef[i].ver == hdr.version))
+					printHdLineData(out, (RINEXlabel) i);
 			}
 		}
 		break;
@@ -2024,8 +2157,8 @@ void RinexData::printNavHeader(FILE* out) {
 	///Before printing, set VERSION data record which depends on the version to be printed.
 	const string msgNotNav("No system selected to generate navigation file");
 	int n = 0;
-	if (version == VTBD) version = inFileVer;
-	if (version == VTBD) throw msgVerTBD;
+	if (hdr.version == VTBD) hdr.version = hdr.inFileVer;
+	if (hdr.version == VTBD) throw msgVerTBD;
     try {
          setFileDataType('N', true);
          setSuffixes();
@@ -2035,13 +2168,16 @@ void RinexData::printNavHeader(FILE* out) {
 	setLabelFlag(VERSION);
     setLabelFlag(EOH);	//END OF HEADER record shall allways be printed
 	///Finally, for each navigation header record belonging to the current version and having data defined, it is printed.
-	for (vector<LABELdata>::iterator it = labelDef.begin(); it != labelDef.end(); it++) {
-		if (((it->type & NAVMSK) != NAVNAP) && (it->ver == VALL || it->ver == version)) {
-			if (it->hasData)
-				printHdLineData(out, it);
-			else if ((it->type & NAVMSK) == NAVOBL)
+	unsigned int comm = 0;
+	for (unsigned int i = 0; i <= LASTONE; i++) {
+		//print comments placed before this record
+		for (; (comm < hdr.hdComments.size()) && (hdr.hdComments[comm].pos <= i); comm++) printHdLineData(out, COMM, hdr.hdComments[comm].text);
+		if (((labelDef[i].type & NAVMSK) != NAVNAP) && (labelDef[i].ver == VALL || labelDef[i].ver == hdr.version)) {
+			if (hdr.labelHasData[i])
+				printHdLineData(out, (RINEXlabel) i);
+			else if ((labelDef[i].type & NAVMSK) == NAVOBL)
 				///Log a warning message when the record to be printed is obligatory, but has not data.
-				plog->warning(valueLabel(it->labelID, msgHdRecNoData));
+				plog->warning(valueLabel((RINEXlabel) i, msgHdRecNoData));
 		}
 	}
 }
@@ -2062,8 +2198,7 @@ void RinexData::printNavEpochs(FILE* out) {
     const string msgNavEpochPrn("Printed epoch for system, satellite=");
 	char timeBuffer[80];
 	int nBroadcastOrbits, nEphemeris;
-	const char* timeFormat;
-	const char* secondsFormat;
+	GPStimeFormatter::timeLayout timeLayout;
 	int lineStartSpaces;
 	vector<SatNavData>::iterator it;
 
@@ -2073,15 +2208,13 @@ void RinexData::printNavEpochs(FILE* out) {
 #endif
 	if(epochNav.empty()) return;
 	//set version constants
-	switch (version) {
+	switch (hdr.version) {
 	case V210:
-		timeFormat = "%y %m %d %H %M";
-		secondsFormat = " %4.1f";
+		timeLayout = GPStimeFormatter::V2NAV;
 		lineStartSpaces = 3;
 		break;
 	case V304:
-		timeFormat = "%Y %m %d %H %M %S";
-		secondsFormat = "";
+		timeLayout = GPStimeFormatter::V3NAV;
 		lineStartSpaces = 4;
 		break;
 	default:
@@ -2091,13 +2224,13 @@ void RinexData::printNavEpochs(FILE* out) {
 	//if (!filterNavData()) return;
 	//sort epochs available by time tag, system, and satellite
 	sort(epochNav.begin(), epochNav.end());
-	plog->finest(msgNavEpochsSys + string(1, sysToPrintId) + msgColon);
+	plog->finest(msgNavEpochsSys + string(1, hdr.sysToPrintId) + msgColon);
 	for (vector<SatNavData>::iterator it = epochNav.begin(); it != epochNav.end(); it++) {
 	    if (isSatSelected(systemIndex(it->systemId), it->satellite)) {
             plog->finest(msgNavEpochPrn + string(1, it->systemId) + msgComma + to_string(it->satellite));
             //print epoch first line
-            formatGPStime (timeBuffer, sizeof timeBuffer, timeFormat, secondsFormat, getWeekGNSSinstant(it->navTimeTag), getTowGNSSinstant(it->navTimeTag));
-            switch (version) {	//print satellite and epoch time
+            timeFormatter.format(timeBuffer, timeLayout, getWeekGNSSinstant(it->navTimeTag), getTowGNSSinstant(it->navTimeTag));
+            switch (hdr.version) {	//print satellite and epoch time
                 case V210:
                     fprintf(out, "%02d %s", it->satellite, timeBuffer);
                     if (it->systemId == 'R') {	//in V2 GLONASS tk to print is daily, not weekly
@@ -2257,7 +2390,7 @@ RinexData::RINEXlabel RinexData::readRinexHeader(FILE* input) {
  */
 int RinexData::readObsEpoch(FILE* input) {
 	epochObs.clear();
-	switch(inFileVer) {
+	switch(hdr.inFileVer) {
 	case V210:
 		return readV2ObsEpoch(input);
 	case V304:
@@ -2306,14 +2439,15 @@ int RinexData::readNavEpoch(FILE* input) {
 	int retCode;
 
 	epochNav.clear();
+	memset(bo, 0, sizeof(bo));
 	//read epoch 1st line and extract data and set specific line parameter
 	if (readRinexRecord(lineBuffer, sizeof lineBuffer, input)) return 0;
 	string msgPrfx =  msgEpoch + string(lineBuffer, 32) + msgBrak;
 	int year = 0, month = 0, day = 0, hour = 0, minute = 0;
 	double second = 0.0;
-	switch (inFileVer) {
+	switch (hdr.inFileVer) {
 	case V210:
-	    sysSat = sysToPrintId;
+	    sysSat = hdr.sysToPrintId;
 		if (sscanf(lineBuffer, "%2d", &prnSat) != 1) LOG_ERR_AND_RETURN(msgWrongSysPRN, 3)
 		if (sscanf(lineBuffer+3, "%2d %2d %2d %2d %2d%5lf", &year, &month, &day, &hour, &minute, &second) != 6)
 			LOG_ERR_AND_RETURN(msgWrongDate, 4)
@@ -2327,7 +2461,7 @@ int RinexData::readNavEpoch(FILE* input) {
 		if (sscanf(lineBuffer+4, "%4d %2d %2d %2d %2d %2d", &year, &month, &day, &hour, &minute, &anInt) != 6)
 			LOG_ERR_AND_RETURN(msgWrongDate, 4)
 		second = (double) anInt;
-		startPos1st = lineBuffer + 22;	//start position of SV clock data in the 1st line
+		startPos1st = lineBuffer + 23;	//start position of SV clock data in the 1st line
 		startPosBO = lineBuffer + 4;	//start position of broadcat orbit data
 		break;
 	default: LOG_ERR_AND_RETURN(msgWrongInFile, 9)
@@ -2366,7 +2500,7 @@ int RinexData::readNavEpoch(FILE* input) {
 		msgPrfx += msgNewEp;
 	}
 	try {
-		epochNav.push_back(SatNavData(attag, sysToPrintId, prnSat, bo));
+		epochNav.push_back(SatNavData(attag, sysSat, prnSat, bo));
 		msgPrfx += msgStored;
 	} catch (std::bad_alloc& ba) {
 		LOG_ERR_AND_RETURN(msgNoMem + ba.what(), 10)
@@ -2377,8 +2511,1284 @@ int RinexData::readNavEpoch(FILE* input) {
 #undef GET_BO
 }
 
+/**buildObsEpochIndex builds an index with the byte offset, time and flag of each epoch in the input RINEX observation file.
+ * The index is obtained in one fast scan of the file, where only epoch lines are decoded: lines starting with '>' for V3.04 files,
+ * or lines matching the epoch line pattern for V2.10 files.
+ * If an index file name is given and it contains an index built for the current input file (the one with its size and modification
+ * time), the index is loaded from it instead of scanning the input file. Otherwise, after scanning the input file the index is saved into the given index file (a sidecar file).
+ * <p>The input file shall be positioned at the first epoch, that is, after reading the header with readRinexHeader. Its position is
+ * not modified by this method.
+ *
+ * @param input the already open input RINEX observation file
+ * @param indexFileName the name of the sidecar file where the index is loaded from or saved to. If empty, no sidecar file is used
+ * @return the number of epochs in the index, or -1 if the input file version is unknown
+ */
+int RinexData::buildObsEpochIndex(FILE* input, string indexFileName) {
+    const string msgIdxLoaded("Epoch index loaded from ");
+    const string msgIdxBuilt("Epoch index built. Epochs=");
+    const string msgIdxNotSaved("Epoch index cannot be saved in ");
+	char lineBuffer[1300];
+	double timeTag;
+	int flag;
+	size_t len;
+	bool lineStart = true;	//true when the next chunk read starts a new line
+	if ((hdr.inFileVer != V210) && (hdr.inFileVer != V304)) return -1;
+	long startPos = ftell(input);
+	fseek(input, 0, SEEK_END);
+	long fileSize = ftell(input);
+	struct stat st;
+	long long fileTime = (fstat(fileno(input), &st) == 0)? (long long) st.st_mtime : -1;
+	if (!indexFileName.empty() && loadObsEpochIndex(indexFileName) && (obsIndexFileSize == fileSize) && (obsIndexFileTime == fileTime)) {
+		fseek(input, startPos, SEEK_SET);
+		plog->fine(msgIdxLoaded + indexFileName);
+		return (int) obsEpochIndex.size();
+	}
+	obsEpochIndex.clear();
+	obsIndexFileSize = fileSize;
+	obsIndexFileTime = fileTime;
+	fseek(input, startPos, SEEK_SET);
+	//offsets are computed adding the length of data read to avoid a ftell per line
+	for (long offset = startPos; fgets(lineBuffer, sizeof lineBuffer, input) != NULL; offset += (long) len) {
+		len = strlen(lineBuffer);
+		if (lineStart && isObsEpochLine(lineBuffer, timeTag, flag)) obsEpochIndex.push_back(OBSepochIndex(offset, timeTag, flag));
+		lineStart = (len > 0) && (lineBuffer[len - 1] == '\n');
+	}
+	clearerr(input);
+	fseek(input, startPos, SEEK_SET);
+	if (!indexFileName.empty() && !saveObsEpochIndex(indexFileName)) plog->warning(msgIdxNotSaved + indexFileName);
+	plog->fine(msgIdxBuilt + to_string(obsEpochIndex.size()));
+	return (int) obsEpochIndex.size();
+}
+
+/**seekObsEpoch positions the input RINEX observation file at the first epoch having time equal or after the given one.
+ * The epoch index shall be built before using buildObsEpochIndex.
+ * After positioning, the epoch can be read using readObsEpoch.
+ *
+ * @param input the already open input RINEX observation file
+ * @param time the epoch time to search for, as seconds from the GPS epoch (see getInstantGPSdate or getInstantGNSStime)
+ * @return true if the file has been positioned, false if there is no epoch at or after the given time
+ */
+bool RinexData::seekObsEpoch(FILE* input, double time) {
+	vector<OBSepochIndex>::iterator it = lower_bound(obsEpochIndex.begin(), obsEpochIndex.end(), OBSepochIndex(0, time, 0));
+	if (it == obsEpochIndex.end()) return false;
+	return fseek(input, it->offset, SEEK_SET) == 0;
+}
+
+/**readObsEpochRange reads from the input RINEX observation file the next epoch inside the given time interval.
+ * No reading state is kept between calls: each call locates the current input file position in the epoch index. If it is
+ * the position of an epoch inside the interval, this epoch is read. Otherwise the file is positioned at the first epoch at or
+ * after fromTime and it is read. When the current position is just after the last epoch of the interval, 0 is returned and the
+ * file is positioned again at the first epoch of the interval, to allow reading it again.
+ * Then, calling it repeatedly reads all epochs in the interval, and readObsEpoch can be used between calls to skip epochs.
+ * The epoch index shall be built before using buildObsEpochIndex.
+ *
+ * @param input the already open input RINEX observation file
+ * @param fromTime the start of the time interval, as seconds from the GPS epoch
+ * @param toTime the end of the time interval, as seconds from the GPS epoch
+ * @return 0 when there are no more epochs in the interval, or the status of the epoch read as per readObsEpoch
+ */
+int RinexData::readObsEpochRange(FILE* input, double fromTime, double toTime) {
+	vector<OBSepochIndex>::iterator first = lower_bound(obsEpochIndex.begin(), obsEpochIndex.end(), OBSepochIndex(0, fromTime, 0));
+	vector<OBSepochIndex>::iterator last = upper_bound(first, obsEpochIndex.end(), OBSepochIndex(0, toTime, 0));
+	if (first == last) return 0;	//no epochs in the interval
+	long pos = ftell(input);
+	long endOffset = (last == obsEpochIndex.end())? obsIndexFileSize : last->offset;
+	//binary search of the current position among the offsets of epochs in the interval (they are in file order)
+	size_t lo = first - obsEpochIndex.begin();
+	size_t hi = last - obsEpochIndex.begin();
+	size_t mid;
+	while (lo < hi) {
+		mid = (lo + hi) / 2;
+		if (obsEpochIndex[mid].offset < pos) lo = mid + 1;
+		else hi = mid;
+	}
+	if ((lo < (size_t) (last - obsEpochIndex.begin())) && (obsEpochIndex[lo].offset == pos)) return readObsEpoch(input);
+	if (fseek(input, first->offset, SEEK_SET) != 0) return 0;
+	if ((pos > first->offset) && (pos <= endOffset)) return 0;	//all epochs in the interval have been read
+	return readObsEpoch(input);
+}
+
+/**readObsEpochsParallel reads all remaining epochs in the input RINEX V3.04 observation file using several threads.
+ * The file is read in blocks which are split into chunks aligned to epoch lines (the ones starting with '>'). Each chunk is parsed
+ * in its own thread as per readObsEpoch, using the header data already read (systems and observables) in read only mode.
+ * Epochs are delivered in file order: each epoch is stored as the current epoch in this object, and the given consumer function
+ * is called, where data can be obtained using getEpochTime and getObsData, or printed. Special event epochs (flags 2 to 5) are
+ * read sequentially in the calling thread, as their header records modify header data. When an event has header records, the
+ * epochs following it in the same block, already decoded with the former header data, are discarded and read again sequentially.
+ * <p>The input file shall be positioned at the first epoch, that is, after reading the header with readRinexHeader. When the
+ * consumer stops reading, the input file is left positioned after the last epoch delivered.
+ *
+ * @param input the already open input RINEX observation file
+ * @param consumer the function to be called for each epoch read, with the status of the epoch read as per readObsEpoch
+ * @param userData a pointer to user data to be passed to the consumer function
+ * @param nThreads the number of threads to use. If 0, the number of processor cores is used
+ * @return the number of epochs delivered, or -1 if the input file version is not V3.04
+ */
+int RinexData::readObsEpochsParallel(FILE* input, ObsEpochConsumer consumer, void* userData, unsigned int nThreads) {
+	const size_t CHUNK_SIZE = 4 * 1024 * 1024;	//amount of data to be parsed by each thread in each block
+	vector<char> buffer;
+	vector<size_t> limits;
+	vector< vector<OBSepochData> > chunkEpochs;
+	vector<thread> workers;
+	size_t dataLen = 0, blockEnd, pos;
+	long blockOffset, nextOffset;
+	long stopOffset = 0;	//the position after the last epoch delivered when the consumer stops reading
+	int nDelivered = 0;
+	int status;
+	bool endOfFile = false;
+	bool goOn = true;
+	bool headerChanged;		//true when an event epoch in the current block had header records
+	if (hdr.inFileVer != V304) return -1;
+	if (nThreads == 0) nThreads = thread::hardware_concurrency();
+	if (nThreads == 0) nThreads = 1;
+	blockOffset = ftell(input);
+	buffer.resize(CHUNK_SIZE * nThreads);
+	while (goOn && !endOfFile) {
+		//fill the buffer after data remaining from the previous block
+		if (buffer.size() - dataLen < CHUNK_SIZE) buffer.resize(dataLen + CHUNK_SIZE * nThreads);
+		dataLen += fread(&buffer[dataLen], 1, buffer.size() - dataLen, input);
+		endOfFile = dataLen < buffer.size();
+		//the block to parse ends at the start of its last epoch, which could be incomplete, unless EOF has been reached
+		blockEnd = dataLen;
+		if (!endOfFile) {
+			for (blockEnd = dataLen - 1; (blockEnd > 0) && !((buffer[blockEnd] == '>') && (buffer[blockEnd - 1] == '\n')); blockEnd--);
+			if (blockEnd == 0) continue;	//no epoch start found: read more data
+		}
+		//split the block in chunks aligned to epoch lines
+		limits.clear();
+		limits.push_back(0);
+		for (unsigned int i = 1; i < nThreads; i++) {
+			pos = max(limits.back() + 1, blockEnd * i / nThreads);
+			while ((pos < blockEnd) && !((buffer[pos] == '>') && (buffer[pos - 1] == '\n'))) pos++;
+			if (pos >= blockEnd) break;
+			limits.push_back(pos);
+		}
+		limits.push_back(blockEnd);
+		//parse chunks concurrently
+		chunkEpochs.assign(limits.size() - 1, vector<OBSepochData>());
+		workers.clear();
+		for (size_t i = 0; i + 1 < limits.size(); i++)
+			workers.push_back(thread(&RinexData::parseV3ObsChunk, this, &buffer[limits[i]], &buffer[0] + limits[i + 1],
+				blockOffset + (long) limits[i], &chunkEpochs[i]));
+		for (vector<thread>::iterator it = workers.begin(); it != workers.end(); ++it) it->join();
+		//deliver epochs in file order
+		nextOffset = ftell(input);
+		headerChanged = false;
+		for (vector< vector<OBSepochData> >::iterator itc = chunkEpochs.begin(); goOn && !headerChanged && (itc != chunkEpochs.end()); ++itc) {
+			for (vector<OBSepochData>::iterator ite = itc->begin(); goOn && !headerChanged && (ite != itc->end()); ++ite) {
+				for (vector<string>::iterator its = ite->skipped.begin(); its != ite->skipped.end(); ++its) plog->warning(*its);
+				if (ite->status == 0) continue;		//only lines out of an epoch at the end of the file
+				epochObs.clear();
+				if (ite->status < 0) {	//special event epoch: read it sequentially
+					fseek(input, ite->offset, SEEK_SET);
+					ite->status = readV3ObsEpoch(input);
+					ite->endOffset = ftell(input);
+					headerChanged = nSatsEpoch > 0;
+				} else {
+					epochFlag = ite->flag;
+					nSatsEpoch = ite->nSats;
+					epochWeek = ite->week;
+					epochTOW = ite->tow;
+					epochTimeTag = ite->timeTag;
+					epochClkOffset = ite->clkOffset;
+					epochObs.swap(ite->obs);
+					if (ite->status == 1) plog->fine(ite->msg);
+					else plog->warning(ite->msg);
+				}
+				nDelivered++;
+				goOn = consumer(*this, ite->status, userData);
+				stopOffset = ite->endOffset;
+			}
+		}
+		//epochs in the block after an event with header records are read again with the new header data
+		while (goOn && headerChanged && (ftell(input) < blockOffset + (long) blockEnd)) {
+			epochObs.clear();
+			if ((status = readV3ObsEpoch(input)) == 0) break;
+			nDelivered++;
+			goOn = consumer(*this, status, userData);
+			stopOffset = ftell(input);
+		}
+		//reading continues after the block, or after the last epoch delivered when the consumer stops it
+		fseek(input, goOn? nextOffset : stopOffset, SEEK_SET);
+		//keep data not parsed for the next block
+		memmove(&buffer[0], &buffer[blockEnd], dataLen - blockEnd);
+		dataLen -= blockEnd;
+		blockOffset += (long) blockEnd;
+	}
+	epochObs.clear();
+	return nDelivered;
+}
+
+/**readObsFile reads all remaining epochs in the input RINEX observation file and stores their observables into the given
+ * columnar store. Observables are stored by system, satellite and observable type, with the time of each epoch.
+ * Observables are placed in the store directly while they are parsed, without storing them as the current epoch.
+ * Only epochs with observables read without errors (status 1 as per readObsEpoch) are stored: epochs with errors are removed from
+ * the store. Event epochs are processed as per readObsEpoch.
+ * Filtering criteria stated with setFilter are applied when reading, as per readObsEpoch.
+ * <p>The input file shall be positioned at the first epoch, that is, after reading the header with readRinexHeader.
+ *
+ * @param input the already open input RINEX observation file
+ * @param store the columnar store where observables will be added
+ * @return the number of epochs stored, or -1 if the input file version is not known
+ */
+int RinexData::readObsFile(FILE* input, RinexObsStore &store) {
+	const int MAXSATS = 100;	//satellite numbers in RINEX files have two digits
+	if ((hdr.inFileVer != V210) && (hdr.inFileVer != V304)) return -1;
+	//the cache with the store series index for each system, satellite and observable type, to avoid searching them
+	OBSstoreSink sink;
+	unsigned int cacheSize = 0;
+	sink.store = &store;
+	for (vector<GNSSsystem>::iterator it = hdr.systems.begin(); it != hdr.systems.end(); ++it) {
+		sink.sysOffset.push_back(cacheSize);
+		cacheSize += MAXSATS * it->obsTypes.size();
+	}
+	sink.seriesCache.assign(cacheSize, -1);
+	int nEpochs = 0;
+	int status;
+	obsSink = &sink;
+	while ((status = readObsEpoch(input)) != 0) {
+		if (status == 1) nEpochs++;
+		//header records in events could define new systems or observables
+		for (size_t i = sink.sysOffset.size(); i < hdr.systems.size(); i++) {
+			sink.sysOffset.push_back((unsigned int) sink.seriesCache.size());
+			sink.seriesCache.insert(sink.seriesCache.end(), MAXSATS * hdr.systems[i].obsTypes.size(), -1);
+		}
+	}
+	obsSink = NULL;
+	store.shrinkToFit();
+	return nEpochs;
+}
+
+/**addObsToSink places the data of an observable read in the store set in obsSink, if any, or appends them to the given vector.
+ * The series index for the system, satellite and observable is taken from the sink cache, which is updated when needed.
+ *
+ * @param tTag the time tag of the epoch
+ * @param sysIdx the index in systems of the satellite system
+ * @param sat the satellite number
+ * @param obsIdx the index in the system obsTypes of the observable
+ * @param value the observable value
+ * @param lli the loss of lock indicator
+ * @param ssi the signal strength indicator
+ * @param obs the vector where data are appended when there is no sink
+ */
+void RinexData::addObsToSink(double tTag, unsigned int sysIdx, int sat, unsigned int obsIdx, double value, int lli, int ssi, vector<SatObsData> &obs) const {
+	const int MAXSATS = 100;	//as per readObsFile
+	if (obsSink == NULL) {
+		obs.push_back(SatObsData(tTag, sysIdx, sat, obsIdx, value, lli, ssi));
+		return;
+	}
+	const GNSSsystem &sys = hdr.systems[sysIdx];
+	int series;
+	if ((sat >= 0) && (sat < MAXSATS) && (sysIdx < obsSink->sysOffset.size())) {
+		int &cached = obsSink->seriesCache[obsSink->sysOffset[sysIdx] + sat * sys.obsTypes.size() + obsIdx];
+		if (cached < 0) cached = obsSink->store->addSeries(sys.system, sat, sys.obsTypes[obsIdx].id);
+		series = cached;
+	} else series = obsSink->store->addSeries(sys.system, sat, sys.obsTypes[obsIdx].id);
+	obsSink->store->setObs(series, value, lli, ssi);
+}
+
+/**addEpochToSink adds the current epoch to the store set in obsSink, if any.
+ */
+void RinexData::addEpochToSink() {
+	if (obsSink != NULL) obsSink->store->addEpoch(epochTimeTag, epochFlag, epochClkOffset);
+}
+
+/**removeEpochFromSink removes the last epoch added to the store set in obsSink, if any, and the cached series removed with it.
+ * It is used when errors are found in the observables of the epoch.
+ */
+void RinexData::removeEpochFromSink() {
+	if (obsSink == NULL) return;
+	obsSink->store->removeLastEpoch();
+	int nSeries = (int) obsSink->store->getNumSeries();
+	for (vector<int>::iterator it = obsSink->seriesCache.begin(); it != obsSink->seriesCache.end(); ++it)
+		if (*it >= nSeries) *it = -1;
+}
+
+/**storeObsEpoch appends the current epoch (its time and observables) to the given columnar store.
+ * It allows storing epochs data obtained from any source (a RINEX file or the GRD / OSP receiver data), for example to
+ * export them to a columnar file using RinexObsStore::writeColumnar.
+ *
+ * @param store the columnar store where current epoch data will be added
+ * @return the number of observables stored
+ */
+int RinexData::storeObsEpoch(RinexObsStore &store) {
+	int nStored = 0;
+	store.addEpoch(epochTimeTag, epochFlag, epochClkOffset);
+	for (vector<SatObsData>::iterator it = epochObs.begin(); it != epochObs.end(); ++it) {
+		if ((it->sysIndex >= hdr.systems.size()) || (it->obsTypeIndex >= hdr.systems[it->sysIndex].obsTypes.size())) continue;
+		store.setObs(store.addSeries(hdr.systems[it->sysIndex].system, it->satellite,
+				hdr.systems[it->sysIndex].obsTypes[it->obsTypeIndex].id), it->obsValue, it->lossOfLock, it->strength);
+		nStored++;
+	}
+	return nStored;
+}
+
+/**writeNavColumnar writes the navigation data currently stored as the NAVDATA table of the given columnar file, already open for writing.
+ * The table has one row for each satellite ephemeris stored, and the columns TIME (the time tag), SYS, PRN and one column for each
+ * broadcast orbit parameter, named BO<line>_<column> (BO0_0 to BO7_3), where unused parameters are set to 0.
+ *
+ * @param out the columnar file where the table will be written
+ * @return true if the table was written, false otherwise
+ */
+bool RinexData::writeNavColumnar(ColumnarFile &out) {
+	char colName[16];
+	vector<double> time;
+	vector<char> sys;
+	vector<int32_t> prn;
+	vector<double> params(epochNav.size() * BO_MAXLINS * BO_MAXCOLS);
+	unsigned int n = (unsigned int) epochNav.size();
+	for (unsigned int i = 0; i < n; i++) {
+		time.push_back(epochNav[i].navTimeTag);
+		sys.push_back(epochNav[i].systemId);
+		prn.push_back(epochNav[i].satellite);
+		for (int l = 0; l < BO_MAXLINS; l++)
+			for (int c = 0; c < BO_MAXCOLS; c++) params[(l * BO_MAXCOLS + c) * n + i] = epochNav[i].broadcastOrbit[l][c];
+	}
+	if (!out.beginTable("NAVDATA", n, 3 + BO_MAXLINS * BO_MAXCOLS)
+		|| !out.writeColumn("TIME", ColumnarFile::FLOAT64, sizeof(double), time.data())
+		|| !out.writeColumn("SYS", ColumnarFile::CHAR, sizeof(char), sys.data())
+		|| !out.writeColumn("PRN", ColumnarFile::INT32, sizeof(int32_t), prn.data())) return false;
+	for (int l = 0; l < BO_MAXLINS; l++)
+		for (int c = 0; c < BO_MAXCOLS; c++) {
+			sprintf(colName, "BO%d_%d", l, c);
+			if (!out.writeColumn(colName, ColumnarFile::FLOAT64, sizeof(double), params.data() + (l * BO_MAXCOLS + c) * n)) return false;
+		}
+	return true;
+}
+
+/**writeNavColumnar reads all remaining records in the input RINEX navigation file and writes them as the NAVDATA table of the
+ * given columnar file, already open for writing, as per writeNavColumnar for the data stored.
+ * As readNavEpoch keeps only the last record read, records are accumulated while reading the file. After writing, they remain
+ * stored in this object. Records with errors are not written.
+ * <p>The input file shall be positioned at the first record, that is, after reading the header with readRinexHeader.
+ *
+ * @param input the already open input RINEX navigation file
+ * @param out the columnar file where the table will be written
+ * @return true if the table was written, false otherwise
+ */
+bool RinexData::writeNavColumnar(FILE* input, ColumnarFile &out) {
+	vector<SatNavData> fileNav;
+	int status;
+	while ((status = readNavEpoch(input)) != 0) {
+		if ((status == 1) || (status == 2)) fileNav.insert(fileNav.end(), epochNav.begin(), epochNav.end());
+		else if (status == 9) return false;
+	}
+	epochNav.swap(fileNav);
+	return writeNavColumnar(out);
+}
+
+/**readNavColumnar reads navigation data from the NAVDATA table of the given columnar file, already loaded, and stores them
+ * as per saveNavData. The table shall have the layout written by writeNavColumnar.
+ * Navigation data previously stored are cleared.
+ *
+ * @param in the columnar file with the table to read
+ * @return the number of satellite ephemeris stored, or -1 if the table or some of its columns do not exist
+ */
+int RinexData::readNavColumnar(const ColumnarFile &in) {
+	char colName[16];
+	const double* params[BO_MAXLINS][BO_MAXCOLS];
+	double bo[BO_MAXLINS][BO_MAXCOLS];
+	epochNav.clear();
+	if (!in.hasTable("NAVDATA")) return -1;
+	unsigned long n = in.getNumRows("NAVDATA");
+	const double* time = (const double*) in.getColumn("NAVDATA", "TIME", ColumnarFile::FLOAT64, sizeof(double));
+	const char* sys = (const char*) in.getColumn("NAVDATA", "SYS", ColumnarFile::CHAR, sizeof(char));
+	const int32_t* prn = (const int32_t*) in.getColumn("NAVDATA", "PRN", ColumnarFile::INT32, sizeof(int32_t));
+	if ((time == NULL) || (sys == NULL) || (prn == NULL)) return -1;
+	for (int l = 0; l < BO_MAXLINS; l++)
+		for (int c = 0; c < BO_MAXCOLS; c++) {
+			sprintf(colName, "BO%d_%d", l, c);
+			if ((params[l][c] = (const double*) in.getColumn("NAVDATA", colName, ColumnarFile::FLOAT64, sizeof(double))) == NULL) return -1;
+		}
+	epochNav.reserve(n);
+	for (unsigned long i = 0; i < n; i++) {
+		for (int l = 0; l < BO_MAXLINS; l++)
+			for (int c = 0; c < BO_MAXCOLS; c++) bo[l][c] = params[l][c][i];
+		epochNav.push_back(SatNavData(time[i], sys[i], prn[i], bo));
+	}
+	return (int) n;
+}
+
+/**openObsMerge starts merging the given RINEX observation files, reading their headers.
+ * Header data of this object are set from the header of the first input file, with the following changes:
+ * - Systems and observable types are the union of those defined in all input files.
+ * - TIME OF FIRST OBS is the earliest one in the input files, and TIME OF LAST OBS the latest one (removed if some file has not it).
+ * - PRN / # OF OBS and # OF SATELLITES are removed, as their data do not apply to the merged file.
+ * <p>If the RINEX version to print is not defined, it is set to the version of the first input file.
+ * Input files shall be positioned at their beginning, and the first one shall allow seeking.
+ *
+ * @param inputs the already open input RINEX observation files
+ * @return true if the merge can be started, false otherwise
+ */
+bool RinexData::openObsMerge(vector<FILE*> &inputs) {
+	char sys;
+	vector<string> obsIds;
+	int week;
+	double tow;
+	bool allHaveTOLO = true;
+	closeObsMerge();
+	if (inputs.empty()) return false;
+	//set header data from the first file, and set it again at its beginning
+	long start = ftell(inputs[0]);
+	readRinexHeader(inputs[0]);
+	if ((start < 0) || (fseek(inputs[0], start, SEEK_SET) != 0) || (hdr.inFileVer == VTBD)) {
+		plog->warning(msgMergeNoFirst);
+		return false;
+	}
+	if (hdr.version == VTBD) hdr.version = hdr.inFileVer;
+	setLabelFlag(PRNOBS, false);
+	setLabelFlag(SATS, false);
+	//read the header of each file and merge their data
+	for (unsigned int i = 0; i < inputs.size(); i++) {
+		OBSmergeInput mi;
+		mi.input = inputs[i];
+		mi.reader.reset(new RinexData(VTBD, plog));
+		mi.status = 0;
+		mi.reader->readRinexHeader(inputs[i]);
+		if (mi.reader->hdr.inFileVer == VTBD) {
+			plog->warning(msgMergeSkipFile + to_string(i));
+			continue;
+		}
+		for (unsigned int s = 0; mi.reader->getHdLnData(SYS, sys, obsIds, s); s++) setHdLnData(SYS, sys, obsIds);
+		if (mi.reader->getHdLnData(TOFO, week, tow, sys)
+				&& (week * 604800.0 + tow < hdr.firstObsWeek * 604800.0 + hdr.firstObsTOW)) {
+			hdr.firstObsWeek = week;
+			hdr.firstObsTOW = tow;
+		}
+		if (mi.reader->getHdLnData(TOLO, week, tow, sys)) {
+			if (week * 604800.0 + tow > hdr.lastObsWeek * 604800.0 + hdr.lastObsTOW) {
+				hdr.lastObsWeek = week;
+				hdr.lastObsTOW = tow;
+			}
+		} else allHaveTOLO = false;
+		mergeInputs.push_back(move(mi));
+	}
+	if (!allHaveTOLO) setLabelFlag(TOLO, false);
+	//map systems and observables of each file to the ones in this object
+	for (vector<OBSmergeInput>::iterator it = mergeInputs.begin(); it != mergeInputs.end(); ++it) {
+		for (vector<GNSSsystem>::iterator sit = it->reader->hdr.systems.begin(); sit != it->reader->hdr.systems.end(); ++sit) {
+			int sysIdx = systemIndex(sit->system);
+			it->sysMap.push_back(sysIdx);
+			it->obsMap.push_back(vector<int>(sit->obsTypes.size(), -1));
+			if (sysIdx < 0) continue;
+			for (unsigned int o = 0; o < sit->obsTypes.size(); o++)
+				for (unsigned int t = 0; t < hdr.systems[sysIdx].obsTypes.size(); t++)
+					if (sit->obsTypes[o].id.compare(hdr.systems[sysIdx].obsTypes[t].id) == 0) {
+						it->obsMap.back()[o] = (int) t;
+						break;
+					}
+		}
+	}
+	//read the first epoch of each file
+	for (unsigned int i = 0; i < mergeInputs.size(); i++) advanceObsMerge(i);
+	return !mergeInputs.empty();
+}
+
+/**readMergedObsEpoch gets the next epoch in time order from the input files being merged, and stores it as the current epoch,
+ * as per readObsEpoch. When several files have epochs with the same time, they are delivered as one epoch with the observables
+ * of all of them. Duplicated observables (the same system, satellite and observable type) are taken from the first file.
+ * Only epochs with observables are merged: event epochs in input files are discarded.
+ *
+ * @return the status of the epoch, which can can be:
+ *		- (0)	No more epochs in the input files, or merge not started using openObsMerge.
+ *		- (1)	Epoch observables and data are well formatted. They have been stored.
+ *		- (3)	Error in observable data in some input file. Epoch data stored, but wrong observables stored as empty ones (0.0)
+ */
+int RinexData::readMergedObsEpoch() {
+	const double SAME_EPOCH = 1E-7;	//time tags closer than this value are considered the same epoch
+	if (mergeQueue.empty()) return 0;
+	double timeTag = mergeQueue.top().first;
+	int status = 1;
+	epochObs.clear();
+	vector<unsigned long long> previousKeys;	//sorted keys (system, satellite, observable) of observables taken from former files
+	for (bool first = true; !mergeQueue.empty() && (mergeQueue.top().first - timeTag < SAME_EPOCH); first = false) {
+		unsigned int inputIdx = mergeQueue.top().second;
+		mergeQueue.pop();
+		OBSmergeInput &mi = mergeInputs[inputIdx];
+		RinexData* rd = mi.reader.get();
+		if (first) {
+			epochWeek = rd->epochWeek;
+			epochTOW = rd->epochTOW;
+			epochTimeTag = rd->epochTimeTag;
+			epochClkOffset = rd->epochClkOffset;
+			epochFlag = rd->epochFlag;
+		}
+		if (mi.status == 3) status = 3;
+		size_t nPrevious = epochObs.size();
+		for (vector<SatObsData>::iterator it = rd->epochObs.begin(); it != rd->epochObs.end(); ++it) {
+			if ((it->sysIndex >= mi.sysMap.size()) || (mi.sysMap[it->sysIndex] < 0)
+					|| (it->obsTypeIndex >= mi.obsMap[it->sysIndex].size()) || (mi.obsMap[it->sysIndex][it->obsTypeIndex] < 0)) continue;
+			unsigned int sysIdx = (unsigned int) mi.sysMap[it->sysIndex];
+			unsigned int obsIdx = (unsigned int) mi.obsMap[it->sysIndex][it->obsTypeIndex];
+			if (!binary_search(previousKeys.begin(), previousKeys.end(), obsKey(sysIdx, it->satellite, obsIdx)))
+				epochObs.push_back(SatObsData(epochTimeTag, sysIdx, it->satellite, obsIdx, it->obsValue, it->lossOfLock, it->strength));
+		}
+		for (size_t i = nPrevious; i < epochObs.size(); i++)
+			previousKeys.push_back(obsKey(epochObs[i].sysIndex, epochObs[i].satellite, epochObs[i].obsTypeIndex));
+		sort(previousKeys.begin(), previousKeys.end());
+		advanceObsMerge(inputIdx);
+	}
+	return status;
+}
+
+/**closeObsMerge ends merging input files, releasing the objects used to read them.
+ * Input files are not closed.
+ */
+void RinexData::closeObsMerge() {
+	mergeInputs.clear();
+	while (!mergeQueue.empty()) mergeQueue.pop();
+}
+
+/**mergeObsFiles merges the given RINEX observation files and prints the resulting RINEX file.
+ * The header is set as per openObsMerge, and epochs are obtained as per readMergedObsEpoch.
+ *
+ * @param inputs the already open input RINEX observation files
+ * @param out the already open output file where the merged RINEX file will be printed
+ * @return the number of epochs printed, or -1 if merge cannot be done
+ * @throws error message string when header cannot be printed
+ */
+int RinexData::mergeObsFiles(vector<FILE*> &inputs, FILE* out) {
+	int nEpochs = 0;
+	if (!openObsMerge(inputs)) return -1;
+	printObsHeader(out);
+	while (readMergedObsEpoch() != 0) {
+		printObsEpoch(out);
+		nEpochs++;
+	}
+	closeObsMerge();
+	return nEpochs;
+}
+
+/**mergeNavFiles merges the given RINEX navigation files (from several stations, for example) and prints the resulting RINEX file.
+ * Header data are taken from the first input file. Input files are read concurrently using several threads, each one with its
+ * own RinexData object. Each ephemeris, identified by its system, satellite, time of clock and issue of data (IODE for GPS
+ * and QZSS, IODnav for Galileo, AODE for Beidou, none for GLONASS and SBAS), is stored only once.
+ * When copies of the same ephemeris have different data, the copy found in more files is taken (in case of a tie,
+ * the one with the lowest values, compared in the order they are printed). Transmission time of message is not taken into account to compare copies,
+ * and the earliest one is printed.
+ * Ephemeris are printed sorted by time, system and satellite.
+ * <p>Input files shall be positioned at their beginning, and the first one shall allow seeking.
+ *
+ * @param inputs the already open input RINEX navigation files
+ * @param out the already open output file where the merged RINEX file will be printed
+ * @param nThreads the number of threads to use. If 0, the number of processor cores is used
+ * @return the number of ephemeris printed, or -1 if merge cannot be done
+ * @throws error message string when header or data cannot be printed
+ */
+int RinexData::mergeNavFiles(vector<FILE*> &inputs, FILE* out, unsigned int nThreads) {
+	vector<string> noObs;
+	if (inputs.empty()) return -1;
+	//set header data from the first file, and set it again at its beginning
+	long start = ftell(inputs[0]);
+	readRinexHeader(inputs[0]);
+	if ((start < 0) || (fseek(inputs[0], start, SEEK_SET) != 0) || (hdr.inFileVer == VTBD)) {
+		plog->warning(msgMergeNoFirst);
+		return -1;
+	}
+	//read input files in parallel, each thread storing ephemeris in its own map
+	if (nThreads == 0) nThreads = thread::hardware_concurrency();
+	if (nThreads == 0) nThreads = 1;
+	if (nThreads > inputs.size()) nThreads = (unsigned int) inputs.size();
+	vector<NAVmergeMap> navMaps(nThreads);
+	vector<thread> workers;
+	for (unsigned int t = 1; t < nThreads; t++)
+		workers.push_back(thread(&RinexData::collectNavFiles, this, ref(inputs), t, nThreads, ref(navMaps[t])));
+	collectNavFiles(inputs, 0, nThreads, navMaps[0]);
+	for (vector<thread>::iterator it = workers.begin(); it != workers.end(); ++it) it->join();
+	for (unsigned int t = 1; t < nThreads; t++) {
+		for (NAVmergeMap::iterator it = navMaps[t].begin(); it != navMaps[t].end(); ++it)
+			for (vector<NAVmergeCopy>::iterator itc = it->second.begin(); itc != it->second.end(); ++itc)
+				addNavCopy(navMaps[0], itc->data, itc->count);
+		navMaps[t].clear();
+	}
+	//store the copy selected for each ephemeris
+	epochNav.clear();
+	epochNav.reserve(navMaps[0].size());
+	for (NAVmergeMap::iterator it = navMaps[0].begin(); it != navMaps[0].end(); ++it) {
+		vector<NAVmergeCopy>::iterator best = it->second.begin();
+		for (vector<NAVmergeCopy>::iterator itc = it->second.begin() + 1; itc < it->second.end(); ++itc)
+			if ((itc->count > best->count) || ((itc->count == best->count)
+					&& isLowerNavCopy(itc->data, best->data))) best = itc;
+		epochNav.push_back(best->data);
+		//systems shall be defined to allow printing their data
+		if (systemIndex(best->data.systemId) < 0) setHdLnData(SYS, best->data.systemId, noObs);
+	}
+	navMaps[0].clear();
+	int nEphemeris = (int) epochNav.size();
+	printNavHeader(out);
+	printNavEpochs(out);
+	return nEphemeris;
+}
+
+/**probeObsFile obtains the main metadata of a RINEX observation file reading only its header and, when needed, its first
+ * and last epoch lines. The header data are stored in this object, as per readRinexHeader.
+ * The time of the first epoch is taken from TIME OF FIRST OBS, or from the first epoch line if this record is not given.
+ * The time of the last epoch is taken from TIME OF LAST OBS, or, if this record is not given, from the last epoch line with
+ * observables, which is found reading backwards blocks of data from the end of the file.
+ * <p>The input file shall be positioned at its beginning. After probing, it is positioned at the first epoch.
+ *
+ * @param input the already open input RINEX observation file
+ * @param meta the metadata obtained
+ * @return true if metadata were obtained, false otherwise (unknown version or epoch times not found)
+ */
+bool RinexData::probeObsFile(FILE* input, OBSmetadata &meta) {
+	const long BLOCK_SIZE = 16384;	//size of the first block of data to read from the end of the file
+	char lineBuffer[100];
+	double timeTag;
+	int flag;
+	readRinexHeader(input);
+	if ((hdr.inFileVer != V210) && (hdr.inFileVer != V304)) return false;
+	//set header data
+	meta.version = hdr.inFileVer;
+	meta.markerName = hdr.markerName;
+	meta.markerNumber = hdr.markerNumber;
+	meta.rxNumber = hdr.rxNumber;
+	meta.rxType = hdr.rxType;
+	meta.rxVersion = hdr.rxVersion;
+	meta.antNumber = hdr.antNumber;
+	meta.antType = hdr.antType;
+	meta.aproxX = meta.aproxY = meta.aproxZ = 0.0;
+	if (getLabelFlag(APPXYZ)) {
+		meta.aproxX = hdr.aproxX;
+		meta.aproxY = hdr.aproxY;
+		meta.aproxZ = hdr.aproxZ;
+	}
+	meta.interval = getLabelFlag(INT)? hdr.obsInterval : 0.0;
+	meta.systems.clear();
+	for (vector<GNSSsystem>::iterator it = hdr.systems.begin(); it != hdr.systems.end(); ++it) meta.systems += it->system;
+	long dataStart = ftell(input);
+	//set time of the first epoch
+	bool found = getLabelFlag(TOFO);
+	if (found) {
+		meta.firstWeek = hdr.firstObsWeek;
+		meta.firstTOW = hdr.firstObsTOW;
+	} else {
+		while (!found && (fgets(lineBuffer, sizeof lineBuffer, input) != NULL))
+			found = isObsEpochLine(lineBuffer, timeTag, flag) && (flag <= 1);
+		if (!found) return false;
+		meta.firstWeek = getWeekGNSSinstant(timeTag);
+		meta.firstTOW = getTowGNSSinstant(timeTag);
+	}
+	//set time of the last epoch
+	meta.lastFromHeader = getLabelFlag(TOLO);
+	if (meta.lastFromHeader) {
+		meta.lastWeek = hdr.lastObsWeek;
+		meta.lastTOW = hdr.lastObsTOW;
+		fseek(input, dataStart, SEEK_SET);
+		return true;
+	}
+	fseek(input, 0, SEEK_END);
+	long fileEnd = ftell(input);
+	vector<char> buffer;
+	found = false;
+	for (long blockSize = BLOCK_SIZE; !found; blockSize *= 2) {
+		long from = fileEnd - blockSize;
+		if (from < dataStart) from = dataStart;
+		buffer.resize((size_t) (fileEnd - from));
+		fseek(input, from, SEEK_SET);
+		if (fread(buffer.data(), 1, buffer.size(), input) != buffer.size()) break;
+		//check lines from the last one to the first one starting in the block
+		for (size_t end = buffer.size(), pos = buffer.size(); (pos-- > 0) && !found; ) {
+			if ((pos > 0) && (buffer[pos - 1] != '\n')) continue;
+			if ((pos == 0) && (from != dataStart)) break;
+			size_t len = end - pos;
+			if (len > sizeof lineBuffer - 1) len = sizeof lineBuffer - 1;
+			memcpy(lineBuffer, buffer.data() + pos, len);
+			lineBuffer[len] = 0;
+			found = isObsEpochLine(lineBuffer, timeTag, flag) && (flag <= 1);
+			end = pos;
+		}
+		if (from == dataStart) break;
+	}
+	fseek(input, dataStart, SEEK_SET);
+	if (!found) return false;
+	meta.lastWeek = getWeekGNSSinstant(timeTag);
+	meta.lastTOW = getTowGNSSinstant(timeTag);
+	return true;
+}
+
+/**openObsSplit starts printing observation data in several files, one for each time window of the given length.
+ * Windows start at multiples of the given length from the GPS epoch (for example, a length of 3600 gives hourly files
+ * starting at each hour, and 86400 gives daily files). Output files are named using getObsFileName, with the start
+ * time of the window as time of first observation and its end as time of last observation.
+ * Current header data are used to print the header of each file.
+ *
+ * @param windowSecs the length of each time window in seconds
+ * @param prefix the file name prefix, as per getObsFileName
+ * @param country the country code, as per getObsFileName
+ * @param path the directory where files will be created (empty for the current one)
+ * @param maxOpen the maximum number of files to be open at the same time
+ * @return true if splitting is started, false otherwise (wrong arguments)
+ */
+bool RinexData::openObsSplit(double windowSecs, string prefix, string country, string path, unsigned int maxOpen) {
+	closeObsSplit();
+	if ((windowSecs <= 0.0) || (maxOpen == 0)) return false;
+	if (hdr.version == VTBD) hdr.version = hdr.inFileVer;
+	splitWindow = windowSecs;
+	splitPrefix = prefix;
+	splitCountry = country;
+	splitPath = path;
+	if (!splitPath.empty() && (splitPath.back() != '/') && (splitPath.back() != '\\')) splitPath += '/';
+	splitMaxOpen = maxOpen;
+	return true;
+}
+
+/**printObsEpochSplit prints the current epoch data, as per printObsEpoch, in the output file of the time window the epoch
+ * belongs to. The file is created, and its header printed, if needed.
+ * Event epochs without time (flags 2 to 5) are printed in the last file used.
+ *
+ * @return true if epoch data have been printed, false otherwise (splitting not started or file cannot be opened)
+ * @throws error message string when header or epoch data cannot be printed
+ */
+bool RinexData::printObsEpochSplit() {
+	if (splitWindow <= 0.0) return false;
+	int fileIdx = splitLast;
+	bool isObsEpoch = (epochFlag < 2) || (epochFlag > 5);
+	if (isObsEpoch || (fileIdx < 0)) {
+		double windowStart = floor(getInstantGNSStime(epochWeek, epochTOW) / splitWindow) * splitWindow;
+		for (fileIdx = 0; (fileIdx < (int) splitFiles.size()) && (splitFiles[fileIdx].windowStart != windowStart); fileIdx++);
+		//a file is created only the first time its window is used
+		if (fileIdx == (int) splitFiles.size()) {
+			if (!openSplitFile(windowStart)) return false;
+			fileIdx = (int) splitFiles.size() - 1;
+		}
+	}
+	OBSsplitFile &sf = splitFiles[fileIdx];
+	if ((sf.out == NULL) && !reopenSplitFile(sf)) return false;
+	if (isObsEpoch) {
+		if (getInstantGNSStime(epochWeek, epochTOW) < getInstantGNSStime(sf.firstWeek, sf.firstTOW)) {
+			sf.firstWeek = epochWeek;
+			sf.firstTOW = epochTOW;
+		}
+		if (getInstantGNSStime(epochWeek, epochTOW) > getInstantGNSStime(sf.lastWeek, sf.lastTOW)) {
+			sf.lastWeek = epochWeek;
+			sf.lastTOW = epochTOW;
+		}
+	}
+	printObsEpoch(sf.out);
+	splitLast = fileIdx;
+	return true;
+}
+
+/**closeObsSplit ends printing observation data in several files, closing all of them.
+ * The TIME OF FIRST OBS and TIME OF LAST OBS records of each file are updated with the first and last epoch printed in it.
+ */
+void RinexData::closeObsSplit() {
+	for (vector<OBSsplitFile>::iterator it = splitFiles.begin(); it != splitFiles.end(); ++it) closeSplitFile(*it);
+	splitFiles.clear();
+	splitWindow = 0.0;
+	splitLast = -1;
+}
+
+/**addObsTarget adds an output file where observation data will be printed, with the given version, at the same time than in
+ * other targets. Printing in targets is performed using printObsHeaderTargets and printObsEpochTargets.
+ *
+ * @param out the already open print stream of the output file
+ * @param ver the RINEX version to print in the file (V210 or V304)
+ * @return true if the target has been added, false otherwise (unknown version)
+ */
+bool RinexData::addObsTarget(FILE* out, RINEXversion ver) {
+	if ((out == NULL) || ((ver != V210) && (ver != V304))) return false;
+	OBStarget target;
+	target.out = out;
+	target.version = ver;
+	target.tofoOffset = target.toloOffset = -1;
+	obsTargets.push_back(target);
+	return true;
+}
+
+/**printObsHeaderTargets prints the observation file header, as per printObsHeader, in each output target with its version.
+ * The observables to print and the print plan for each version are kept to print epochs in the target. The version,
+ * observables to print and print plans in use are restored after printing, also when an error happens.
+ *
+ * @throws error message string when header cannot be printed
+ */
+void RinexData::printObsHeaderTargets() {
+	targetSaved.version = hdr.version;
+	keepObsTarget(targetSaved);
+	try {
+		for (vector<OBStarget>::iterator it = obsTargets.begin(); it != obsTargets.end(); ++it) {
+			hdr.version = it->version;
+			printObsHeader(it->out);
+			it->tofoOffset = hdTofoOffset;
+			it->toloOffset = hdToloOffset;
+			keepObsTarget(*it);
+		}
+	} catch (...) {
+		selectObsTarget(targetSaved);
+		throw;
+	}
+	selectObsTarget(targetSaved);
+}
+
+/**printObsEpochTargets prints the current epoch data, as per printObsEpoch, in each output target with its version.
+ * Epoch data are filtered and formatted for each target from the same data stored, which are removed after printing
+ * them in all targets. The version, observables to print and print plans in use are restored after printing, also when
+ * an error happens.
+ *
+ * @throws error message string when epoch data cannot be printed
+ */
+void RinexData::printObsEpochTargets() {
+	targetSaved.version = hdr.version;
+	keepObsTarget(targetSaved);	//the storage is reused from epoch to epoch
+	targetObs = epochObs;
+	try {
+		for (unsigned int i = 0; i < obsTargets.size(); i++) {
+			if (i > 0) epochObs = targetObs;
+			selectObsTarget(obsTargets[i]);
+			printObsEpoch(obsTargets[i].out);
+		}
+	} catch (...) {
+		selectObsTarget(targetSaved);
+		throw;
+	}
+	selectObsTarget(targetSaved);
+}
+
+/**endObsTargets ends printing observation data in several output targets, updating the TIME OF FIRST OBS and TIME OF LAST OBS
+ * records of each one with their current data. Files are not closed.
+ */
+void RinexData::endObsTargets() {
+	RINEXversion saveVersion = hdr.version;
+	long saveTofoOffset = hdTofoOffset, saveToloOffset = hdToloOffset;
+	for (vector<OBStarget>::iterator it = obsTargets.begin(); it != obsTargets.end(); ++it) {
+		hdr.version = it->version;
+		hdTofoOffset = it->tofoOffset;
+		hdToloOffset = it->toloOffset;
+		updateObsTimes(it->out);
+	}
+	hdr.version = saveVersion;
+	hdTofoOffset = saveTofoOffset;
+	hdToloOffset = saveToloOffset;
+	obsTargets.clear();
+}
+
+/**saveCheckpoint writes to a binary file the current state of the conversion process: header data, current epoch time and
+ * flag, and the position of the TIME OF FIRST OBS and TIME OF LAST OBS records in the last header printed.
+ * Epoch observation and navigation data are not saved. The checkpoint can be restored using restoreCheckpoint.
+ * <p>Other data (f.e. from the receiver data decoder) could be written to the same file before or after the checkpoint.
+ * Data items are written as they are stored in memory: the checkpoint can be restored only by a build having the same layout
+ * (see getCkpLayout).
+ *
+ * @param out the binary file, already open, where the checkpoint is written
+ * @return true if the checkpoint has been written, false otherwise
+ */
+bool RinexData::saveCheckpoint(FILE* out) {
+///macros to write checkpoint data items, strings and vectors of strings, and the size of a vector. ok becomes false on error
+	#define CKP_PUT(VALUE) ok = ok && (fwrite(&(VALUE), sizeof(VALUE), 1, out) == 1)
+	#define CKP_PUTSTR(VALUE) ok = ok && writeBinString(out, VALUE)
+	#define CKP_PUTSTRS(VALUE) ok = ok && writeBinStrings(out, VALUE)
+	#define CKP_PUTSIZE(VECTOR) n = VECTOR.size(); CKP_PUT(n)
+
+	bool ok = fwrite(RINEX_CKP_TAG, sizeof RINEX_CKP_TAG, 1, out) == 1;
+	unsigned int layout[RINEX_CKP_LAYOUTSIZE];
+	getCkpLayout(layout);
+	CKP_PUT(layout);
+	unsigned int n;
+	int anInt;
+	string labels = hdr.labelHasData.to_string();
+	//"RINEX VERSION / TYPE" and "PGM / RUN BY / DATE"
+	anInt = hdr.inFileVer;
+	CKP_PUT(anInt);
+	anInt = hdr.version;
+	CKP_PUT(anInt);
+	CKP_PUT(hdr.fileType);
+	CKP_PUTSTR(hdr.fileTypeSfx);
+	CKP_PUT(hdr.sysToPrintId);
+	CKP_PUTSTR(hdr.systemIdSfx);
+	CKP_PUTSTR(hdr.pgm);
+	CKP_PUTSTR(hdr.runby);
+	CKP_PUTSTR(hdr.date);
+	//marker, observer, receiver and antenna records
+	CKP_PUTSTR(hdr.markerName);
+	CKP_PUTSTR(hdr.markerNumber);
+	CKP_PUTSTR(hdr.markerType);
+	CKP_PUTSTR(hdr.observer);
+	CKP_PUTSTR(hdr.agency);
+	CKP_PUTSTR(hdr.rxNumber);
+	CKP_PUTSTR(hdr.rxType);
+	CKP_PUTSTR(hdr.rxVersion);
+	CKP_PUTSTR(hdr.antNumber);
+	CKP_PUTSTR(hdr.antType);
+	double coords[] = {hdr.aproxX, hdr.aproxY, hdr.aproxZ, hdr.antHigh, hdr.eccEast, hdr.eccNorth, hdr.antX, hdr.antY, hdr.antZ,
+		hdr.antPhNoX, hdr.antPhEoY, hdr.antPhUoZ, hdr.antBoreX, hdr.antBoreY, hdr.antBoreZ, hdr.antZdAzi, hdr.antZdX, hdr.antZdY, hdr.antZdZ,
+		hdr.centerX, hdr.centerY, hdr.centerZ};
+	CKP_PUT(coords);
+	CKP_PUT(hdr.antPhSys);
+	CKP_PUTSTR(hdr.antPhCode);
+	//observation records
+	CKP_PUTSIZE(hdr.wvlenFactor);
+	for (vector<WVLNfactor>::iterator it = hdr.wvlenFactor.begin(); it != hdr.wvlenFactor.end(); ++it) {
+		CKP_PUT(it->wvlenFactorL1);
+		CKP_PUT(it->wvlenFactorL2);
+		CKP_PUTSTRS(it->satNums);
+	}
+	CKP_PUTSIZE(hdr.systems);
+	for (vector<GNSSsystem>::iterator it = hdr.systems.begin(); it != hdr.systems.end(); ++it) {
+		CKP_PUT(it->system);
+		CKP_PUT(it->selSystem);
+		CKP_PUTSIZE(it->obsTypes);
+		for (vector<OBSmeta>::iterator ito = it->obsTypes.begin(); ito != it->obsTypes.end(); ++ito) {
+			CKP_PUTSTR(ito->id);
+			CKP_PUT(ito->sel);
+			CKP_PUT(ito->prt);
+		}
+		CKP_PUTSIZE(it->selSat);
+		for (unsigned int i = 0; i < it->selSat.size(); i++) CKP_PUT(it->selSat[i]);
+		CKP_PUTSIZE(it->obsColumns);
+		for (unsigned int i = 0; i < it->obsColumns.size(); i++) CKP_PUT(it->obsColumns[i]);
+	}
+	CKP_PUTSTR(hdr.signalUnit);
+	CKP_PUT(hdr.obsInterval);
+	CKP_PUT(hdr.firstObsWeek);
+	CKP_PUT(hdr.firstObsTOW);
+	CKP_PUT(hdr.obsTimeSys);
+	CKP_PUT(hdr.lastObsWeek);
+	CKP_PUT(hdr.lastObsTOW);
+	CKP_PUT(hdr.rcvClkOffs);
+	for (int k = 0; k < 2; k++) {
+		vector<DCBSPCVSapp> &app = (k == 0)? hdr.dcbsApp : hdr.pcvsApp;
+		CKP_PUTSIZE(app);
+		for (vector<DCBSPCVSapp>::iterator it = app.begin(); it != app.end(); ++it) {
+			CKP_PUT(it->sysIndex);
+			CKP_PUTSTR(it->corrProg);
+			CKP_PUTSTR(it->corrSource);
+		}
+	}
+	CKP_PUTSIZE(hdr.obsScaleFact);
+	for (vector<OSCALEfact>::iterator it = hdr.obsScaleFact.begin(); it != hdr.obsScaleFact.end(); ++it) {
+		CKP_PUT(it->sysIndex);
+		CKP_PUT(it->factor);
+		CKP_PUTSTRS(it->obsType);
+	}
+	CKP_PUTSIZE(hdr.phshCorrection);
+	for (vector<PHSHcorr>::iterator it = hdr.phshCorrection.begin(); it != hdr.phshCorrection.end(); ++it) {
+		CKP_PUT(it->sysIndex);
+		CKP_PUTSTR(it->obsCode);
+		CKP_PUT(it->correction);
+		CKP_PUTSTRS(it->obsSats);
+	}
+	CKP_PUTSIZE(hdr.gloSltFrq);
+	for (vector<GLSLTfrq>::iterator it = hdr.gloSltFrq.begin(); it != hdr.gloSltFrq.end(); ++it) {
+		CKP_PUT(it->slot);
+		CKP_PUT(it->frqNum);
+	}
+	CKP_PUTSIZE(hdr.gloPhsBias);
+	for (vector<GLPHSbias>::iterator it = hdr.gloPhsBias.begin(); it != hdr.gloPhsBias.end(); ++it) {
+		CKP_PUTSTR(it->obsCode);
+		CKP_PUT(it->obsCodePhaseBias);
+	}
+	//"LEAP SECONDS", "# OF SATELLITES" and "PRN / # OF OBS"
+	CKP_PUTSIZE(hdr.leapSecs);
+	for (vector<LEAPsecs>::iterator it = hdr.leapSecs.begin(); it != hdr.leapSecs.end(); ++it) {
+		CKP_PUT(it->secs);
+		CKP_PUT(it->deltaLSF);
+		CKP_PUT(it->weekLSF);
+		CKP_PUT(it->dayLSF);
+		CKP_PUT(it->sysId);
+	}
+	CKP_PUT(hdr.leapSec);
+	CKP_PUT(hdr.leapDeltaLSF);
+	CKP_PUT(hdr.leapWeekLSF);
+	CKP_PUT(hdr.leapDN);
+	CKP_PUT(hdr.leapSysId);
+	CKP_PUT(hdr.numOfSat);
+	CKP_PUTSIZE(hdr.prnObsNum);
+	for (vector<PRNobsnum>::iterator it = hdr.prnObsNum.begin(); it != hdr.prnObsNum.end(); ++it) {
+		CKP_PUT(it->sysPrn);
+		CKP_PUT(it->satPrn);
+		CKP_PUTSIZE(it->obsNum);
+		for (unsigned int i = 0; i < it->obsNum.size(); i++) CKP_PUT(it->obsNum[i]);
+	}
+	//navigation records
+	CKP_PUTSIZE(hdr.corrections);
+	for (vector<CORRECTION>::iterator it = hdr.corrections.begin(); it != hdr.corrections.end(); ++it) {
+		anInt = it->corrType;
+		CKP_PUT(anInt);
+		CKP_PUT(it->corrValues);
+	}
+	//records having data, and comments
+	CKP_PUTSTR(labels);
+	CKP_PUTSIZE(hdr.hdComments);
+	for (vector<HDcomment>::iterator it = hdr.hdComments.begin(); it != hdr.hdComments.end(); ++it) {
+		CKP_PUT(it->pos);
+		CKP_PUTSTR(it->text);
+	}
+	//epoch state and position of time records in the output file
+	CKP_PUT(epochWeek);
+	CKP_PUT(epochTOW);
+	CKP_PUT(epochClkOffset);
+	CKP_PUT(epochFlag);
+	CKP_PUT(epochTimeTag);
+	CKP_PUT(hdTofoOffset);
+	CKP_PUT(hdToloOffset);
+	return ok;
+	#undef CKP_PUT
+	#undef CKP_PUTSTR
+	#undef CKP_PUTSTRS
+	#undef CKP_PUTSIZE
+}
+
+/**restoreCheckpoint reads from a binary file a checkpoint written using saveCheckpoint, and sets its data as the current
+ * header data, epoch state and position of the time records in the output file. Epoch observation data are cleared.
+ * <p>Data are set only if the whole checkpoint has been read without errors. Otherwise the object is not modified.
+ *
+ * @param in the binary file, already open, where the checkpoint is read
+ * @return true if the checkpoint has been restored, false otherwise
+ */
+bool RinexData::restoreCheckpoint(FILE* in) {
+///macros to read checkpoint data items, strings and vectors of strings, and the size of a vector, checking it is not too big.
+///ok becomes false on error
+	#define CKP_GET(VALUE) ok = ok && (fread(&(VALUE), sizeof(VALUE), 1, in) == 1)
+	#define CKP_GETSTR(VALUE) ok = ok && readBinString(in, VALUE)
+	#define CKP_GETSTRS(VALUE) ok = ok && readBinStrings(in, VALUE)
+	#define CKP_GETSIZE(VALUE) CKP_GET(VALUE); ok = ok && (VALUE <= RINEX_CKP_MAXITEMS)
+
+	char tag[sizeof RINEX_CKP_TAG];
+	bool ok = (fread(tag, sizeof tag, 1, in) == 1) && (memcmp(tag, RINEX_CKP_TAG, sizeof tag) == 0);
+	unsigned int layout[RINEX_CKP_LAYOUTSIZE], ckpLayout[RINEX_CKP_LAYOUTSIZE];
+	getCkpLayout(layout);
+	CKP_GET(ckpLayout);
+	ok = ok && (memcmp(layout, ckpLayout, sizeof layout) == 0);
+	unsigned int n, m;
+	int anInt;
+	string labels;
+	HDRdata ckp;			//header data are read here, and then copied
+	int week = 0, flag = 0;	//epoch state and position of time records are read here, and then copied
+	double tow = 0.0, clkOffset = 0.0, timeTag = 0.0;
+	long tofoOffset = -1, toloOffset = -1;
+	//"RINEX VERSION / TYPE" and "PGM / RUN BY / DATE"
+	CKP_GET(anInt);
+	ckp.inFileVer = (RINEXversion) anInt;
+	CKP_GET(anInt);
+	ckp.version = (RINEXversion) anInt;
+	CKP_GET(ckp.fileType);
+	CKP_GETSTR(ckp.fileTypeSfx);
+	CKP_GET(ckp.sysToPrintId);
+	CKP_GETSTR(ckp.systemIdSfx);
+	CKP_GETSTR(ckp.pgm);
+	CKP_GETSTR(ckp.runby);
+	CKP_GETSTR(ckp.date);
+	//marker, observer, receiver and antenna records
+	CKP_GETSTR(ckp.markerName);
+	CKP_GETSTR(ckp.markerNumber);
+	CKP_GETSTR(ckp.markerType);
+	CKP_GETSTR(ckp.observer);
+	CKP_GETSTR(ckp.agency);
+	CKP_GETSTR(ckp.rxNumber);
+	CKP_GETSTR(ckp.rxType);
+	CKP_GETSTR(ckp.rxVersion);
+	CKP_GETSTR(ckp.antNumber);
+	CKP_GETSTR(ckp.antType);
+	double coords[22];
+	CKP_GET(coords);
+	double* coordMembers[] = {&ckp.aproxX, &ckp.aproxY, &ckp.aproxZ, &ckp.antHigh, &ckp.eccEast, &ckp.eccNorth,
+		&ckp.antX, &ckp.antY, &ckp.antZ, &ckp.antPhNoX, &ckp.antPhEoY, &ckp.antPhUoZ, &ckp.antBoreX, &ckp.antBoreY,
+		&ckp.antBoreZ, &ckp.antZdAzi, &ckp.antZdX, &ckp.antZdY, &ckp.antZdZ, &ckp.centerX, &ckp.centerY, &ckp.centerZ};
+	for (int i = 0; i < 22; i++) *coordMembers[i] = coords[i];
+	CKP_GET(ckp.antPhSys);
+	CKP_GETSTR(ckp.antPhCode);
+	//observation records
+	vector<string> aVectorStr;
+	int i1, i2;
+	CKP_GETSIZE(n);
+	ckp.wvlenFactor.clear();
+	for (unsigned int i = 0; ok && (i < n); i++) {
+		CKP_GET(i1);
+		CKP_GET(i2);
+		CKP_GETSTRS(aVectorStr);
+		ckp.wvlenFactor.push_back(WVLNfactor(i1, i2, aVectorStr));
+	}
+	CKP_GETSIZE(n);
+	for (unsigned int i = 0; ok && (i < n); i++) {
+		char sys = ' ';
+		CKP_GET(sys);
+		GNSSsystem system(sys, vector<string>());
+		system.obsTypes.clear();
+		CKP_GET(system.selSystem);
+		CKP_GETSIZE(m);
+		for (unsigned int j = 0; ok && (j < m); j++) {
+			OBSmeta obs(string(), false, false);
+			CKP_GETSTR(obs.id);
+			CKP_GET(obs.sel);
+			CKP_GET(obs.prt);
+			system.obsTypes.push_back(obs);
+		}
+		CKP_GETSIZE(m);
+		for (unsigned int j = 0; ok && (j < m); j++) {
+			CKP_GET(i1);
+			system.selSat.push_back(i1);
+		}
+		CKP_GETSIZE(m);
+		for (unsigned int j = 0; ok && (j < m); j++) {
+			unsigned int column = 0;
+			CKP_GET(column);
+			ok = ok && (column < system.obsTypes.size());
+			system.obsColumns.push_back(column);
+		}
+		ckp.systems.push_back(system);
+	}
+	CKP_GETSTR(ckp.signalUnit);
+	CKP_GET(ckp.obsInterval);
+	CKP_GET(ckp.firstObsWeek);
+	CKP_GET(ckp.firstObsTOW);
+	CKP_GET(ckp.obsTimeSys);
+	CKP_GET(ckp.lastObsWeek);
+	CKP_GET(ckp.lastObsTOW);
+	CKP_GET(ckp.rcvClkOffs);
+	for (int k = 0; k < 2; k++) {
+		vector<DCBSPCVSapp> &app = (k == 0)? ckp.dcbsApp : ckp.pcvsApp;
+		CKP_GETSIZE(n);
+		for (unsigned int i = 0; ok && (i < n); i++) {
+			DCBSPCVSapp item;
+			CKP_GET(item.sysIndex);
+			CKP_GETSTR(item.corrProg);
+			CKP_GETSTR(item.corrSource);
+			app.push_back(item);
+		}
+	}
+	CKP_GETSIZE(n);
+	for (unsigned int i = 0; ok && (i < n); i++) {
+		CKP_GET(i1);
+		CKP_GET(i2);
+		CKP_GETSTRS(aVectorStr);
+		ckp.obsScaleFact.push_back(OSCALEfact(i1, i2, aVectorStr));
+	}
+	CKP_GETSIZE(n);
+	for (unsigned int i = 0; ok && (i < n); i++) {
+		string code;
+		double correction = 0.0;
+		CKP_GET(i1);
+		CKP_GETSTR(code);
+		CKP_GET(correction);
+		CKP_GETSTRS(aVectorStr);
+		ckp.phshCorrection.push_back(PHSHcorr(i1, code, correction, aVectorStr));
+	}
+	CKP_GETSIZE(n);
+	for (unsigned int i = 0; ok && (i < n); i++) {
+		CKP_GET(i1);
+		CKP_GET(i2);
+		ckp.gloSltFrq.push_back(GLSLTfrq(i1, i2));
+	}
+	CKP_GETSIZE(n);
+	for (unsigned int i = 0; ok && (i < n); i++) {
+		string code;
+		double bias = 0.0;
+		CKP_GETSTR(code);
+		CKP_GET(bias);
+		ckp.gloPhsBias.push_back(GLPHSbias(code, bias));
+	}
+	//"LEAP SECONDS", "# OF SATELLITES" and "PRN / # OF OBS"
+	CKP_GETSIZE(n);
+	ckp.leapSecs.clear();
+	for (unsigned int i = 0; ok && (i < n); i++) {
+		LEAPsecs leap(0, 0, 0, 0, ' ');
+		CKP_GET(leap.secs);
+		CKP_GET(leap.deltaLSF);
+		CKP_GET(leap.weekLSF);
+		CKP_GET(leap.dayLSF);
+		CKP_GET(leap.sysId);
+		ckp.leapSecs.push_back(leap);
+	}
+	CKP_GET(ckp.leapSec);
+	CKP_GET(ckp.leapDeltaLSF);
+	CKP_GET(ckp.leapWeekLSF);
+	CKP_GET(ckp.leapDN);
+	CKP_GET(ckp.leapSysId);
+	CKP_GET(ckp.numOfSat);
+	CKP_GETSIZE(n);
+	for (unsigned int i = 0; ok && (i < n); i++) {
+		PRNobsnum prn;
+		CKP_GET(prn.sysPrn);
+		CKP_GET(prn.satPrn);
+		CKP_GETSIZE(m);
+		for (unsigned int j = 0; ok && (j < m); j++) {
+			CKP_GET(i1);
+			prn.obsNum.push_back(i1);
+		}
+		ckp.prnObsNum.push_back(prn);
+	}
+	//navigation records
+	CKP_GETSIZE(n);
+	for (unsigned int i = 0; ok && (i < n); i++) {
+		CORRECTION corr;
+		CKP_GET(anInt);
+		corr.corrType = (RINEXlabel) anInt;
+		CKP_GET(corr.corrValues);
+		ckp.corrections.push_back(corr);
+	}
+	//records having data, and comments
+	CKP_GETSTR(labels);
+	ok = ok && (labels.size() == ckp.labelHasData.size()) && (labels.find_first_not_of("01") == string::npos);
+	if (ok) ckp.labelHasData = bitset<LASTONE + 1>(labels);
+	CKP_GETSIZE(n);
+	for (unsigned int i = 0; ok && (i < n); i++) {
+		HDcomment comment(0, string());
+		CKP_GET(comment.pos);
+		CKP_GETSTR(comment.text);
+		ckp.hdComments.push_back(comment);
+	}
+	//epoch state and position of time records in the output file
+	CKP_GET(week);
+	CKP_GET(tow);
+	CKP_GET(clkOffset);
+	CKP_GET(flag);
+	CKP_GET(timeTag);
+	CKP_GET(tofoOffset);
+	CKP_GET(toloOffset);
+	if (!ok) return false;
+	hdr = ckp;
+	setPrintPlan();
+	epochWeek = week;
+	epochTOW = tow;
+	epochClkOffset = clkOffset;
+	epochFlag = flag;
+	epochTimeTag = timeTag;
+	hdTofoOffset = tofoOffset;
+	hdToloOffset = toloOffset;
+	epochObs.clear();
+	return true;
+	#undef CKP_GET
+	#undef CKP_GETSTR
+	#undef CKP_GETSTRS
+	#undef CKP_GETSIZE
+}
+
+/**updateObsTimes updates the TIME OF FIRST OBS and TIME OF LAST OBS records in the header of an observation file already printed,
+ * using their current data. Records are updated in the positions they have in the last header printed (or restored from a
+ * checkpoint). After updating, the file is positioned at its end.
+ * <p>It is useful when epochs are appended to an existing file, f.e. when resuming a conversion.
+ *
+ * @param out the output file, open for update, where the header was printed
+ * @return true if records have been updated, false if their positions are unknown or they cannot be updated
+ */
+bool RinexData::updateObsTimes(FILE* out) {
+	bool updated = false;
+	if ((hdTofoOffset >= 0) && getLabelFlag(TOFO) && (fseek(out, hdTofoOffset, SEEK_SET) == 0)) {
+		printHdLineData(out, TOFO);
+		updated = true;
+	}
+	if ((hdToloOffset >= 0) && getLabelFlag(TOLO) && (fseek(out, hdToloOffset, SEEK_SET) == 0)) {
+		printHdLineData(out, TOLO);
+		updated = true;
+	}
+	fseek(out, 0, SEEK_END);
+	return updated;
+}
+
 //Class private methods
 //=====================
+/**getCkpLayout gives the layout of checkpoint data: the format version and the sizes of data types written as they are stored
+ * in memory. A checkpoint can be restored only if its layout is the current one.
+ *
+ * @param layout the array where the layout is given
+ */
+void RinexData::getCkpLayout(unsigned int (&layout)[RINEX_CKP_LAYOUTSIZE]) {
+	unsigned int items[RINEX_CKP_LAYOUTSIZE] = {RINEX_CKP_VERSION, sizeof(int), sizeof(unsigned int), sizeof(long), sizeof(double),
+		sizeof(bool)};
+	memcpy(layout, items, sizeof items);
+}
+
 /**setDefValues sets default values to optional RINEX data members, generation parameters, and
  * GPS navigation data constans (like scale factors and data).
  *
@@ -2389,16 +3799,25 @@ void RinexData::setDefValues(RINEXversion v, Logger *p) {
 	plog = p;
 	//Header data
 	//"RINEX VERSION / TYPE"
-	version = v;
-	inFileVer = VTBD;
-	fileType = sysToPrintId = '?';
+	hdr.version = v;
+	hdr.inFileVer = VTBD;
+	hdr.fileType = hdr.sysToPrintId = '?';
 	//Epoch time data
 	epochWeek = 0;
 	epochTOW = epochTimeTag = epochClkOffset = 0.0;
 	epochFlag = 0;
+	//Epoch index data
+	obsIndexFileSize = -1;
+	obsIndexFileTime = -1;
+	obsSink = NULL;
+	//Split data
+	splitWindow = 0.0;
+	splitMaxOpen = 2;
+	splitLast = -1;
+	hdTofoOffset = hdToloOffset = -1;
 	//LEAP SECONDS
 	//1st element in vector allways GPS, and default values set to 18 secs as per 2019
-    leapSecs.push_back(LEAPsecs(18,0,0,0,'G'));
+    hdr.leapSecs.push_back(LEAPsecs(18,0,0,0,'G'));
     //a table of system related descriptions (system identification, time description, system description, ...)
 	sysDescript.push_back(SYSdescript('G', "GPS", ": GPS"));
 	sysDescript.push_back(SYSdescript('M', "GPS", ": Mixed"));
@@ -2409,75 +3828,11 @@ void RinexData::setDefValues(RINEXversion v, Logger *p) {
 	sysDescript.push_back(SYSdescript('I', "IRN", ": IRNSS"));
 	sysDescript.push_back(SYSdescript('S', "GPS", ": SBAS payload"));
     sysDescript.push_back(SYSdescript(' ', "GPS", ": GPS"));
-	//fill vector with label definitions. Order is relevant.
-	labelDef.push_back(LABELdata(VERSION,	"RINEX VERSION / TYPE",	VALL, OBSOBL + NAVOBL));
-	labelDef.push_back(LABELdata(RUNBY,		"PGM / RUN BY / DATE",	VALL, OBSOBL + NAVOBL));
-	labelDef.push_back(LABELdata(COMM,		"COMMENT",				VALL, OBSOPT + NAVOPT));
-	labelDef.push_back(LABELdata(MRKNAME,	"MARKER NAME",			VALL, OBSOBL + NAVNAP));
-	labelDef.push_back(LABELdata(MRKNUMBER,	"MARKER NUMBER",		VALL, OBSOPT + NAVNAP));
-	labelDef.push_back(LABELdata(MRKTYPE,	"MARKER TYPE",			V304, OBSOBL + NAVNAP));
-	labelDef.push_back(LABELdata(AGENCY,	"OBSERVER / AGENCY",	VALL, OBSOBL + NAVNAP));
-	labelDef.push_back(LABELdata(RECEIVER,	"REC # / TYPE / VERS",	VALL, OBSOBL + NAVNAP));
-	labelDef.push_back(LABELdata(ANTTYPE,	"ANT # / TYPE",			VALL, OBSOBL + NAVNAP));
-	labelDef.push_back(LABELdata(APPXYZ,	"APPROX POSITION XYZ",	VALL, OBSOBL + NAVNAP));
-	labelDef.push_back(LABELdata(ANTHEN,	"ANTENNA: DELTA H/E/N",	VALL, OBSOBL + NAVNAP));
-	labelDef.push_back(LABELdata(ANTXYZ,	"ANTENNA: DELTA X/Y/Z",	V304, OBSOPT + NAVNAP));
-	labelDef.push_back(LABELdata(ANTPHC,	"ANTENNA: PHASECENTER",	V304, OBSOPT + NAVNAP));
-	labelDef.push_back(LABELdata(ANTBS,		"ANTENNA: B.SIGHT XYZ",	V304, OBSOPT + NAVNAP));
-	labelDef.push_back(LABELdata(ANTZDAZI,	"ANTENNA: ZERODIR AZI",	V304, OBSOPT + NAVNAP));
-	labelDef.push_back(LABELdata(ANTZDXYZ,	"ANTENNA: ZERODIR XYZ",	V304, OBSOPT + NAVNAP));
-	labelDef.push_back(LABELdata(COFM,		"CENTER OF MASS XYZ",	V304, OBSOPT + NAVNAP));
-	labelDef.push_back(LABELdata(WVLEN,		"WAVELENGTH FACT L1/2",	V210, OBSOBL + NAVNAP));
-	labelDef.push_back(LABELdata(TOBS,		"# / TYPES OF OBSERV",	V210, OBSOBL + NAVNAP));
-	labelDef.push_back(LABELdata(SYS,		"SYS / # / OBS TYPES",	V304, OBSOBL + NAVNAP));
-	labelDef.push_back(LABELdata(SIGU,		"SIGNAL STRENGTH UNIT",	V304, OBSOPT + NAVNAP));
-	labelDef.push_back(LABELdata(INT,		"INTERVAL",				VALL, OBSOPT + NAVNAP));
-	labelDef.push_back(LABELdata(TOFO,		"TIME OF FIRST OBS",	VALL, OBSOBL + NAVNAP));
-	labelDef.push_back(LABELdata(TOLO,		"TIME OF LAST OBS",		VALL, OBSOPT + NAVNAP));
-	labelDef.push_back(LABELdata(CLKOFFS,	"RCV CLOCK OFFS APPL",	VALL, OBSOPT + NAVNAP));
-	labelDef.push_back(LABELdata(DCBS,		"SYS / DCBS APPLIED",	V304, OBSOPT + NAVNAP));
-	labelDef.push_back(LABELdata(PCVS,		"SYS / PCVS APPLIED",	V304, OBSOPT + NAVNAP));
-	labelDef.push_back(LABELdata(SCALE,		"SYS / SCALE FACTOR",	V304, OBSOPT + NAVNAP));
-	labelDef.push_back(LABELdata(PHSH,		"SYS / PHASE SHIFTS",	V304, OBSOBL + NAVNAP));
-	labelDef.push_back(LABELdata(GLSLT,		"GLONASS SLOT / FRQ #",	V304, OBSOBL + NAVNAP));
-    labelDef.push_back(LABELdata(GLPHS,     "GLONASS COD/PHS/BIS",  V304, OBSOBL + NAVNAP));
-	labelDef.push_back(LABELdata(SATS,		"# OF SATELLITES",		VALL, OBSOPT + NAVNAP));
-	labelDef.push_back(LABELdata(PRNOBS,	"PRN / # OF OBS",		VALL, OBSOPT + NAVNAP));
-	labelDef.push_back(LABELdata(IONA,		"ION ALPHA",			V210, OBSNAP + NAVOPT));
-	labelDef.push_back(LABELdata(IONB,		"ION BETA",				V210, OBSNAP + NAVOPT));
-	labelDef.push_back(LABELdata(IONC,		"IONOSPHERIC CORR",		V304, OBSNAP + NAVOPT));
-	labelDef.push_back(LABELdata(DUTC,		"DELTA-UTC: A0,A1,T,W",	V210, OBSNAP + NAVOPT));
-	labelDef.push_back(LABELdata(CORRT,		"CORR TO SYSTEM TIME",	V210, OBSNAP + NAVOPT));
-	labelDef.push_back(LABELdata(GEOT,		"D-UTC A0,A1,T,W,S,U",	V210, OBSNAP + NAVOPT));
-	labelDef.push_back(LABELdata(TIMC,		"TIME SYSTEM CORR",		V304, OBSNAP + NAVOPT));
-	labelDef.push_back(LABELdata(LEAP,		"LEAP SECONDS",			VALL, OBSOPT + NAVOPT));
-	labelDef.push_back(LABELdata(EOH,		"END OF HEADER",		VALL, OBSOBL + NAVOBL));
-
-	labelDef.push_back(LABELdata(IONC_GAL,   "GAL ",	VALL, NAP));
-	labelDef.push_back(LABELdata(IONC_GPSA,  "GPSA",	VALL, NAP));
-	labelDef.push_back(LABELdata(IONC_GPSB,  "GPSB",	VALL, NAP));
-	labelDef.push_back(LABELdata(IONC_QZSA,  "QZSA",	VALL, NAP));
-	labelDef.push_back(LABELdata(IONC_QZSB,  "QZSB",	VALL, NAP));
-	labelDef.push_back(LABELdata(IONC_BDSA,  "BDSA",	VALL, NAP));
-	labelDef.push_back(LABELdata(IONC_BDSB,  "BDSB",	VALL, NAP));
-	labelDef.push_back(LABELdata(IONC_IRNA,  "IRNA",	VALL, NAP));
-	labelDef.push_back(LABELdata(IONC_IRNB,  "IRNB",	VALL, NAP));
-	labelDef.push_back(LABELdata(TIMC_GPUT,  "GPUT",	VALL, NAP));
-	labelDef.push_back(LABELdata(TIMC_GLUT,  "GLUT",	VALL, NAP));
-	labelDef.push_back(LABELdata(TIMC_GAUT,  "GAUT",	VALL, NAP));
-	labelDef.push_back(LABELdata(TIMC_BDUT,  "BDUT",	VALL, NAP));
-	labelDef.push_back(LABELdata(TIMC_BDGP,  "BDGP",	VALL, NAP));
-	labelDef.push_back(LABELdata(TIMC_QZUT,  "QZUT",	VALL, NAP));
-	labelDef.push_back(LABELdata(TIMC_IRUT,  "IRUT",	VALL, NAP));
-	labelDef.push_back(LABELdata(TIMC_SBUT,  "SBUT",	VALL, NAP));
-	labelDef.push_back(LABELdata(TIMC_GLGP,  "GLGP",	VALL, NAP));
-	labelDef.push_back(LABELdata(TIMC_GAGP,  "GAGP",	VALL, NAP));
-	labelDef.push_back(LABELdata(TIMC_QZGP,  "QZGP",	VALL, NAP));
-	labelDef.push_back(LABELdata(TIMC_IRGP,  "IRGP",	VALL, NAP));
-
-	labelDef.push_back(LABELdata(NOLABEL,	"No label detected",	VALL, NAP));
-	labelDef.push_back(LABELdata(DONTMATCH,	"Incorrect label for this RINEX version", VALL, NAP));
-	labelDef.push_back(LABELdata(LASTONE,	"Last item",	VALL, NAP));
+	//header records have not data
+	hdr.labelHasData.reset();
+	hdr.hdComments.clear();
+	lastRecordSet = NOLABEL;
+	commentIdx = 0;
 	labelIdIdx = 0;
     for (numberV2ObsTypes = 0; !v3obsTypes[numberV2ObsTypes].empty(); numberV2ObsTypes++);
 }
@@ -2498,47 +3853,47 @@ void RinexData::setDefValues(RINEXversion v, Logger *p) {
 void RinexData::setFileDataType(char ftype, bool setCOMMs) {
     //identify the first system selected, and count the number of selected ones
     char firstSys = 0;
-    for (vector<GNSSsystem>::iterator it = systems.begin(); it != systems.end(); it++) {
+    for (vector<GNSSsystem>::iterator it = hdr.systems.begin(); it != hdr.systems.end(); it++) {
         if (it->selSystem)  {
             firstSys = it->system;
             break;
         }
     }
     int n = 0;
-    for (vector<GNSSsystem>::iterator it = systems.begin(); it != systems.end(); it++) {
+    for (vector<GNSSsystem>::iterator it = hdr.systems.begin(); it != hdr.systems.end(); it++) {
         if (it->selSystem) n++;
     }
     if (n == 0) throw msgNotSys;        //at least one system shall be selected
     //set default value for sysToPrintId
-    if (n > 1) sysToPrintId = 'M';
-    else sysToPrintId = firstSys;
+    if (n > 1) hdr.sysToPrintId = 'M';
+    else hdr.sysToPrintId = firstSys;
     //set values according RINEX file version to be printed
     switch (ftype) {
         case 'O':
         case 'o':
-            fileType = 'O';
+            hdr.fileType = 'O';
             break;
         case 'N':
         case 'n':
-            fileType = 'N';
-            switch (version) {    //version to print
+            hdr.fileType = 'N';
+            switch (hdr.version) {    //version to print
                 case V210:
                     switch (firstSys) {
                         case 'G':    //GPS nav
-                            sysToPrintId = fileType = 'N';
+                            hdr.sysToPrintId = hdr.fileType = 'N';
                             break;
                         case 'R':    //GLONASS nav
-                            sysToPrintId = fileType = 'G';
+                            hdr.sysToPrintId = hdr.fileType = 'G';
                             break;
                         case 'E':    //Galileo nav. Un-official version
-                            sysToPrintId = fileType = 'L';
+                            hdr.sysToPrintId = hdr.fileType = 'L';
                             if (setCOMMs) {
 								setHdLnData(COMM, COMM, "This un-official version formats b.o. data as per V3.04");
 								setHdLnData(COMM, COMM, "V2.10 does not define nav. data format for Galileo");
                             }
                             break;
                         case 'S':    //SBAS nav
-                            sysToPrintId = fileType = 'B';
+                            hdr.sysToPrintId = hdr.fileType = 'B';
                             break;
                         default:
                             throw "Cannot generate navigation V2.10 file for system " + string(1, firstSys);
@@ -2575,7 +3930,7 @@ string RinexData::fmtRINEXv2name(string designator, int week, double tow) {
     sprintf(buffer, "%4.4s%s%c",
             (designator + "----").c_str(),
             yday2year,
-            fileType
+            hdr.fileType
     );
 	return string(buffer);
 }
@@ -2597,8 +3952,8 @@ string RinexData::fmtRINEXv3name(string designator, int week, double tow, string
 	//set value for field <SITE/STATION/MONUMENT/RECEIVER/COUNTRY/> (XXXXMRCCC) if not given
 	if (designator.length() != 9) {
 		strcpy(buffer, ((designator + "------").substr(0, 6) + (country + "---").substr(0, 3)).c_str());	//set  buffer to XXXX--CCC
-		if (getLabelFlag(MRKNUMBER)) buffer[4] = getFirstDigit(markerNumber, '-');
-		if (getLabelFlag(RECEIVER)) buffer[5] = getFirstDigit(rxNumber, '-');
+		if (getLabelFlag(MRKNUMBER)) buffer[4] = getFirstDigit(hdr.markerNumber, '-');
+		if (getLabelFlag(RECEIVER)) buffer[5] = getFirstDigit(hdr.rxNumber, '-');
 		designator = string(buffer);
 	}
 	//set value for field <START TIME>
@@ -2608,8 +3963,8 @@ string RinexData::fmtRINEXv3name(string designator, int week, double tow, string
 	char periodUnit = 'U';
 	double periodStart, periodEnd;
 	if (getLabelFlag(TOFO) && getLabelFlag(TOLO)) {
-		periodStart = getInstantGNSStime (firstObsWeek, firstObsTOW);
-		periodEnd = getInstantGNSStime (lastObsWeek, lastObsTOW);
+		periodStart = getInstantGNSStime (hdr.firstObsWeek, hdr.firstObsTOW);
+		periodEnd = getInstantGNSStime (hdr.lastObsWeek, hdr.lastObsTOW);
 		if (periodEnd > periodStart) period = (int) ((periodEnd - periodStart) / 60);
 	}
 	if (period >= 365*24*60) {
@@ -2631,20 +3986,20 @@ string RinexData::fmtRINEXv3name(string designator, int week, double tow, string
 	int frequency = 0;
 	char frequencyUnit = 'U';
 	if (getLabelFlag(INT)) {
-		if ((obsInterval < 1) && (obsInterval > 0)) {
-			frequency = (int) (1.0 / obsInterval);
+		if ((hdr.obsInterval < 1) && (hdr.obsInterval > 0)) {
+			frequency = (int) (1.0 / hdr.obsInterval);
 			frequencyUnit = 'Z';
-		} else if (obsInterval < 60) {
-			frequency = (int) obsInterval;
+		} else if (hdr.obsInterval < 60) {
+			frequency = (int) hdr.obsInterval;
 			frequencyUnit = 'S';
-		} else if (obsInterval < 60*60) {
-			frequency = (int) (obsInterval / 60);
+		} else if (hdr.obsInterval < 60*60) {
+			frequency = (int) (hdr.obsInterval / 60);
 			frequencyUnit = 'M';
-		} else if (obsInterval < 60*60*24) {
-			frequency = (int) (obsInterval / 60 / 60);
+		} else if (hdr.obsInterval < 60*60*24) {
+			frequency = (int) (hdr.obsInterval / 60 / 60);
 			frequencyUnit = 'H';
 		} else {
-			frequency = (int) (obsInterval / 60 / 60 / 24);
+			frequency = (int) (hdr.obsInterval / 60 / 60 / 24);
 			frequencyUnit = 'D';
 		}
 	}
@@ -2656,8 +4011,8 @@ string RinexData::fmtRINEXv3name(string designator, int week, double tow, string
 			periodUnit,
 			frequency,
 			frequencyUnit,
-			sysToPrintId,
-			fileType);
+			hdr.sysToPrintId,
+			hdr.fileType);
 	return string(buffer);
 }
 
@@ -2668,13 +4023,9 @@ string RinexData::fmtRINEXv3name(string designator, int week, double tow, string
  * @param flagVal is the value to set (by default true)
  */
 void RinexData::setLabelFlag(RINEXlabel label, bool flagVal) {
-	lastRecordSet = labelDef.end();
-	for (vector<LABELdata>::iterator it = labelDef.begin() ; it != labelDef.end(); ++it)
-		if(it->labelID == label) {
-			it->hasData = flagVal;
-			lastRecordSet = it;
-			return;
-		}
+	if ((label < NOLABEL) || (label > LASTONE)) return;
+	hdr.labelHasData[label] = flagVal;
+	lastRecordSet = label;
 }
 
 /**sgetLabelFlag gets the hasData flag value of the given label
@@ -2683,9 +4034,8 @@ void RinexData::setLabelFlag(RINEXlabel label, bool flagVal) {
  * @return the value stored in the hasData flag for this labelId, or false if the label does not exist
  */
 bool RinexData::getLabelFlag(RINEXlabel label) {
-	for (vector<LABELdata>::iterator it = labelDef.begin() ; it != labelDef.end(); ++it)
-		if(it->labelID == label) return it->hasData;
-	return false;
+	if ((label < NOLABEL) || (label > LASTONE)) return false;
+	return hdr.labelHasData[label];
 }
 
 /**checkLabel checks if the RINEX line passed ends with a correct RINEX header label for the input file version
@@ -2696,14 +4046,13 @@ bool RinexData::getLabelFlag(RINEXlabel label) {
  */
 RinexData::RINEXlabel RinexData::checkLabel(char *line) {
 	//label shall be in columns 61 to 80 (index 60 to 79)
-	if (strlen(line) < 61) return NOLABEL;
-	char *label = &line[60];
-	for (vector<LABELdata>::iterator it = labelDef.begin() ; it != labelDef.end(); ++it)
-		if (strncmp(label, it->labelVal, strlen(it->labelVal)) == 0) {
-			if ((it->ver == VALL) || (it->ver == inFileVer)) return it->labelID;
-			else return DONTMATCH;
-		}
-	return NOLABEL;
+	size_t len = strlen(line);
+	if (len < 61) return NOLABEL;
+	len -= 60;
+	if (len > 20) len = 20;
+	RINEXlabel id = labelIndex().find(&line[60], len);
+	if ((id == NOLABEL) || (labelDef[id].ver == VALL) || (labelDef[id].ver == hdr.inFileVer)) return id;
+	return DONTMATCH;
 }
 
 /**findLabelId finds for the label passed the corresponding identifier
@@ -2712,9 +4061,11 @@ RinexData::RINEXlabel RinexData::checkLabel(char *line) {
  * @return the RINEX label identification, NOLABEL has not a valid RINEX lable,
  */
 RinexData::RINEXlabel RinexData::findLabelId(char *label) {
-	for (vector<LABELdata>::iterator it = labelDef.begin() ; it != labelDef.end(); ++it)
-		if (strncmp(label, it->labelVal, strlen(it->labelVal)) == 0) return it->labelID;
-	return NOLABEL;
+	size_t len = strnlen(label, 20);
+	RINEXlabel id = labelIndex().find(label, len);
+	//correction type identifiers have 4 chars and are followed by data
+	if ((id == NOLABEL) && (len > 4)) id = labelIndex().find(label, 4);
+	return id;
 }
 
 /**valueLabel gives the sting value for the RINEXlabel passed
@@ -2724,12 +4075,82 @@ RinexData::RINEXlabel RinexData::findLabelId(char *label) {
  */
 string RinexData::valueLabel(RINEXlabel labelId, string toAppend) {
     const string msgErrUnkLabel("Unknown label identifier");
-	for (vector<LABELdata>::iterator it = labelDef.begin() ; it != labelDef.end(); ++it)
-		if(it->labelID == labelId) {
-			if (toAppend.empty()) return string(it->labelVal);
-			else return string(it->labelVal) + msgColon + toAppend;
+	if ((labelId < NOLABEL) || (labelId > LASTONE) || (labelDef[labelId].labelVal == NULL)) return msgErrUnkLabel;
+	if (toAppend.empty()) return string(labelDef[labelId].labelVal);
+	else return string(labelDef[labelId].labelVal) + msgColon + toAppend;
+}
+
+/**insertComment inserts a comment record in the header just before the record with the given label.
+ * If there are other comments before this record, the new one is placed after them.
+ *
+ * @param pos the label identifier of the record before which the comment is placed
+ * @param comment the comment to insert
+ */
+void RinexData::insertComment(unsigned int pos, const string &comment) {
+	if (pos > LASTONE) pos = LASTONE;
+	vector<HDcomment>::iterator it = hdr.hdComments.begin();
+	while ((it != hdr.hdComments.end()) && (it->pos <= pos)) ++it;
+	hdr.hdComments.insert(it, HDcomment(pos, comment));
+}
+
+/**labelIndex gives the index used to identify labels by their value.
+ * It is built on first use and shared by all RinexData objects.
+ *
+ * @return the label index
+ */
+const RinexData::LABELindex& RinexData::labelIndex() {
+	static const LABELindex index;
+	return index;
+}
+
+/**Constructs the label index finding a seed for the hash function which places each label value in a different slot.
+ */
+RinexData::LABELindex::LABELindex() {
+	memset(length, 0, sizeof length);
+	for (unsigned int i = VERSION; i < INFILEVER; i++) {
+		size_t len = strlen(labelDef[i].labelVal);
+		while ((len > 0) && (labelDef[i].labelVal[len - 1] == ' ')) len--;
+		length[i] = (unsigned char) len;
+	}
+	bool collision;
+	seed = 0;
+	do {
+		memset(slot, NOLABEL, sizeof slot);
+		collision = false;
+		for (unsigned int i = VERSION; (i < INFILEVER) && !collision; i++) {
+			unsigned int h = hash(labelDef[i].labelVal, length[i], seed);
+			if (slot[h] != NOLABEL) {
+				collision = true;
+				seed++;
+			} else slot[h] = (unsigned char) i;
 		}
-	return msgErrUnkLabel;
+	} while (collision);
+}
+
+/**hash computes the slot in the label index for the given label value.
+ *
+ * @param label the label value
+ * @param len the number of chars in the label value
+ * @param seed the seed for the hash function
+ * @return the slot for this label value
+ */
+unsigned int RinexData::LABELindex::hash(const char* label, size_t len, unsigned int seed) {
+	unsigned int h = 2166136261u ^ seed;
+	for (size_t i = 0; i < len; i++) h = (h ^ (unsigned char) label[i]) * 16777619u;
+	return (h ^ (h >> 16)) & (SIZE - 1);
+}
+
+/**find gives the label identifier for the given label value. Trailing blanks and end of line chars are not taken into account.
+ *
+ * @param label the label value
+ * @param len the number of chars in the label value
+ * @return the label identifier, or NOLABEL if there is not a label with this value
+ */
+RinexData::RINEXlabel RinexData::LABELindex::find(const char* label, size_t len) const {
+	while ((len > 0) && ((unsigned char) label[len - 1] <= ' ')) len--;
+	unsigned int id = slot[hash(label, len, seed)];
+	if ((id != NOLABEL) && (length[id] == len) && (memcmp(labelDef[id].labelVal, label, len) == 0)) return (RINEXlabel) id;
+	return NOLABEL;
 }
 
 /**readV2ObsEpoch reads from the RINEX version 2.1 observation file data lines of an epoch.
@@ -2760,6 +4181,8 @@ int RinexData::readV2ObsEpoch(FILE* input) {
 	double valObs;
 	int lliObs, strgObs;
 	int i, j, k;
+	unsigned int obsIdx;
+	bool satSelected;
 
 	//read epoch 1st line and extract data
 	if (readRinexRecord(lineBuffer, sizeof lineBuffer, input)) return 0;
@@ -2825,29 +4248,37 @@ int RinexData::readV2ObsEpoch(FILE* input) {
 			return 4;
 		}
 		//read the observation records for each satellite in the epoch
+		addEpochToSink();
 		for (i=0; i<nSatsEpoch; i++) {
 			if (readRinexRecord(lineBuffer, sizeof lineBuffer, input)) {
+				removeEpochFromSink();
 				plog->warning(msgPrfx + msgUnexpObsEOF);
 				return 3;
 			}
-			nObs = systems[sysInEpoch[i]].obsTypes.size();
+			const GNSSsystem &sys = hdr.systems[sysInEpoch[i]];
+			nObs = sys.obsColumns.size();
+			//data of satellites not selected are read, but not decoded
+			satSelected = isSatSelected(sysInEpoch[i], prnInEpoch[i]);
 			//for each observable type in this satellite extracts its data from the record
 			//each record can have data for 5 observable types (or less). Continuation records are used when needed 
 			for (j=0; j<nObs; j+=5) {
 				for (k=0, posObs = 0; k<5 && j+k<nObs; k++, posObs += 16) {
+					obsIdx = sys.obsColumns[j+k];
+					if (!satSelected || !sys.obsTypes[obsIdx].sel) continue;	//columns not selected are skipped
 					if (isBlank(lineBuffer + posObs, 14)) {	//empty observable
-						epochObs.push_back(SatObsData(epochTimeTag, sysInEpoch[i], prnInEpoch[i], j+k, 0.0, 0, 0));
+						addObsToSink(epochTimeTag, sysInEpoch[i], prnInEpoch[i], obsIdx, 0.0, 0, 0, epochObs);
 					} else {
-						valObs = stod(string(lineBuffer+posObs, 14));
+						valObs = fieldToDouble(lineBuffer + posObs, 14);
 						if (lineBuffer[posObs+14] == ' ') lliObs = 0;
 						else lliObs = (int) (lineBuffer[posObs+14] - '0');
 						if (lineBuffer[posObs+15] == ' ') strgObs = 0;
 						else strgObs = (int) (lineBuffer[posObs+15] - '0');
-						epochObs.push_back(SatObsData(epochTimeTag, sysInEpoch[i], prnInEpoch[i], j+k, valObs, lliObs, strgObs ));
+						addObsToSink(epochTimeTag, sysInEpoch[i], prnInEpoch[i], obsIdx, valObs, lliObs, strgObs, epochObs);
 					}
 				}
 				if (j+k < nObs) {
 					if (readRinexRecord(lineBuffer, sizeof lineBuffer, input)) {
+						removeEpochFromSink();
 						plog->warning(msgPrfx + msgUnexpEOF2);
 						return 3;
 					}
@@ -2886,13 +4317,8 @@ int RinexData::readV2ObsEpoch(FILE* input) {
 int RinexData::readV3ObsEpoch(FILE* input) {
     const string msgWrongStart(" Wrong start of epoch. Line skip");
 	char lineBuffer[1300]; //enough big to allocate 3 + 2 + 19 x 4 measurements x 16 chars= 1221
-	int nObs, posObs;
-	unsigned int sysIdx;
-	int prnSat;
-	double valObs;
-	int lliObs, strgObs;
-	int i, j;
-	string msgPrfx, aStr;
+	int i;
+	string msgPrfx;
 	//read epoch 1st line and extract data
 	for (;;) {	//synchronize start of epoch
 		if (readRinexRecord(lineBuffer, sizeof lineBuffer, input)) return 0;
@@ -2900,72 +4326,34 @@ int RinexData::readV3ObsEpoch(FILE* input) {
 		if (lineBuffer[0] == '>') break;
 		plog->warning(msgPrfx + msgWrongStart);
 	}
-	bool badEpoch = false;
-	if ((epochFlag = (int) (lineBuffer[31] - '0')) < 0) {
-		badEpoch = true;
-		msgPrfx  += msgNoFlag;
-		epochFlag = 999;	//a nonexisting flag
-	}
-	if (isBlank(lineBuffer + 32, 3)) {
-		badEpoch = true;
-		msgPrfx += msgSatOrSp;
-		nSatsEpoch = 0;
-	} else nSatsEpoch = stoi(string(lineBuffer + 32, 3));
-	int year = 0, month = 0, day = 0, hour = 0, minute = 0;
-	double second = 0.0;
-	bool wrongDate = sscanf(lineBuffer+2, "%4d %2d %2d %2d %2d%11lf", &year, &month, &day, &hour, &minute, &second) != 6 ;
-	if (!wrongDate) {	//translate date read to week + tow
-		getWeekTowGPSdate (year, month, day, hour, minute, second, epochWeek, epochTOW);
-		epochTimeTag = getInstantGNSStime(epochWeek, epochTOW);
-	}
+	OBSepochData epoch(epochWeek, epochTOW, epochTimeTag, epochClkOffset);
+	bool badEpoch = decodeV3EpochLine(lineBuffer, epoch, msgPrfx);
+	epochFlag = epoch.flag;
+	nSatsEpoch = epoch.nSats;
+	epochWeek = epoch.week;
+	epochTOW = epoch.tow;
+	epochTimeTag = epoch.timeTag;
+	epochClkOffset = epoch.clkOffset;
 	switch (epochFlag) {
 	case 0:
 	case 1:
 	case 6:
-		if (wrongDate) {
-			badEpoch = true;
-			msgPrfx += msgWrongDate;
-		}
 		if (badEpoch) {
 			plog->warning(msgPrfx);
 			return 4;
 		}
-		if (isBlank(lineBuffer + 41, 15)) epochClkOffset = 0.0;
-		else epochClkOffset = stod(string(lineBuffer + 41, 15));
 		//get the observation record for each satellite and extract data
+		addEpochToSink();
 		for (i = 0; i < nSatsEpoch; i++) {
 			if (readRinexRecord(lineBuffer, sizeof lineBuffer, input)) {
+				removeEpochFromSink();
 				plog->warning(msgPrfx + msgUnexpObsEOF);
 				return 3;
 			}
-			try {
-				sysIdx = getSysIndex(lineBuffer[0]);
-				if (sscanf(lineBuffer+1, "%2d", &prnSat) == 1) {
-					//for each observable type in the system of this satellite
-					nObs = systems[sysIdx].obsTypes.size();
-					for (j = 0, posObs = 3; j < nObs; j++, posObs += 16) {
-						if (isBlank(lineBuffer + posObs, 14)) {
-							//empty observable: values are considered 0
-							epochObs.push_back(SatObsData(epochTimeTag, sysIdx, prnSat, j, 0.0, 0, 0));
-						} else {
-							valObs = stod(string(lineBuffer+posObs, 14));
-							if (lineBuffer[posObs+14] == ' ') lliObs = 0;
-							else lliObs = stoi(string(lineBuffer+posObs+14, 1));
-							if (lineBuffer[posObs+15] == ' ') strgObs = 0;
-							else strgObs = stoi(string(lineBuffer+posObs+15, 1));
-							epochObs.push_back(SatObsData(epochTimeTag, sysIdx, prnSat, j,  valObs, lliObs, strgObs));
-						}
-					}
-				} else {
-					badEpoch = true;
-					msgPrfx += msgWrongPRN;
-				}
-			}  catch (string error) {
-				badEpoch = true;
-				msgPrfx += error;
-			}
+			if (!decodeV3SatLine(lineBuffer, epochTimeTag, epochObs, msgPrfx)) badEpoch = true;
 		}
 		if (badEpoch) {
+			removeEpochFromSink();
 			plog->warning(msgPrfx);
 			return 3;
 		}
@@ -2976,13 +4364,190 @@ int RinexData::readV3ObsEpoch(FILE* input) {
 	case 4:
 	case 5:
 		plog->fine(msgPrfx);
-		return readObsEpochEvent(input, wrongDate);
+		return readObsEpochEvent(input, epoch.wrongDate);
 	default:
 		plog->warning(msgPrfx + msgWrongFlag);
 		return 8;
 	}
 }
 
+/**decodeV3EpochLine extracts data from a RINEX V3.04 epoch line (the one starting with '>').
+ * Epoch time data are set only when date is correct, and clock offset only for epochs with observation data (flags 0, 1, 6).
+ * It does not modify the object state, and can be used concurrently.
+ *
+ * @param line the epoch line, padded with blanks
+ * @param epoch the place where extracted data are stored
+ * @param msgPrfx the message prefix where errors found are appended
+ * @return true if there are errors in the epoch line data, false otherwise
+ */
+bool RinexData::decodeV3EpochLine(const char* line, OBSepochData &epoch, string &msgPrfx) const {
+	bool badEpoch = false;
+	char field[16];		//a NUL terminated copy of the number of satellites or clock offset fields
+	char* fieldEnd;
+	double clkOffset;
+	if ((epoch.flag = (int) (line[31] - '0')) < 0) {
+		badEpoch = true;
+		msgPrfx  += msgNoFlag;
+		epoch.flag = 999;	//a nonexisting flag
+	}
+	memcpy(field, line + 32, 3);
+	field[3] = 0;
+	epoch.nSats = (int) strtol(field, &fieldEnd, 10);
+	if (fieldEnd == field) {
+		badEpoch = true;
+		msgPrfx += msgSatOrSp;
+		epoch.nSats = 0;
+	}
+	int year = 0, month = 0, day = 0, hour = 0, minute = 0;
+	double second = 0.0;
+	epoch.wrongDate = sscanf(line+2, "%4d %2d %2d %2d %2d%11lf", &year, &month, &day, &hour, &minute, &second) != 6 ;
+	if (!epoch.wrongDate) {	//translate date read to week + tow
+		getWeekTowGPSdate (year, month, day, hour, minute, second, epoch.week, epoch.tow);
+		epoch.timeTag = getInstantGNSStime(epoch.week, epoch.tow);
+	}
+	switch (epoch.flag) {
+	case 0:
+	case 1:
+	case 6:
+		if (epoch.wrongDate) {
+			badEpoch = true;
+			msgPrfx += msgWrongDate;
+		}
+		if (badEpoch) break;
+		if (isBlank(line + 41, 15)) epoch.clkOffset = 0.0;
+		else {
+			memcpy(field, line + 41, 15);
+			field[15] = 0;
+			clkOffset = strtod(field, &fieldEnd);
+			if (fieldEnd == field) {
+				badEpoch = true;
+				msgPrfx += msgWrongClkOffs;
+			} else epoch.clkOffset = clkOffset;
+		}
+		break;
+	default:
+		break;
+	}
+	return badEpoch;
+}
+
+/**decodeV3SatLine extracts the observables of a satellite from a RINEX V3.04 observation line and appends them to the given vector.
+ * It does not modify the object state, and can be used concurrently.
+ *
+ * @param line the satellite observation line, padded with blanks
+ * @param tTag the time tag of the epoch
+ * @param obs the vector where observables extracted are appended, when they are not placed directly in a store (see addObsToSink)
+ * @param msgPrfx the message prefix where errors found are appended
+ * @return true if the line has been decoded, false if there are errors in the satellite system or PRN
+ */
+bool RinexData::decodeV3SatLine(const char* line, double tTag, vector<SatObsData> &obs, string &msgPrfx) const {
+	int nObs, posObs, j;
+	unsigned int sysIdx, obsIdx;
+	int prnSat;
+	double valObs;
+	int lliObs, strgObs;
+	try {
+		sysIdx = getSysIndex(line[0]);
+		if (sscanf(line+1, "%2d", &prnSat) == 1) {
+			//data of satellites not selected are skipped without decoding them
+			if (!isSatSelected(sysIdx, prnSat)) return true;
+			//for each observable column in the system of this satellite
+			const GNSSsystem &sys = hdr.systems[sysIdx];
+			nObs = sys.obsColumns.size();
+			for (j = 0, posObs = 3; j < nObs; j++, posObs += 16) {
+				obsIdx = sys.obsColumns[j];
+				if (!sys.obsTypes[obsIdx].sel) continue;	//columns of observables not selected are skipped
+				if (isBlank(line + posObs, 14)) {
+					//empty observable: values are considered 0
+					addObsToSink(tTag, sysIdx, prnSat, obsIdx, 0.0, 0, 0, obs);
+				} else {
+					valObs = fieldToDouble(line + posObs, 14);
+					if (line[posObs+14] == ' ') lliObs = 0;
+					else lliObs = (int) (line[posObs+14] - '0');
+					if (line[posObs+15] == ' ') strgObs = 0;
+					else strgObs = (int) (line[posObs+15] - '0');
+					addObsToSink(tTag, sysIdx, prnSat, obsIdx, valObs, lliObs, strgObs, obs);
+				}
+			}
+			return true;
+		}
+		msgPrfx += msgWrongPRN;
+	}  catch (string error) {
+		msgPrfx += error;
+	}
+	return false;
+}
+
+/**parseV3ObsChunk parses the RINEX V3.04 observation epochs contained in the given memory chunk.
+ * It does not modify the object state, and it is called concurrently from several threads by readObsEpochsParallel.
+ * Special event epochs are not parsed: they are marked with status -1 to be read sequentially.
+ *
+ * @param begin the start of the chunk, which shall be the start of an epoch line
+ * @param end the position just after the last char in the chunk
+ * @param offset the byte offset of the chunk in the input file
+ * @param epochs the vector where epochs parsed are stored
+ */
+void RinexData::parseV3ObsChunk(const char* begin, const char* end, long offset, vector<OBSepochData>* epochs) const {
+	const string msgWrongStart(" Wrong start of epoch. Line skip");
+	char lineBuffer[1300];
+	const char* cursor = begin;
+	const char* lineStart;
+	int i;
+	vector<string> skipped;		//messages for lines out of an epoch found before the next one
+	for (;;) {
+		lineStart = cursor;
+		if (readRinexRecord(lineBuffer, sizeof lineBuffer, cursor, end)) {
+			if (!skipped.empty()) {		//lines skipped at the end: pass their messages in an empty epoch (status 0)
+				epochs->push_back(OBSepochData(0, 0.0, 0.0, 0.0));
+				epochs->back().skipped.swap(skipped);
+			}
+			return;
+		}
+		OBSepochData epoch(0, 0.0, 0.0, 0.0);
+		epoch.msg = msgEpoch + string(lineBuffer, 35) + msgBrak;
+		if (lineBuffer[0] != '>') {		//lines out of an epoch are skipped
+			skipped.push_back(epoch.msg + msgWrongStart);
+			continue;
+		}
+		epoch.skipped.swap(skipped);
+		epoch.offset = offset + (long) (lineStart - begin);
+		bool badEpoch = decodeV3EpochLine(lineBuffer, epoch, epoch.msg);
+		switch (epoch.flag) {
+		case 0:
+		case 1:
+		case 6:
+			if (badEpoch) {
+				epoch.status = 4;
+				break;
+			}
+			epoch.obs.reserve(epoch.nSats * 8);
+			epoch.status = 1;
+			for (i = 0; i < epoch.nSats; i++) {
+				if (readRinexRecord(lineBuffer, sizeof lineBuffer, cursor, end)) {
+					epoch.msg += msgUnexpObsEOF;
+					epoch.status = 3;
+					break;
+				}
+				if (!decodeV3SatLine(lineBuffer, epoch.timeTag, epoch.obs, epoch.msg)) epoch.status = 3;
+			}
+			break;
+		case 2:
+		case 3:
+		case 4:
+		case 5:
+			epoch.status = -1;
+			for (i = 0; i < epoch.nSats; i++) readRinexRecord(lineBuffer, sizeof lineBuffer, cursor, end);
+			break;
+		default:
+			epoch.msg += msgWrongFlag;
+			epoch.status = 8;
+			break;
+		}
+		epoch.endOffset = offset + (long) (cursor - begin);
+		epochs->push_back(epoch);
+	}
+}
+
 /**readObsEpochEvent reads from the RINEX observation file event records
  * 
  * @param input the already open print stream where RINEX epoch will be read
@@ -3053,12 +4618,337 @@ int RinexData::readObsEpochEvent(FILE* input, bool wrongDate) {
 	return retValue;
 }
 
+/**isObsEpochLine checks if the given line read from the input RINEX observation file is an epoch line and extracts its time and flag.
+ * For V3.04 files epoch lines start with '>'. For V2.10 files epoch lines shall match the pattern " yy mm dd hh mm ss.sssssss  f",
+ * or have blank date for special events (flags 2 to 5).
+ * Special event epochs without date are given the time of the previous epoch in the index.
+ *
+ * @param line the line to check
+ * @param timeTag the epoch time as seconds from the GPS epoch
+ * @param flag the epoch flag
+ * @return true if the line is an epoch line, false otherwise
+ */
+bool RinexData::isObsEpochLine(const char* line, double &timeTag, int &flag) {
+	int year = 0, month = 0, day = 0, hour = 0, minute = 0;
+	double second = 0.0;
+	bool hasDate;
+	switch (hdr.inFileVer) {
+	case V304:
+		if (line[0] != '>') return false;
+		if (strlen(line) < 32) return false;
+		flag = (int) (line[31] - '0');
+		hasDate = sscanf(line + 2, "%4d %2d %2d %2d %2d%11lf", &year, &month, &day, &hour, &minute, &second) == 6;
+		break;
+	case V210:
+		if (strlen(line) < 32) return false;
+		flag = (int) (line[28] - '0');
+		if ((flag < 0) || (flag > 6) || (line[26] != ' ') || (line[27] != ' ')) return false;
+		if ((line[18] == '.') && (line[0] == ' ') && (line[3] == ' ') && (line[6] == ' ')) {
+			hasDate = sscanf(line, " %2d %2d %2d %2d %2d%11lf", &year, &month, &day, &hour, &minute, &second) == 6;
+			if (year >= 80) year += 1900;
+			else year += 2000;
+		} else if ((flag >= 2) && (flag <= 5) && isBlank(line, 26)) {
+			hasDate = false;
+		} else return false;
+		break;
+	default:
+		return false;
+	}
+	if (hasDate) timeTag = getInstantGPSdate(year, month, day, hour, minute, second);
+	else timeTag = obsEpochIndex.empty()? 0.0 : obsEpochIndex.back().timeTag;
+	return true;
+}
+
+/**loadObsEpochIndex loads the epoch index from the given sidecar file.
+ * The first line of the file contains the format version (V2), the size and modification time of the indexed observation file,
+ * and the number of epochs.
+ * Each following line contains the offset, time and flag of an epoch.
+ *
+ * @param indexFileName the name of the file containing the index
+ * @return true if the index has been loaded, false otherwise
+ */
+bool RinexData::loadObsEpochIndex(string indexFileName) {
+	long offset, fileSize;
+	long long fileTime;
+	double timeTag;
+	int flag, nEpochs;
+	FILE* idxFile = fopen(indexFileName.c_str(), "r");
+	if (idxFile == NULL) return false;
+	bool loaded = fscanf(idxFile, "RINEX OBS EPOCH INDEX V2 %ld %lld %d", &fileSize, &fileTime, &nEpochs) == 3;
+	if (loaded) {
+		obsEpochIndex.clear();
+		obsEpochIndex.reserve(nEpochs);
+		while (fscanf(idxFile, "%ld %lf %d", &offset, &timeTag, &flag) == 3) obsEpochIndex.push_back(OBSepochIndex(offset, timeTag, flag));
+		loaded = (int) obsEpochIndex.size() == nEpochs;
+		obsIndexFileSize = loaded? fileSize : -1;
+		obsIndexFileTime = loaded? fileTime : -1;
+	}
+	fclose(idxFile);
+	return loaded;
+}
+
+/**advanceObsMerge reads the next epoch with observables from the given input file being merged, and queues its time tag.
+ * Event epochs and epochs with errors are discarded.
+ *
+ * @param inputIdx the position of the input file in mergeInputs
+ * @return true if an epoch was read, false if there are no more epochs in the file
+ */
+bool RinexData::advanceObsMerge(unsigned int inputIdx) {
+	OBSmergeInput &mi = mergeInputs[inputIdx];
+	while ((mi.status = mi.reader->readObsEpoch(mi.input)) != 0) {
+		if ((mi.status == 1) || (mi.status == 3)) {
+			mergeQueue.push(make_pair(mi.reader->epochTimeTag, inputIdx));
+			return true;
+		}
+		plog->info(msgMergeSkipEpoch + to_string(inputIdx) + msgStatus + to_string(mi.status));
+	}
+	return false;
+}
+
+/**obsKey computes a key identifying an observable of an epoch, which allows sorting and searching them.
+ *
+ * @param sysIdx the system index
+ * @param sat the satellite number
+ * @param obsIdx the observable index
+ * @return the key for the given system, satellite and observable
+ */
+unsigned long long RinexData::obsKey(unsigned int sysIdx, int sat, unsigned int obsIdx) {
+	return ((unsigned long long) sysIdx << 48) | ((unsigned long long) (unsigned int) sat << 16) | (obsIdx & 0xFFFF);
+}
+
+/**collectNavFiles reads the given navigation files, from the first one and stepping the given number of files, storing
+ * their ephemeris into the given map. Each file is read using its own RinexData object, allowing concurrent calls.
+ *
+ * @param inputs the already open input RINEX navigation files
+ * @param first the position in inputs of the first file to read
+ * @param step the increment in the position of the next file to read
+ * @param navMap the map where ephemeris read are stored
+ */
+void RinexData::collectNavFiles(vector<FILE*> &inputs, unsigned int first, unsigned int step, NAVmergeMap &navMap) {
+	int status;
+	for (unsigned int i = first; i < inputs.size(); i += step) {
+		RinexData reader(VTBD, plog);
+		reader.readRinexHeader(inputs[i]);
+		if (reader.hdr.inFileVer == VTBD) {
+			plog->warning(msgMergeSkipFile + to_string(i));
+			continue;
+		}
+		while ((status = reader.readNavEpoch(inputs[i])) != 0)
+			if (((status == 1) || (status == 2)) && !reader.epochNav.empty()) addNavCopy(navMap, reader.epochNav[0], 1);
+	}
+}
+
+/**addNavCopy adds to the given map a copy of an ephemeris found the given number of times.
+ * If the same copy already exists (see isSameNavCopy) its count is increased, keeping the earliest transmission time.
+ *
+ * @param navMap the map where the ephemeris is added
+ * @param navData the ephemeris data
+ * @param count the number of times it was found
+ */
+void RinexData::addNavCopy(NAVmergeMap &navMap, const SatNavData &navData, int count) {
+	NAVmergeKey key;
+	key.systemId = navData.systemId;
+	key.satellite = navData.satellite;
+	key.toc = navData.navTimeTag;
+	key.iod = 0;
+	if ((key.systemId == 'G') || (key.systemId == 'E') || (key.systemId == 'C') || (key.systemId == 'J'))
+		key.iod = (int) navData.broadcastOrbit[1][0];
+	vector<NAVmergeCopy> &copies = navMap[key];
+	for (vector<NAVmergeCopy>::iterator it = copies.begin(); it != copies.end(); ++it) {
+		if (isSameNavCopy(it->data, navData)) {
+			it->count += count;
+			if (navData.broadcastOrbit[7][0] < it->data.broadcastOrbit[7][0]) it->data.broadcastOrbit[7][0] = navData.broadcastOrbit[7][0];
+			return;
+		}
+	}
+	copies.push_back(NAVmergeCopy(navData));
+	copies.back().count = count;
+}
+
+/**isSameNavCopy checks if two copies of the same ephemeris have the same data, excluding the transmission time of message.
+ *
+ * @param a the data of one copy
+ * @param b the data of the other copy
+ * @return true if both copies have the same data, false otherwise
+ */
+bool RinexData::isSameNavCopy(const SatNavData &a, const SatNavData &b) {
+	for (int i = 0; i < BO_MAXLINS; i++)
+		for (int j = 0; j < BO_MAXCOLS; j++)
+			if ((a.broadcastOrbit[i][j] != b.broadcastOrbit[i][j]) && !((i == 7) && (j == 0))) return false;
+	return true;
+}
+
+/**isLowerNavCopy checks if a copy of an ephemeris has lower values than other copy of the same ephemeris, comparing their
+ * broadcast orbit values in the order they are printed, and excluding the transmission time of message.
+ *
+ * @param a the data of one copy
+ * @param b the data of the other copy
+ * @return true if the first value different in both copies is lower in the first one, false otherwise
+ */
+bool RinexData::isLowerNavCopy(const SatNavData &a, const SatNavData &b) {
+	for (int i = 0; i < BO_MAXLINS; i++)
+		for (int j = 0; j < BO_MAXCOLS; j++)
+			if ((a.broadcastOrbit[i][j] != b.broadcastOrbit[i][j]) && !((i == 7) && (j == 0)))
+				return a.broadcastOrbit[i][j] < b.broadcastOrbit[i][j];
+	return false;
+}
+
+/**openSplitFile creates the output file for the given time window and prints its header, using the current epoch time as the
+ * time of first and last observation. If the maximum number of files open is reached, the one with the oldest window is closed.
+ *
+ * @param windowStart the start time of the window, as seconds from the GPS epoch
+ * @return true if the file was created, false otherwise
+ * @throws error message string when header cannot be printed
+ */
+bool RinexData::openSplitFile(double windowStart) {
+	closeOldestSplitFile();
+	//name the file using the window period, and print its header with current epoch as first and last observation
+	int saveFirstWeek = hdr.firstObsWeek, saveLastWeek = hdr.lastObsWeek;
+	double saveFirstTOW = hdr.firstObsTOW, saveLastTOW = hdr.lastObsTOW;
+	bool saveTOFO = getLabelFlag(TOFO), saveTOLO = getLabelFlag(TOLO);
+	OBSsplitFile sf;
+	sf.windowStart = windowStart;
+	hdr.firstObsWeek = getWeekGNSSinstant(windowStart);
+	hdr.firstObsTOW = getTowGNSSinstant(windowStart);
+	hdr.lastObsWeek = getWeekGNSSinstant(windowStart + splitWindow);
+	hdr.lastObsTOW = getTowGNSSinstant(windowStart + splitWindow);
+	setLabelFlag(TOFO);
+	setLabelFlag(TOLO);
+	sf.fileName = splitPath + getObsFileName(splitPrefix, splitCountry);
+	sf.firstWeek = sf.lastWeek = hdr.firstObsWeek = hdr.lastObsWeek = epochWeek;
+	sf.firstTOW = sf.lastTOW = hdr.firstObsTOW = hdr.lastObsTOW = epochTOW;
+	sf.out = fopen(sf.fileName.c_str(), "w+");
+	if (sf.out != NULL) {
+		printObsHeader(sf.out);
+		sf.tofoOffset = hdTofoOffset;
+		sf.toloOffset = hdToloOffset;
+	} else plog->warning(msgSplitNoFile + sf.fileName);
+	hdr.firstObsWeek = saveFirstWeek;
+	hdr.firstObsTOW = saveFirstTOW;
+	hdr.lastObsWeek = saveLastWeek;
+	hdr.lastObsTOW = saveLastTOW;
+	setLabelFlag(TOFO, saveTOFO);
+	setLabelFlag(TOLO, saveTOLO);
+	if (sf.out == NULL) return false;
+	splitFiles.push_back(sf);
+	return true;
+}
+
+/**reopenSplitFile opens again, to append data, an output file of the split data already created and closed.
+ * If the maximum number of files open is reached, the one with the oldest window is closed.
+ *
+ * @param sf the data of the output file to reopen
+ * @return true if the file was opened and positioned at its end, false otherwise
+ */
+bool RinexData::reopenSplitFile(OBSsplitFile &sf) {
+	closeOldestSplitFile();
+	if (((sf.out = fopen(sf.fileName.c_str(), "r+")) == NULL) || (fseek(sf.out, 0, SEEK_END) != 0)) {
+		if (sf.out != NULL) fclose(sf.out);
+		sf.out = NULL;
+		plog->warning(msgSplitNoFile + sf.fileName);
+		return false;
+	}
+	return true;
+}
+
+/**closeOldestSplitFile closes the output file of the split data with the oldest window, if the maximum number of files
+ * open is reached.
+ */
+void RinexData::closeOldestSplitFile() {
+	unsigned int nOpen = 0;
+	int oldest = -1;
+	for (unsigned int i = 0; i < splitFiles.size(); i++) {
+		if (splitFiles[i].out == NULL) continue;
+		nOpen++;
+		if ((oldest < 0) || (splitFiles[i].windowStart < splitFiles[oldest].windowStart)) oldest = (int) i;
+	}
+	if ((nOpen >= splitMaxOpen) && (oldest >= 0)) closeSplitFile(splitFiles[oldest]);
+}
+
+/**selectObsTarget sets the version, observables to print and print plans of the given output target, to print epoch data in it.
+ * Systems added after printing the target header have nothing to print in it.
+ *
+ * @param target the output target
+ */
+void RinexData::selectObsTarget(const OBStarget &target) {
+	hdr.version = target.version;
+	for (unsigned int i = 0; i < hdr.systems.size(); i++) {
+		GNSSsystem &sys = hdr.systems[i];
+		bool known = i < target.prt.size();
+		for (unsigned int j = 0; j < sys.obsTypes.size(); j++) sys.obsTypes[j].prt = known && (j < target.prt[i].size()) && target.prt[i][j];
+		if (known) {
+			sys.prtColumns = target.prtColumns[i];
+			sys.prtLineEnd = target.prtLineEnd[i];
+		} else {
+			sys.prtColumns.clear();
+			sys.prtLineEnd.clear();
+		}
+	}
+}
+
+/**keepObsTarget keeps in the given output target the observables to print and print plans currently set for each system.
+ * The storage in the target is reused.
+ *
+ * @param target the output target
+ */
+void RinexData::keepObsTarget(OBStarget &target) {
+	unsigned int n = hdr.systems.size();
+	target.prt.resize(n);
+	target.prtColumns.resize(n);
+	target.prtLineEnd.resize(n);
+	for (unsigned int i = 0; i < n; i++) {
+		GNSSsystem &sys = hdr.systems[i];
+		target.prt[i].clear();
+		for (vector<OBSmeta>::iterator itobs = sys.obsTypes.begin(); itobs != sys.obsTypes.end(); itobs++)
+			target.prt[i].push_back(itobs->prt);
+		target.prtColumns[i] = sys.prtColumns;
+		target.prtLineEnd[i] = sys.prtLineEnd;
+	}
+}
+
+/**closeSplitFile closes the given output file of the split data, updating its TIME OF FIRST OBS and TIME OF LAST OBS records.
+ *
+ * @param sf the data of the output file to close
+ */
+void RinexData::closeSplitFile(OBSsplitFile &sf) {
+	if (sf.out == NULL) return;
+	int saveFirstWeek = hdr.firstObsWeek, saveLastWeek = hdr.lastObsWeek;
+	double saveFirstTOW = hdr.firstObsTOW, saveLastTOW = hdr.lastObsTOW;
+	hdr.firstObsWeek = sf.firstWeek;
+	hdr.firstObsTOW = sf.firstTOW;
+	hdr.lastObsWeek = sf.lastWeek;
+	hdr.lastObsTOW = sf.lastTOW;
+	if ((sf.tofoOffset >= 0) && (fseek(sf.out, sf.tofoOffset, SEEK_SET) == 0)) printHdLineData(sf.out, TOFO);
+	if ((sf.toloOffset >= 0) && (fseek(sf.out, sf.toloOffset, SEEK_SET) == 0)) printHdLineData(sf.out, TOLO);
+	hdr.firstObsWeek = saveFirstWeek;
+	hdr.firstObsTOW = saveFirstTOW;
+	hdr.lastObsWeek = saveLastWeek;
+	hdr.lastObsTOW = saveLastTOW;
+	fclose(sf.out);
+	sf.out = NULL;
+}
+
+/**saveObsEpochIndex saves the current epoch index into the given sidecar file (see loadObsEpochIndex for its format).
+ *
+ * @param indexFileName the name of the file where the index will be saved
+ * @return true if the index has been saved, false otherwise
+ */
+bool RinexData::saveObsEpochIndex(string indexFileName) {
+	FILE* idxFile = fopen(indexFileName.c_str(), "w");
+	if (idxFile == NULL) return false;
+	fprintf(idxFile, "RINEX OBS EPOCH INDEX V2 %ld %lld %d\n", obsIndexFileSize, obsIndexFileTime, (int) obsEpochIndex.size());
+	for (vector<OBSepochIndex>::iterator it = obsEpochIndex.begin(); it != obsEpochIndex.end(); ++it)
+		fprintf(idxFile, "%ld %.7f %d\n", it->offset, it->timeTag, it->flag);
+	return fclose(idxFile) == 0;
+}
+
 /**printHdLineData prints a header line data into the output file
  * 
  * @param out the already open print stream where RINEX header line will be printed
  * @param labelId is the label identifier for the line to be printed
+ * @param comment is the comment to be printed when labelId is COMM
  */
-void RinexData::printHdLineData(FILE* out, vector<LABELdata>::iterator lbIter) {
+void RinexData::printHdLineData(FILE* out, RINEXlabel labelId, const string &comment) {
 	///a macro to print a SYS / type record
 	#define PRINT_SYSREC(VECTOR, ITEMS_PER_LINE, PRNTPFX_1ST, PRNTPFX_CON, PRNT_ITEM, PRNT_EMPTYITEM) \
 		/*in a VECTOR, print ITEMS_PER_LINE VECTOR elements per line (in a 1st line + continuation lines if needed)*/ \
@@ -3087,75 +4977,74 @@ void RinexData::printHdLineData(FILE* out, vector<LABELdata>::iterator lbIter) {
 
     double instant;
 
-	RINEXlabel labelId = lbIter->labelID;
 	switch (labelId) {
     case VERSION:    //"RINEX VERSION / TYPE"
-        if (version == V210) {  //print VERSION params as per V210
-            if (fileType == 'O') {
-                fprintf(out, "%9.2f%11c%1c%-19.19s%1c%-19.19s", 2.10, ' ', fileType, fileTypeSfx.c_str(), sysToPrintId, systemIdSfx.c_str());
+        if (hdr.version == V210) {  //print VERSION params as per V210
+            if (hdr.fileType == 'O') {
+                fprintf(out, "%9.2f%11c%1c%-19.19s%1c%-19.19s", 2.10, ' ', hdr.fileType, hdr.fileTypeSfx.c_str(), hdr.sysToPrintId, hdr.systemIdSfx.c_str());
             } else {
-                fprintf(out, "%9.2f%11c%1c%-19.19s%1c%-19.19s", 2.10, ' ', fileType, fileTypeSfx.c_str(), ' ', " ");
+                fprintf(out, "%9.2f%11c%1c%-19.19s%1c%-19.19s", 2.10, ' ', hdr.fileType, hdr.fileTypeSfx.c_str(), ' ', " ");
             }
         } else {    //by default V304
-            fprintf(out, "%9.2f%11c%1c%-19.19s%1c%-19.19s", 3.04, ' ', fileType, fileTypeSfx.c_str(), sysToPrintId, systemIdSfx.c_str());
+            fprintf(out, "%9.2f%11c%1c%-19.19s%1c%-19.19s", 3.04, ' ', hdr.fileType, hdr.fileTypeSfx.c_str(), hdr.sysToPrintId, hdr.systemIdSfx.c_str());
         }
         break;
     case RUNBY:        //"PGM / RUN BY / DATE"
-        if (date.length() == 0) {
+        if (hdr.date.length() == 0) {
             //get current UTC time and format it
             formatUTCtime(timeBuffer, sizeof timeBuffer, "%Y%m%d %H%M%S ");
-            fprintf(out, "%-20.20s%-20.20s%s%3s ", pgm.c_str(), runby.c_str(), timeBuffer, "UTC");
+            fprintf(out, "%-20.20s%-20.20s%s%3s ", hdr.pgm.c_str(), hdr.runby.c_str(), timeBuffer, "UTC");
         } else {
-            fprintf(out, "%-20.20s%-20.20s%-20.20s", pgm.c_str(), runby.c_str(), date.c_str());
+            fprintf(out, "%-20.20s%-20.20s%-20.20s", hdr.pgm.c_str(), hdr.runby.c_str(), hdr.date.c_str());
         }
         break;
     case COMM:        //"COMMENT"
-        fprintf(out, "%-60.60s", (lbIter->comment).c_str());
+        fprintf(out, "%-60.60s", comment.c_str());
         break;
     case MRKNAME:    //"MARKER NAME"
-        fprintf(out, "%-60.60s", markerName.c_str());
+        fprintf(out, "%-60.60s", hdr.markerName.c_str());
     	break;
     case MRKNUMBER:    //"MARKER NUMBER"
-        fprintf(out, "%-60.60s", markerNumber.c_str());
+        fprintf(out, "%-60.60s", hdr.markerNumber.c_str());
         break;
     case MRKTYPE:    //"MARKER TYPE"
-        fprintf(out, "%-20.20s%40c", markerType.c_str(), ' ');
+        fprintf(out, "%-20.20s%40c", hdr.markerType.c_str(), ' ');
         break;
     case AGENCY:    //"OBSERVER / AGENCY"
-    	fprintf(out, "%-20.20s%-40.40s", observer.c_str(), agency.c_str());
+    	fprintf(out, "%-20.20s%-40.40s", hdr.observer.c_str(), hdr.agency.c_str());
         break;
     case RECEIVER:    //"REC # / TYPE / VERS
-    	fprintf(out, "%-20.20s%-20.20s%-20.20s", rxNumber.c_str(), rxType.c_str(), rxVersion.c_str());
+    	fprintf(out, "%-20.20s%-20.20s%-20.20s", hdr.rxNumber.c_str(), hdr.rxType.c_str(), hdr.rxVersion.c_str());
         break;
     case ANTTYPE:    //"ANT # / TYPE"
-        fprintf(out, "%-20.20s%-20.20s%20c", antNumber.c_str(), antType.c_str(), ' ');
+        fprintf(out, "%-20.20s%-20.20s%20c", hdr.antNumber.c_str(), hdr.antType.c_str(), ' ');
         break;
     case APPXYZ:    //"APPROX POSITION XYZ"
-        fprintf(out, "%14.4lf%14.4lf%14.4lf%18c", aproxX, aproxY, aproxZ, ' ');
+        fprintf(out, "%14.4lf%14.4lf%14.4lf%18c", hdr.aproxX, hdr.aproxY, hdr.aproxZ, ' ');
     	break;
     case ANTHEN:        //"ANTENNA: DELTA H/E/N"
-        fprintf(out, "%14.4lf%14.4lf%14.4lf%18c", antHigh, eccEast, eccNorth, ' ');
+        fprintf(out, "%14.4lf%14.4lf%14.4lf%18c", hdr.antHigh, hdr.eccEast, hdr.eccNorth, ' ');
         break;
     case ANTXYZ:        //"ANTENNA: DELTA X/Y/Z"	V300
-        fprintf(out, "%14.4lf%14.4lf%14.4lf%18c", antX, antY, antX, ' ');
+        fprintf(out, "%14.4lf%14.4lf%14.4lf%18c", hdr.antX, hdr.antY, hdr.antX, ' ');
         break;
     case ANTPHC:        //"ANTENNA: PHASECENTE"		V300
-        fprintf(out, "%c %-3.3s%9.4lf%14.4lf%14.4lf%18c", antPhSys, antPhCode.c_str(), antPhNoX, antPhEoY, antPhUoZ, ' ');
+        fprintf(out, "%c %-3.3s%9.4lf%14.4lf%14.4lf%18c", hdr.antPhSys, hdr.antPhCode.c_str(), hdr.antPhNoX, hdr.antPhEoY, hdr.antPhUoZ, ' ');
         break;
     case ANTBS:            //"ANTENNA: B.SIGHT XYZ"	V300
-        fprintf(out, "%14.4lf%14.4lf%14.4lf%18c", antBoreX, antBoreY, antBoreX, ' ');
+        fprintf(out, "%14.4lf%14.4lf%14.4lf%18c", hdr.antBoreX, hdr.antBoreY, hdr.antBoreX, ' ');
         break;
     case ANTZDAZI:        //"ANTENNA: ZERODIR AZI"	V300
-        fprintf(out, "%14.4lf%46c", antZdAzi, ' ');
+        fprintf(out, "%14.4lf%46c", hdr.antZdAzi, ' ');
         break;
     case ANTZDXYZ:        //"ANTENNA: ZERODIR XYZ"	V300
-        fprintf(out, "%14.4lf%14.4lf%14.4lf%18c", antZdX, antZdY, antZdX, ' ');
+        fprintf(out, "%14.4lf%14.4lf%14.4lf%18c", hdr.antZdX, hdr.antZdY, hdr.antZdX, ' ');
         break;
     case COFM :            //"CENTER OF MASS XYZ"		V300
-        fprintf(out, "%14.4lf%14.4lf%14.4lf%18c", centerX, centerY, centerX, ' ');
+        fprintf(out, "%14.4lf%14.4lf%14.4lf%18c", hdr.centerX, hdr.centerY, hdr.centerX, ' ');
         break;
     case WVLEN:            //"WAVELENGTH FACT L1/2"	V210
-        for (vector<WVLNfactor>::iterator it = wvlenFactor.begin(); it != wvlenFactor.end(); it++) {
+        for (vector<WVLNfactor>::iterator it = hdr.wvlenFactor.begin(); it != hdr.wvlenFactor.end(); it++) {
             n = it->satNums.size();
             fprintf(out, "%6d%6d%6d", it->wvlenFactorL1, it->wvlenFactorL2, n);
             for (i = 0; i < 7; i++)
@@ -3165,13 +5054,13 @@ void RinexData::printHdLineData(FILE* out, vector<LABELdata>::iterator lbIter) {
         }
         return;
     case TOBS:        //"# / TYPES OF OBSERV"		V210
-        if (systems.empty()) return;
+        if (hdr.systems.empty()) return;
 		//Note that only V210 obsTypes are taken into account
         //copy into aVectorStr the V210 obsTypes identifiers to be printed
         //note that all systems have the same observables to print
         aVectorStr.clear();
         for (i = 0; i < numberV2ObsTypes; i++)
-            if (systems[0].obsTypes[i].prt) aVectorStr.push_back(v2obsTypes[i]);
+            if (hdr.systems[0].obsTypes[i].prt) aVectorStr.push_back(v2obsTypes[i]);
         PRINT_SYSREC(aVectorStr,
     	        9,
         	    fprintf(out, "%6u", k),
@@ -3183,7 +5072,7 @@ void RinexData::printHdLineData(FILE* out, vector<LABELdata>::iterator lbIter) {
 	case SYS :		//"SYS / # / OBS TYPES"		V300
 		//for each system, print 13 observable types per line (a 1st line + continuation lines if needed)
         //to do it, copy into aVectorStr the obsTypes identifications to be printed
-        for (vector<GNSSsystem>::iterator itsys = systems.begin(); itsys != systems.end(); itsys++) {
+        for (vector<GNSSsystem>::iterator itsys = hdr.systems.begin(); itsys != hdr.systems.end(); itsys++) {
 			aVectorStr.clear();
 			for (vector<OBSmeta>::iterator itobs = itsys->obsTypes.begin(); itobs != itsys->obsTypes.end(); itobs++) {
 			    itobs->prt = itobs->sel;
@@ -3199,45 +5088,45 @@ void RinexData::printHdLineData(FILE* out, vector<LABELdata>::iterator lbIter) {
  		}
 		return;
 	case SIGU :		//"SIGNAL STRENGTH UNIT"
-		fprintf(out, "%-20.20s%40c", signalUnit.c_str(), ' ');
+		fprintf(out, "%-20.20s%40c", hdr.signalUnit.c_str(), ' ');
 		break;
 	case INT :		//"INTERVAL"
-	 	fprintf(out, "%10.3lf%50c", obsInterval, ' ');
+	 	fprintf(out, "%10.3lf%50c", hdr.obsInterval, ' ');
 		break;
 	case TOFO :		//"TIME OF FIRST OBS"
-		formatGPStime (timeBuffer, sizeof timeBuffer, "  %Y    %m    %d    %H    %M  ", "%11.7lf", firstObsWeek, firstObsTOW);
+		timeFormatter.format(timeBuffer, GPStimeFormatter::HDOBS, hdr.firstObsWeek, hdr.firstObsTOW);
 		// fprintf(out, "%s%5c%-3.3s%9c", timeBuffer, ' ', obsTimeSys.c_str(), ' ');
-		fprintf(out, "%s%5c%-3.3s%9c", timeBuffer, ' ', getTimeDes(obsTimeSys).c_str(), ' ');
+		fprintf(out, "%s%5c%-3.3s%9c", timeBuffer, ' ', getTimeDes(hdr.obsTimeSys).c_str(), ' ');
 		break;
 	case TOLO :		//"TIME OF LAST OBS"
-		formatGPStime (timeBuffer, sizeof timeBuffer, "  %Y    %m    %d    %H    %M  ", "%11.7lf", lastObsWeek, lastObsTOW);
+		timeFormatter.format(timeBuffer, GPStimeFormatter::HDOBS, hdr.lastObsWeek, hdr.lastObsTOW);
 		// fprintf(out, "%s%5c%-3.3s%9c", timeBuffer, ' ', obsTimeSys.c_str(), ' ');
-		fprintf(out, "%s%5c%-3.3s%9c", timeBuffer, ' ', getTimeDes(obsTimeSys).c_str(), ' ');
+		fprintf(out, "%s%5c%-3.3s%9c", timeBuffer, ' ', getTimeDes(hdr.obsTimeSys).c_str(), ' ');
 		break;
 	case CLKOFFS :	//"RCV CLOCK OFFS APPL"
-	 	fprintf(out, "%6d%54c", rcvClkOffs, ' ');
+	 	fprintf(out, "%6d%54c", hdr.rcvClkOffs, ' ');
 		break;
 	case DCBS :		//"SYS / DCBS APPLIED"
-		for (vector<DCBSPCVSapp>::iterator it = dcbsApp.begin(); it != dcbsApp.end(); ++it)
-			if (systems[it->sysIndex].selSystem) {
-				fprintf(out, "%c %-17.17s %-40.40s", systems[it->sysIndex].system, it->corrProg.c_str(), it->corrSource.c_str());
+		for (vector<DCBSPCVSapp>::iterator it = hdr.dcbsApp.begin(); it != hdr.dcbsApp.end(); ++it)
+			if (hdr.systems[it->sysIndex].selSystem) {
+				fprintf(out, "%c %-17.17s %-40.40s", hdr.systems[it->sysIndex].system, it->corrProg.c_str(), it->corrSource.c_str());
 				fprintf(out, "%-20s\n", valueLabel(labelId).c_str());
 			}
 		return;
 	case PCVS :		//"SYS / PCVS APPLIED"
-		for (vector<DCBSPCVSapp>::iterator it = pcvsApp.begin(); it != pcvsApp.end(); ++it)
-			if (systems[it->sysIndex].selSystem) {
-				fprintf(out, "%c %-17.17s %-40.40s", systems[it->sysIndex].system, it->corrProg.c_str(), it->corrSource.c_str());
+		for (vector<DCBSPCVSapp>::iterator it = hdr.pcvsApp.begin(); it != hdr.pcvsApp.end(); ++it)
+			if (hdr.systems[it->sysIndex].selSystem) {
+				fprintf(out, "%c %-17.17s %-40.40s", hdr.systems[it->sysIndex].system, it->corrProg.c_str(), it->corrSource.c_str());
 				fprintf(out, "%-20s\n", valueLabel(labelId).c_str());
 			}
 		return;
 	case SCALE :	//"SYS / SCALE FACTOR"
 		//for each record, print 12 observable types per line (a 1st line + continuation lines if needed)
-        for (vector <OSCALEfact>::iterator it = obsScaleFact.begin(); it != obsScaleFact.end(); it++)
-            if (systems[it->sysIndex].selSystem) {
+        for (vector <OSCALEfact>::iterator it = hdr.obsScaleFact.begin(); it != hdr.obsScaleFact.end(); it++)
+            if (hdr.systems[it->sysIndex].selSystem) {
                 PRINT_SYSREC(it->obsType,
                              12,
-                             fprintf(out, "%c %4d  %2u",  systems[it->sysIndex].system,  it->factor, k),
+                             fprintf(out, "%c %4d  %2u",  hdr.systems[it->sysIndex].system,  it->factor, k),
                              fprintf(out, "%10c", ' '),
                              fprintf(out, " %-3.3s", it->obsType[j].c_str()),
                              fprintf(out, "%4c", ' ') )
@@ -3245,14 +5134,14 @@ void RinexData::printHdLineData(FILE* out, vector<LABELdata>::iterator lbIter) {
 		return;
 	case PHSH :	//"SYS / PHASE SHIFTS"
 		//for each record, print 10 satellites per line (a 1st line + continuation lines if needed)
-        for (vector <PHSHcorr>::iterator it = phshCorrection.begin(); it != phshCorrection.end(); it++)
-            if (systems[it->sysIndex].selSystem) {
+        for (vector <PHSHcorr>::iterator it = hdr.phshCorrection.begin(); it != hdr.phshCorrection.end(); it++)
+            if (hdr.systems[it->sysIndex].selSystem) {
                 if (it->obsCode.empty() && (it->correction == 0.0)) {
-                    fprintf(out, "%c %s%-20s\n", systems[it->sysIndex].system, string(58,' ').c_str(), valueLabel(labelId).c_str());
+                    fprintf(out, "%c %s%-20s\n", hdr.systems[it->sysIndex].system, string(58,' ').c_str(), valueLabel(labelId).c_str());
                 } else {
                     PRINT_SYSREC(it->obsSats,
                                  10,
-                                 fprintf(out, "%c %-3.3s %8.5lf  %2u", systems[it->sysIndex].system, it->obsCode.c_str(), it->correction, k),
+                                 fprintf(out, "%c %-3.3s %8.5lf  %2u", hdr.systems[it->sysIndex].system, it->obsCode.c_str(), it->correction, k),
                                  fprintf(out, "%18c", ' '),
                                  fprintf(out, " %-3.3s", it->obsSats[j].c_str()),
                                  fprintf(out, "%4c", ' ')
@@ -3261,39 +5150,39 @@ void RinexData::printHdLineData(FILE* out, vector<LABELdata>::iterator lbIter) {
             }
         return;
 	case GLSLT:	//*GLONASS SLOT / FRQ #
-		PRINT_SYSREC(gloSltFrq,
+		PRINT_SYSREC(hdr.gloSltFrq,
 					 8,
-					 fprintf(out, "%3d ", (int) gloSltFrq.size()),
+					 fprintf(out, "%3d ", (int) hdr.gloSltFrq.size()),
 					 fprintf(out, "%4c", ' '),
-					 fprintf(out, "R%-2.2d %2d ", gloSltFrq[j].slot, gloSltFrq[j].frqNum),
+					 fprintf(out, "R%-2.2d %2d ", hdr.gloSltFrq[j].slot, hdr.gloSltFrq[j].frqNum),
 					 fprintf(out, "%7c", ' ') )
 		return;
 	case GLPHS:	//"GLONASS COD/PHS/BIS"
-		PRINT_SYSREC(gloPhsBias,
+		PRINT_SYSREC(hdr.gloPhsBias,
 					 4,
 					 fprintf(out, ""),
 					 fprintf(out, ""),
-					 fprintf(out, " %-3.3s %8.3lf", gloPhsBias[j].obsCode.c_str(), gloPhsBias[j].obsCodePhaseBias),
+					 fprintf(out, " %-3.3s %8.3lf", hdr.gloPhsBias[j].obsCode.c_str(), hdr.gloPhsBias[j].obsCodePhaseBias),
 					 fprintf(out, "%13c", ' ') )
 		return;
 	case LEAP :		//"LEAP SECONDS"
-		if (version == V304) {
-			for (vector<LEAPsecs>::iterator it = leapSecs.begin(); it != leapSecs.end(); it++) {
+		if (hdr.version == V304) {
+			for (vector<LEAPsecs>::iterator it = hdr.leapSecs.begin(); it != hdr.leapSecs.end(); it++) {
 				fprintf(out, "%6d%6d%6d%6d", it->secs, it->deltaLSF, it->weekLSF, it->dayLSF);
-				if (leapSysId == 'C') fprintf(out, "BDS%33c", ' ');
+				if (hdr.leapSysId == 'C') fprintf(out, "BDS%33c", ' ');
 				else fprintf(out, "%36c", ' ');
                 fprintf(out, "%-20s\n", valueLabel(labelId).c_str());
 			}
 			return;
 		}
-		fprintf(out, "%6d%54c", leapSecs[0].secs, ' ');
+		fprintf(out, "%6d%54c", hdr.leapSecs[0].secs, ' ');
 		break;
 	case SATS :		//"# OF SATELLITES"
-	 	fprintf(out, "%6d%54c", numOfSat, ' ');
+	 	fprintf(out, "%6d%54c", hdr.numOfSat, ' ');
 		break;
 	case PRNOBS :	//"PRN / # OF OBS"
 		//for each record, print 9 observable types per line (a 1st line + continuation lines if needed)
-        for (vector<PRNobsnum>::iterator it = prnObsNum.begin(); it != prnObsNum.end(); it++) {
+        for (vector<PRNobsnum>::iterator it = hdr.prnObsNum.begin(); it != hdr.prnObsNum.end(); it++) {
             PRINT_SYSREC(it->obsNum,
                          9,
                          fprintf(out, "   %c%-2.2d", it->sysPrn, it->satPrn),
@@ -3304,7 +5193,7 @@ void RinexData::printHdLineData(FILE* out, vector<LABELdata>::iterator lbIter) {
         }
 		return;
 	case IONA :		//"ION ALPHA"			(in GPS NAV version V210)
-		for (vector<CORRECTION>::iterator it = corrections.begin(); it != corrections.end(); it++) {
+		for (vector<CORRECTION>::iterator it = hdr.corrections.begin(); it != hdr.corrections.end(); it++) {
 			if (it->corrType == IONC_GPSA) {
 				fprintf(out, "%2c", ' ');
 				for (i = 0; i < 4; i++) {
@@ -3315,7 +5204,7 @@ void RinexData::printHdLineData(FILE* out, vector<LABELdata>::iterator lbIter) {
 		}
 		return;
 	case IONB :		//"ION BETA"				(in GPS NAV version V210)
-		for (vector<CORRECTION>::iterator it = corrections.begin(); it != corrections.end(); it++) {
+		for (vector<CORRECTION>::iterator it = hdr.corrections.begin(); it != hdr.corrections.end(); it++) {
 			if (it->corrType == IONC_GPSB) {
 				fprintf(out, "%2c", ' ');
 				for (i = 0; i < 4; i++) {
@@ -3326,7 +5215,7 @@ void RinexData::printHdLineData(FILE* out, vector<LABELdata>::iterator lbIter) {
 		}
 		return;
 	case IONC :		//"IONOSPHERIC CORR"		GNSS nav V304
-		for (vector<CORRECTION>::iterator it = corrections.begin(); it != corrections.end(); it++) {
+		for (vector<CORRECTION>::iterator it = hdr.corrections.begin(); it != hdr.corrections.end(); it++) {
 		    if (isIonoCorrection(it->corrType)) {
 				fprintf(out, "%-4.4s ", valueLabel(it->corrType).c_str());
 				for (i = 0; i < 4; i++) {
@@ -3338,7 +5227,7 @@ void RinexData::printHdLineData(FILE* out, vector<LABELdata>::iterator lbIter) {
 		}
 		return;
 	case DUTC :		//"DELTA-UTC: A0,A1,T,W"	(in GPS NAV version V210)
-		for (vector<CORRECTION>::iterator it = corrections.begin(); it != corrections.end(); ++it) {
+		for (vector<CORRECTION>::iterator it = hdr.corrections.begin(); it != hdr.corrections.end(); ++it) {
 			if (it->corrType == TIMC_GPUT) {
 				fprintf(out, "%3c", ' ');
 				for (i = 0; i < 2; i++) fprintf(out, "%19.12lE", it->corrValues[i]);
@@ -3348,7 +5237,7 @@ void RinexData::printHdLineData(FILE* out, vector<LABELdata>::iterator lbIter) {
 		}
 		return;
 	case CORRT:     //"CORR TO SYSTEM TIME"  (in GLONASS NAV version v210)
-        for (vector<CORRECTION>::iterator it = corrections.begin(); it != corrections.end(); ++it) {
+        for (vector<CORRECTION>::iterator it = hdr.corrections.begin(); it != hdr.corrections.end(); ++it) {
             if (it->corrType == TIMC_GLUT) {
                 formatGPStime(timeBuffer, sizeof timeBuffer, "  %Y    %m    %d", "   ", (int) it->corrValues[3], it->corrValues[2]);
                 fprintf(out, "%s%19.12lE", timeBuffer, it->corrValues[0]);
@@ -3357,7 +5246,7 @@ void RinexData::printHdLineData(FILE* out, vector<LABELdata>::iterator lbIter) {
         }
         return;
 	case GEOT:      //"D-UTC A0,A1,T,W,S,U"  (in GEOSTATIONARY NAV version V210)
-		for (vector<CORRECTION>::iterator it = corrections.begin(); it != corrections.end(); ++it) {
+		for (vector<CORRECTION>::iterator it = hdr.corrections.begin(); it != hdr.corrections.end(); ++it) {
             if (it->corrType == TIMC_SBUT) {
                 for (i = 0; i < 2; i++) {
                     fprintf(out, "%19.12lE", it->corrValues[i]);
@@ -3368,7 +5257,7 @@ void RinexData::printHdLineData(FILE* out, vector<LABELdata>::iterator lbIter) {
         }
         return;
 	case TIMC :		//"*TIME SYSTEM CORR"		GNSS nav V304
-		for (vector<CORRECTION>::iterator it = corrections.begin(); it != corrections.end(); ++it) {
+		for (vector<CORRECTION>::iterator it = hdr.corrections.begin(); it != hdr.corrections.end(); ++it) {
             if (isTimeCorrection(it->corrType)) {
                 switch (it->corrType) {
                     case TIMC_GPUT: cnsId = 'G'; break;
@@ -3409,70 +5298,80 @@ void RinexData::printHdLineData(FILE* out, vector<LABELdata>::iterator lbIter) {
 	#undef PRINT_SYSREC
 }
 
+/**setPrintPlan computes for each system the print plan of its observation records: the observables to print (those
+ * printable in the version being printed), in print order, and the columns after which a record line ends
+ * (in V210 lines have five observables at most, and continuation lines follow).
+ * It shall be called when printable observables are stated, that is, when the header is printed.
+ */
+void RinexData::setPrintPlan() {
+    unsigned int maxPerLine = (hdr.version == V210)? 5 : 0;    //maximum observables to print per line (0 = unlimited)
+    for (vector<GNSSsystem>::iterator itsys = hdr.systems.begin(); itsys != hdr.systems.end(); itsys++) {
+        itsys->prtColumns.clear();
+        itsys->prtLineEnd.clear();
+        for (unsigned int i = 0; i < itsys->obsTypes.size(); i++) {
+            if (!itsys->obsTypes[i].prt) continue;
+            itsys->prtColumns.push_back(i);
+            itsys->prtLineEnd.push_back((maxPerLine != 0) && ((itsys->prtColumns.size() % maxPerLine) == 0));
+        }
+        //the last column always ends the record
+        if (!itsys->prtLineEnd.empty()) itsys->prtLineEnd.back() = true;
+    }
+}
+
 /**printSatObsValues prints a line or lines with observable values of the first satellite in epochObs.
- * If the number of observables to print is greather than the maximum number of observable values to be printed
- * in one line, one or several continuation lines would be necessary.
+ * Values are printed as per the print plan of the satellite system (see setPrintPlan): for each column in the plan
+ * the observable value, if any, or a blank field, ending lines where the plan states.
  * After printing observation data of this first satellite, they are removed from the storage.
  * It is assumed that values in the observables storage  belong to the same epoch and are sorted by system,
  * satellite PRN and observable type.
  *
  * @param out the already open print stream where RINEX epoch data will be printed
- * @param ver the RINEX version being printed
  * @return true if they remain observables belonging to the current epoch, false when no data remains to print.
  */
-bool RinexData::printSatObsValues(FILE* out, RINEXversion ver) {
+bool RinexData::printSatObsValues(FILE* out) {
 	double valueToPrint;
 	int lli;
-    vector <SatObsData>::iterator itobs;
 	if (epochObs.empty()) return false;
 	//satellite data to print are those of the firts satellite in epochObs
 	int sysToPrint = epochObs[0].sysIndex;
 	int satToPrint = epochObs[0].satellite;
-    int maxPerLine;         //maximum observables to print per line
-    switch (ver) {
-        case V210: maxPerLine = 5; break;
-        default: maxPerLine = 999;  // 999 = practically unlimited
-    }
-    bool printObs;          //a flag computed to know if current obsType shall be printed or not
-    int nObsPrinted = 0;    //number of observables already printed in the current line
-    //for all observables of the given system, print values if printable and data available
-    for (int i = 0; i < systems[sysToPrint].obsTypes.size(); i++) {
-        //check is value for obsType in position i shall be printed or not
-        printObs = systems[sysToPrint].obsTypes[i].prt;
-        //Check if there are data to print and belongs to the system, satellite and obsType
-        itobs = epochObs.begin();
-        if (!epochObs.empty() && (itobs->sysIndex == sysToPrint) && (itobs->satellite == satToPrint) && (itobs->obsTypeIndex == i)) {
-            if (printObs) {
-                //normal case: there are data for this observable and shall be printed
-                valueToPrint = itobs->obsValue;
-                lli = itobs->lossOfLock;
-                //adjust measurements out of range in the RINEX format 14.3f
-                while (valueToPrint > MAXOBSVAL) {valueToPrint -= 1.E9; lli |= 1;}
-                while (valueToPrint < MINOBSVAL) {valueToPrint += 1.E9; lli |= 1;}
-                fprintf(out, "%14.3lf", valueToPrint);
-                if (lli == 0) fprintf(out, " ");
-                else fprintf(out, "%1d", lli);
-                if (itobs->strength == 0) fprintf(out, " ");
-                else fprintf(out, "%1d", itobs->strength);
-                nObsPrinted++;
-            } else {
-                plog->warning(msgIgnObservable
-                              + to_string((long double) epochTimeTag)
-                              + msgComma + string(1,systems[sysToPrint].system) + to_string((long long) satToPrint)
-                              + msgComma + string(systems[sysToPrint].obsTypes[itobs->obsTypeIndex].id));
-            }
-            epochObs.erase(epochObs.begin());    //remove printed data
-        } else if (printObs) {
-            //there are no data for this observable, but shall be printed
-            fprintf(out, "%14.3lf  ", (double) 0.0);
-            nObsPrinted++;
-        } else continue;    //this obsType has no data and is not printable
-        if ((nObsPrinted % maxPerLine) == 0) {
-            fprintf(out, "\n");
-            nObsPrinted = 0;
+    GNSSsystem &sys = hdr.systems[sysToPrint];
+    unsigned int nColumns = sys.prtColumns.size();
+    unsigned int k = 0;     //the current column in the print plan
+    vector <SatObsData>::iterator itobs;
+    for (itobs = epochObs.begin(); (itobs != epochObs.end()) && (itobs->sysIndex == sysToPrint) && (itobs->satellite == satToPrint); itobs++) {
+        //print blank fields for the columns before the one of this observable
+        for (; (k < nColumns) && (sys.prtColumns[k] < itobs->obsTypeIndex); k++) {
+            fputs(OBS_BLANKFIELD, out);
+            if (sys.prtLineEnd[k]) fputc('\n', out);
+        }
+        if ((k < nColumns) && (sys.prtColumns[k] == itobs->obsTypeIndex)) {
+            //normal case: there are data for this observable and shall be printed
+            valueToPrint = itobs->obsValue;
+            lli = itobs->lossOfLock;
+            //adjust measurements out of range in the RINEX format 14.3f
+            while (valueToPrint > MAXOBSVAL) {valueToPrint -= 1.E9; lli |= 1;}
+            while (valueToPrint < MINOBSVAL) {valueToPrint += 1.E9; lli |= 1;}
+            fprintf(out, "%14.3lf", valueToPrint);
+            if (lli == 0) fprintf(out, " ");
+            else fprintf(out, "%1d", lli);
+            if (itobs->strength == 0) fprintf(out, " ");
+            else fprintf(out, "%1d", itobs->strength);
+            if (sys.prtLineEnd[k]) fputc('\n', out);
+            k++;
+        } else {
+            plog->warning(msgIgnObservable
+                          + to_string((long double) epochTimeTag)
+                          + msgComma + string(1,sys.system) + to_string((long long) satToPrint)
+                          + msgComma + string(sys.obsTypes[itobs->obsTypeIndex].id));
         }
     }
-    if ((nObsPrinted % maxPerLine) != 0) fprintf(out, "\n");
+    //print blank fields for the remaining columns
+    for (; k < nColumns; k++) {
+        fputs(OBS_BLANKFIELD, out);
+        if (sys.prtLineEnd[k]) fputc('\n', out);
+    }
+    epochObs.erase(epochObs.begin(), itobs);    //remove printed data
     return !epochObs.empty();
 }
 
@@ -3525,152 +5424,151 @@ RinexData::RINEXlabel RinexData::readHdLineData (FILE* input) {
 		return DONTMATCH;
 	case VERSION:	//"RINEX VERSION / TYPE"
 		//extract TYPE. In V210: O {N,G,H}. In V304 N, O
-		fileType = lineBuffer[20];
-		fileTypeSfx = string(lineBuffer+21, 19);
+		hdr.fileType = lineBuffer[20];
+		hdr.fileTypeSfx = string(lineBuffer+21, 19);
 		//extract Satellite System: V210= ' ' G R S T M; V300= G R E J C S M
-		sysToPrintId = lineBuffer[40];
-		systemIdSfx = string(lineBuffer+41, 19);
+		hdr.sysToPrintId = lineBuffer[40];
+		hdr.systemIdSfx = string(lineBuffer+41, 19);
 		//extract and verify version, and set values as per V304
 		if(sscanf(lineBuffer, "%9lf", &aDouble) !=1) aDouble = 0;
 		if ((aDouble >= 2) && (aDouble < 3)) {
-			inFileVer = V210;
+			hdr.inFileVer = V210;
 			if (aDouble != 2.1) plog->warning(valueLabel(VERSION, msgProcessV210));
 			//store VERSION parameters as per V304
-			switch (fileType) {
+			switch (hdr.fileType) {
 			case 'O':   //in V210 observation GPS
-				if (sysToPrintId == ' ') {
-                    sysToPrintId = 'G';
-					fileTypeSfx = ":GPS";
+				if (hdr.sysToPrintId == ' ') {
+                    hdr.sysToPrintId = 'G';
+					hdr.fileTypeSfx = ":GPS";
 				}
 				break;
 			case 'N':   //in V210 navigation GPS
-				sysToPrintId = 'G';
-				systemIdSfx = ":GPS";
+				hdr.sysToPrintId = 'G';
+				hdr.systemIdSfx = ":GPS";
 				break;
 			case 'G':   //in V210 navigarion GLONASS
-				fileType = 'N';
-				sysToPrintId = 'R';
-				systemIdSfx = ":GLONASS";
+				hdr.fileType = 'N';
+				hdr.sysToPrintId = 'R';
+				hdr.systemIdSfx = ":GLONASS";
 				break;
 			case 'H':   //in V210 navigation SBAS
-				fileType = 'N';
-				sysToPrintId = 'S';
-				systemIdSfx = ":SBAS";
+				hdr.fileType = 'N';
+				hdr.sysToPrintId = 'S';
+				hdr.systemIdSfx = ":SBAS";
 				break;
 			default:
 				throw string("This version only process Observation or Navigation files");
 			}
 		}
 		else if ((aDouble >= 3) && (aDouble < 4)) {
-			inFileVer = V304;
+			hdr.inFileVer = V304;
 			if (aDouble != 3.04) plog->warning(valueLabel(VERSION, msgProcessV304));
 		}
 		else {
 			plog->warning(valueLabel(VERSION, msgProcessTBD));
-			inFileVer = VTBD;
+			hdr.inFileVer = VTBD;
 		}
 		//set systems for navigation files because they do not have SYS / OBS record
-		if (fileType == 'N' && sysToPrintId != 'M') {
+		if (hdr.fileType == 'N' && hdr.sysToPrintId != 'M') {
 		    strList.clear();
-		    systems.push_back(GNSSsystem(sysToPrintId, strList));
+		    hdr.systems.push_back(GNSSsystem(hdr.sysToPrintId, strList));
 		}
-		plog->finer(valueLabel(VERSION, to_string((long double) aDouble)) + msgSlash + string(1,fileType) + msgSlash + string(1,sysToPrintId));
+		plog->finer(valueLabel(VERSION, to_string((long double) aDouble)) + msgSlash + string(1,hdr.fileType) + msgSlash + string(1,hdr.sysToPrintId));
 		break;
 	case RUNBY:		//"PGM / RUN BY / DATE"
-		pgm = string(lineBuffer, 20);
-		runby = string(lineBuffer + 20, 20);
-		date = string(lineBuffer + 40, 20);
-		plog->finer(valueLabel(RUNBY, pgm + msgSlash + runby));
+		hdr.pgm = string(lineBuffer, 20);
+		hdr.runby = string(lineBuffer + 20, 20);
+		hdr.date = string(lineBuffer + 40, 20);
+		plog->finer(valueLabel(RUNBY, hdr.pgm + msgSlash + hdr.runby));
 		break;
 	case COMM:		//"COMMENT"
-		//the comment read is inserted as a new label (header record) after the lastRecordSet (last record read)
-		//it is used the LABELdata constructor for COMM records
-		lastRecordSet = labelDef.insert(lastRecordSet + 1, LABELdata(string(lineBuffer, 60)));
+		//the comment read is inserted after the lastRecordSet (last record read)
+		insertComment(lastRecordSet + 1, string(lineBuffer, 60));
 		plog->finer(valueLabel(COMM, string(lineBuffer, 60)));
 		return COMM;
 	case MRKNAME:	//"MARKER NAME"
-		markerName = string(lineBuffer, 60);
-		plog->finer(valueLabel(MRKNAME, markerName)); 
+		hdr.markerName = string(lineBuffer, 60);
+		plog->finer(valueLabel(MRKNAME, hdr.markerName)); 
 		break;
 	case MRKNUMBER:	//"MARKER N"
-		markerNumber = string(lineBuffer, 20);
-		plog->finer(valueLabel(MRKNUMBER, markerNumber)); 
+		hdr.markerNumber = string(lineBuffer, 20);
+		plog->finer(valueLabel(MRKNUMBER, hdr.markerNumber)); 
 		break;
 	case MRKTYPE:	//"MARKER TYPE"
-		markerType = string(lineBuffer, 20);
-		plog->finer(valueLabel(MRKTYPE, markerType)); 
+		hdr.markerType = string(lineBuffer, 20);
+		plog->finer(valueLabel(MRKTYPE, hdr.markerType)); 
 		break;
 	case AGENCY:	//"OBSERVER / AGENCY"
-		observer = string(lineBuffer, 20);
-		agency = string(lineBuffer + 20, 40);
-		plog->finer(valueLabel(AGENCY, observer + msgSlash + agency));
+		hdr.observer = string(lineBuffer, 20);
+		hdr.agency = string(lineBuffer + 20, 40);
+		plog->finer(valueLabel(AGENCY, hdr.observer + msgSlash + hdr.agency));
 		break;
 	case RECEIVER:	//"REC # / TYPE / VERS
-		rxNumber = string(lineBuffer, 20);
-		rxType = string(lineBuffer + 20, 20);
-		rxVersion = string(lineBuffer + 40, 20);
-		plog->finer(valueLabel(RECEIVER, rxNumber + msgSlash + rxType + msgSlash + rxVersion));
+		hdr.rxNumber = string(lineBuffer, 20);
+		hdr.rxType = string(lineBuffer + 20, 20);
+		hdr.rxVersion = string(lineBuffer + 40, 20);
+		plog->finer(valueLabel(RECEIVER, hdr.rxNumber + msgSlash + hdr.rxType + msgSlash + hdr.rxVersion));
 		break;
 	case ANTTYPE:	//"ANT # / TYPE"
-		antNumber = string(lineBuffer, 20);
-		antType = string(lineBuffer + 20, 20);
-		plog->finer(valueLabel(ANTTYPE, antNumber + msgSlash + antType));
+		hdr.antNumber = string(lineBuffer, 20);
+		hdr.antType = string(lineBuffer + 20, 20);
+		plog->finer(valueLabel(ANTTYPE, hdr.antNumber + msgSlash + hdr.antType));
 		break;
 	case APPXYZ:	//"APPROX POSITION XYZ"
-		if(sscanf(lineBuffer, "%14lf%14lf%14lf", &aproxX, &aproxY, &aproxZ) != 3) LOG_ERR_AND_RETURN(string())
-		plog->finer(valueLabel(APPXYZ, to_string((long double) aproxX) + msgSlash + to_string((long double) aproxY) + msgSlash + to_string((long double) aproxZ)));
+		if(sscanf(lineBuffer, "%14lf%14lf%14lf", &hdr.aproxX, &hdr.aproxY, &hdr.aproxZ) != 3) LOG_ERR_AND_RETURN(string())
+		plog->finer(valueLabel(APPXYZ, to_string((long double) hdr.aproxX) + msgSlash + to_string((long double) hdr.aproxY) + msgSlash + to_string((long double) hdr.aproxZ)));
 		break;
 	case ANTHEN:		//"ANTENNA: DELTA H/E/N"
-		if(sscanf(lineBuffer, "%14lf%14lf%14lf", &antHigh, &eccEast, &eccNorth) != 3) LOG_ERR_AND_RETURN(string())
-		plog->finer(valueLabel(ANTHEN, to_string((long double) antHigh) + msgSlash + to_string((long double) eccEast) + msgSlash + to_string((long double) eccNorth)));
+		if(sscanf(lineBuffer, "%14lf%14lf%14lf", &hdr.antHigh, &hdr.eccEast, &hdr.eccNorth) != 3) LOG_ERR_AND_RETURN(string())
+		plog->finer(valueLabel(ANTHEN, to_string((long double) hdr.antHigh) + msgSlash + to_string((long double) hdr.eccEast) + msgSlash + to_string((long double) hdr.eccNorth)));
 		break;
 	case ANTXYZ:		//"ANTENNA: DELTA X/Y/Z"	V300
-		if(sscanf(lineBuffer, "%14lf%14lf%14lf", &antX, &antY, &antZ) != 3) LOG_ERR_AND_RETURN(string())
-		plog->finer(valueLabel(ANTXYZ, to_string((long double) antX) + msgSlash + to_string((long double) antY) + msgSlash + to_string((long double) antZ)));
+		if(sscanf(lineBuffer, "%14lf%14lf%14lf", &hdr.antX, &hdr.antY, &hdr.antZ) != 3) LOG_ERR_AND_RETURN(string())
+		plog->finer(valueLabel(ANTXYZ, to_string((long double) hdr.antX) + msgSlash + to_string((long double) hdr.antY) + msgSlash + to_string((long double) hdr.antZ)));
 		break;
 	case ANTPHC:		//"ANTENNA: PHASECENTE"		V300
-		antPhSys = lineBuffer[0];
-		antPhCode = string(lineBuffer+2, 3);
-		if(sscanf(lineBuffer+5, "%9lf%14lf%14lf", &antPhNoX, &antPhEoY, &antPhUoZ) != 3) LOG_ERR_AND_RETURN(string())
-		plog->finer(valueLabel(ANTPHC, string(&antPhSys, 1) + msgSlash + antPhCode + msgSlash + to_string((long double) antPhNoX) + msgSlash + to_string((long double) antPhEoY) + msgSlash + to_string((long double) antPhUoZ)));
+		hdr.antPhSys = lineBuffer[0];
+		hdr.antPhCode = string(lineBuffer+2, 3);
+		if(sscanf(lineBuffer+5, "%9lf%14lf%14lf", &hdr.antPhNoX, &hdr.antPhEoY, &hdr.antPhUoZ) != 3) LOG_ERR_AND_RETURN(string())
+		plog->finer(valueLabel(ANTPHC, string(&hdr.antPhSys, 1) + msgSlash + hdr.antPhCode + msgSlash + to_string((long double) hdr.antPhNoX) + msgSlash + to_string((long double) hdr.antPhEoY) + msgSlash + to_string((long double) hdr.antPhUoZ)));
 		break;
 	case ANTBS:			//"ANTENNA: B.SIGHT XYZ"	V300
-		if(sscanf(lineBuffer, "%14lf%14lf%14lf", &antBoreX, &antBoreY, &antBoreZ) != 3) LOG_ERR_AND_RETURN(string())
-		plog->finer(valueLabel(ANTBS, to_string((long double) antBoreX) + msgSlash + to_string((long double) antBoreY) + msgSlash + to_string((long double) antBoreZ)));
+		if(sscanf(lineBuffer, "%14lf%14lf%14lf", &hdr.antBoreX, &hdr.antBoreY, &hdr.antBoreZ) != 3) LOG_ERR_AND_RETURN(string())
+		plog->finer(valueLabel(ANTBS, to_string((long double) hdr.antBoreX) + msgSlash + to_string((long double) hdr.antBoreY) + msgSlash + to_string((long double) hdr.antBoreZ)));
 		break;
 	case ANTZDAZI:		//"ANTENNA: ZERODIR AZI"	V300
-		if(sscanf(lineBuffer, "%14lf", &antZdAzi) != 1) LOG_ERR_AND_RETURN(string())
-		plog->finer(valueLabel(ANTZDAZI, to_string((long double) antZdAzi)));
+		if(sscanf(lineBuffer, "%14lf", &hdr.antZdAzi) != 1) LOG_ERR_AND_RETURN(string())
+		plog->finer(valueLabel(ANTZDAZI, to_string((long double) hdr.antZdAzi)));
 		break;
 	case ANTZDXYZ:		//"ANTENNA: ZERODIR XYZ"	V300
-		if(sscanf(lineBuffer, "%14lf%14lf%14lf", &antZdX, &antZdY, &antZdZ) !=3) LOG_ERR_AND_RETURN(string())
-		plog->finer(valueLabel(ANTZDXYZ, to_string((long double) antZdX) + msgSlash + to_string((long double) antZdY) + msgSlash + to_string((long double) antZdZ)));
+		if(sscanf(lineBuffer, "%14lf%14lf%14lf", &hdr.antZdX, &hdr.antZdY, &hdr.antZdZ) !=3) LOG_ERR_AND_RETURN(string())
+		plog->finer(valueLabel(ANTZDXYZ, to_string((long double) hdr.antZdX) + msgSlash + to_string((long double) hdr.antZdY) + msgSlash + to_string((long double) hdr.antZdZ)));
 		break;
 	case COFM :			//"CENTER OF MASS XYZ"		V300
-		if(sscanf(lineBuffer, "%14lf%14lf%14lf", &centerX, &centerY, &centerZ) !=3) LOG_ERR_AND_RETURN(string())
-		plog->finer(valueLabel(COFM) + to_string((long double) centerX) + msgSlash + to_string((long double) centerY) + msgSlash + to_string((long double) centerZ));
+		if(sscanf(lineBuffer, "%14lf%14lf%14lf", &hdr.centerX, &hdr.centerY, &hdr.centerZ) !=3) LOG_ERR_AND_RETURN(string())
+		plog->finer(valueLabel(COFM) + to_string((long double) hdr.centerX) + msgSlash + to_string((long double) hdr.centerY) + msgSlash + to_string((long double) hdr.centerZ));
 		break;
 	case WVLEN:			//"WAVELENGTH FACT L1/2"	V210
 		if(sscanf(lineBuffer, "%6d%6d", &i, &j) != 2) LOG_ERR_AND_RETURN(string())
 		if((sscanf(lineBuffer+12, "%6d", &k) == 0) || (k == 0)) {
 			//it is the default wavelength factor header line
-			if (wvlenFactor.empty()) wvlenFactor.push_back(WVLNfactor(i,j));
+			if (hdr.wvlenFactor.empty()) hdr.wvlenFactor.push_back(WVLNfactor(i,j));
 			else {
-				wvlenFactor[0].wvlenFactorL1 = i;
-				wvlenFactor[0].wvlenFactorL2 = j;
+				hdr.wvlenFactor[0].wvlenFactorL1 = i;
+				hdr.wvlenFactor[0].wvlenFactorL2 = j;
 			}
 		} else {
 			//it is a wavelength factor header line with satellite numbers (up to 7)
 			if (k >= 7) LOG_ERR_AND_RETURN(msgNumsat7)
 			for (i = 0, n = 18; i < k; i++, n += 6)
 				strList.push_back(string(lineBuffer+n+3, 3));
-			wvlenFactor.push_back(WVLNfactor(i, j, strList));
+			hdr.wvlenFactor.push_back(WVLNfactor(i, j, strList));
 		}
 		plog->finer(valueLabel(WVLEN, to_string((long long) i) + msgSlash + to_string((long long) j) + ":" + to_string((long long) strList.size())));
 		break;
 	case TOBS:		//"# / TYPES OF OBSERV"		V210
 		if((sscanf(lineBuffer, "%6d", &k) == 0) || (k == 0)) LOG_ERR_AND_RETURN(string())
-		if(sysToPrintId == 'T') LOG_ERR_AND_RETURN(msgTransit);
+		if(hdr.sysToPrintId == 'T') LOG_ERR_AND_RETURN(msgTransit);
 		n = k;	//expected number of types. If n>9 there will be continuation line(s)
 		while (n > 0) {  //get V210 types and convert them to V300 notation
 		    strList.clear();
@@ -3687,13 +5585,13 @@ RinexData::RINEXlabel RinexData::readHdLineData (FILE* input) {
 		}
 		if (k != obsTypeIds.size()) plog->warning(valueLabel(TOBS, msgMisCode));
 		//	store data on observable types
-		if (sysToPrintId == 'M') {
+		if (hdr.sysToPrintId == 'M') {
 		    //when data come from multiple systems, add obsTypeIds for each system in V210
-			systems.push_back(GNSSsystem('G', obsTypeIds));
-			systems.push_back(GNSSsystem('R', obsTypeIds));
-			systems.push_back(GNSSsystem('S', obsTypeIds));
+			hdr.systems.push_back(GNSSsystem('G', obsTypeIds));
+			hdr.systems.push_back(GNSSsystem('R', obsTypeIds));
+			hdr.systems.push_back(GNSSsystem('S', obsTypeIds));
 		}
-		else systems.push_back(GNSSsystem(sysToPrintId, obsTypeIds));
+		else hdr.systems.push_back(GNSSsystem(hdr.sysToPrintId, obsTypeIds));
 		plog->finer(valueLabel(TOBS, to_string((long long) k) + msgTypes));
 		break;
 	case SYS :		//"SYS / # / OBS TYPES"		V300
@@ -3711,42 +5609,42 @@ RinexData::RINEXlabel RinexData::readHdLineData (FILE* input) {
 		}
 		if (k != obsTypeIds.size()) plog->warning(valueLabel(SYS, msgMisCode));
 		//store data on observable types
-		systems.push_back(GNSSsystem(lineBuffer[0], obsTypeIds));
+		hdr.systems.push_back(GNSSsystem(lineBuffer[0], obsTypeIds));
 		plog->finer(valueLabel(SYS, to_string((long long) k) + msgTypes));
 		break;
 	case SIGU :		//"SIGNAL STRENGTH UNIT"
-		signalUnit = string(lineBuffer, 20);
-		plog->finer(valueLabel(SIGU, signalUnit));
+		hdr.signalUnit = string(lineBuffer, 20);
+		plog->finer(valueLabel(SIGU, hdr.signalUnit));
 		break;
 	case INT :		//"INTERVAL"
-		if(sscanf(lineBuffer, "%10lf", &obsInterval) != 1) LOG_ERR_AND_RETURN(string())
-		plog->finer(valueLabel(INT, to_string((long double) obsInterval)));
+		if(sscanf(lineBuffer, "%10lf", &hdr.obsInterval) != 1) LOG_ERR_AND_RETURN(string())
+		plog->finer(valueLabel(INT, to_string((long double) hdr.obsInterval)));
 		break;
 	case TOFO :		//"TIME OF FIRST OBS"
 		if(sscanf(lineBuffer, "%6d%6d%6d%6d%6d%13lf", &year, &month, &day, &hour, &minute, &second) != 6) LOG_ERR_AND_RETURN(string())
 		//use date to obtain first observable time
-		getWeekTowGPSdate (year, month, day, hour, minute, second, firstObsWeek, firstObsTOW);
-		obsTimeSys = getSysId(string(lineBuffer + 48, 3));
-		plog->finer(valueLabel(TOFO, to_string((long long) firstObsWeek) + msgSlash + to_string((long double) firstObsTOW)));
+		getWeekTowGPSdate (year, month, day, hour, minute, second, hdr.firstObsWeek, hdr.firstObsTOW);
+		hdr.obsTimeSys = getSysId(string(lineBuffer + 48, 3));
+		plog->finer(valueLabel(TOFO, to_string((long long) hdr.firstObsWeek) + msgSlash + to_string((long double) hdr.firstObsTOW)));
 		break;
 	case TOLO :		//"TIME OF LAST OBS"
 		if(sscanf(lineBuffer, "%6d%6d%6d%6d%6d%13lf", &year, &month, &day, &hour, &minute, &second) != 6) LOG_ERR_AND_RETURN(string())
 		//use date to obtain last obsrvation time. Time system ignored: same system as per TOFO assumed.
-		getWeekTowGPSdate (year, month, day, hour, minute, second, lastObsWeek, lastObsTOW);
-		plog->finer(valueLabel(TOLO, to_string((long long) lastObsWeek) + msgSlash + to_string((long double) lastObsTOW)));
+		getWeekTowGPSdate (year, month, day, hour, minute, second, hdr.lastObsWeek, hdr.lastObsTOW);
+		plog->finer(valueLabel(TOLO, to_string((long long) hdr.lastObsWeek) + msgSlash + to_string((long double) hdr.lastObsTOW)));
 		break;
 	case CLKOFFS :	//"RCV CLOCK OFFS APPL"
-		if(sscanf(lineBuffer, "%6d", &rcvClkOffs) != 1) LOG_ERR_AND_RETURN(string())
-		plog->finer(valueLabel(CLKOFFS, to_string((long long) rcvClkOffs)));
+		if(sscanf(lineBuffer, "%6d", &hdr.rcvClkOffs) != 1) LOG_ERR_AND_RETURN(string())
+		plog->finer(valueLabel(CLKOFFS, to_string((long long) hdr.rcvClkOffs)));
 		break;
 	case DCBS :		//"SYS / DCBS APPLIED"
 		if ((n = systemIndex(lineBuffer[0])) < 0) LOG_ERR_AND_RETURN(msgSysUnk)
-		dcbsApp.push_back(DCBSPCVSapp(n, string(lineBuffer + 1, 17), string(lineBuffer + 20, 40)));
+		hdr.dcbsApp.push_back(DCBSPCVSapp(n, string(lineBuffer + 1, 17), string(lineBuffer + 20, 40)));
 		plog->finer(valueLabel(DCBS, string(" for sys ") + string(1, lineBuffer[0])));
 		break;
 	case PCVS :		//"SYS / PCVS APPLIED"
 		if ((n = systemIndex(lineBuffer[0])) < 0) LOG_ERR_AND_RETURN(msgSysUnk)
-		pcvsApp.push_back(DCBSPCVSapp(n, string(lineBuffer + 1, 17), string(lineBuffer + 20, 40)));
+		hdr.pcvsApp.push_back(DCBSPCVSapp(n, string(lineBuffer + 1, 17), string(lineBuffer + 20, 40)));
 		plog->finer(valueLabel(DCBS, string(" for sys ") + string(1, lineBuffer[0])));
 		break;
 	case SCALE :	//"SYS / SCALE FACTOR"
@@ -3767,7 +5665,7 @@ RinexData::RINEXlabel RinexData::readHdLineData (FILE* input) {
 		}
 		if (j != obsTypeIds.size()) plog->warning(valueLabel(SCALE, msgMisCode));
 		//store data on observable types
-		obsScaleFact.push_back(OSCALEfact(i, k, obsTypeIds));
+		hdr.obsScaleFact.push_back(OSCALEfact(i, k, obsTypeIds));
 		plog->finer(valueLabel(SCALE, to_string((long long) k) + " scale for " + to_string((long long) j) + msgTypes));
 		break;
 	case PHSH :		//"SYS / PHASE SHIFTS"
@@ -3788,7 +5686,7 @@ RinexData::RINEXlabel RinexData::readHdLineData (FILE* input) {
 		}
 		if (j != obsTypeIds.size()) plog->warning(valueLabel(PHSH, msgMisCode));
 		//store data on observable types
-		phshCorrection.push_back(PHSHcorr(i, string(lineBuffer+2, 3), aDouble, obsTypeIds));
+		hdr.phshCorrection.push_back(PHSHcorr(i, string(lineBuffer+2, 3), aDouble, obsTypeIds));
 		plog->finer(valueLabel(PHSH, msgPhPerType + to_string((long double) aDouble) + msgComma + to_string((long long) j)));
 		break;
 	case GLSLT :	//"GLONASS SLOT / FRQ #"
@@ -3798,7 +5696,7 @@ RinexData::RINEXlabel RinexData::readHdLineData (FILE* input) {
 			while (n > 0) {
 				if(sscanf(lineBuffer+k+1, "%2d", &j) == 0) plog->warning(valueLabel(GLSLT,msgNoSlot));
 				else if(sscanf(lineBuffer+k+4, "%2d", &i) == 0) plog->warning(valueLabel(GLSLT, msgNoFreq));
-				else gloSltFrq.push_back(GLSLTfrq(j, i));
+				else hdr.gloSltFrq.push_back(GLSLTfrq(j, i));
 				n--;
 				k += 6;
 				if (k > 46) {	//read a continuation line and verify its label
@@ -3806,7 +5704,7 @@ RinexData::RINEXlabel RinexData::readHdLineData (FILE* input) {
 				}
 			}
 		}
-		if (j != gloSltFrq.size()) plog->warning(valueLabel(GLSLT, msgMisSlots));
+		if (j != hdr.gloSltFrq.size()) plog->warning(valueLabel(GLSLT, msgMisSlots));
 		plog->finer(valueLabel(GLSLT, to_string((long long) j) + msgSlots));
 		break;
 	case LEAP :		//"LEAP SECONDS"
@@ -3822,17 +5720,17 @@ RinexData::RINEXlabel RinexData::readHdLineData (FILE* input) {
         else k = stoi(string(lineBuffer + 18, 6));
         //check if this data is already stored
         readOK = true;  //it means here that leapSecs record shall be added
-        for (vector<LEAPsecs>::iterator it = leapSecs.begin(); readOK && it != leapSecs.end(); it++) {
+        for (vector<LEAPsecs>::iterator it = hdr.leapSecs.begin(); readOK && it != hdr.leapSecs.end(); it++) {
             if ((it->sysId == aChar) && (n == it->secs)) readOK = false;
         }
         if (readOK) {
-            leapSecs.push_back(LEAPsecs(n, i, j, k, aChar));
+            hdr.leapSecs.push_back(LEAPsecs(n, i, j, k, aChar));
             plog->finer(valueLabel(LEAP, to_string((long long) n)));
         }
 		break;
 	case SATS :		//"# OF SATELLITES"
-		if(sscanf(lineBuffer, "%6d", &numOfSat) != 1) LOG_ERR_AND_RETURN(string())
-		plog->finer(valueLabel(SATS, to_string((long long) numOfSat)));
+		if(sscanf(lineBuffer, "%6d", &hdr.numOfSat) != 1) LOG_ERR_AND_RETURN(string())
+		plog->finer(valueLabel(SATS, to_string((long long) hdr.numOfSat)));
 		break;
 	case PRNOBS :	//"PRN / # OF OBS"
 		//get the list with the number of observables
@@ -3845,13 +5743,13 @@ RinexData::RINEXlabel RinexData::readHdLineData (FILE* input) {
 			prnobs.sysPrn = lineBuffer[3];
 			prnobs.satPrn = k;
 			prnobs.obsNum = anIntLst;
-			prnObsNum.push_back(prnobs);
+			hdr.prnObsNum.push_back(prnobs);
 		} else {
 			//It is a continuation line of the last PRNOBS read
-			if (prnObsNum.empty()) LOG_ERR_AND_RETURN(msgWrongCont)
-			prnObsNum.back().obsNum.insert(prnObsNum.back().obsNum.end(), anIntLst.begin(), anIntLst.end());
+			if (hdr.prnObsNum.empty()) LOG_ERR_AND_RETURN(msgWrongCont)
+			hdr.prnObsNum.back().obsNum.insert(hdr.prnObsNum.back().obsNum.end(), anIntLst.begin(), anIntLst.end());
 		}
-		plog->finer(valueLabel(PRNOBS, string(1, prnObsNum.back().sysPrn) + msgSlash + to_string((long long) prnObsNum.back().obsNum.size())));
+		plog->finer(valueLabel(PRNOBS, string(1, hdr.prnObsNum.back().sysPrn) + msgSlash + to_string((long long) hdr.prnObsNum.back().obsNum.size())));
 		break;
 	case IONA:
         //TODO implement reader
@@ -3888,7 +5786,7 @@ RinexData::RINEXlabel RinexData::readHdLineData (FILE* input) {
 				default:
 					break;
 			}
-			corrections.push_back(aCorrection);
+			hdr.corrections.push_back(aCorrection);
 			plog->finer(valueLabel(IONC, msgDataRead));
         }
         else plog->warning(valueLabel(IONC, msgErrCorr));
@@ -3929,7 +5827,7 @@ RinexData::RINEXlabel RinexData::readHdLineData (FILE* input) {
 				default:
 					break;
 			}
-			corrections.push_back(aCorrection);
+			hdr.corrections.push_back(aCorrection);
         	plog->finer(valueLabel(TIMC, msgDataRead));
         }
         else plog->warning(valueLabel(TIMC, msgErrCorr));
@@ -3966,17 +5864,40 @@ bool RinexData::readRinexRecord(char* rinexRec, int recSize, FILE* input) {
 	return false;
 }
 
+/**readRinexRecord reads from a memory buffer a line as per readRinexRecord from a file.
+ *
+ * @param rinexRec a pointer to a record buffer
+ * @param recSize the size in bytes of the record buffer
+ * @param cursor the current position in the memory buffer. It is updated to the start of the next line
+ * @param end the position just after the last char in the memory buffer
+ * @return true if the end of the memory buffer is reached, false otherwise
+ */
+bool RinexData::readRinexRecord(char* rinexRec, int recSize, const char* &cursor, const char* end) const {
+	size_t obsLen;
+	do {
+		if (cursor >= end) return true;
+		//copy up to the end of line or recSize - 1 chars, as fgets does
+		for (obsLen = 0; (cursor < end) && (obsLen < (size_t) recSize - 1); ) {
+			rinexRec[obsLen++] = *cursor;
+			if (*(cursor++) == '\n') break;
+		}
+		obsLen--;
+		memset(rinexRec + obsLen, ' ', recSize - obsLen);
+	} while (isBlank(rinexRec, recSize-1));
+	return false;
+}
+
 /**isSatSelected checks if the given system and satellite are selected.
  * Note that for a system selected an empty list of satellites is considered as ALL SELECTED
  * @param sysIx the given system index in the systems vector 
  * @param sat the given satellite number 
  * @return true when the given system is selected and the satellite is in the list of selected ones or the list is empty, false otherwise
  */
-bool RinexData::isSatSelected(int sysIx, int sat) {
+bool RinexData::isSatSelected(int sysIx, int sat) const {
     if (sysIx < 0) return false;
-    if (!systems[sysIx].selSystem) return false;
-	if (systems[sysIx].selSat.empty()) return true;
-	for (vector<int>::iterator its = systems[sysIx].selSat.begin(); its != systems[sysIx].selSat.end(); its++)
+    if (!hdr.systems[sysIx].selSystem) return false;
+	if (hdr.systems[sysIx].selSat.empty()) return true;
+	for (vector<int>::const_iterator its = hdr.systems[sysIx].selSat.begin(); its != hdr.systems[sysIx].selSat.end(); its++)
 		if ((*its) == sat) return true;
 	return false;
 }
@@ -3986,9 +5907,9 @@ bool RinexData::isSatSelected(int sysIx, int sat) {
  * @param sysCode the one character system code (G, R, S, E, ...)
  * @return the index of the given system code in the systems vector, or -1 if it is not in the vector
  */
-int RinexData::systemIndex(char sysId) {
-	for (int i = 0; i < (int) systems.size(); i++)
-		if (systems[i].system == sysId) return i;
+int RinexData::systemIndex(char sysId) const {
+	for (int i = 0; i < (int) hdr.systems.size(); i++)
+		if (hdr.systems[i].system == sysId) return i;
 	return -1;
 }
 
@@ -3998,7 +5919,7 @@ int RinexData::systemIndex(char sysId) {
  * @return the index inside the vector system for it
  * @throws error string with the related message
  */
-unsigned int RinexData::getSysIndex(char sysId) {
+unsigned int RinexData::getSysIndex(char sysId) const {
     int inx;
     if ((inx = systemIndex(sysId)) >= 0) return (unsigned int) inx;
     throw msgSysUnk + string(1, sysId);
@@ -4042,43 +5963,43 @@ string RinexData::getTimeDes(char s) {
  */
 void RinexData::setSuffixes() {
     const string desOBS = "BSERVATION DATA";
-    if (version == V210) {
-        switch (fileType) {
+    if (hdr.version == V210) {
+        switch (hdr.fileType) {
             case 'O':   //observation
-                fileTypeSfx = desOBS;
-                systemIdSfx = getSysDes(sysToPrintId);
+                hdr.fileTypeSfx = desOBS;
+                hdr.systemIdSfx = getSysDes(hdr.sysToPrintId);
                 break;
             case 'N':
-                fileTypeSfx = "AVIGATION GPS DATA";
-                systemIdSfx = getSysDes('G');
+                hdr.fileTypeSfx = "AVIGATION GPS DATA";
+                hdr.systemIdSfx = getSysDes('G');
                 break;
             case 'G':
-                fileTypeSfx = "LONASS NAVIGATION";
-                systemIdSfx = getSysDes('R');
+                hdr.fileTypeSfx = "LONASS NAVIGATION";
+                hdr.systemIdSfx = getSysDes('R');
                 break;
             case 'L':
-                fileTypeSfx = " GALILEO NAVIGATION";
-                systemIdSfx = getSysDes('E');
+                hdr.fileTypeSfx = " GALILEO NAVIGATION";
+                hdr.systemIdSfx = getSysDes('E');
                 break;
             case 'B':
-                fileTypeSfx = " SBAS NAVIGATION";
-                systemIdSfx = getSysDes('S');
+                hdr.fileTypeSfx = " SBAS NAVIGATION";
+                hdr.systemIdSfx = getSysDes('S');
                 break;
             default:
                 break;
         }
     } else { //it is assumed V310
-        switch (fileType) {
+        switch (hdr.fileType) {
             case 'O':   //observation
-                fileTypeSfx = desOBS;
+                hdr.fileTypeSfx = desOBS;
                 break;
             case 'N':
-                fileTypeSfx = "AVIGATION DATA";
+                hdr.fileTypeSfx = "AVIGATION DATA";
                 break;
             default:
                 break;
         }
-        systemIdSfx = getSysDes(sysToPrintId);
+        hdr.systemIdSfx = getSysDes(hdr.sysToPrintId);
     }
 }
 
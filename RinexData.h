@@ -28,9 +28,15 @@
 
 #include <vector>
 #include <string>
+#include <bitset>
 #include <algorithm>
+#include <queue>
+#include <unordered_map>
+#include <memory>
 
 #include "Logger.h"	//from CommonClasses
+#include "Utilities.h"	//from CommonClasses
+#include "RinexObsStore.h"	//from CommonClasses
 
 using namespace std;
 
@@ -72,6 +78,7 @@ const string IONO_BDSB_DES("BDSB");
 
 const double MAXOBSVAL = 9999999999.999; //the maximum value for any observable to fit the F14.4 RINEX format
 const double MINOBSVAL = -999999999.999; //the minimum value for any observable to fit the F14.4 RINEX format
+const char OBS_BLANKFIELD[] = "         0.000  ";   //the field printed in observation records for an observable without data
 //Mask values to define RINEX header record/label type
 const unsigned int NAP = 0x00;		//Not applicable for the given file type
 const unsigned int OBL = 0x01;		//Obligatory
@@ -99,6 +106,7 @@ const string msgNoFlag(" Missed flag.");
 const string msgGetHdLn(" (getHdLnData)");
 const string msgHdRecNoData(" is obligatory, but has not data");
 const string msgNotInSYS("NOT in SYS/TOBS records");
+const string msgSysObs(" the system, in observable=");
 const string msgNotSys("Satellite systems not defined or none selected");
 const string msgSatOrSp(" Missed number of sats or special records.");
 const string msgSetHdLn(" (setHdLnData)");
@@ -106,6 +114,7 @@ const string msgSysUnk("Satellite system code unknown=");
 const string msgUnexpObsEOF("Unexpected EOF in observation record");
 const string msgVerTBD("Undefined version to print");
 const string msgWrongDate("Wrong date-time");
+const string msgWrongClkOffs(" Wrong receiver clock offset.");
 const string msgWrongFlag(" Wrong flag");
 const string msgWrongPRN("Wrong PRN");
 const string msgNoLabel("No header label found in ");
@@ -153,8 +162,19 @@ const string msgNoMem(". NOT SAVED:");
 const string msgNoBO("Error Broad.Orb. less than expected");
 const string msgBadFileName("Output file name cannot be set");
 const string msgWrongVer("Wrong data in RINEX VERSION / TYPE record");
+const string msgMergeNoFirst("Merge not started: cannot read the header of the first input file");
+const string msgMergeSkipFile("Merge: ignored input file with unknown version, position=");
+const string msgMergeSkipEpoch("Merge: discarded epoch in input file ");
+const string msgStatus(", status=");
+const string msgSplitNoFile("Split: cannot open output file ");
 
 const string errorLabelMis("Internal error. Wrong argument types in RINEX label identifier=");
+//Identification of RinexData checkpoint data (see saveCheckpoint), format version, number of items in its layout (the version
+//and the sizes of data types written as stored in memory), and maximum size of vectors in them
+const char RINEX_CKP_TAG[] = "RINEXDATA CKP";
+const unsigned int RINEX_CKP_VERSION = 2;
+const int RINEX_CKP_LAYOUTSIZE = 6;
+const unsigned int RINEX_CKP_MAXITEMS = 1000000;
 //time constant
 const struct tm UTCepoch = {.tm_sec = 0,.tm_min = 0,.tm_hour = 0,.tm_mday = 1,.tm_mon = 0,.tm_year = 70,
                             .tm_wday = 0, .tm_yday = 0, .tm_isdst = -1};
@@ -207,6 +227,56 @@ const struct tm UTCepoch = {.tm_sec = 0,.tm_min = 0,.tm_hour = 0,.tm_mday = 1,.t
  * -# Use method readObsEpoch to read an epoch data from the input RINEX observation file.
  * -# Get needed observation data from this epoch using getObsData
  * -# Repeat former two steps while epoch data exist.
+ *<p>When only some time windows of a RINEX observation file are needed, the sequential reading can be avoided using an epoch index:
+ * -# After readRinexHeader, use buildObsEpochIndex to scan the file (or load a previously saved sidecar index file) obtaining
+ *    the byte offset, time and flag of each epoch.
+ * -# Use seekObsEpoch to position the input file at the first epoch at or after a given time, and readObsEpoch to read from there, or
+ * -# Use readObsEpochRange repeatedly to read the epochs inside a given time interval.
+ *<p>Large RINEX V3.04 observation files can be read using several processor cores with readObsEpochsParallel. After readRinexHeader,
+ *this method splits the rest of the file in chunks aligned to epoch lines, parses them concurrently, and delivers each epoch in file
+ *order calling a function provided by the user, where epoch data can be obtained using getEpochTime and getObsData as per readObsEpoch.
+ *<p>When the whole observation file is to be processed in memory (time series of a satellite observable, for example), the method
+ *readObsFile loads all epochs into a RinexObsStore object, where observables are stored by columns. Epochs obtained from other sources
+ *(GRD or OSP receiver data, for example) can be added to a store using storeObsEpoch instead of printObsEpoch.
+ *<p>To avoid parsing again RINEX text files, observation and navigation data can be exported to a binary columnar file (see ColumnarFile):
+ * -# Use ColumnarFile::beginWrite to start the file.
+ * -# Use RinexObsStore::writeColumnar to write the observation data in a store, and / or writeNavColumnar to write navigation data stored
+ *    or all the records in a RINEX navigation file.
+ * -# Use ColumnarFile::endWrite to end the file.
+ *<p>These data can be later obtained using ColumnarFile::load, and RinexObsStore::readColumnar and / or readNavColumnar.
+ *<p>Several RINEX observation files (consecutive sessions, or overlapping files from several receivers) can be merged in one output
+ *file, reading them concurrently and holding in memory only one epoch of each file:
+ * -# Use openObsMerge to read the headers of all input files. Header data are set from the first file, with the union of
+ *    systems and observable types of all of them, and the time of first / last observation covering all of them.
+ * -# Set any other header data needed and print them using printObsHeader.
+ * -# Use readMergedObsEpoch to get the epochs in time order, and print them using printObsEpoch. Epochs with the same time in
+ *    several files are delivered once, with the observables of all of them (duplicated observables are discarded).
+ * -# Use closeObsMerge when done.
+ *<p>The method mergeObsFiles performs all these steps.
+ *<p>Observation data can be printed in several files, each one containing the epochs in a given time window (hourly, daily, ...),
+ *in only one pass over input data:
+ * -# Set header data as per printing one observation file.
+ * -# Use openObsSplit to state the window length and the data to name output files (see getObsFileName).
+ * -# For each epoch, set its data as per printing one file, and use printObsEpochSplit instead of printObsEpoch.
+ *    The header of each file is printed when its first epoch is printed.
+ * -# Use closeObsSplit when done. TIME OF FIRST OBS and TIME OF LAST OBS of each file are updated when it is closed.
+ *<p>Observation data can be printed at the same time in several output files of different versions (f.e. a V2.10 and a V3.04
+ *file), in only one pass over input data:
+ * -# Set header data as per printing one observation file.
+ * -# Use addObsTarget to state each output file and the version to print in it.
+ * -# Use printObsHeaderTargets to print the header in all of them.
+ * -# For each epoch, set its data as per printing one file, and use printObsEpochTargets instead of printObsEpoch. Epoch data
+ *    are filtered and formatted for each output as per its version.
+ * -# Use endObsTargets when done. TIME OF FIRST OBS and TIME OF LAST OBS records of each file are updated with their current data.
+ *<p>When the same header data are needed in several outputs (V2.10 and V3.04 files from one input, or one writer per thread),
+ *getHeaderSnapshot captures them once (after readRinexHeader or setting them) in an immutable object that can be shared,
+ *and each writer is created from it using the constructors having a snapshot parameter. Writers do not share epoch data.
+ *<p>Conversions of input files which grow along time can be resumed: saveCheckpoint writes to a binary file the header data,
+ *the current epoch state and the position of the TIME OF FIRST OBS and TIME OF LAST OBS records in the last header printed.
+ *A later process can restore them using restoreCheckpoint, append new epochs to the existing output file, and update its
+ *observation times using updateObsTimes.
+ *<p>When only the main metadata of observation files are needed (to catalog them, for example), probeObsFile obtains them
+ *reading only the header and, if TIME OF LAST OBS is not given, the last epoch, found searching backwards from the end of the file.
  *<p>To obtain satellite ephemeris data from RINEX navigation files the process would be similar:
  * -# Create a RinexData object
  * -# Use method readRinexHeader to read from the input RINEX file header records data and store them into the RinexData object.
@@ -221,6 +291,10 @@ const struct tm UTCepoch = {.tm_sec = 0,.tm_min = 0,.tm_hour = 0,.tm_mday = 1,.t
  */
 class RinexData {
 public:
+	/// The type of the function called by readObsEpochsParallel to deliver each epoch read. It returns false to stop reading
+	typedef bool (*ObsEpochConsumer)(RinexData &rinex, int status, void* userData);
+	/// The header data of a RinexData object, as captured by getHeaderSnapshot
+	struct HDRdata;
 	/// RINEX versions known in the current implementation of this class
 	enum RINEXversion {
 		V210 = 0,		///< RINEX version V2.10
@@ -304,12 +378,36 @@ public:
 		DONTMATCH,	///< Label do not match with RINEX version (to manage error messages)
 		LASTONE		///< Las item: last RINEXlabel. Also EOF found when reading.
 		};
+	/// The main metadata of a RINEX observation file, as obtained by probeObsFile
+	struct OBSmetadata {
+		RINEXversion version;	///< the version of the file
+		string markerName;		///< data from MARKER NAME and MARKER NUMBER records
+		string markerNumber;
+		string rxNumber;		///< data from REC # / TYPE / VERS record
+		string rxType;
+		string rxVersion;
+		string antNumber;		///< data from ANT # / TYPE record
+		string antType;
+		double aproxX;			///< data from APPROX POSITION XYZ record (0.0 if not given)
+		double aproxY;
+		double aproxZ;
+		double interval;		///< data from INTERVAL record (0.0 if not given)
+		string systems;			///< the identifiers of the systems with observables (G, R, E, ...)
+		int firstWeek;			///< week and TOW of the first epoch
+		double firstTOW;
+		int lastWeek;			///< week and TOW of the last epoch
+		double lastTOW;
+		bool lastFromHeader;	///< true if the last epoch time was taken from TIME OF LAST OBS, false if from the last epoch
+	};
 	//constructors & destructor
 	RinexData(RINEXversion ver, Logger* plogger);
 	RinexData(RINEXversion ver);
 	RinexData(RINEXversion ver, string prg, string rby, Logger* plogger);
 	RinexData(RINEXversion ver, string prg, string rby);
+	RinexData(RINEXversion ver, const shared_ptr<const HDRdata> &snapshot, Logger* plogger);
+	RinexData(RINEXversion ver, const shared_ptr<const HDRdata> &snapshot);
 	~RinexData(void);
+	shared_ptr<const HDRdata> getHeaderSnapshot() const;
 	//methods to set RINEX line header record data values storing them in the RinexData object
 	bool setHdLnData(RINEXlabel rl, RINEXlabel a, const string &b);
 	bool setHdLnData(RINEXlabel rl, RINEXlabel a, const double (&b)[4], int c, int d);
@@ -377,6 +475,32 @@ public:
 	RINEXlabel readRinexHeader(FILE* input);
 	int readObsEpoch(FILE* input);
 	int readNavEpoch(FILE* input);
+	int buildObsEpochIndex(FILE* input, string indexFileName = string());
+	bool seekObsEpoch(FILE* input, double time);
+	int readObsEpochRange(FILE* input, double fromTime, double toTime);
+	int readObsEpochsParallel(FILE* input, ObsEpochConsumer consumer, void* userData, unsigned int nThreads = 0);
+	int readObsFile(FILE* input, RinexObsStore &store);
+	int storeObsEpoch(RinexObsStore &store);
+	bool writeNavColumnar(ColumnarFile &out);
+	bool writeNavColumnar(FILE* input, ColumnarFile &out);
+	int readNavColumnar(const ColumnarFile &in);
+	bool openObsMerge(vector<FILE*> &inputs);
+	int readMergedObsEpoch();
+	void closeObsMerge();
+	int mergeObsFiles(vector<FILE*> &inputs, FILE* out);
+	bool openObsSplit(double windowSecs, string prefix, string country = "---", string path = string(), unsigned int maxOpen = 2);
+	bool printObsEpochSplit();
+	void closeObsSplit();
+	bool addObsTarget(FILE* out, RINEXversion ver);
+	void printObsHeaderTargets();
+	void printObsEpochTargets();
+	void endObsTargets();
+	int mergeNavFiles(vector<FILE*> &inputs, FILE* out, unsigned int nThreads = 0);
+	//methods to resume conversions
+	bool saveCheckpoint(FILE* out);
+	bool restoreCheckpoint(FILE* in);
+	bool updateObsTimes(FILE* out);
+	bool probeObsFile(FILE* input, OBSmetadata &meta);
 
 private:
 	struct LABELdata {	        //A template for data related to each defined RINEX label and related record
@@ -384,28 +508,28 @@ private:
 		const char* labelVal;	//The RINEX label value in columns 61-80
 		RINEXversion ver;	//The RINEX version where this label is defined
 		unsigned int type;	//The type of the record with this label
-		bool hasData;		//If there are data stored for this record or not
-		string comment;
-		//Constructor for most labelID (except COMM)
-		LABELdata (RINEXlabel lId, const char* lVal, RINEXversion v, unsigned int t) {
-			labelID = lId;
-			labelVal = lVal;
-			ver = v;
-			type = t;
-			hasData = false;
-		}
-		//Constructor for labelID COMM
-		LABELdata (string c) {
-			labelID = COMM;
-			labelVal = "COMMENT";
-			ver = VALL;
-			type = OBSOPT + NAVOPT;
-			hasData = true;
-			comment = c;
+	};
+	static const LABELdata labelDef[LASTONE + 1];	//The definitions of all RINEX header labels, indexed by their RINEXlabel
+	struct LABELindex {		//A perfect hash index to identify labels by their value
+		static const unsigned int SIZE = 512;	//the number of slots in the index (a power of 2)
+		unsigned int seed;		//the seed of the hash function giving a different slot to each label
+		unsigned char slot[SIZE];	//the label identifier for each slot (NOLABEL if empty)
+		unsigned char length[LASTONE + 1];	//the length of each label value without trailing blanks
+		LABELindex();
+		static unsigned int hash(const char* label, size_t len, unsigned int seed);
+		RINEXlabel find(const char* label, size_t len) const;
+	};
+	static const LABELindex& labelIndex();
+	struct HDcomment {	//A comment record in the header
+		unsigned int pos;	//the RINEXlabel of the record before which the comment is placed
+		string text;		//the comment
+		HDcomment(unsigned int p, const string &t) {
+			pos = p;
+			text = t;
 		}
 	};
-	vector <LABELdata> labelDef;	//A place to store data for all RINEX header labels
-	unsigned int labelIdIdx;		//an index to iterater over labelDef with get1stLabelId and getNextLabelId 
+	unsigned int labelIdIdx;		//indexes to iterate over labels and comments with get1stLabelId and getNextLabelId
+	unsigned int commentIdx;
     struct SYSdescript {     //A template to define a table containing descriptions related to syste identification
         char sysId;         //the system identification (G, R, E, C, ...)
         string timeDes;     //the related system time description
@@ -418,67 +542,7 @@ private:
         }
     };
     vector <SYSdescript> sysDescript;
-	//RINEX header data grouped by line type/label
-	//"RINEX VERSION / TYPE"
-	RINEXversion inFileVer;	//The RINEX version of the input file (when applicable)
-	RINEXversion version;	//The RINEX version of the output file
-	char fileType;			//V210:O, N(GPS nav), G(GLONASS nav), H(Geo nav), ...; V304:O, N, M
-	string fileTypeSfx;		//a suffix to better describe the file type
-	char sysToPrintId;		//System to print identifier: V210=G(GPS), R(GLO), S(SBAS), T, M(multiple); V304=G, R, E (Galileo), J, C, S, M
-	string systemIdSfx;		//a suffix to better describe the system
-	//"PGM / RUN BY / DATE"
-	string pgm;				//Program used to create current file
-	string runby;			//Who executed the program
-	string date;			//Date and time of file creation
-	//"MARKER NAME"
-	string markerName;		//Name of antenna marker
-	//"* MARKER NUMBER"
-	string markerNumber;	//Number of antenna marker (HUMAN)
-	//"MARKER TYPE"
-	string markerType;		//Marker type as per V304
-	//"OBSERVER / AGENCY"
-	string observer;		//Name of observer
-	string agency;			//Name of agency
-	//"REC # / TYPE / VERS
-	string rxNumber;		//Receiver number
-	string rxType;			//Receiver type
-	string rxVersion;		//Receiver version (e.g. Internal Software Version)
-	//"ANT # / TYPE"
-	string antNumber;		//Antenna number
-	string antType;			//Antenna type
-	//"APPROX POSITION XYZ"
-	double aproxX;			//Geocentric approximate marker position
-	double aproxY;
-	double aproxZ;
-	//"ANTENNA: DELTA H/E/N"
-	double antHigh;		//Antenna height: Height of the antenna reference point (ARP) above the marker
-	double eccEast;		//Horizontal eccentricity of ARP relative to the marker (east/north)
-	double eccNorth;
-	//"* ANTENNA: DELTA X/Y/Z"	V304
-	double antX;
-	double antY;
-	double antZ;
-	//"* ANTENNA: PHASECENTER"	V304
-	char antPhSys;
-	string antPhCode;
-	double antPhNoX;
-	double antPhEoY;
-	double antPhUoZ;
-	//"* ANTENNA: B.SIGHT XYZ"	V304
-	double antBoreX;
-	double antBoreY;
-	double antBoreZ;
-	//"* ANTENNA: ZERODIR AZI"	V304
-	double antZdAzi;
-	//"* ANTENNA: ZERODIR XYZ"	V304
-	double antZdX;
-	double antZdY;
-	double antZdZ;
-	//"* CENTER OF MASS XYZ"	V304
-	double centerX;
-	double centerY;
-	double centerZ;
-	//"WAVELENGTH FACT L1/2"	V210
+	//types of RINEX header data
 	struct WVLNfactor {
 		int wvlenFactorL1;  //1:Full cycle ambiguities; 2:Half cycle ambiguities (squaring)
 		int wvlenFactorL2;  //1,2 as above; 0: Single frequency instrument
@@ -494,9 +558,6 @@ private:
 			satNums = sats;
 		}
 	};
-	vector <WVLNfactor> wvlenFactor;
-	//"# / TYPES OF OBSERV"		V210
-	//"SYS / # / OBS TYPES"		V304
     struct OBSmeta {    //Defines metadata to manage observables
         string id;  //identifier of each obsType type: C1C, L1C, D1C, S1C... (see RINEX V304 document: 5.1 Observation codes)
         bool sel;   //if true, the obsType is selected, that is, their data will be taken into account
@@ -513,6 +574,9 @@ private:
 		bool selSystem;	//a flag stating if the system is selected (will pass filtering or not)
         vector <OBSmeta> obsTypes;
         vector <int> selSat;       //the list of selected satelites to be printed. If empty all of them will be printed
+        vector <unsigned int> obsColumns;  //the index in obsTypes of each observable, in the order given (the order of columns in observation records)
+        vector <unsigned int> prtColumns;  //the print plan: the index in obsTypes of each observable printed in epoch records, in print order
+        vector <bool> prtLineEnd;   //for each column in prtColumns, true if the record line ends after printing it
 		//constructor
 		//GNSSsystem (char sys, const vector<string> &obsT) {
         GNSSsystem (char sys, vector<string> obsT) {
@@ -526,25 +590,11 @@ private:
             for (vector<string>::iterator iti = obsT.begin(); iti != obsT.end(); iti++) {
                 for (itobs = obsTypes.begin(); (itobs != obsTypes.end()) && ((*iti).compare(itobs->id) != 0); itobs++);
                 if (itobs != obsTypes.end()) itobs->sel = true;
-                else obsTypes.push_back(OBSmeta(*iti, true, false));
+                else itobs = obsTypes.insert(obsTypes.end(), OBSmeta(*iti, true, false));
+                obsColumns.push_back((unsigned int) (itobs - obsTypes.begin()));
             }
         };
 	};
-	vector <GNSSsystem> systems;
-	//"* SIGNAL STRENGTH UNIT"	V304
-	string signalUnit;
-	//"* INTERVAL"				VALL
-	double obsInterval;
-	//"TIME OF FIRST OBS"		VALL
-	int firstObsWeek;
-	double firstObsTOW;
-	char obsTimeSys;
-	//"* TIME OF LAST OBS"		VALL
-	int lastObsWeek;
-	double lastObsTOW;
-	//"* RCV CLOCK OFFS APPL"		VALL
-	int rcvClkOffs;
-	//"* SYS / DCBS APPLIED"		V304
 	struct DCBSPCVSapp {	//defines data for corrections of differential code biases (DCBS)
 							//or corrections of phase center variations (PCVS)
 		int sysIndex;		//the system index in vector systems
@@ -559,10 +609,6 @@ private:
 			corrSource = cs;
 		};
 	};
-	vector <DCBSPCVSapp> dcbsApp;
-	//"*SYS / PCVS APPLIED		V304
-	vector <DCBSPCVSapp> pcvsApp;
-	//"* SYS / SCALE FACTOR"	V304
 	struct OSCALEfact {	//defines scale factor applied to observables
 		int sysIndex;	//the system index in vector systems
 		int factor;		//a factor to divide stored observables with before use (1,10,100,1000)
@@ -574,8 +620,6 @@ private:
 			obsType = ot;
 		};
 	};
-	vector <OSCALEfact> obsScaleFact;
-	//"* SYS / PHASE SHIFTS		V304
 	struct PHSHcorr {	//defines Phase shift correction used to generate phases consistent w/r to cycle shifts
 		int sysIndex;	//the system index in vector systems
 		string obsCode;	//Carrier phase observable code (Type-Band-Attribute)
@@ -589,8 +633,6 @@ private:
 			obsSats = os;
 		};
 	};
-	vector <PHSHcorr> phshCorrection;
-	//* GLONASS SLOT / FRQ #
 	struct GLSLTfrq {	//defines Glonass slot and frequency numbers
 		int slot;		//slot
 		int frqNum;		//Frequency numbers (-7...+6)
@@ -600,8 +642,6 @@ private:
 			frqNum = fr;
 		};
 	};
-	vector <GLSLTfrq> gloSltFrq;
-	//* GLONASS COD/PHS/BIS
     struct GLPHSbias {
         string obsCode;   //the observation code
         double obsCodePhaseBias;    //the code phase bias correction
@@ -611,8 +651,6 @@ private:
             obsCodePhaseBias = phb;
         }
     };
-    vector <GLPHSbias> gloPhsBias;
-	//"* LEAP SECONDS"			VALL
     struct LEAPsecs {
         int secs;       //number of leap seconds
         int deltaLSF;
@@ -628,16 +666,6 @@ private:
             sysId = sy;
         }
     };
-    vector <LEAPsecs> leapSecs;
-
-	int leapSec;
-	int leapDeltaLSF;		//V304 only
-	int leapWeekLSF;		//V304 only
-	int leapDN;			    //V304 only
-    char leapSysId;         //V304 only
-	//"* # OF SATELLITES"		VALL
-	int numOfSat;
-	//"* PRN / # OF OBS"			VALL
 	struct PRNobsnum {	//defines prn and number of observables for each observable type
 		char sysPrn;	//the system the satellite prn belongs
 		int	satPrn;		//the prn number of the satellite
@@ -651,9 +679,6 @@ private:
 			obsNum = o;
 		};
 	};
-	vector <PRNobsnum> prnObsNum;
-    //"* IONOSPHERIC CORR		(in GNSS NAV version V304)
-	//"* TIME SYSTEM CORR		(in GNSS NAV version V304)
 	struct CORRECTION {	//defines ionospheric and time corrections
         RINEXlabel  corrType;	//Correction type: IONO_XXX or TIME_YYYY defined above
         double corrValues[6];   //Correction values depend on the correction type:
@@ -684,7 +709,117 @@ private:
             corrValues[5] = sourceId;
         }
 	};
-	vector <CORRECTION> corrections;
+public:
+	struct HDRdata {	//RINEX header data grouped by line type/label, copied as a whole between objects and to snapshots
+		//"RINEX VERSION / TYPE"
+		RINEXversion inFileVer;	//The RINEX version of the input file (when applicable)
+		RINEXversion version;	//The RINEX version of the output file
+		char fileType;			//V210:O, N(GPS nav), G(GLONASS nav), H(Geo nav), ...; V304:O, N, M
+		string fileTypeSfx;		//a suffix to better describe the file type
+		char sysToPrintId;		//System to print identifier: V210=G(GPS), R(GLO), S(SBAS), T, M(multiple); V304=G, R, E (Galileo), J, C, S, M
+		string systemIdSfx;		//a suffix to better describe the system
+		//"PGM / RUN BY / DATE"
+		string pgm;				//Program used to create current file
+		string runby;			//Who executed the program
+		string date;			//Date and time of file creation
+		//"MARKER NAME"
+		string markerName;		//Name of antenna marker
+		//"* MARKER NUMBER"
+		string markerNumber;	//Number of antenna marker (HUMAN)
+		//"MARKER TYPE"
+		string markerType;		//Marker type as per V304
+		//"OBSERVER / AGENCY"
+		string observer;		//Name of observer
+		string agency;			//Name of agency
+		//"REC # / TYPE / VERS
+		string rxNumber;		//Receiver number
+		string rxType;			//Receiver type
+		string rxVersion;		//Receiver version (e.g. Internal Software Version)
+		//"ANT # / TYPE"
+		string antNumber;		//Antenna number
+		string antType;			//Antenna type
+		//"APPROX POSITION XYZ"
+		double aproxX;			//Geocentric approximate marker position
+		double aproxY;
+		double aproxZ;
+		//"ANTENNA: DELTA H/E/N"
+		double antHigh;		//Antenna height: Height of the antenna reference point (ARP) above the marker
+		double eccEast;		//Horizontal eccentricity of ARP relative to the marker (east/north)
+		double eccNorth;
+		//"* ANTENNA: DELTA X/Y/Z"	V304
+		double antX;
+		double antY;
+		double antZ;
+		//"* ANTENNA: PHASECENTER"	V304
+		char antPhSys;
+		string antPhCode;
+		double antPhNoX;
+		double antPhEoY;
+		double antPhUoZ;
+		//"* ANTENNA: B.SIGHT XYZ"	V304
+		double antBoreX;
+		double antBoreY;
+		double antBoreZ;
+		//"* ANTENNA: ZERODIR AZI"	V304
+		double antZdAzi;
+		//"* ANTENNA: ZERODIR XYZ"	V304
+		double antZdX;
+		double antZdY;
+		double antZdZ;
+		//"* CENTER OF MASS XYZ"	V304
+		double centerX;
+		double centerY;
+		double centerZ;
+		//"WAVELENGTH FACT L1/2"	V210
+		vector <WVLNfactor> wvlenFactor;
+		//"# / TYPES OF OBSERV"		V210
+		//"SYS / # / OBS TYPES"		V304
+		vector <GNSSsystem> systems;
+		//"* SIGNAL STRENGTH UNIT"	V304
+		string signalUnit;
+		//"* INTERVAL"				VALL
+		double obsInterval;
+		//"TIME OF FIRST OBS"		VALL
+		int firstObsWeek;
+		double firstObsTOW;
+		char obsTimeSys;
+		//"* TIME OF LAST OBS"		VALL
+		int lastObsWeek;
+		double lastObsTOW;
+		//"* RCV CLOCK OFFS APPL"		VALL
+		int rcvClkOffs;
+		//"* SYS / DCBS APPLIED"		V304
+		vector <DCBSPCVSapp> dcbsApp;
+		//"*SYS / PCVS APPLIED		V304
+		vector <DCBSPCVSapp> pcvsApp;
+		//"* SYS / SCALE FACTOR"	V304
+		vector <OSCALEfact> obsScaleFact;
+		//"* SYS / PHASE SHIFTS		V304
+		vector <PHSHcorr> phshCorrection;
+		//* GLONASS SLOT / FRQ #
+		vector <GLSLTfrq> gloSltFrq;
+		//* GLONASS COD/PHS/BIS
+		vector <GLPHSbias> gloPhsBias;
+		//"* LEAP SECONDS"			VALL
+		vector <LEAPsecs> leapSecs;
+		int leapSec;
+		int leapDeltaLSF;		//V304 only
+		int leapWeekLSF;		//V304 only
+		int leapDN;			    //V304 only
+		char leapSysId;         //V304 only
+		//"* # OF SATELLITES"		VALL
+		int numOfSat;
+		//"* PRN / # OF OBS"			VALL
+		vector <PRNobsnum> prnObsNum;
+		//"* IONOSPHERIC CORR		(in GNSS NAV version V304)
+		//"* TIME SYSTEM CORR		(in GNSS NAV version V304)
+		vector <CORRECTION> corrections;
+		//records having data, and comments
+		bitset<LASTONE + 1> labelHasData;	//If there are data stored for each header record or not
+		vector <HDcomment> hdComments;	//The comment records in the header, in the order they are printed
+	};
+private:
+	HDRdata hdr;		//the header data
 	//Epoch time parameters
 	int epochWeek;			//Extended (0 to NO LIMIT) GPS/GAL week number of current epoch
 	double epochTOW;		//Seconds into the current week, accounting for clock bias, when the current measurement was made
@@ -693,6 +828,7 @@ private:
 	int epochFlag;		//The type of data following this epoch record (observation, event, ...). See RINEX definition
 	int nSatsEpoch;		//Number of satellites or special records in current epoch
 	double epochTimeTag;	//A tag to identify the measurements of a given epoch. Could be the estimated time of current epoch before fix
+	GPStimeFormatter timeFormatter;	//formats epoch times caching the calendar date of the current day
 	struct SatObsData {	//defines data storage for a satellite observable (pseudorrange, phase, ...) in an epoch.
 		unsigned int sysIndex;		//the system this observable belongs: its index in systems vector (see above)
 		int satellite;		//the satellite this observable belongs: PRN of satellite
@@ -722,6 +858,32 @@ private:
 		};
 	};
 	vector <SatObsData> epochObs;	//A place to store observable data (pseudorange, phase, ...) for one epoch
+	struct OBSepochData {	//defines storage for an epoch decoded from an observation file, but not yet stored as current epoch
+		int week;			//epoch time data, as per epochWeek, epochTOW, epochTimeTag, and epochClkOffset
+		double tow;
+		double timeTag;
+		double clkOffset;
+		int flag;			//the epoch flag
+		int nSats;			//number of satellites or special records
+		bool wrongDate;		//true when the date in the epoch line is not correct
+		int status;			//the status of the epoch read, as per readObsEpoch
+		long offset;		//the byte offset of the epoch line in the input file
+		long endOffset;		//the byte offset just after the last line of the epoch in the input file
+		string msg;			//the message to log for this epoch
+		vector <string> skipped;	//the messages to log for lines out of an epoch found before this one
+		vector <SatObsData> obs;	//the observables in this epoch
+		//constructor
+		OBSepochData(int w, double t, double tT, double clk) {
+			week = w;
+			tow = t;
+			timeTag = tT;
+			clkOffset = clk;
+			flag = nSats = 0;
+			wrongDate = false;
+			status = 0;
+			offset = endOffset = 0;
+		}
+	};
 	//Epoch navigation data
 	struct SatNavData {	//defines storage for navigation data for a given GNSS satellite
 		double navTimeTag;	//a time tag to identify the epoch of this data:
@@ -754,8 +916,97 @@ private:
 		};
 	};
 	vector <SatNavData> epochNav;		//A place to store navigation data for one epoch
+	struct NAVmergeKey {	//identifies a satellite ephemeris when merging navigation files
+		char systemId;		//the system identification (G, E, R, ...)
+		int satellite;		//the PRN of the satellite
+		double toc;			//the time tag of the ephemeris
+		int iod;			//the issue of data of the ephemeris (0 for systems without it)
+		bool operator == (const NAVmergeKey &param) const {
+			return (systemId == param.systemId) && (satellite == param.satellite) && (toc == param.toc) && (iod == param.iod);
+		}
+	};
+	struct NAVmergeKeyHash {	//computes the hash of a NAVmergeKey
+		size_t operator () (const NAVmergeKey &key) const {
+			return hash<double>()(key.toc) ^ ((size_t) key.systemId << 24) ^ ((size_t) key.satellite << 16) ^ (size_t) key.iod;
+		}
+	};
+	struct NAVmergeCopy {	//a copy of an ephemeris found when merging navigation files, and the number of times found
+		SatNavData data;
+		int count;
+		NAVmergeCopy(const SatNavData &d) : data(d) {
+			count = 1;
+		}
+	};
+	typedef unordered_map < NAVmergeKey, vector<NAVmergeCopy>, NAVmergeKeyHash > NAVmergeMap;
+	//Epoch index of the input observation file
+	struct OBSepochIndex {	//defines data to locate an epoch in the input observation file
+		long offset;		//the byte offset of the epoch line from the beginning of the file
+		double timeTag;		//the epoch time as seconds from the GPS epoch
+		int flag;			//the epoch flag
+		//constructor
+		OBSepochIndex(long o, double t, int f) {
+			offset = o;
+			timeTag = t;
+			flag = f;
+		}
+		//define operator for searching by time
+		bool operator < (const OBSepochIndex &param) const {
+			return timeTag < param.timeTag;
+		}
+	};
+	struct OBSstoreSink {	//defines the store where observables are placed directly while reading a file (see readObsFile)
+		RinexObsStore* store;		//the store
+		vector <unsigned int> sysOffset;	//for each system, the position in seriesCache of its first entry
+		vector <int> seriesCache;	//for each system, satellite and observable, its series index in the store (-1 if not known yet)
+	};
+	OBSstoreSink* obsSink;		//when not NULL, observables read are placed in its store instead of in epochObs
+	vector <OBSepochIndex> obsEpochIndex;	//the offset, time and flag of each epoch in the input observation file
+	long obsIndexFileSize;		//the size of the input observation file when the epoch index was built
+	long long obsIndexFileTime;	//the modification time of the input observation file when the epoch index was built
+	struct OBSmergeInput {	//defines data for each input observation file being merged (move only, as it owns its reader)
+		FILE* input;			//the input file
+		unique_ptr<RinexData> reader;	//the object reading the input file
+		int status;				//the status of the last epoch read, as per readObsEpoch
+		vector < vector<int> > obsMap;	//for each reader system and observable, the index of the observable in this object (-1 if none)
+		vector <int> sysMap;	//for each reader system, its index in this object
+	};
+	vector <OBSmergeInput> mergeInputs;		//the input files being merged
+	//the time tag of the current epoch of each input file being merged, and its position in mergeInputs, ordered by earliest time
+	priority_queue < pair<double, unsigned int>, vector< pair<double, unsigned int> >, greater< pair<double, unsigned int> > > mergeQueue;
+	struct OBSsplitFile {	//defines data for each output file generated when splitting observation data in time windows
+		double windowStart;		//the start time of the window, as seconds from the GPS epoch
+		string fileName;		//the file name, including path
+		FILE* out;				//the file stream (NULL when closed)
+		long tofoOffset;		//the position in the file of the TIME OF FIRST OBS record
+		long toloOffset;		//the position in the file of the TIME OF LAST OBS record
+		int firstWeek;			//week and TOW of the first and last epochs printed in the file
+		double firstTOW;
+		int lastWeek;
+		double lastTOW;
+	};
+	vector <OBSsplitFile> splitFiles;	//the output files when splitting observation data
+	double splitWindow;			//the length in seconds of each time window (0 if splitting is not active)
+	string splitPrefix;			//the prefix, country and path to be used to name output files
+	string splitCountry;
+	string splitPath;
+	unsigned int splitMaxOpen;	//the maximum number of output files open at the same time
+	int splitLast;				//the position in splitFiles of the last file printed (-1 if none)
+	struct OBStarget {	//defines data for each output file printed at the same time with its own version
+		FILE* out;				//the file stream
+		RINEXversion version;	//the version printed in the file
+		long tofoOffset;		//the position in the file of the TIME OF FIRST OBS record
+		long toloOffset;		//the position in the file of the TIME OF LAST OBS record
+		vector < vector<bool> > prt;	//for each system, the prt flag of each obsType in this version
+		vector < vector<unsigned int> > prtColumns;	//for each system, its print plan in this version (see GNSSsystem)
+		vector < vector<bool> > prtLineEnd;
+	};
+	vector <OBStarget> obsTargets;	//the output files printed at the same time
+	vector <SatObsData> targetObs;	//a copy of the current epoch observations, to print them in each target
+	OBStarget targetSaved;			//the version, observables to print and print plans to restore after printing in targets
+	long hdTofoOffset;			//the position in the output file of the TIME OF FIRST OBS record in the last header printed
+	long hdToloOffset;			//the position in the output file of the TIME OF LAST OBS record in the last header printed
 	//A state variable used to store reference to the label of the last record which data has been modified
-	vector<LABELdata>::iterator lastRecordSet;
+	RINEXlabel lastRecordSet;
 	unsigned int numberV2ObsTypes;
 	//Logger
 	Logger* plog;		//the place to send logging messages
@@ -770,16 +1021,41 @@ private:
 	RINEXlabel checkLabel(char *);
 	RINEXlabel findLabelId(char *);
 	string valueLabel(RINEXlabel label, string toAppend = string());
+	void insertComment(unsigned int pos, const string &comment);
 	int readV2ObsEpoch(FILE* input);
 	int readV3ObsEpoch(FILE* input);
 	int readObsEpochEvent(FILE* input, bool wrongDate);
-	void printHdLineData (FILE* out, vector<LABELdata>::iterator lbIter);
-	bool printSatObsValues(FILE* out, RINEXversion ver);
+	bool decodeV3EpochLine(const char* line, OBSepochData &epoch, string &msgPrfx) const;
+	bool decodeV3SatLine(const char* line, double tTag, vector<SatObsData> &obs, string &msgPrfx) const;
+	void addObsToSink(double tTag, unsigned int sysIdx, int sat, unsigned int obsIdx, double value, int lli, int ssi, vector<SatObsData> &obs) const;
+	void addEpochToSink();
+	void removeEpochFromSink();
+	void parseV3ObsChunk(const char* begin, const char* end, long offset, vector<OBSepochData>* epochs) const;
+	bool isObsEpochLine(const char* line, double &timeTag, int &flag);
+	bool loadObsEpochIndex(string indexFileName);
+	bool advanceObsMerge(unsigned int inputIdx);
+	static unsigned long long obsKey(unsigned int sysIdx, int sat, unsigned int obsIdx);
+	void collectNavFiles(vector<FILE*> &inputs, unsigned int first, unsigned int step, NAVmergeMap &navMap);
+	static void addNavCopy(NAVmergeMap &navMap, const SatNavData &navData, int count);
+	static bool isSameNavCopy(const SatNavData &a, const SatNavData &b);
+	static bool isLowerNavCopy(const SatNavData &a, const SatNavData &b);
+	bool openSplitFile(double windowStart);
+	bool reopenSplitFile(OBSsplitFile &sf);
+	void closeOldestSplitFile();
+	void closeSplitFile(OBSsplitFile &sf);
+	void selectObsTarget(const OBStarget &target);
+	void keepObsTarget(OBStarget &target);
+	bool saveObsEpochIndex(string indexFileName);
+	static void getCkpLayout(unsigned int (&layout)[RINEX_CKP_LAYOUTSIZE]);
+	void printHdLineData (FILE* out, RINEXlabel labelId, const string &comment = string());
+	void setPrintPlan();
+	bool printSatObsValues(FILE* out);
 	RINEXlabel readHdLineData(FILE* input);
 	bool readRinexRecord(char* rinexRec, int recSize, FILE* input);
-	bool isSatSelected(int sysIx, int sat);
-    unsigned int getSysIndex(char sysId);
-	int systemIndex(char sysCode);
+	bool readRinexRecord(char* rinexRec, int recSize, const char* &cursor, const char* end) const;
+	bool isSatSelected(int sysIx, int sat) const;
+    unsigned int getSysIndex(char sysId) const;
+	int systemIndex(char sysCode) const;
 	string getSysDes(char s);
 	char getSysId(string s);
 	string getTimeDes(char s);
@@ -0,0 +1,378 @@
+/** @file RinexObsStore.cpp
+ * Contains the implementation of the RinexObsStore class.
+ */
+#include "RinexObsStore.h"
+
+/**Constructs an empty RinexObsStore object.
+ */
+RinexObsStore::RinexObsStore() {
+	lastEpochSeries = 0;
+}
+
+/**Destructor.
+ */
+RinexObsStore::~RinexObsStore() {
+}
+
+/**clear removes all data stored.
+ */
+void RinexObsStore::clear() {
+	times.clear();
+	flags.clear();
+	clkOffsets.clear();
+	series.clear();
+	lastEpochSeries = 0;
+}
+
+/**addEpoch appends a new epoch to the store. Following calls to setObs will set data for this epoch.
+ *
+ * @param timeTag the epoch time as seconds from the GPS epoch
+ * @param flag the epoch flag
+ * @param clkOffset the receiver clock offset
+ * @return the index of the epoch added
+ */
+unsigned int RinexObsStore::addEpoch(double timeTag, int flag, double clkOffset) {
+	times.push_back(timeTag);
+	flags.push_back((unsigned char) flag);
+	clkOffsets.push_back(clkOffset);
+	lastEpochSeries = (unsigned int) series.size();
+	return (unsigned int) times.size() - 1;
+}
+
+/**addSeries gets the index of the series for the given system, satellite and observable, adding it if it does not exist.
+ *
+ * @param sys the system identification (G, R, E, ...)
+ * @param sat the satellite number
+ * @param obsType the observable type (C1C, L1C, ...)
+ * @return the index of the series
+ */
+int RinexObsStore::addSeries(char sys, int sat, const string &obsType) {
+	int idx = findSeries(sys, sat, obsType);
+	if (idx >= 0) return idx;
+	series.push_back(OBSseries(sys, sat, obsType));
+	return (int) series.size() - 1;
+}
+
+/**setObs sets the data of the given series in the last epoch added.
+ * Arrays of the series are extended up to the last epoch, and the epochs without data are marked as not present.
+ *
+ * @param seriesIdx the index of the series
+ * @param value the observable value
+ * @param lli the loss of lock indicator
+ * @param ssi the signal strength indicator
+ */
+void RinexObsStore::setObs(int seriesIdx, double value, int lli, int ssi) {
+	if (times.empty()) return;
+	OBSseries &s = series[seriesIdx];
+	unsigned int epoch = (unsigned int) times.size() - 1;
+	if (s.values.empty()) s.firstEpoch = epoch;
+	unsigned int pos = epoch - s.firstEpoch;
+	if (pos >= s.values.size()) {
+		s.values.resize(pos + 1, 0.0);
+		s.llis.resize(pos + 1, 0);
+		s.ssis.resize(pos + 1, 0);
+		s.present.resize(pos / 32 + 1, 0);
+	}
+	s.values[pos] = value;
+	s.llis[pos] = (unsigned char) lli;
+	s.ssis[pos] = (unsigned char) ssi;
+	s.present[pos / 32] |= 0x01U << (pos % 32);
+}
+
+/**removeLastEpoch removes the last epoch added, the data set for it, and the series added after it.
+ * It allows discarding an epoch when errors are found while its data are being set.
+ */
+void RinexObsStore::removeLastEpoch() {
+	if (times.empty()) return;
+	unsigned int epoch = (unsigned int) times.size() - 1;
+	unsigned int pos;
+	if (lastEpochSeries < series.size()) series.erase(series.begin() + lastEpochSeries, series.end());
+	for (vector<OBSseries>::iterator it = series.begin(); it != series.end(); ++it) {
+		if (it->values.empty() || (it->firstEpoch + it->values.size() - 1 != epoch)) continue;
+		pos = (unsigned int) it->values.size() - 1;
+		it->values.pop_back();
+		it->llis.pop_back();
+		it->ssis.pop_back();
+		if (pos % 32 == 0) it->present.pop_back();
+		else it->present[pos / 32] &= ~(0x01U << (pos % 32));
+	}
+	times.pop_back();
+	flags.pop_back();
+	clkOffsets.pop_back();
+	lastEpochSeries = (unsigned int) series.size();
+}
+
+/**shrinkToFit releases the memory reserved, but not used, by the store arrays.
+ * It is usually called after loading all data.
+ */
+void RinexObsStore::shrinkToFit() {
+	times.shrink_to_fit();
+	flags.shrink_to_fit();
+	clkOffsets.shrink_to_fit();
+	series.shrink_to_fit();
+	for (vector<OBSseries>::iterator it = series.begin(); it != series.end(); ++it) {
+		it->values.shrink_to_fit();
+		it->llis.shrink_to_fit();
+		it->ssis.shrink_to_fit();
+		it->present.shrink_to_fit();
+	}
+}
+
+/**getNumEpochs gets the number of epochs stored.
+ *
+ * @return the number of epochs
+ */
+unsigned int RinexObsStore::getNumEpochs() const {
+	return (unsigned int) times.size();
+}
+
+/**getTimes gets the array with the time of each epoch, as seconds from the GPS epoch.
+ *
+ * @return a pointer to the array of getNumEpochs times
+ */
+const double* RinexObsStore::getTimes() const {
+	return times.data();
+}
+
+/**getFlags gets the array with the flag of each epoch.
+ *
+ * @return a pointer to the array of getNumEpochs flags
+ */
+const unsigned char* RinexObsStore::getFlags() const {
+	return flags.data();
+}
+
+/**getClkOffsets gets the array with the receiver clock offset of each epoch.
+ *
+ * @return a pointer to the array of getNumEpochs clock offsets
+ */
+const double* RinexObsStore::getClkOffsets() const {
+	return clkOffsets.data();
+}
+
+/**getNumSeries gets the number of series (system, satellite, observable) stored.
+ *
+ * @return the number of series
+ */
+unsigned int RinexObsStore::getNumSeries() const {
+	return (unsigned int) series.size();
+}
+
+/**findSeries gets the index of the series for the given system, satellite and observable.
+ *
+ * @param sys the system identification (G, R, E, ...)
+ * @param sat the satellite number
+ * @param obsType the observable type (C1C, L1C, ...)
+ * @return the index of the series, or -1 if it does not exist
+ */
+int RinexObsStore::findSeries(char sys, int sat, const string &obsType) const {
+	for (unsigned int i = 0; i < series.size(); i++)
+		if ((series[i].system == sys) && (series[i].satellite == sat) && (series[i].obsType.compare(obsType) == 0)) return (int) i;
+	return -1;
+}
+
+/**getSeriesId gets the system, satellite and observable of the given series.
+ *
+ * @param seriesIdx the index of the series
+ * @param sys the system identification
+ * @param sat the satellite number
+ * @param obsType the observable type
+ * @return true if the series exists, false otherwise
+ */
+bool RinexObsStore::getSeriesId(int seriesIdx, char &sys, int &sat, string &obsType) const {
+	if ((seriesIdx < 0) || (seriesIdx >= (int) series.size())) return false;
+	sys = series[seriesIdx].system;
+	sat = series[seriesIdx].satellite;
+	obsType = series[seriesIdx].obsType;
+	return true;
+}
+
+/**getFirstEpoch gets the index of the epoch corresponding to the first element in the arrays of the given series.
+ *
+ * @param seriesIdx the index of the series
+ * @return the epoch index
+ */
+unsigned int RinexObsStore::getFirstEpoch(int seriesIdx) const {
+	return series[seriesIdx].firstEpoch;
+}
+
+/**getSeriesSize gets the number of elements in the arrays of the given series.
+ *
+ * @param seriesIdx the index of the series
+ * @return the number of elements
+ */
+unsigned int RinexObsStore::getSeriesSize(int seriesIdx) const {
+	return (unsigned int) series[seriesIdx].values.size();
+}
+
+/**getValues gets the array with the observable values of the given series.
+ * Element i of the array corresponds to epoch getFirstEpoch + i.
+ *
+ * @param seriesIdx the index of the series
+ * @return a pointer to the array of getSeriesSize values
+ */
+const double* RinexObsStore::getValues(int seriesIdx) const {
+	return series[seriesIdx].values.data();
+}
+
+/**getLLIs gets the array with the loss of lock indicators of the given series.
+ *
+ * @param seriesIdx the index of the series
+ * @return a pointer to the array of getSeriesSize indicators
+ */
+const unsigned char* RinexObsStore::getLLIs(int seriesIdx) const {
+	return series[seriesIdx].llis.data();
+}
+
+/**getSSIs gets the array with the signal strength indicators of the given series.
+ *
+ * @param seriesIdx the index of the series
+ * @return a pointer to the array of getSeriesSize indicators
+ */
+const unsigned char* RinexObsStore::getSSIs(int seriesIdx) const {
+	return series[seriesIdx].ssis.data();
+}
+
+/**isPresent checks if the given series has data for the given epoch.
+ *
+ * @param seriesIdx the index of the series
+ * @param epochIdx the index of the epoch
+ * @return true if there are data for the epoch, false otherwise
+ */
+bool RinexObsStore::isPresent(int seriesIdx, unsigned int epochIdx) const {
+	const OBSseries &s = series[seriesIdx];
+	if ((epochIdx < s.firstEpoch) || (epochIdx - s.firstEpoch >= s.values.size())) return false;
+	unsigned int pos = epochIdx - s.firstEpoch;
+	return (s.present[pos / 32] & (0x01U << (pos % 32))) != 0;
+}
+
+/**getMemorySize gets the approximate size in bytes of the memory used by the data stored.
+ *
+ * @return the size in bytes
+ */
+size_t RinexObsStore::getMemorySize() const {
+	size_t size = times.capacity() * sizeof(double) + flags.capacity() + clkOffsets.capacity() * sizeof(double)
+			+ series.capacity() * sizeof(OBSseries);
+	for (vector<OBSseries>::const_iterator it = series.begin(); it != series.end(); ++it)
+		size += it->values.capacity() * sizeof(double) + it->llis.capacity() + it->ssis.capacity()
+				+ it->present.capacity() * sizeof(uint32_t);
+	return size;
+}
+
+/**writeColumnar writes the data stored as tables of the given columnar file, already open for writing.
+ * Epochs are written in the OBSEPOCHS table, observable types in OBSTYPES, and observables, ordered by epoch, in OBSDATA.
+ * Each OBSDATA row has the index of its epoch in OBSEPOCHS, as several epochs can have the same time (an epoch with flag 6
+ * following the one with flag 0, for example).
+ *
+ * @param out the columnar file where tables will be written
+ * @return true if tables were written, false otherwise
+ */
+bool RinexObsStore::writeColumnar(ColumnarFile &out) const {
+	//write epochs
+	if (!out.beginTable("OBSEPOCHS", times.size(), 3)
+		|| !out.writeColumn("TIME", ColumnarFile::FLOAT64, sizeof(double), times.data())
+		|| !out.writeColumn("FLAG", ColumnarFile::UINT8, sizeof(unsigned char), flags.data())
+		|| !out.writeColumn("CLKOFFS", ColumnarFile::FLOAT64, sizeof(double), clkOffsets.data())) return false;
+	//write the observable types used, and the index of each series observable type in them
+	const unsigned int OBSIDLEN = 3;
+	vector<char> obsIds;
+	vector<uint16_t> seriesObs;
+	for (vector<OBSseries>::const_iterator it = series.begin(); it != series.end(); ++it) {
+		string id = it->obsType.substr(0, OBSIDLEN);
+		id.resize(OBSIDLEN, ' ');
+		unsigned int i;
+		for (i = 0; i < obsIds.size(); i += OBSIDLEN) if (id.compare(0, OBSIDLEN, &obsIds[i], OBSIDLEN) == 0) break;
+		if (i == obsIds.size()) obsIds.insert(obsIds.end(), id.begin(), id.end());
+		seriesObs.push_back((uint16_t) (i / OBSIDLEN));
+	}
+	if (!out.beginTable("OBSTYPES", obsIds.size() / OBSIDLEN, 1)
+		|| !out.writeColumn("ID", ColumnarFile::FIXSTR, OBSIDLEN, obsIds.data())) return false;
+	//arrange observables by epoch
+	vector<int32_t> rowEpoch;
+	vector<double> rowTime;
+	vector<char> rowSys;
+	vector<int32_t> rowPrn;
+	vector<uint16_t> rowObs;
+	vector<double> rowValue;
+	vector<unsigned char> rowLli, rowSsi;
+	for (unsigned int e = 0; e < times.size(); e++) {
+		for (unsigned int s = 0; s < series.size(); s++) {
+			if (!isPresent(s, e)) continue;
+			unsigned int pos = e - series[s].firstEpoch;
+			rowEpoch.push_back((int32_t) e);
+			rowTime.push_back(times[e]);
+			rowSys.push_back(series[s].system);
+			rowPrn.push_back(series[s].satellite);
+			rowObs.push_back(seriesObs[s]);
+			rowValue.push_back(series[s].values[pos]);
+			rowLli.push_back(series[s].llis[pos]);
+			rowSsi.push_back(series[s].ssis[pos]);
+		}
+	}
+	return out.beginTable("OBSDATA", rowTime.size(), 8)
+		&& out.writeColumn("EPOCH", ColumnarFile::INT32, sizeof(int32_t), rowEpoch.data())
+		&& out.writeColumn("TIME", ColumnarFile::FLOAT64, sizeof(double), rowTime.data())
+		&& out.writeColumn("SYS", ColumnarFile::CHAR, sizeof(char), rowSys.data())
+		&& out.writeColumn("PRN", ColumnarFile::INT32, sizeof(int32_t), rowPrn.data())
+		&& out.writeColumn("OBS", ColumnarFile::UINT16, sizeof(uint16_t), rowObs.data())
+		&& out.writeColumn("VALUE", ColumnarFile::FLOAT64, sizeof(double), rowValue.data())
+		&& out.writeColumn("LLI", ColumnarFile::UINT8, sizeof(unsigned char), rowLli.data())
+		&& out.writeColumn("SSI", ColumnarFile::UINT8, sizeof(unsigned char), rowSsi.data());
+}
+
+/**readColumnar clears the store and sets it with the data in the tables of the given columnar file, already loaded.
+ * Tables shall have the layout written by writeColumnar.
+ *
+ * @param in the columnar file with the tables to read
+ * @return true if data were read, false otherwise (tables or columns not existing, or data not consistent)
+ */
+bool RinexObsStore::readColumnar(const ColumnarFile &in) {
+	const unsigned int OBSIDLEN = 3;
+	clear();
+	//get all table columns
+	unsigned long nEpochs = in.getNumRows("OBSEPOCHS");
+	const double* eTime = (const double*) in.getColumn("OBSEPOCHS", "TIME", ColumnarFile::FLOAT64, sizeof(double));
+	const unsigned char* eFlag = (const unsigned char*) in.getColumn("OBSEPOCHS", "FLAG", ColumnarFile::UINT8, sizeof(unsigned char));
+	const double* eClk = (const double*) in.getColumn("OBSEPOCHS", "CLKOFFS", ColumnarFile::FLOAT64, sizeof(double));
+	unsigned long nObsIds = in.getNumRows("OBSTYPES");
+	const char* obsIds = (const char*) in.getColumn("OBSTYPES", "ID", ColumnarFile::FIXSTR, OBSIDLEN);
+	unsigned long nRows = in.getNumRows("OBSDATA");
+	const int32_t* rEpoch = (const int32_t*) in.getColumn("OBSDATA", "EPOCH", ColumnarFile::INT32, sizeof(int32_t));
+	const char* rSys = (const char*) in.getColumn("OBSDATA", "SYS", ColumnarFile::CHAR, sizeof(char));
+	const int32_t* rPrn = (const int32_t*) in.getColumn("OBSDATA", "PRN", ColumnarFile::INT32, sizeof(int32_t));
+	const uint16_t* rObs = (const uint16_t*) in.getColumn("OBSDATA", "OBS", ColumnarFile::UINT16, sizeof(uint16_t));
+	const double* rValue = (const double*) in.getColumn("OBSDATA", "VALUE", ColumnarFile::FLOAT64, sizeof(double));
+	const unsigned char* rLli = (const unsigned char*) in.getColumn("OBSDATA", "LLI", ColumnarFile::UINT8, sizeof(unsigned char));
+	const unsigned char* rSsi = (const unsigned char*) in.getColumn("OBSDATA", "SSI", ColumnarFile::UINT8, sizeof(unsigned char));
+	if (((nEpochs > 0) && ((eTime == NULL) || (eFlag == NULL) || (eClk == NULL)))
+		|| ((nObsIds > 0) && (obsIds == NULL))
+		|| ((nRows > 0) && ((rEpoch == NULL) || (rSys == NULL) || (rPrn == NULL) || (rObs == NULL)
+			|| (rValue == NULL) || (rLli == NULL) || (rSsi == NULL)))) return false;
+	//store epochs and observables, that are ordered by epoch index
+	times.reserve(nEpochs);
+	flags.reserve(nEpochs);
+	clkOffsets.reserve(nEpochs);
+	//a cache with the series index for each observable type, system and satellite, to avoid searching them
+	const int MAXSYSID = 128;
+	const int MAXSATS = 100;
+	vector<int> seriesCache(nObsIds * MAXSYSID * MAXSATS, -1);
+	unsigned long row = 0;
+	for (unsigned long e = 0; e < nEpochs; e++) {
+		addEpoch(eTime[e], eFlag[e], eClk[e]);
+		for (; (row < nRows) && (rEpoch[row] == (int32_t) e); row++) {
+			if (rObs[row] >= nObsIds) return false;
+			int *cached = NULL;
+			if ((rPrn[row] >= 0) && (rPrn[row] < MAXSATS) && (rSys[row] >= 0))
+				cached = &seriesCache[(rObs[row] * MAXSYSID + rSys[row]) * MAXSATS + rPrn[row]];
+			if ((cached == NULL) || (*cached < 0)) {
+				string obsType(obsIds + rObs[row] * OBSIDLEN, OBSIDLEN);
+				obsType.erase(obsType.find_last_not_of(' ') + 1);
+				int idx = addSeries(rSys[row], rPrn[row], obsType);
+				if (cached != NULL) *cached = idx;
+				setObs(idx, rValue[row], rLli[row], rSsi[row]);
+			} else setObs(*cached, rValue[row], rLli[row], rSsi[row]);
+		}
+	}
+	shrinkToFit();
+	return row == nRows;
+}
@@ -0,0 +1,99 @@
+/** @file RinexObsStore.h
+ * Contains the definition of the RinexObsStore class.
+ * A RinexObsStore object contains in memory, arranged by columns, the observation data of a whole RINEX file.
+ *
+ *Copyright 2015, 2021 by Francisco Cancillo & Luis Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *See the GNU General Public License for more details.
+ *<p>
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *<p>Ver.	|Date	|Reason for change
+ *<p>---------------------------------
+ *<p>V1.0	|10/2026|First release
+ */
+#ifndef RINEXOBSSTORE_H
+#define RINEXOBSSTORE_H
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "ColumnarFile.h"	//from CommonClasses
+
+using namespace std;
+
+/**RinexObsStore class defines a columnar in-memory storage for the observation data of a whole RINEX file.
+ *<p>Data are arranged as:
+ * - A vector with the time of each epoch stored (and its flag and receiver clock offset).
+ * - For each series, that is, for each system, satellite and observable, contiguous arrays with the value, LLI and SSI
+ *   of the observable in each epoch, and a bitmap stating in which epochs the observable is present.
+ *   Arrays of a series start at the first epoch having data for it.
+ *<p>A RinexObsStore object is usually filled using the RinexData::readObsFile method, but it can be filled also using
+ *addEpoch, addSeries and setObs methods.
+ *<p>Accessors provide pointers to the stored arrays, avoiding copy of data. These pointers are valid until new data are added
+ *to the store.
+ *<p>Store data can be saved to a binary columnar file using writeColumnar, and loaded from it using readColumnar, avoiding the parsing
+ *of RINEX text. Three tables are used: OBSEPOCHS (columns TIME, FLAG, CLKOFFS), OBSTYPES (column ID) and OBSDATA, with one row for each
+ *observable stored (columns EPOCH, TIME, SYS, PRN, OBS, VALUE, LLI, SSI, where EPOCH is the row index in OBSEPOCHS and OBS the row
+ *index in OBSTYPES).
+ */
+class RinexObsStore {
+public:
+	RinexObsStore();
+	~RinexObsStore();
+	void clear();
+	unsigned int addEpoch(double timeTag, int flag, double clkOffset);
+	int addSeries(char sys, int sat, const string &obsType);
+	void setObs(int seriesIdx, double value, int lli, int ssi);
+	void removeLastEpoch();
+	void shrinkToFit();
+	//accessors
+	unsigned int getNumEpochs() const;
+	const double* getTimes() const;
+	const unsigned char* getFlags() const;
+	const double* getClkOffsets() const;
+	unsigned int getNumSeries() const;
+	int findSeries(char sys, int sat, const string &obsType) const;
+	bool getSeriesId(int seriesIdx, char &sys, int &sat, string &obsType) const;
+	unsigned int getFirstEpoch(int seriesIdx) const;
+	unsigned int getSeriesSize(int seriesIdx) const;
+	const double* getValues(int seriesIdx) const;
+	const unsigned char* getLLIs(int seriesIdx) const;
+	const unsigned char* getSSIs(int seriesIdx) const;
+	bool isPresent(int seriesIdx, unsigned int epochIdx) const;
+	size_t getMemorySize() const;
+	//columnar file input / output
+	bool writeColumnar(ColumnarFile &out) const;
+	bool readColumnar(const ColumnarFile &in);
+
+private:
+	struct OBSseries {		//defines storage for the data of a system, satellite and observable
+		char system;		//the system identification (G, R, E, ...)
+		int satellite;		//the satellite number
+		string obsType;		//the observable type (C1C, L1C, ...)
+		unsigned int firstEpoch;	//index in times of the first element in the arrays
+		vector <double> values;		//the value of the observable in each epoch
+		vector <unsigned char> llis;	//the loss of lock indicator in each epoch
+		vector <unsigned char> ssis;	//the signal strength indicator in each epoch
+		vector <uint32_t> present;		//a bitmap stating if there are data for each epoch
+		//constructor
+		OBSseries(char sys, int sat, const string &obs) {
+			system = sys;
+			satellite = sat;
+			obsType = obs;
+			firstEpoch = 0;
+		}
+	};
+	vector <double> times;		//the time tag of each epoch, as seconds from the GPS epoch
+	vector <unsigned char> flags;	//the flag of each epoch
+	vector <double> clkOffsets;	//the receiver clock offset of each epoch
+	vector <OBSseries> series;	//the data of each system, satellite and observable
+	unsigned int lastEpochSeries;	//the number of series existing when the last epoch was added
+};
+#endif
@@ -6,7 +6,8 @@
 #include "SerialTxRxLnx.h"
 #include <string.h>
 #include <vector>
-#include <sstream>
+//from CommonClasses
+#include "Utilities.h"
 
 //needed by Linux (2) open, read, write, close
 #include <sys/types.h>
@@ -281,31 +282,33 @@ int SerialTxRx::readOSPmsg(int patience) {
  * @throw error string when message cannot be send
  */
 void SerialTxRx::writeOSPcmd(int mid, string cmdArgs, int base) {
-	//extract command arguments in cmrArgs: bytes in hexadecimal separated by blanks
-	stringstream ss(cmdArgs);	// Insert the string with payload data into a stream
-	vector<string> tokens;		//create a vector for command arguments
-	string strBuf;
-	DBGRPT("writeOSPmsg:");
-	while (ss >> strBuf)		//extract arguments: each one is a token in the string
-		tokens.push_back(strBuf);
-	unsigned int payloadLen = 1 + tokens.size();
-	if ((2 + 2 + 1 + payloadLen + 2 + 2) > MAXBUFFERSIZE) {
-		string error = "Error OSP cmd too long = " + to_string((long long) payloadLen);
-		DBGRPT("%s\n", error.c_str());
-		throw error;
-	}
-	//start filling the message buffer (pyload buffer used here for that) with command data
-	unsigned int bufferIndex = 0;
-	payBuff[bufferIndex++] = START1;
-	payBuff[bufferIndex++] = START2;
-	payBuff[bufferIndex++] = (unsigned char) (payloadLen >> 8);
-	payBuff[bufferIndex++] = (unsigned char) (payloadLen & 0xFF);
-	payBuff[bufferIndex++] = (unsigned char) mid;
+	//extract command arguments in cmdArgs (bytes separated by blanks) and put them directly in the message buffer
+	const char* cursor = cmdArgs.c_str();
+	const char* end = cursor + cmdArgs.size();
+	StrView token;
 	unsigned long ul;
-	for (vector<string>::iterator it = tokens.begin(); it != tokens.end(); it++) {
-		ul = stoul(*it, nullptr, base);
+	unsigned int bufferIndex = 5;	//arguments are placed after start sequence, payload length and mid
+	DBGRPT("writeOSPmsg:");
+	while (nextToken(cursor, end, " \t\r\n", token)) {
+		if ((bufferIndex + 2 + 2) >= MAXBUFFERSIZE) {
+			string error = "Error OSP cmd too long = " + to_string((long long) (bufferIndex - 3));
+			DBGRPT("%s\n", error.c_str());
+			throw error;
+		}
+		if (!tokenToUL(token, base, ul)) {
+			string error = "Error OSP cmd argument = " + token.str();
+			DBGRPT("%s\n", error.c_str());
+			throw error;
+		}
 		payBuff[bufferIndex++] = (unsigned char) ( ul & 0xFF);
 	}
+	//fill the message buffer (pyload buffer used here for that) with command header data
+	unsigned int payloadLen = bufferIndex - 4;
+	payBuff[0] = START1;
+	payBuff[1] = START2;
+	payBuff[2] = (unsigned char) (payloadLen >> 8);
+	payBuff[3] = (unsigned char) (payloadLen & 0xFF);
+	payBuff[4] = (unsigned char) mid;
 	//compute checksum and put its value in the buffer
 	unsigned int computedCheck = payBuff[4];
 	for (unsigned int i=5; i<bufferIndex; i++) {
@@ -447,17 +450,17 @@ int SerialTxRx::readNMEAmsg(int patience) {
 void SerialTxRx::writeNMEAcmd(int mid, string cmdArgs) {
 	ssize_t nBytesWritten = 0;
 	char checksumBuff[10];
-	//init buffer with command header data and append arguments
-	sprintf((char*) payBuff, "$PSRF%3d,", mid);
-	strncat((char*) payBuff, cmdArgs.c_str(), MAXBUFFERSIZE);
+	//init buffer with command header data and append arguments (leaving room for the checksum)
+	int plLen = sprintf((char*) payBuff, "$PSRF%3d,", mid);
+	size_t argsLen = cmdArgs.size();
+	if (argsLen > (size_t) (MAXBUFFERSIZE - plLen - sizeof checksumBuff)) argsLen = MAXBUFFERSIZE - plLen - sizeof checksumBuff;
+	memcpy(payBuff + plLen, cmdArgs.data(), argsLen);
+	plLen += (int) argsLen;
 	//compute checksum and append its value
-	int plLen = strlen((char*) payBuff);
 	unsigned int computedCheck = payBuff[1];
 	for (int i=2; i<plLen; i++) computedCheck ^= (unsigned int) payBuff[i];
-	sprintf(checksumBuff, "*%02X\r\n", computedCheck);
-	strncat((char*) payBuff, checksumBuff, MAXBUFFERSIZE);
+	plLen += sprintf((char*) payBuff + plLen, "*%02X\r\n", computedCheck);
 	//send command
-	plLen = strlen((char*) payBuff);
 	nBytesWritten = write(hSerial, payBuff, plLen);
 	DBGRPT("writeNMEAmsg:(%d)=%s",(int) nBytesWritten, payBuff)
 	if (tcdrain(hSerial) == -1) {
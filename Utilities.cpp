@@ -2,11 +2,97 @@
  * Contains the implementation of routines used in several places.
  */
 #include "Utilities.h"
-#include <sstream>
 #include <algorithm>
+#include <stdexcept>
 #include <ctype.h>
 #include <time.h>
 #include <math.h>
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+
+/**equals compares the chars referenced by this StrView with the given c-string.
+ *
+ * @param str the null terminated c-string to compare with
+ * @return true if both have the same chars, false otherwise
+ */
+bool StrView::equals(const char* str) const {
+    return (strncmp(data, str, len) == 0) && (str[len] == 0);
+}
+
+/**equalsNoCase compares the chars referenced by this StrView with the given c-string ignoring case.
+ *
+ * @param str the null terminated c-string to compare with
+ * @return true if both have the same chars (in upper or lower case), false otherwise
+ */
+bool StrView::equalsNoCase(const char* str) const {
+    for (size_t i = 0; i < len; i++)
+        if ((str[i] == 0) || (toupper((unsigned char) data[i]) != toupper((unsigned char) str[i]))) return false;
+    return str[len] == 0;
+}
+
+/**nextToken gets from the caller buffer the next token delimited by any of the given delimiters.
+ * Leading delimiters are skipped. No memory is allocated: the token found references chars in the buffer.
+ *
+ * @param cursor the current position in the buffer. It is updated to the position just after the token found
+ * @param end the position just after the last char in the buffer
+ * @param delimiters a c-string with the chars used to delimit tokens
+ * @param token the StrView where the token found is returned
+ * @return true if a token has been found, false if the end of buffer has been reached
+ */
+bool nextToken(const char* &cursor, const char* end, const char* delimiters, StrView &token) {
+    while ((cursor < end) && (strchr(delimiters, *cursor) != NULL) && (*cursor != 0)) cursor++;
+    if ((cursor >= end) || (*cursor == 0)) return false;
+    token.data = cursor;
+    while ((cursor < end) && (*cursor != 0) && (strchr(delimiters, *cursor) == NULL)) cursor++;
+    token.len = cursor - token.data;
+    return true;
+}
+
+/**getTokens gets into a caller array the tokens in the given buffer separated by any of the given delimiters.
+ *
+ * @param source the buffer containing the tokens
+ * @param len the number of chars in the buffer
+ * @param delimiters a c-string with the chars used to delimit tokens
+ * @param tokens the array of StrView where tokens found are placed
+ * @param maxTokens the size of the tokens array
+ * @return the number of tokens placed in the array
+ */
+size_t getTokens(const char* source, size_t len, const char* delimiters, StrView* tokens, size_t maxTokens) {
+    const char* end = source + len;
+    size_t n = 0;
+    while ((n < maxTokens) && nextToken(source, end, delimiters, tokens[n])) n++;
+    return n;
+}
+
+/**tokenToUL converts the number in the given token to an unsigned long using the given base.
+ * As stoul does, it accepts the "0x" prefix for base 16 numbers.
+ *
+ * @param token the token containing the number
+ * @param base the base used to write the number (16, 10, ...)
+ * @param value the converted value
+ * @return true if all chars in the token are part of the number and it is in range, false otherwise
+ */
+bool tokenToUL(const StrView &token, int base, unsigned long &value) {
+    char digits[32];    //a bounded NUL terminated copy of the token
+    char* endp;
+    value = 0;
+    if ((token.len == 0) || (token.len >= sizeof digits)) return false;
+    memcpy(digits, token.data, token.len);
+    digits[token.len] = 0;
+    errno = 0;
+    value = strtoul(digits, &endp, base);
+    return (endp != digits) && (*endp == 0) && (errno == 0);
+}
+
+/**toUpperInPlace converts to upper case the first n chars in the given buffer.
+ *
+ * @param buffer the buffer with chars to convert
+ * @param n the number of chars to convert
+ */
+void toUpperInPlace(char* buffer, size_t n) {
+    for (size_t i = 0; i < n; i++) buffer[i] = (char) toupper((unsigned char) buffer[i]);
+}
 
 /**getTokens gets tokens from a string separated by the given separator
  *
@@ -15,11 +101,12 @@
  * @return a vector of strings containing the extracted tokens
  */
 vector<string> getTokens (string source, char separator) {
-    string strBuf;
-    stringstream ss(source);
+    char delimiters[2] = {separator, 0};
+    const char* cursor = source.c_str();
+    const char* end = cursor + source.size();
+    StrView token;
     vector<string> tokensFound;
-    while (getline(ss, strBuf, separator))
-        if(strBuf.size() > 0) tokensFound.push_back(strBuf);
+    while (nextToken(cursor, end, delimiters, token)) tokensFound.push_back(token.str());
     return tokensFound;
 }
 
@@ -29,20 +116,34 @@ vector<string> getTokens (string source, char separator) {
  * @param n the length to check
  * @return true if all n chars are blanks, false otherwise
  */
-bool isBlank (char* buffer, int n) {
+bool isBlank (const char* buffer, int n) {
     while (n-- > 0) if (*(buffer++) != ' ')  return false;
     return true;
 }
 
+/**fieldToDouble converts to double the number in a fixed width field of the given char buffer.
+ * Conversion does not go beyond the field, even when the following chars could be part of a number.
+ *
+ * @param field the start of the field
+ * @param width the field width, up to 31 chars
+ * @return the value converted, or 0.0 if the field does not start with a number
+ */
+double fieldToDouble(const char* field, int width) {
+    char digits[32];    //a NUL terminated copy of the field
+    if (width > (int) sizeof digits - 1) width = sizeof digits - 1;
+    memcpy(digits, field, width);
+    digits[width] = 0;
+    return strtod(digits, NULL);
+}
+
 /**strToUpper gets a string containing the given string with characters converted to upper case.
  *
  * @param strToConvert the string to convert to upper case
  * @return the converted string
  */
 string strToUpper(string strToConvert) {
-    string strConverted;
-    for (string::iterator p = strToConvert.begin(); p!= strToConvert.end(); p++) strConverted += string(1,toupper(*p));
-    return strConverted;
+    toUpperInPlace(&strToConvert[0], strToConvert.size());
+    return strToConvert;
 }
 
 /**getTwosComplement converts a two's complement number represented with the given number of bits to an int having the same value.
@@ -136,6 +237,66 @@ unsigned int getBits(unsigned int *stream, int bitpos, int len) {
     return bits;
 }
 
+/**writeBinString writes to a binary file the given string, as its length followed by its chars.
+ *
+ * @param out the binary file where the string is written
+ * @param s the string to write
+ * @return true if the string has been written, false otherwise
+ */
+bool writeBinString(FILE* out, const string &s) {
+    unsigned int n = s.size();
+    return (fwrite(&n, sizeof n, 1, out) == 1) && (fwrite(s.data(), 1, n, out) == n);
+}
+
+/**readBinString reads from a binary file a string written with writeBinString.
+ *
+ * @param in the binary file where the string is read
+ * @param s the string read
+ * @return true if the string has been read, false otherwise
+ */
+bool readBinString(FILE* in, string &s) {
+    const unsigned int MAX_LENGTH = 65536;  //a limit to detect wrong data
+    char buffer[256];
+    unsigned int n;
+    if ((fread(&n, sizeof n, 1, in) != 1) || (n > MAX_LENGTH)) return false;
+    s.clear();
+    while (n > 0) {
+        unsigned int chunk = n < sizeof buffer? n : sizeof buffer;
+        if (fread(buffer, 1, chunk, in) != chunk) return false;
+        s.append(buffer, chunk);
+        n -= chunk;
+    }
+    return true;
+}
+
+/**writeBinStrings writes to a binary file the given vector of strings, as its size followed by each string (see writeBinString).
+ *
+ * @param out the binary file where the strings are written
+ * @param v the vector of strings to write
+ * @return true if the strings have been written, false otherwise
+ */
+bool writeBinStrings(FILE* out, const vector<string> &v) {
+    unsigned int n = v.size();
+    if (fwrite(&n, sizeof n, 1, out) != 1) return false;
+    for (unsigned int i = 0; i < n; i++) if (!writeBinString(out, v[i])) return false;
+    return true;
+}
+
+/**readBinStrings reads from a binary file a vector of strings written with writeBinStrings.
+ *
+ * @param in the binary file where the strings are read
+ * @param v the vector of strings read
+ * @return true if the strings have been read, false otherwise
+ */
+bool readBinStrings(FILE* in, vector<string> &v) {
+    const unsigned int MAX_ITEMS = 65536;  //a limit to detect wrong data
+    unsigned int n;
+    if ((fread(&n, sizeof n, 1, in) != 1) || (n > MAX_ITEMS)) return false;
+    v.resize(n);
+    for (unsigned int i = 0; i < n; i++) if (!readBinString(in, v[i])) return false;
+    return true;
+}
+
 /**formatUTCtime gives text calendar data of the current UTC computer time using the format provided (as per strftime).
  *
  * @param buffer the text buffer where calendar data are placed
@@ -314,6 +475,113 @@ void formatGPStime (char* buffer,  size_t bufferSize, const char* fmtYtoM, const
     }
 }
 
+/**putDigits writes in the given buffer the given non negative integer value using nDigits positions.
+ * Leading zeros, if any, are written as the pad character given (but the last digit).
+ *
+ * @param p the position in the buffer where the first digit will be written
+ * @param value the integer value to write
+ * @param nDigits the number of positions to write
+ * @param pad the character to use for leading zeros ('0' or ' ')
+ * @return the position in the buffer just after the last digit written
+ */
+static char* putDigits(char* p, long long value, int nDigits, char pad) {
+    char* last = p + nDigits - 1;
+    for (char* q = last; q >= p; --q) {
+        if ((value == 0) && (q != last)) *q = pad;
+        else *q = (char) ('0' + value % 10);
+        value /= 10;
+    }
+    return last + 1;
+}
+
+/**GPStimeFormatter constructs the object with an empty date cache.
+ */
+GPStimeFormatter::GPStimeFormatter() {
+    cachedMjd = -1;
+    cachedYear = cachedMonth = cachedDay = 0;
+}
+
+/**format writes in the given buffer the calendar data of the given GPS time using the layout stated.
+ * The calendar date is computed only when the GPS day differs from the one cached in the previous call.
+ *
+ * @param buffer the text buffer where calendar data are placed. It shall have at least 44 bytes
+ * @param layout the layout of the calendar data (see timeLayout)
+ * @param week the GPS week from 6/1/1980
+ * @param tow the GPS time of week, or seconds from the beginning of the week
+ * @return the number of chars written in the buffer, not including the ending null
+ */
+int GPStimeFormatter::format(char* buffer, timeLayout layout, int week, double tow) {
+    double dow;     //day of week
+    long long units;
+    int hour, min;
+    char* p = buffer;
+    modf(tow / 86400., &dow);
+    int mjd = 44244 + week * 7 + (int) dow;    //44244 is getMjd(1980, 1, 6), the GPS epoch
+    if (mjd != cachedMjd) {
+        mjdToDate(mjd, &cachedYear, &cachedMonth, &cachedDay);
+        cachedMjd = mjd;
+    }
+    tow -= dow * 86400.;    //seconds of the day
+    hour = (int) (tow / 3600.);
+    tow -= hour * 3600.;
+    min = (int) (tow / 60.);
+    tow -= min * 60.;
+    //the year, preceded by the record start of the epoch layouts
+    switch (layout) {
+        case V2OBS:
+        case V2NAV:
+            if (layout == V2OBS) *p++ = ' ';
+            p = putDigits(p, cachedYear % 100, 2, '0');
+            break;
+        case V3OBS:
+        case V3NAV:
+            if (layout == V3OBS) {
+                *p++ = '>';
+                *p++ = ' ';
+            }
+            p = putDigits(p, cachedYear, 4, '0');
+            break;
+        case HDOBS:
+            *p++ = ' ';
+            *p++ = ' ';
+            p = putDigits(p, cachedYear, 4, '0');
+            break;
+    }
+    //month, day, hour and minute are separated by one blank, or four in the header layout
+    int sepBlanks = layout == HDOBS? 4 : 1;
+    int values[] = {cachedMonth, cachedDay, hour, min};
+    for (int i = 0; i < 4; ++i) {
+        for (int j = 0; j < sepBlanks; ++j) *p++ = ' ';
+        p = putDigits(p, values[i], 2, '0');
+    }
+    switch (layout) {
+        case V2NAV:     //seconds as " %4.1f"
+            units = (long long) floor(tow * 10. + 0.5);
+            *p++ = ' ';
+            p = putDigits(p, units / 10, 2, ' ');
+            *p++ = '.';
+            p = putDigits(p, units % 10, 1, '0');
+            break;
+        case V3NAV:     //seconds as " %02d"
+            *p++ = ' ';
+            p = putDigits(p, (long long) floor(tow + 0.5), 2, '0');
+            break;
+        default:        //seconds as "%11.7f"
+            if (layout == HDOBS) {
+                *p++ = ' ';
+                *p++ = ' ';
+            }
+            units = (long long) floor(tow * 1E7 + 0.5);
+            *p++ = ' ';
+            p = putDigits(p, units / 10000000, 2, ' ');
+            *p++ = '.';
+            p = putDigits(p, units % 10000000, 7, '0');
+            break;
+    }
+    *p = 0;
+    return (int) (p - buffer);
+}
+
 /**getWeekGPSdate compute number of weeks from the GPS ephemeris (6/1/1980) to a given GPS date
  *
  * @param year of the date
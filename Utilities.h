@@ -25,17 +25,41 @@
 #include <string>
 #include <vector>
 #include <string.h>
+#include <stdio.h>
 
 using namespace std;
 
+/**StrView is a non owning reference to a sequence of chars placed in a caller buffer (like C++17 string_view).
+ * It allows tokenizing and comparing text without allocating memory for each token.
+ * The referenced buffer shall exist while the StrView is used.
+ */
+struct StrView {
+    const char* data;   //pointer to the first char of the sequence in the caller buffer
+    size_t len;         //number of chars in the sequence
+    StrView() : data(NULL), len(0) {}
+    StrView(const char* d, size_t l) : data(d), len(l) {}
+    bool equals(const char* str) const;
+    bool equalsNoCase(const char* str) const;
+    string str() const { return string(data, len); }
+};
+bool nextToken(const char* &cursor, const char* end, const char* delimiters, StrView &token);
+size_t getTokens(const char* source, size_t len, const char* delimiters, StrView* tokens, size_t maxTokens);
+bool tokenToUL(const StrView &token, int base, unsigned long &value);
+void toUpperInPlace(char* buffer, size_t n);
+
 vector<string> getTokens (string source, char separator);
-bool isBlank (char* buffer, int n);
+bool isBlank (const char* buffer, int n);
+double fieldToDouble(const char* field, int width);
 string strToUpper(string strToConvert);
 int getTwosComplement(unsigned int number, int nbits);
 int getSigned(unsigned int number, int nbits);
 unsigned int reverseWord(unsigned int wordToReverse, int nBits=32);
 char getFirstDigit(string intNum, char defChar = ' ');
 unsigned int getBits(unsigned int *stream, int bitpos, int len);
+bool writeBinString(FILE* out, const string &s);
+bool readBinString(FILE* in, string &s);
+bool writeBinStrings(FILE* out, const vector<string> &v);
+bool readBinStrings(FILE* in, vector<string> &v);
 
 void formatUTCtime(char* buffer,  size_t bufferSize, const char* fmt);
 double getUTCinstant(int year, int month, int day, int hour, int min, double sec);
@@ -54,4 +78,27 @@ double getInstantGPSdate (int year, int month, int day, int hour, int min, doubl
 int getWeekGNSSinstant (double secs); //computes weeks from the ephemeris to a given instant
 double getTowGNSSinstant (double secs); //computes the TOW for a given instant
 double getInstantGNSStime (int week, double tow); //compute instant seconds from the ephemeris to a given GNSS time (week and tow)
+
+/**GPStimeFormatter formats GPS times (week and tow) as RINEX calendar data writing digits directly into the output buffer.
+ *<p>The calendar date of the last GPS day formatted is cached, and it is recomputed only when the day changes. As consecutive
+ * epochs usually share the date, formatting an epoch time requires only a few integer operations.
+ *<p>The layouts available produce the same text than the formatGPStime formats used for each RINEX record:
+ * - V2OBS: " yy mm dd hh mm ss.sssssss" (V2.10 observation epoch, 26 chars)
+ * - V3OBS: "> yyyy mm dd hh mm ss.sssssss" (V3.04 observation epoch, 29 chars)
+ * - V2NAV: "yy mm dd hh mm ss.s" (V2.10 navigation epoch, 19 chars)
+ * - V3NAV: "yyyy mm dd hh mm ss" (V3.04 navigation epoch, 19 chars)
+ * - HDOBS: "  yyyy    mm    dd    hh    mm   ss.sssssss" (TIME OF FIRST / LAST OBS header records, 43 chars)
+ */
+class GPStimeFormatter {
+public:
+    ///the layouts of calendar data available
+    enum timeLayout {V2OBS=0, V3OBS, V2NAV, V3NAV, HDOBS};
+    GPStimeFormatter();
+    int format(char* buffer, timeLayout layout, int week, double tow);
+private:
+    int cachedMjd;      //the Modified Julian Day of the cached date
+    int cachedYear;     //the calendar date for the cached day
+    int cachedMonth;
+    int cachedDay;
+};
 #endif
\ No newline at end of file
@@ -0,0 +1,107 @@
+/** @file TestUtils.h
+ * Contains helpers shared by the behaviour checks of CommonClasses.
+ * Each check is a small program which returns 0 when all its checks pass, and it is run by ctest.
+ *
+ *Copyright 2026 by Francisco Cancillo & Luis Cancillo
+ *<p>
+ *This file is part of the toRINEX tool.
+ *<p>
+ *<p>Ver.	|Date	|Reason for change
+ *<p>---------------------------------
+ *<p>V1.0	|10/2026|First release
+ */
+#ifndef TESTUTILS_H
+#define TESTUTILS_H
+
+#include <stdio.h>
+#include <string>
+
+#include "RinexData.h"
+
+using namespace std;
+
+///CHECK reports a condition not satisfied and counts it as a failure, without stopping the test
+#define CHECK(COND) \
+	if (!(COND)) { \
+		fprintf(stderr, "%s:%d check failed: %s\n", __FILE__, __LINE__, #COND); \
+		testFailures++; \
+	}
+
+static int testFailures = 0;	//number of checks failed
+
+/**writeTextFile creates a file with the given name and content.
+ *
+ * @param name the file name
+ * @param content the text to write
+ * @return true if the file was written, false otherwise
+ */
+inline bool writeTextFile(string name, string content) {
+	FILE* out = fopen(name.c_str(), "wb");
+	if (out == NULL) return false;
+	bool written = fwrite(content.data(), 1, content.size(), out) == content.size();
+	return (fclose(out) == 0) && written;
+}
+
+/**readTextFile gets the content of the file with the given name.
+ *
+ * @param name the file name
+ * @return the content of the file, or an empty string if it cannot be read
+ */
+inline string readTextFile(string name) {
+	string content;
+	char buffer[4096];
+	size_t n;
+	FILE* in = fopen(name.c_str(), "rb");
+	if (in == NULL) return content;
+	while ((n = fread(buffer, 1, sizeof buffer, in)) > 0) content.append(buffer, n);
+	fclose(in);
+	return content;
+}
+
+/**countText counts the occurrences of a pattern in the given text.
+ *
+ * @param text the text where the pattern is searched
+ * @param pattern the pattern to search for
+ * @return the number of occurrences found
+ */
+inline int countText(const string &text, const string &pattern) {
+	int n = 0;
+	for (size_t pos = text.find(pattern); pos != string::npos; pos = text.find(pattern, pos + pattern.size())) n++;
+	return n;
+}
+
+/**dumpObsEpoch describes in a text line the current epoch in the given RinexData object: the status of the epoch read,
+ * its time and flag, and its observables.
+ *
+ * @param rinex the RinexData object with the current epoch
+ * @param status the status of the epoch read, as per readObsEpoch
+ * @return the text line describing the epoch
+ */
+inline string dumpObsEpoch(RinexData &rinex, int status) {
+	char buffer[128];
+	int week, flag, lol, strg;
+	double tow, bias, value;
+	char sys;
+	int sat;
+	string obsType;
+	rinex.getEpochTime(week, tow, bias, flag);
+	snprintf(buffer, sizeof buffer, "st=%d w=%d tow=%.7f flag=%d:", status, week, tow, flag);
+	string line(buffer);
+	for (unsigned int i = 0; rinex.getObsData(sys, sat, obsType, value, lol, strg, i); i++) {
+		snprintf(buffer, sizeof buffer, " %c%02d %s %.3f %d %d", sys, sat, obsType.c_str(), value, lol, strg);
+		line += buffer;
+	}
+	return line + "\n";
+}
+
+/**testResult reports the result of the test.
+ *
+ * @param name the test name
+ * @return the exit code of the test program: 0 if all checks passed, 1 otherwise
+ */
+inline int testResult(const char* name) {
+	if (testFailures == 0) printf("%s: all checks passed\n", name);
+	else printf("%s: %d checks failed\n", name, testFailures);
+	return testFailures == 0? 0 : 1;
+}
+#endif
@@ -0,0 +1,98 @@
+/** @file testCheckpoint.cpp
+ * Checks that RinexData and GNSSdataFromGRD checkpoints are restored only when their format version and layout are the
+ * current ones, and that a GRD conversion resumed from a checkpoint counts messages from the position where it resumes.
+ *
+ *Copyright 2026 by Francisco Cancillo & Luis Cancillo
+ *<p>
+ *This file is part of the toRINEX tool.
+ *<p>
+ *<p>Ver.	|Date	|Reason for change
+ *<p>---------------------------------
+ *<p>V1.0	|10/2026|First release
+ */
+#include "TestUtils.h"
+#include "GNSSdataFromGRD.h"
+
+const string GRDFILE("testCheckpoint.ORD");
+const string LOGFILE("testCheckpoint.log");
+
+//@cond DUMMY
+///a GRD observation file with a header message, two full epochs (messages 2 to 7) and a third one
+///lacking a satellite (messages 8 and 9)
+const string grdObs =
+	"50;.ORD;2\n"
+	"1;1000;-1270179999999999000;0.0;0.0;0;18;2\n"
+	"2;G1;1C;47;99999915938172;0.0;0;0.0;40.0;1575.42;0.0;0.1;10\n"
+	"2;G2;1C;47;99999921795195;0.0;0;0.0;40.0;1575.42;0.0;0.1;10\n"
+	"1;1000;-1270180000999999000;0.0;0.0;0;18;2\n"
+	"2;G1;1C;47;100999915937037;0.0;0;0.0;40.0;1575.42;0.0;0.1;10\n"
+	"2;G2;1C;47;100999921792925;0.0;0;0.0;40.0;1575.42;0.0;0.1;10\n"
+	"1;1000;-1270180001999999000;0.0;0.0;0;18;2\n"
+	"2;G1;1C;47;101999915935902;0.0;0;0.0;40.0;1575.42;0.0;0.1;10\n";
+///the message completing the third epoch, appended to the file before resuming: an unknown satellite to get a warning
+const string grdObsEnd =
+	"2;X2;1C;47;101999921790655;0.0;0;0.0;40.0;1575.42;0.0;0.1;10\n";
+//@endcond
+
+/**corruptVersion changes in a checkpoint file the first byte after the identification tag, that is, the format version.
+ *
+ * @param ckp the checkpoint file
+ * @param tagSize the size of the identification tag
+ */
+void corruptVersion(FILE* ckp, long tagSize) {
+	fseek(ckp, tagSize, SEEK_SET);
+	int c = fgetc(ckp);
+	fseek(ckp, tagSize, SEEK_SET);
+	fputc(c + 1, ckp);
+	rewind(ckp);
+}
+
+int main() {
+	remove(LOGFILE.c_str());
+	CHECK(writeTextFile(GRDFILE, grdObs))
+	{
+		Logger log(LOGFILE);
+		RinexData rinex(RinexData::V304, &log);
+		GNSSdataFromGRD grd(&log);
+		CHECK(grd.openInputGRD("", GRDFILE))
+		CHECK(grd.collectHeaderData(rinex, 0, 0))
+		grd.rewindInputGRD();
+		//the third epoch is not complete: the checkpoint is taken at the end of the second one
+		int nEpochs = 0;
+		while (grd.collectEpochObsData(rinex)) {
+			rinex.clearObsData();
+			nEpochs++;
+		}
+		CHECK(nEpochs == 2)
+		FILE* rinexCkp = tmpfile();
+		FILE* grdCkp = tmpfile();
+		CHECK((rinexCkp != NULL) && (grdCkp != NULL))
+		if ((rinexCkp == NULL) || (grdCkp == NULL)) return testResult("testCheckpoint");
+		CHECK(rinex.saveCheckpoint(rinexCkp))
+		CHECK(grd.saveCheckpoint(grdCkp))
+		//checkpoints are restored when their layout is the current one
+		RinexData rinexRestored(RinexData::V304, &log);
+		rewind(rinexCkp);
+		CHECK(rinexRestored.restoreCheckpoint(rinexCkp))
+		//and rejected when their format version is other
+		corruptVersion(rinexCkp, sizeof RINEX_CKP_TAG);
+		CHECK(!rinexRestored.restoreCheckpoint(rinexCkp))
+		fclose(rinexCkp);
+		//the conversion is resumed from the third epoch, counting its messages from number 8
+		CHECK(writeTextFile(GRDFILE, grdObs + grdObsEnd))
+		GNSSdataFromGRD grdRestored(&log);
+		CHECK(grdRestored.openInputGRD("", GRDFILE))
+		rewind(grdCkp);
+		CHECK(grdRestored.restoreCheckpoint(grdCkp))
+		CHECK(grdRestored.collectEpochObsData(rinex))
+		CHECK(!grdRestored.collectEpochObsData(rinex))
+		corruptVersion(grdCkp, sizeof GRD_CKP_TAG);
+		CHECK(!grdRestored.restoreCheckpoint(grdCkp))
+		fclose(grdCkp);
+	}
+	string logged = readTextFile(LOGFILE);
+	CHECK(countText(logged, "@10:X2") == 1)
+	CHECK(countText(logged, "other format version or build") == 1)
+	remove(GRDFILE.c_str());
+	return testResult("testCheckpoint");
+}
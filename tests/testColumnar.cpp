@@ -0,0 +1,187 @@
+/** @file testColumnar.cpp
+ * Checks the columnar file export and import of observation data: a store written with RinexObsStore::writeColumnar is read back
+ * unchanged with readColumnar, including epochs with the same time, all records in a navigation file are exported and read back,
+ * and ColumnarFile::load rejects files with wrong sizes.
+ *
+ *Copyright 2026 by Francisco Cancillo & Luis Cancillo
+ *<p>
+ *This file is part of the toRINEX tool.
+ *<p>
+ *<p>Ver.	|Date	|Reason for change
+ *<p>---------------------------------
+ *<p>V1.0	|10/2026|First release
+ */
+#include <string.h>
+
+#include "TestUtils.h"
+#include "ColumnarFile.h"
+
+const string COLFILE("testColumnar.col");
+const string NAVFILE("testColumnar.rnx");
+const string LOGFILE("testColumnar.log");
+
+//@cond DUMMY
+///writes the given store to the columnar file
+bool writeStore(const RinexObsStore &store) {
+	FILE* out = fopen(COLFILE.c_str(), "wb");
+	if (out == NULL) return false;
+	ColumnarFile colFile;
+	bool ok = colFile.beginWrite(out) && store.writeColumnar(colFile) && colFile.endWrite();
+	return (fclose(out) == 0) && ok;
+}
+
+///loads the columnar file content, returning true if its layout is correct
+bool loadFile(ColumnarFile &colFile) {
+	FILE* in = fopen(COLFILE.c_str(), "rb");
+	if (in == NULL) return false;
+	bool ok = colFile.load(in);
+	fclose(in);
+	return ok;
+}
+
+///writes a file with a table of one FLOAT64 column with the given number of rows
+bool writeTable(unsigned long nRows) {
+	vector<double> data(nRows, 1.0);
+	FILE* out = fopen(COLFILE.c_str(), "wb");
+	if (out == NULL) return false;
+	ColumnarFile colFile;
+	bool ok = colFile.beginWrite(out) && colFile.beginTable("T", nRows, 1)
+		&& colFile.writeColumn("C", ColumnarFile::FLOAT64, sizeof(double), data.data()) && colFile.endWrite();
+	return (fclose(out) == 0) && ok;
+}
+
+///patches the file at the given position with the given 64 bits value
+bool patchFile(long pos, uint64_t value) {
+	FILE* file = fopen(COLFILE.c_str(), "r+b");
+	if (file == NULL) return false;
+	bool ok = (fseek(file, pos, SEEK_SET) == 0) && (fwrite(&value, sizeof value, 1, file) == 1);
+	return (fclose(file) == 0) && ok;
+}
+
+///checks that files with sizes overflowing or out of the file are rejected
+void checkWrongSizes() {
+	//offsets in the file of the table number of rows and of the column data size
+	const long ROWS_POS = 16 + 24;
+	const long DATASIZE_POS = 16 + 40 + 24;
+	ColumnarFile colFile;
+	//the number of rows times the element size (8) overflows to the data size (0)
+	CHECK(writeTable(0))
+	CHECK(patchFile(ROWS_POS, (uint64_t) 1 << 61))
+	CHECK(!loadFile(colFile))
+	//the data size wraps the position in the file
+	CHECK(writeTable(1))
+	CHECK(patchFile(ROWS_POS, ((uint64_t) 0 - 8) / 8) && patchFile(DATASIZE_POS, (uint64_t) 0 - 8))
+	CHECK(!loadFile(colFile))
+	//the data size exceeds the file size
+	CHECK(writeTable(1))
+	CHECK(patchFile(ROWS_POS, 1000) && patchFile(DATASIZE_POS, 8000))
+	CHECK(!loadFile(colFile))
+	//the file not modified is accepted
+	CHECK(writeTable(1))
+	CHECK(loadFile(colFile))
+	CHECK(colFile.getNumRows("T") == 1)
+}
+///checks that a store with epochs having the same time is read back unchanged
+void checkStoreRoundTrip() {
+	RinexObsStore store, loaded;
+	ColumnarFile colFile;
+	char sys;
+	int sat;
+	string obsType;
+	//an epoch with flag 0, the cycle slips for it (flag 6 and the same time), and the following epoch
+	store.addEpoch(100.0, 0, 0.5);
+	store.setObs(store.addSeries('G', 1, "C1C"), 20000001.125, 0, 7);
+	store.setObs(store.addSeries('G', 2, "L1C"), 20000002.125, 0, 6);
+	store.addEpoch(100.0, 6, 0.0);
+	store.setObs(store.addSeries('G', 2, "L1C"), 20000002.250, 1, 6);
+	store.addEpoch(101.0, 0, 0.5);
+	store.setObs(store.addSeries('G', 1, "C1C"), 20000011.125, 0, 7);
+	store.setObs(store.addSeries('E', 5, "C5Q"), 21000005.500, 0, 8);
+	CHECK(writeStore(store))
+	CHECK(loadFile(colFile))
+	CHECK(loaded.readColumnar(colFile))
+	CHECK(loaded.getNumEpochs() == store.getNumEpochs())
+	CHECK(loaded.getNumSeries() == store.getNumSeries())
+	if ((loaded.getNumEpochs() != store.getNumEpochs()) || (loaded.getNumSeries() != store.getNumSeries())) return;
+	for (unsigned int e = 0; e < store.getNumEpochs(); e++) {
+		CHECK(loaded.getTimes()[e] == store.getTimes()[e])
+		CHECK(loaded.getFlags()[e] == store.getFlags()[e])
+		CHECK(loaded.getClkOffsets()[e] == store.getClkOffsets()[e])
+	}
+	for (unsigned int s = 0; s < store.getNumSeries(); s++) {
+		CHECK(store.getSeriesId(s, sys, sat, obsType))
+		int ls = loaded.findSeries(sys, sat, obsType);
+		CHECK(ls >= 0)
+		if (ls < 0) continue;
+		for (unsigned int e = 0; e < store.getNumEpochs(); e++) {
+			CHECK(loaded.isPresent(ls, e) == store.isPresent(s, e))
+			if (!store.isPresent(s, e) || !loaded.isPresent(ls, e)) continue;
+			unsigned int pos = e - store.getFirstEpoch(s);
+			unsigned int lpos = e - loaded.getFirstEpoch(ls);
+			CHECK(loaded.getValues(ls)[lpos] == store.getValues(s)[pos])
+			CHECK(loaded.getLLIs(ls)[lpos] == store.getLLIs(s)[pos])
+			CHECK(loaded.getSSIs(ls)[lpos] == store.getSSIs(s)[pos])
+		}
+	}
+}
+///a V3.04 navigation file with two GPS ephemerides
+const string v3Nav =
+	"     3.04           NAVIGATION DATA     G: GPS              RINEX VERSION / TYPE\n"
+	"                                                            END OF HEADER       \n"
+	"G02 2023 12 08 22 35 28-6.658933125436E-04 2.780438990158E-09-2.220446049250E-16\n"
+	"     2.200000000000E+01-8.481562500000E+02-1.048686539147E-08-2.522816388743E-01\n"
+	"    -2.429448068142E-05 1.540757685434E-01 3.364682197571E-05 4.901621152878E+03\n"
+	"     5.646880000000E+05-1.377984881401E-05 1.033262426042E+00-2.971664071083E-05\n"
+	"     1.467556268352E+00-4.842500000000E+02 1.924884245898E+00 1.227884717756E-06\n"
+	"    -1.227908290166E-09 0.000000000000E+00 2.291000000000E+03 0.000000000000E+00\n"
+	"     6.144000000000E+03 3.300000000000E+01 2.095475792885E-08 7.900000000000E+02\n"
+	"     6.598800000000E+04 4.000000000000E+00\n"
+	"G04 2024 05 21 15 42 40 4.213443025947E-05 2.878550731111E-09 2.442490654175E-15\n"
+	"     2.400000000000E+01 6.725000000000E+02-1.034185935138E-08-9.233370236189E-01\n"
+	"     1.486949622631E-05 4.787291628309E-01-5.663372576237E-05 4.297742927551E+03\n"
+	"     2.975200000000E+05-1.169182360172E-05-2.526452525757E+00 4.293583333492E-05\n"
+	"    -1.412843651523E+00-8.272500000000E+02 2.118909246492E+00-2.117665352119E-06\n"
+	"    -5.964534161075E-11 2.000000000000E+00 2.315000000000E+03 1.000000000000E+00\n"
+	"     5.700000000000E+00 2.500000000000E+01-2.980232238770E-08 7.920000000000E+02\n"
+	"     4.920480000000E+05 6.000000000000E+00\n";
+
+///checks that all records in a navigation file are written to a columnar file and read back unchanged
+void checkNavRoundTrip() {
+	Logger log(LOGFILE);
+	RinexData writer(RinexData::V304, &log), reader(RinexData::V304, &log);
+	ColumnarFile colFile;
+	char sysW, sysR;
+	int satW, satR;
+	double boW[BO_MAXLINS][BO_MAXCOLS], boR[BO_MAXLINS][BO_MAXCOLS];
+	double tTagW, tTagR;
+	CHECK(writeTextFile(NAVFILE, v3Nav))
+	FILE* input = fopen(NAVFILE.c_str(), "r");
+	CHECK(input != NULL)
+	if (input == NULL) return;
+	CHECK(writer.readRinexHeader(input))
+	FILE* out = fopen(COLFILE.c_str(), "wb");
+	CHECK(colFile.beginWrite(out) && writer.writeNavColumnar(input, colFile) && colFile.endWrite())
+	fclose(out);
+	fclose(input);
+	CHECK(loadFile(colFile))
+	CHECK(colFile.getNumRows("NAVDATA") == 2)
+	CHECK(reader.readNavColumnar(colFile) == 2)
+	for (unsigned int i = 0; i < 2; i++) {
+		CHECK(writer.getNavData(sysW, satW, boW, tTagW, i))
+		CHECK(reader.getNavData(sysR, satR, boR, tTagR, i))
+		CHECK((sysR == 'G') && (sysR == sysW) && (satR == satW) && (tTagR == tTagW))
+		CHECK(memcmp(boR, boW, sizeof boR) == 0)
+	}
+	CHECK(reader.getNavData(sysR, satR, boR, tTagR, 1) && (satR == 4) && (boR[1][1] == 672.5))
+	remove(NAVFILE.c_str());
+}
+//@endcond
+
+int main() {
+	remove(LOGFILE.c_str());
+	checkStoreRoundTrip();
+	checkNavRoundTrip();
+	checkWrongSizes();
+	remove(COLFILE.c_str());
+	return testResult("testColumnar");
+}
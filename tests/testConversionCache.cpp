@@ -0,0 +1,104 @@
+/** @file testConversionCache.cpp
+ * Checks that ConversionCache gives different keys to inputs differing in a few bytes and to different parameters, that an
+ * entry is fetched only for inputs having the size stored in it, and that outputs are not changed when an entry is fetched partially.
+ *
+ *Copyright 2026 by Francisco Cancillo & Luis Cancillo
+ *<p>
+ *This file is part of the toRINEX tool.
+ *<p>
+ *<p>Ver.	|Date	|Reason for change
+ *<p>---------------------------------
+ *<p>V1.0	|10/2026|First release
+ */
+#include <string.h>
+#include <unistd.h>
+
+#include "TestUtils.h"
+#include "ConversionCache.h"
+
+const string INFILE1("testConversionCache1.in");
+const string INFILE2("testConversionCache2.in");
+const string OUTFILE("testConversionCache.out");
+const string OUTFILE2("testConversionCache2.out");
+const string CACHEDIR("testConversionCache.dir");
+const string LOGFILE("testConversionCache.log");
+const string PARAMS("toRINEX V1.0 -v 3.04");
+const string FORMER("former output");	//the content of an output before fetching it
+
+/**wordCollision gives two inputs of two 64 bits words which would have the same key if words were hashed as a whole using
+ * hash = (hash ^ word) * prime: the second word of the other input cancels the difference in the first one.
+ *
+ * @param input1 the first input
+ * @param input2 the second input
+ */
+void wordCollision(string &input1, string &input2) {
+	const uint64_t basis = 0xcbf29ce484222325ULL;
+	const uint64_t prime = 0x100000001b3ULL;
+	uint64_t words1[2] = {0x4141414141414141ULL, 0x4242424242424242ULL};
+	uint64_t words2[2] = {0x4343434343434343ULL, 0};
+	words2[1] = words1[1] ^ ((basis ^ words1[0]) * prime) ^ ((basis ^ words2[0]) * prime);
+	input1 = string((const char*) words1, sizeof words1);
+	input2 = string((const char*) words2, sizeof words2);
+}
+
+int main() {
+	string input1, input2, key1, key2;
+	uint64_t size1 = 0, size2 = 0;
+	remove(LOGFILE.c_str());
+	wordCollision(input1, input2);
+	CHECK(writeTextFile(INFILE1, input1))
+	CHECK(writeTextFile(INFILE2, input2))
+	{
+		Logger log(LOGFILE);
+		ConversionCache cache(CACHEDIR, 0, &log);
+		//the same input gives the same key and size, and inputs of the same size differing in some bytes other keys
+		CHECK(cache.computeKey(vector<string>(1, INFILE1), PARAMS, key1, size1))
+		CHECK(cache.computeKey(vector<string>(1, INFILE1), PARAMS, key2, size2))
+		CHECK((key1 == key2) && (size1 == 16) && (size2 == 16))
+		CHECK(cache.computeKey(vector<string>(1, INFILE2), PARAMS, key2, size2))
+		CHECK((key1 != key2) && (size2 == 16))
+		CHECK(cache.computeKey(vector<string>(1, INFILE1), PARAMS + " ", key2, size2))
+		CHECK(key1 != key2)
+		//an entry is fetched only for inputs of the size stored
+		CHECK(cache.store(key1, size1, vector<string>(1, INFILE1)))
+		CHECK(!cache.fetch(key1, size1 + 1, vector<string>(1, OUTFILE)))
+		CHECK(cache.fetch(key1, size1, vector<string>(1, OUTFILE)))
+		CHECK(readTextFile(OUTFILE) == input1)
+		//when a file of an entry is missing no output is changed
+		vector<string> outputs;
+		outputs.push_back(INFILE1);
+		outputs.push_back(INFILE2);
+		CHECK(cache.computeKey(outputs, PARAMS, key2, size2))
+		CHECK(cache.store(key2, size2, outputs))
+		CHECK(writeTextFile(OUTFILE, FORMER))
+		CHECK(writeTextFile(OUTFILE2, FORMER))
+		outputs[0] = OUTFILE;
+		outputs[1] = OUTFILE2;
+		CHECK(cache.fetch(key2, size2, outputs))
+		CHECK((readTextFile(OUTFILE) == input1) && (readTextFile(OUTFILE2) == input2))
+		CHECK(writeTextFile(OUTFILE, FORMER))
+		CHECK(writeTextFile(OUTFILE2, FORMER))
+		CHECK(remove((CACHEDIR + "/" + key2 + "/1").c_str()) == 0)
+		CHECK(!cache.fetch(key2, size2, outputs))
+		CHECK((readTextFile(OUTFILE) == FORMER) && (readTextFile(OUTFILE2) == FORMER))
+		//parameters differing in any of them give different strings
+		vector<string> sats(1, "G01"), obs(1, "C1C");
+		string params = ConversionCache::makeParams("toRINEX V1.0", RinexData::V304, sats, obs, true, 1);
+		CHECK(params == ConversionCache::makeParams("toRINEX V1.0", RinexData::V304, sats, obs, true, 1))
+		CHECK(params != ConversionCache::makeParams("toRINEX V1.0", RinexData::V210, sats, obs, true, 1))
+		CHECK(params != ConversionCache::makeParams("toRINEX V1.0", RinexData::V304, obs, sats, true, 1))
+		CHECK(params != ConversionCache::makeParams("toRINEX V1.0", RinexData::V304, sats, obs, false, 1))
+		CHECK(params != ConversionCache::makeParams("toRINEX V1.0", RinexData::V304, sats, obs, true, 0))
+		sats.push_back("G02");
+		CHECK(params != ConversionCache::makeParams("toRINEX V1.0", RinexData::V304, sats, obs, true, 1))
+		//remove all entries
+		ConversionCache emptier(CACHEDIR, 1, &log);
+		CHECK(emptier.evict() == 0)
+	}
+	rmdir(CACHEDIR.c_str());
+	remove(INFILE1.c_str());
+	remove(INFILE2.c_str());
+	remove(OUTFILE.c_str());
+	remove(OUTFILE2.c_str());
+	return testResult("testConversionCache");
+}
@@ -0,0 +1,142 @@
+/** @file testConversionServer.cpp
+ * Checks that ConversionServer parses request lines and formats replies as per its documentation, that jobs submitted
+ * in-process are converted, or end with an error when their input does not exist, and that outputs of inputs already converted
+ * are fetched from the conversion cache.
+ *
+ *Copyright 2026 by Francisco Cancillo & Luis Cancillo
+ *<p>
+ *This file is part of the toRINEX tool.
+ *<p>
+ *<p>Ver.	|Date	|Reason for change
+ *<p>---------------------------------
+ *<p>V1.0	|10/2026|First release
+ */
+#include <mutex>
+#include <unistd.h>
+
+#include "TestUtils.h"
+#include "ConversionServer.h"
+
+const string GRDFILE("testConversionServer.ORD");
+const string OBSFILE("testConversionServer.rnx");
+const string MISSINGFILE("testConversionServerMissing.ORD");
+const string LOGFILE("testConversionServer.log");
+const string CACHEDIR("testConversionServer.dir");
+
+//@cond DUMMY
+///a GRD observation file with a header message and two epochs of two satellites
+const string grdObs =
+	"50;.ORD;2\n"
+	"1;1000;-1270179999999999000;0.0;0.0;0;18;2\n"
+	"2;G1;1C;47;99999915938172;0.0;0;0.0;40.0;1575.42;0.0;0.1;10\n"
+	"2;G2;1C;47;99999921795195;0.0;0;0.0;40.0;1575.42;0.0;0.1;10\n"
+	"1;1000;-1270180000999999000;0.0;0.0;0;18;2\n"
+	"2;G1;1C;47;100999915937037;0.0;0;0.0;40.0;1575.42;0.0;0.1;10\n"
+	"2;G2;1C;47;100999921792925;0.0;0;0.0;40.0;1575.42;0.0;0.1;10\n";
+
+mutex statusLock;							//to store statuses given from worker threads
+vector<ConversionServer::JOBstatus> statuses;	//the statuses given to the callback
+
+///the callback of submitted jobs: stores the status of the job when it ends
+void storeStatus(const ConversionServer::JOBstatus &status) {
+	lock_guard<mutex> lock(statusLock);
+	if (status.done) statuses.push_back(status);
+}
+//@endcond
+
+/**checkRequests checks the parsing of well formed and wrong request lines, and the format of replies.
+ */
+void checkRequests() {
+	ConversionServer::CONVjob job;
+	CHECK(ConversionServer::parseJob("J1;3;a.ORD;a.rnx;;", job))
+	CHECK((job.id == "J1") && (job.version == RinexData::V304) && (job.ordFile == "a.ORD") && (job.obsFile == "a.rnx"))
+	CHECK(job.nrdFile.empty() && job.navFile.empty())
+	CHECK(ConversionServer::parseJob("J2;;;;a.NRD;a.nav", job))
+	CHECK((job.version == RinexData::VTBD) && (job.nrdFile == "a.NRD") && (job.navFile == "a.nav"))
+	//wrong version, no input, input without output, and missing fields
+	CHECK(!ConversionServer::parseJob("J3;4;a.ORD;a.rnx;;", job))
+	CHECK(!ConversionServer::parseJob("J4;3;;;;", job))
+	CHECK(!ConversionServer::parseJob("J5;3;a.ORD;;;", job))
+	CHECK(!ConversionServer::parseJob("J6;3;a.ORD;a.rnx", job))
+	CHECK(!ConversionServer::parseJob(";3;a.ORD;a.rnx;;", job))
+	ConversionServer::JOBstatus status;
+	status.id = "J1";
+	status.done = false;
+	status.ok = false;
+	status.worker = 2;
+	status.epochs = 0;
+	status.millis = 0.0;
+	CHECK(ConversionServer::formatStatus(status) == "J1;STARTED;2")
+	status.done = true;
+	status.message = "failed";
+	CHECK(ConversionServer::formatStatus(status) == "J1;ERROR;failed")
+	status.ok = true;
+	status.epochs = 2;
+	status.millis = 1.5;
+	CHECK(ConversionServer::formatStatus(status) == "J1;OK;2;1.500")
+}
+
+/**checkJobs submits a job converting the GRD file and a job with a missing input, and checks their statuses and output.
+ */
+void checkJobs() {
+	Logger log(LOGFILE);
+	ConversionServer server(2, &log);
+	ConversionServer::CONVjob job;
+	CHECK(ConversionServer::parseJob("OK1;3;" + GRDFILE + ";" + OBSFILE + ";;", job))
+	CHECK(server.submit(job, storeStatus))
+	CHECK(ConversionServer::parseJob("ERR1;3;" + MISSINGFILE + ";" + OBSFILE + ".2;;", job))
+	CHECK(server.submit(job, storeStatus))
+	server.waitIdle();
+	CHECK(statuses.size() == 2)
+	for (vector<ConversionServer::JOBstatus>::iterator it = statuses.begin(); it != statuses.end(); ++it) {
+		if (it->id == "OK1") {
+			CHECK(it->ok && (it->epochs == 2))
+		} else {
+			CHECK(!it->ok && (it->message == LOG_MSG_CSERROPEN + MISSINGFILE))
+			CHECK(ConversionServer::formatStatus(*it) == "ERR1;ERROR;" + LOG_MSG_CSERROPEN + MISSINGFILE)
+		}
+	}
+	string obs = readTextFile(OBSFILE);
+	CHECK(countText(obs, "END OF HEADER") == 1)
+	CHECK(countText(obs, "\n> ") == 2)
+}
+
+/**checkCache submits twice a job converting the GRD file using a conversion cache: the first time the output is converted and
+ * stored, and the second time it is fetched from the cache.
+ */
+void checkCache() {
+	Logger log(LOGFILE);
+	ConversionServer::CONVjob job;
+	statuses.clear();
+	{
+		ConversionServer server(2, CACHEDIR, 0, &log);
+		CHECK(ConversionServer::parseJob("C1;3;" + GRDFILE + ";" + OBSFILE + ";;", job))
+		CHECK(server.submit(job, storeStatus))
+		server.waitIdle();
+		remove(OBSFILE.c_str());
+		job.id = "C2";
+		CHECK(server.submit(job, storeStatus))
+		server.waitIdle();
+	}
+	CHECK(statuses.size() == 2)
+	if (statuses.size() == 2) {
+		CHECK(statuses[0].ok && !statuses[0].cached && (statuses[0].epochs == 2))
+		CHECK(statuses[1].ok && statuses[1].cached && (statuses[1].epochs == 0))
+	}
+	CHECK(countText(readTextFile(OBSFILE), "\n> ") == 2)
+	ConversionCache emptier(CACHEDIR, 1, &log);
+	CHECK(emptier.evict() == 0)
+}
+
+int main() {
+	remove(LOGFILE.c_str());
+	remove(MISSINGFILE.c_str());
+	CHECK(writeTextFile(GRDFILE, grdObs))
+	checkRequests();
+	checkJobs();
+	checkCache();
+	rmdir(CACHEDIR.c_str());
+	remove(GRDFILE.c_str());
+	remove(OBSFILE.c_str());
+	return testResult("testConversionServer");
+}
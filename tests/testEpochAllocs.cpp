@@ -0,0 +1,223 @@
+/** @file testEpochAllocs.cpp
+ * Checks that converting GRD and OSP observation epochs to RINEX does not allocate memory once the first epochs have been
+ * converted, counting the calls to the global operator new, and that both Logger::isLevel overloads agree.
+ *
+ *Copyright 2026 by Francisco Cancillo & Luis Cancillo
+ *<p>
+ *This file is part of the toRINEX tool.
+ *<p>
+ *<p>Ver.	|Date	|Reason for change
+ *<p>---------------------------------
+ *<p>V1.0	|10/2026|First release
+ */
+#include <new>
+#include <stdlib.h>
+#include <string.h>
+
+#include "TestUtils.h"
+#include "GNSSdataFromGRD.h"
+#include "GNSSdataFromOSP.h"
+
+const string GRDFILE("testEpochAllocs.ORD");
+const string OSPFILE("testEpochAllocs.osp");
+const string LOGFILE("testEpochAllocs.log");
+const int NEPOCHS = 30;			//the number of epochs in the GRD file
+const int WARMUP_EPOCHS = 5;	//the number of epochs converted before counting allocations
+const int NSATS = 5;			//the number of satellites in each epoch
+const int OSPWEEK = 2100;		//the GPS week of OSP epochs
+
+//@cond DUMMY
+static long long nAllocs = 0;	//the number of calls to the global operator new
+
+void* operator new(size_t size) {
+	nAllocs++;
+	void* p = malloc(size);
+	if (p == NULL) throw std::bad_alloc();
+	return p;
+}
+
+void operator delete(void* p) noexcept {
+	free(p);
+}
+
+///the satellites and the pseudorange of each one in the first epoch
+const char* satIds[] = {"G1", "G2", "G7", "G8", "G10"};
+const int satPrns[] = {1, 2, 7, 8, 10};
+const long long firstRanges[] = {99999915938172LL, 99999921795195LL, 99999919732245LL, 99999922428701LL, 99999922844572LL};
+//@endcond
+
+/**writeGRDfile writes a GRD observation file with NEPOCHS epochs, one per second, of five GPS satellites.
+ *
+ * @return true if the file was written, false otherwise
+ */
+bool writeGRDfile() {
+	char line[128];
+	string content("50;.ORD;2\n");
+	for (int e = 0; e < NEPOCHS; e++) {
+		snprintf(line, sizeof line, "1;1000;%lld;0.0;0.0;0;18;5\n", -1270179999999999000LL - e * 1000000000LL);
+		content += line;
+		for (int s = 0; s < 5; s++) {
+			snprintf(line, sizeof line, "2;%s;1C;47;%lld;0.0;0;0.0;40.0;1575.42;0.0;0.1;10\n",
+				satIds[s], firstRanges[s] + e * 1000000000LL - e * 1135LL * (s + 1));
+			content += line;
+		}
+	}
+	return writeTextFile(GRDFILE, content);
+}
+
+/**putFloating places in an OSP payload the bytes of a float or double value in the order OSPMessage gets them: the bytes of
+ * each 32 bits word in reverse order.
+ *
+ * @param payload the message payload
+ * @param pos the position in payload of the first byte of the value
+ * @param value the pointer to the value bytes
+ * @param size the size of the value (4 or 8)
+ */
+void putFloating(string &payload, int pos, const void* value, int size) {
+	unsigned char bytes[8];
+	memcpy(bytes, value, size);
+	for (int i = 0; i < size; i++) payload[pos + (i / 4) * 4 + 3 - i % 4] = (char) bytes[i];
+}
+
+/**putBigEndian places in an OSP payload an unsigned integer with the most significant byte first.
+ *
+ * @param payload the message payload
+ * @param pos the position in payload of the first byte of the value
+ * @param value the value
+ * @param size the number of bytes of the value
+ */
+void putBigEndian(string &payload, int pos, unsigned int value, int size) {
+	for (int i = 0; i < size; i++) payload[pos + i] = (char) ((value >> (8 * (size - 1 - i))) & 0xFF);
+}
+
+/**appendMessage appends to the given OSP data a message with the given payload, preceded by its length.
+ *
+ * @param osp the OSP data
+ * @param payload the message payload, starting with its MID
+ */
+void appendMessage(string &osp, const string &payload) {
+	osp += (char) ((payload.size() >> 8) & 0xFF);
+	osp += (char) (payload.size() & 0xFF);
+	osp += payload;
+}
+
+/**writeOSPfile writes an OSP file with NEPOCHS epochs, one per second, of five GPS satellites: for each epoch a MID28 with the
+ * measurements of each satellite, followed by a MID7 with the epoch time.
+ *
+ * @return true if the file was written, false otherwise
+ */
+bool writeOSPfile() {
+	string osp, mid28(56, '\0'), mid7(20, '\0');
+	for (int e = 0; e < NEPOCHS; e++) {
+		double tow = 100.0 + e;
+		for (int s = 0; s < NSATS; s++) {
+			double range = 20000000.0 + 1000.0 * s - 0.5 * e;
+			double phase = range + 0.25;
+			float frequency = -500.0f;
+			mid28[0] = 28;
+			mid28[1] = (char) s;			//channel
+			mid28[6] = (char) satPrns[s];
+			putFloating(mid28, 7, &tow, 8);
+			putFloating(mid28, 15, &range, 8);
+			putFloating(mid28, 23, &frequency, 4);
+			putFloating(mid28, 27, &phase, 8);
+			mid28[37] = 0x13;				//acquisition complete, phase and frequency valid
+			for (int i = 0; i < 10; i++) mid28[38 + i] = 40;	//C/N0
+			appendMessage(osp, mid28);
+		}
+		mid7[0] = 7;
+		putBigEndian(mid7, 1, OSPWEEK, 2);
+		putBigEndian(mid7, 3, (unsigned int) (tow * 100.0), 4);
+		mid7[7] = NSATS;
+		appendMessage(osp, mid7);
+	}
+	return writeTextFile(OSPFILE, osp);
+}
+
+/**checkEpochAllocs converts the GRD file to RINEX V3.04 and checks that epochs after the first ones do not allocate memory.
+ */
+void checkEpochAllocs() {
+	Logger log(LOGFILE);
+	GNSSdataFromGRD grd(&log);
+	RinexData rinex(RinexData::V304, &log);
+	CHECK(grd.openInputGRD("", GRDFILE))
+	CHECK(grd.collectHeaderData(rinex, 0, 0))
+	grd.rewindInputGRD();
+	FILE* out = tmpfile();
+	CHECK(out != NULL)
+	if (out == NULL) return;
+	rinex.printObsHeader(out);
+	int nEpochs = 0;
+	long long warmAllocs = 0;
+	while (grd.collectEpochObsData(rinex)) {
+		rinex.printObsEpoch(out);
+		rinex.clearObsData();
+		if (++nEpochs == WARMUP_EPOCHS) warmAllocs = nAllocs;
+	}
+	CHECK(nEpochs == NEPOCHS)
+	CHECK(nAllocs - warmAllocs == 0)
+	if (nAllocs != warmAllocs) fprintf(stderr, "%lld allocations in %d epochs\n", nAllocs - warmAllocs, nEpochs - WARMUP_EPOCHS);
+	fclose(out);
+}
+
+/**checkOSPEpochAllocs converts the OSP file to RINEX V3.04 and checks that epochs after the first ones do not allocate memory.
+ */
+void checkOSPEpochAllocs() {
+	const char* obsTypes[] = {"C1C", "L1C", "D1C", "S1C"};
+	vector<string> obsIds(obsTypes, obsTypes + 4);
+	Logger log(LOGFILE);
+	RinexData rinex(RinexData::V304, &log);
+	FILE* input = fopen(OSPFILE.c_str(), "rb");
+	FILE* out = tmpfile();
+	CHECK((input != NULL) && (out != NULL))
+	if ((input == NULL) || (out == NULL)) return;
+	{
+		GNSSdataFromOSP osp("TEST", 4, true, input, &log);
+		osp.acqHeaderData(rinex);	//without MID2 and MID6 messages, only time data are acquired
+		CHECK(rinex.setHdLnData(RinexData::SYS, 'G', obsIds))
+		rewind(input);
+		rinex.printObsHeader(out);
+		int nEpochs = 0;
+		long long warmAllocs = 0;
+		while (osp.acqEpochData(rinex, false, false)) {
+			rinex.printObsEpoch(out);
+			rinex.clearObsData();
+			if (++nEpochs == WARMUP_EPOCHS) warmAllocs = nAllocs;
+		}
+		CHECK(nEpochs == NEPOCHS)
+		CHECK(nAllocs - warmAllocs == 0)
+		if (nAllocs != warmAllocs) fprintf(stderr, "%lld allocations in %d OSP epochs\n", nAllocs - warmAllocs, nEpochs - WARMUP_EPOCHS);
+	}
+	//the last epoch printed has the observables of all satellites
+	rewind(out);
+	char line[128];
+	int nSatLines = 0;
+	while (fgets(line, sizeof line, out) != NULL) if (strncmp(line, "G10", 3) == 0) nSatLines++;
+	CHECK(nSatLines == NEPOCHS)
+	fclose(out);
+	fclose(input);
+}
+
+/**checkLogLevels checks that Logger::isLevel gives the same result for a level and for its description.
+ */
+void checkLogLevels() {
+	Logger log(LOGFILE);
+	const char* descriptions[] = {"SEVERE", "WARNING", "INFO", "CONFIG", "FINE", "FINER", "FINEST"};
+	log.setLevel("CONFIG");
+	for (int level = Logger::SEVERE; level <= Logger::FINEST; level++) {
+		CHECK(log.isLevel((Logger::logLevel) level) == (level <= Logger::CONFIG))
+		CHECK(log.isLevel(string(descriptions[level])) == log.isLevel((Logger::logLevel) level))
+	}
+}
+
+int main() {
+	remove(LOGFILE.c_str());
+	CHECK(writeGRDfile())
+	CHECK(writeOSPfile())
+	checkEpochAllocs();
+	checkOSPEpochAllocs();
+	checkLogLevels();
+	remove(GRDFILE.c_str());
+	remove(OSPFILE.c_str());
+	return testResult("testEpochAllocs");
+}
@@ -0,0 +1,69 @@
+/** @file testHeaderSnapshot.cpp
+ * Checks that a header snapshot can be used after the RinexData object and Logger it was taken from are deleted, and that
+ * writers created from it print the header data read, each one in its own version.
+ *
+ *Copyright 2026 by Francisco Cancillo & Luis Cancillo
+ *<p>
+ *This file is part of the toRINEX tool.
+ *<p>
+ *<p>Ver.	|Date	|Reason for change
+ *<p>---------------------------------
+ *<p>V1.0	|10/2026|First release
+ */
+#include "TestUtils.h"
+
+const string OBSFILE("testHeaderSnapshot.rnx");
+const string V3FILE("testHeaderSnapshotV3.rnx");
+const string V2FILE("testHeaderSnapshotV2.rnx");
+const string LOGFILE("testHeaderSnapshot.log");
+const string WRITERLOG("testHeaderSnapshotWriter.log");
+
+//@cond DUMMY
+///a V3.04 observation file header with GPS observables
+const string v3Obs =
+	"     3.04           OBSERVATION DATA    G: GPS              RINEX VERSION / TYPE\n"
+	"SNAPSHOT                                                    MARKER NAME         \n"
+	"G    2 C1C L1C                                              SYS / # / OBS TYPES \n"
+	"                                                            END OF HEADER       \n";
+//@endcond
+
+int main() {
+	shared_ptr<const RinexData::HDRdata> snapshot;
+	remove(LOGFILE.c_str());
+	remove(WRITERLOG.c_str());
+	CHECK(writeTextFile(OBSFILE, v3Obs))
+	//the reader and its Logger are deleted before using the snapshot
+	{
+		Logger log(LOGFILE);
+		RinexData reader(RinexData::V304, &log);
+		FILE* input = fopen(OBSFILE.c_str(), "r");
+		CHECK(input != NULL)
+		if (input == NULL) return testResult("testHeaderSnapshot");
+		CHECK(reader.readRinexHeader(input))
+		fclose(input);
+		snapshot = reader.getHeaderSnapshot();
+	}
+	{
+		Logger log(WRITERLOG);
+		RinexData v3Writer(RinexData::VTBD, snapshot, &log);
+		RinexData v2Writer(RinexData::V210, snapshot, &log);
+		FILE* v3 = fopen(V3FILE.c_str(), "w");
+		FILE* v2 = fopen(V2FILE.c_str(), "w");
+		CHECK((v3 != NULL) && (v2 != NULL))
+		if ((v3 == NULL) || (v2 == NULL)) return testResult("testHeaderSnapshot");
+		v3Writer.printObsHeader(v3);
+		v2Writer.printObsHeader(v2);
+		fclose(v3);
+		fclose(v2);
+	}
+	string v3Hdr = readTextFile(V3FILE);
+	string v2Hdr = readTextFile(V2FILE);
+	CHECK(countText(v3Hdr, "     3.04") == 1)
+	CHECK(countText(v2Hdr, "     2.10") == 1)
+	CHECK(countText(v3Hdr, "SNAPSHOT") == 1)
+	CHECK(countText(v2Hdr, "SNAPSHOT") == 1)
+	remove(OBSFILE.c_str());
+	remove(V3FILE.c_str());
+	remove(V2FILE.c_str());
+	return testResult("testHeaderSnapshot");
+}
@@ -0,0 +1,150 @@
+/** @file testNavEvaluator.cpp
+ * Checks that NavEvaluator selects the nearest valid ephemeris of a satellite, even when a nearer one with a shorter validity
+ * interval is too old, and that the satellite states computed agree with positions computed in closed form from Keplerian
+ * elements, and with the GLONASS state vector at its reference time.
+ *
+ *Copyright 2026 by Francisco Cancillo & Luis Cancillo
+ *<p>
+ *This file is part of the toRINEX tool.
+ *<p>
+ *<p>Ver.	|Date	|Reason for change
+ *<p>---------------------------------
+ *<p>V1.0	|10/2026|First release
+ */
+#include <math.h>
+
+#include "TestUtils.h"
+#include "NavEvaluator.h"
+
+const double WEEK = 2100.0 * 604800.0;	//the start of the GPS week of ephemerides
+const double TOE = 7200.0;				//the time of ephemeris in the week of the first GPS ephemeris
+const double GPS_MU = 3.986005e14;
+const double GPS_OMEGAE = 7.2921151467e-5;
+const double GPS_F = -4.442807633e-10;
+
+/**setKepler sets in the given broadcast orbit the Keplerian elements and clock parameters of a GPS ephemeris without
+ * harmonic corrections.
+ *
+ * @param bo the broadcast orbit data
+ * @param toe the time of ephemeris in the week
+ * @param e the eccentricity
+ * @param fit the fit interval in hours
+ */
+void setKepler(double (&bo)[BO_MAXLINS][BO_MAXCOLS], double toe, double e, double fit) {
+	memset(bo, 0, sizeof bo);
+	bo[0][1] = 1.0e-4;		//af0, af1, af2
+	bo[0][2] = 1.0e-11;
+	bo[0][3] = 0.0;
+	bo[1][3] = 0.2;			//M0
+	bo[2][1] = e;
+	bo[2][3] = 5153.7;		//sqrtA
+	bo[3][0] = toe;
+	bo[3][2] = 1.0;			//OMEGA0
+	bo[4][0] = 0.96;		//i0
+	bo[4][2] = 0.5;			//omega
+	bo[7][1] = fit;
+}
+
+/**keplerPosition computes in closed form the ECEF position and clock correction for the ephemeris set by setKepler, solving
+ * the Kepler equation until convergence.
+ *
+ * @param bo the broadcast orbit data
+ * @param tk the time from the time of ephemeris
+ * @param pos the position computed
+ * @param clk the clock correction computed
+ */
+void keplerPosition(const double (&bo)[BO_MAXLINS][BO_MAXCOLS], double tk, double (&pos)[3], double &clk) {
+	double e = bo[2][1];
+	double a = bo[2][3] * bo[2][3];
+	double m = bo[1][3] + sqrt(GPS_MU / (a * a * a)) * tk;
+	double ea = m, former;
+	do {
+		former = ea;
+		ea = m + e * sin(ea);
+	} while (fabs(ea - former) > 1.0e-15);
+	double v = 2.0 * atan(sqrt((1.0 + e) / (1.0 - e)) * tan(ea / 2.0));
+	double u = v + bo[4][2];
+	double r = a * (1.0 - e * cos(ea));
+	double node = bo[3][2] - GPS_OMEGAE * (tk + bo[3][0]);
+	pos[0] = r * (cos(u) * cos(node) - sin(u) * cos(bo[4][0]) * sin(node));
+	pos[1] = r * (cos(u) * sin(node) + sin(u) * cos(bo[4][0]) * cos(node));
+	pos[2] = r * sin(u) * sin(bo[4][0]);
+	clk = bo[0][1] + bo[0][2] * tk + GPS_F * e * bo[2][3] * sin(ea);
+}
+
+/**checkSelection checks the ephemeris selected for a satellite having an ephemeris with an 8 hours fit interval followed, one
+ * hour later, by other with a 4 hours fit interval.
+ */
+void checkSelection() {
+	NavEvaluator evaluator;
+	double bo[BO_MAXLINS][BO_MAXCOLS];
+	setKepler(bo, TOE, 0.01, 8.0);
+	CHECK(evaluator.addEphemeris('G', 5, bo, WEEK + TOE))
+	setKepler(bo, TOE + 3600.0, 0.01, 4.0);
+	CHECK(evaluator.addEphemeris('G', 5, bo, WEEK + TOE + 3600.0))
+	//the second ephemeris while it is valid, and then the first one, valid for 4 hours
+	CHECK(evaluator.findEphemeris('G', 5, WEEK + TOE + 3700.0) == 1)
+	CHECK(evaluator.findEphemeris('G', 5, WEEK + TOE + 3600.0 + 9000.0) == 0)
+	CHECK(evaluator.findEphemeris('G', 5, WEEK + TOE - 14000.0) == 0)
+	CHECK(evaluator.findEphemeris('G', 5, WEEK + TOE + 15000.0) == -1)
+	CHECK(evaluator.findEphemeris('G', 6, WEEK + TOE) == -1)
+}
+
+/**checkKepler checks the states computed from a GPS ephemeris at several times against the ones computed in closed form.
+ */
+void checkKepler() {
+	NavEvaluator evaluator;
+	NavEvaluator::SATstates states;
+	double bo[BO_MAXLINS][BO_MAXCOLS];
+	double pos[3], clk;
+	setKepler(bo, TOE, 0.02, 4.0);
+	CHECK(evaluator.addEphemeris('G', 7, bo, WEEK + TOE))
+	vector<double> times;
+	for (double tk = -7200.0; tk <= 7200.0; tk += 1800.0) times.push_back(WEEK + TOE + tk);
+	times.push_back(WEEK + TOE + 7300.0);	//too old
+	CHECK(evaluator.evaluateSat('G', 7, times, states) == times.size() - 1)
+	for (unsigned int i = 0; i + 1 < times.size(); i++) {
+		keplerPosition(bo, times[i] - WEEK - TOE, pos, clk);
+		CHECK((fabs(states.x[i] - pos[0]) < 1.0e-3) && (fabs(states.y[i] - pos[1]) < 1.0e-3) && (fabs(states.z[i] - pos[2]) < 1.0e-3))
+		CHECK(fabs(states.clk[i] - clk) < 1.0e-15)
+	}
+	CHECK(states.valid.back() == 0)
+}
+
+/**checkGlonass checks the states computed from a GLONASS ephemeris of a circular orbit: at its reference time they are the
+ * state vector given, and the orbit radius is kept after integrating it for 15 minutes.
+ */
+void checkGlonass() {
+	const double mu = 3.9860044e14;
+	const double omegaE = 7.292115e-5;
+	const double radius = 25510000.0;
+	const double inc = 64.8 * M_PI / 180.0;
+	NavEvaluator evaluator;
+	NavEvaluator::SATstates states;
+	double bo[BO_MAXLINS][BO_MAXCOLS];
+	memset(bo, 0, sizeof bo);
+	//a satellite at the ascending node, with its inertial velocity expressed in the rotating frame (km and km/s)
+	double speed = sqrt(mu / radius);
+	bo[0][1] = 2.0e-5;
+	bo[0][2] = 1.0e-12;
+	bo[1][0] = radius / 1000.0;
+	bo[2][1] = (speed * cos(inc) - omegaE * radius) / 1000.0;
+	bo[3][1] = speed * sin(inc) / 1000.0;
+	CHECK(evaluator.addEphemeris('R', 3, bo, WEEK + TOE))
+	vector<double> times;
+	times.push_back(WEEK + TOE);
+	times.push_back(WEEK + TOE + 900.0);
+	CHECK(evaluator.evaluateSat('R', 3, times, states) == 2)
+	CHECK((states.x[0] == radius) && (states.y[0] == 0.0) && (states.z[0] == 0.0) && (states.clk[0] == 2.0e-5))
+	double r = sqrt(states.x[1] * states.x[1] + states.y[1] * states.y[1] + states.z[1] * states.z[1]);
+	CHECK(fabs(r - radius) < 10000.0)
+	CHECK(states.z[1] > speed * sin(inc) * 800.0)
+	CHECK(fabs(states.clk[1] - (2.0e-5 + 1.0e-12 * 900.0)) < 1.0e-18)
+}
+
+int main() {
+	checkSelection();
+	checkKepler();
+	checkGlonass();
+	return testResult("testNavEvaluator");
+}
@@ -0,0 +1,84 @@
+/** @file testNavMerge.cpp
+ * Checks that RinexData::mergeNavFiles stores each ephemeris once, taking the copy found in more files and, in case of
+ * a tie, the one with the lowest values.
+ *
+ *Copyright 2026 by Francisco Cancillo & Luis Cancillo
+ *<p>
+ *This file is part of the toRINEX tool.
+ *<p>
+ *<p>Ver.	|Date	|Reason for change
+ *<p>---------------------------------
+ *<p>V1.0	|10/2026|First release
+ */
+#include "TestUtils.h"
+
+const string NAVFILE1("testNavMerge1.rnx");
+const string NAVFILE2("testNavMerge2.rnx");
+const string MERGEDFILE("testNavMerge.rnx");
+const string LOGFILE("testNavMerge.log");
+
+//@cond DUMMY
+///the header of the navigation files
+const string v3NavHeader =
+	"     3.04           N: GNSS NAV DATA    G: GPS              RINEX VERSION / TYPE\n"
+	"                                                            END OF HEADER       \n";
+///the lines of a GPS ephemeris before the Crs value
+const string v3NavStart =
+	"G02 2023 12 08 22 35 28-6.658933125436E-04 2.780438990158E-09-2.220446049250E-16\n"
+	"     2.200000000000E+01";
+///the lines of a GPS ephemeris after the Crs value
+const string v3NavEnd =
+	"-1.048686539147E-08-2.522816388743E-01\n"
+	"    -2.429448068142E-05 1.540757685434E-01 3.364682197571E-05 4.901621152878E+03\n"
+	"     5.646880000000E+05-1.377984881401E-05 1.033262426042E+00-2.971664071083E-05\n"
+	"     1.467556268352E+00-4.842500000000E+02 1.924884245898E+00 1.227884717756E-06\n"
+	"    -1.227908290166E-09 0.000000000000E+00 2.291000000000E+03 0.000000000000E+00\n"
+	"     6.144000000000E+03 3.300000000000E+01 2.095475792885E-08 7.900000000000E+02\n"
+	"     6.598800000000E+04 4.000000000000E+00\n";
+//@endcond
+
+/**mergeCrs merges two navigation files with a copy of the same ephemeris, each one with the given Crs value.
+ *
+ * @param crs1 the Crs value in the first file
+ * @param crs2 the Crs value in the second file
+ * @return the Crs value of the ephemeris in the merged file, or 0.0 if it cannot be read
+ */
+double mergeCrs(const string &crs1, const string &crs2) {
+	char sys;
+	int sat;
+	double bo[BO_MAXLINS][BO_MAXCOLS];
+	double tTag;
+	Logger log(LOGFILE);
+	CHECK(writeTextFile(NAVFILE1, v3NavHeader + v3NavStart + crs1 + v3NavEnd))
+	CHECK(writeTextFile(NAVFILE2, v3NavHeader + v3NavStart + crs2 + v3NavEnd))
+	RinexData merger(RinexData::V304, &log);
+	vector<FILE*> inputs;
+	inputs.push_back(fopen(NAVFILE1.c_str(), "r"));
+	inputs.push_back(fopen(NAVFILE2.c_str(), "r"));
+	FILE* out = fopen(MERGEDFILE.c_str(), "w");
+	CHECK((inputs[0] != NULL) && (inputs[1] != NULL) && (out != NULL))
+	CHECK(merger.mergeNavFiles(inputs, out, 2) == 1)
+	fclose(inputs[0]);
+	fclose(inputs[1]);
+	fclose(out);
+	RinexData rinex(RinexData::V304, &log);
+	FILE* input = fopen(MERGEDFILE.c_str(), "r");
+	if (input == NULL) return 0.0;
+	rinex.readRinexHeader(input);
+	bool read = (rinex.readNavEpoch(input) == 1) && rinex.getNavData(sys, sat, bo, tTag, 0);
+	CHECK(rinex.readNavEpoch(input) == 0)
+	fclose(input);
+	return read? bo[1][1] : 0.0;
+}
+
+int main() {
+	remove(LOGFILE.c_str());
+	//the lowest value is taken, whatever its sign and the order of files
+	CHECK(mergeCrs(" 5.000000000000E-01", "-1.000000000000E+00") == -1.0)
+	CHECK(mergeCrs("-1.000000000000E+00", " 5.000000000000E-01") == -1.0)
+	CHECK(mergeCrs(" 2.500000000000E+00", " 3.000000000000E+00") == 2.5)
+	remove(NAVFILE1.c_str());
+	remove(NAVFILE2.c_str());
+	remove(MERGEDFILE.c_str());
+	return testResult("testNavMerge");
+}
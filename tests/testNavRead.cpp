@@ -0,0 +1,67 @@
+/** @file testNavRead.cpp
+ * Checks the data that RinexData::readNavEpoch obtains from the records of a V3.04 mixed navigation file.
+ *
+ *Copyright 2026 by Francisco Cancillo & Luis Cancillo
+ *<p>
+ *This file is part of the toRINEX tool.
+ *<p>
+ *<p>Ver.	|Date	|Reason for change
+ *<p>---------------------------------
+ *<p>V1.0	|10/2026|First release
+ */
+#include "TestUtils.h"
+
+const string NAVFILE("testNavRead.rnx");
+const string LOGFILE("testNavRead.log");
+
+//@cond DUMMY
+///a V3.04 mixed navigation file with a GPS ephemeris (8 lines) followed by a GLONASS one (4 lines)
+const string v3Nav =
+	"     3.04           N: GNSS NAV DATA    M: Mixed            RINEX VERSION / TYPE\n"
+	"                                                            END OF HEADER       \n"
+	"G02 2023 12 08 22 35 28-6.658933125436E-04 2.780438990158E-09-2.220446049250E-16\n"
+	"     2.200000000000E+01-8.481562500000E+02-1.048686539147E-08-2.522816388743E-01\n"
+	"    -2.429448068142E-05 1.540757685434E-01 3.364682197571E-05 4.901621152878E+03\n"
+	"     5.646880000000E+05-1.377984881401E-05 1.033262426042E+00-2.971664071083E-05\n"
+	"     1.467556268352E+00-4.842500000000E+02 1.924884245898E+00 1.227884717756E-06\n"
+	"    -1.227908290166E-09 0.000000000000E+00 2.291000000000E+03 0.000000000000E+00\n"
+	"     6.144000000000E+03 3.300000000000E+01 2.095475792885E-08 7.900000000000E+02\n"
+	"     6.598800000000E+04 4.000000000000E+00\n"
+	"R05 2023 12 08 22 45 00 1.234567890123E-05 0.000000000000E+00 8.100000000000E+04\n"
+	"     1.234567890000E+04 1.234000000000E+00 0.000000000000E+00 0.000000000000E+00\n"
+	"    -1.234567890000E+04 2.345000000000E+00 0.000000000000E+00 1.000000000000E+00\n"
+	"     2.000000000000E+04-3.456000000000E+00 9.313225746155E-10 0.000000000000E+00\n";
+//@endcond
+
+int main() {
+	char sys;
+	int sat;
+	double bo[BO_MAXLINS][BO_MAXCOLS];
+	double tTag;
+	remove(LOGFILE.c_str());
+	CHECK(writeTextFile(NAVFILE, v3Nav))
+	Logger log(LOGFILE);
+	RinexData rinex(RinexData::V304, &log);
+	FILE* input = fopen(NAVFILE.c_str(), "r");
+	CHECK(input != NULL)
+	CHECK(rinex.readRinexHeader(input))
+	//the GPS ephemeris
+	CHECK(rinex.readNavEpoch(input) == 1)
+	CHECK(rinex.getNavData(sys, sat, bo, tTag, 0))
+	CHECK((sys == 'G') && (sat == 2))
+	CHECK((bo[0][1] == -6.658933125436E-04) && (bo[0][2] == 2.780438990158E-09) && (bo[0][3] == -2.220446049250E-16))
+	CHECK(bo[7][1] == 4.0)
+	//the GLONASS ephemeris
+	CHECK(rinex.readNavEpoch(input) == 1)
+	CHECK(rinex.getNavData(sys, sat, bo, tTag, 0))
+	CHECK((sys == 'R') && (sat == 5))
+	CHECK((bo[0][1] == 1.234567890123E-05) && (bo[0][3] == 8.1E+04))
+	CHECK(bo[3][2] == 9.313225746155E-10)
+	//broadcast orbit lines not in GLONASS records are empty
+	for (int i = 4; i < BO_MAXLINS; i++)
+		for (int j = 0; j < BO_MAXCOLS; j++) CHECK(bo[i][j] == 0.0)
+	CHECK(rinex.readNavEpoch(input) == 0)
+	fclose(input);
+	remove(NAVFILE.c_str());
+	return testResult("testNavRead");
+}
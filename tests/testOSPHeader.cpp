@@ -0,0 +1,80 @@
+/** @file testOSPHeader.cpp
+ * Checks that GNSSdataFromOSP::acqHeaderData for RINEX and RTK, which reads the whole OSP file, sets the observation interval
+ * and the time of first observation from the first MID7 messages, and later MID7 messages do not change them.
+ *
+ *Copyright 2026 by Francisco Cancillo & Luis Cancillo
+ *<p>
+ *This file is part of the toRINEX tool.
+ *<p>
+ *<p>Ver.	|Date	|Reason for change
+ *<p>---------------------------------
+ *<p>V1.0	|10/2026|First release
+ */
+#include "TestUtils.h"
+#include "GNSSdataFromOSP.h"
+#include "RTKobservation.h"
+
+const string OSPFILE("testOSPHeader.osp");
+const string LOGFILE("testOSPHeader.log");
+const int MINSATS = 4;		//the minimum number of satellites for a fix
+const int WEEK = 2100;		//the GPS week of MID7 messages
+
+/**appendMessage appends to the given OSP data a message with the given payload, preceded by its length.
+ *
+ * @param osp the OSP data
+ * @param payload the message payload, starting with its MID
+ */
+void appendMessage(string &osp, const string &payload) {
+	osp += (char) ((payload.size() >> 8) & 0xFF);
+	osp += (char) (payload.size() & 0xFF);
+	osp += payload;
+}
+
+/**appendEpoch appends to the given OSP data the messages of an epoch: a MID28 with measurements (only its MID is relevant
+ * here), and a MID7 with the given time of week and number of satellites in the solution.
+ *
+ * @param osp the OSP data
+ * @param tow the time of week, in seconds
+ * @param sats the number of satellites in the solution
+ */
+void appendEpoch(string &osp, double tow, int sats) {
+	string mid7(20, '\0');
+	unsigned int towScaled = (unsigned int) (tow * 100.0);
+	mid7[0] = 7;
+	mid7[1] = (char) ((WEEK >> 8) & 0xFF);
+	mid7[2] = (char) (WEEK & 0xFF);
+	for (int i = 0; i < 4; i++) mid7[3 + i] = (char) ((towScaled >> (8 * (3 - i))) & 0xFF);
+	mid7[7] = (char) sats;
+	appendMessage(osp, string(1, (char) 28));
+	appendMessage(osp, mid7);
+}
+
+int main() {
+	int week = 0;
+	double tow = 0.0, interval = 0.0;
+	char timeSys = ' ';
+	remove(LOGFILE.c_str());
+	//the interval is the one between the first two epochs; the last epoch has too few satellites
+	string osp;
+	appendEpoch(osp, 100.0, 8);
+	appendEpoch(osp, 101.0, 8);
+	appendEpoch(osp, 200.0, 8);
+	appendEpoch(osp, 300.0, MINSATS - 1);
+	CHECK(writeTextFile(OSPFILE, osp))
+	FILE* input = fopen(OSPFILE.c_str(), "rb");
+	CHECK(input != NULL)
+	if (input == NULL) return testResult("testOSPHeader");
+	{
+		Logger log(LOGFILE);
+		RinexData rinex(RinexData::V304, &log);
+		RTKobservation rtko("testOSPHeader", OSPFILE);
+		GNSSdataFromOSP gnssData("TEST", MINSATS, true, input, &log);
+		gnssData.acqHeaderData(rinex, rtko);
+		CHECK(rinex.getHdLnData(RinexData::INT, interval) && (interval == 1.0))
+		CHECK(rinex.getHdLnData(RinexData::TOFO, week, tow, timeSys) && (week == WEEK) && (tow == 100.0))
+	}
+	fclose(input);
+	CHECK(countText(readTextFile(LOGFILE), "Observation interval;") == 1)
+	remove(OSPFILE.c_str());
+	return testResult("testOSPHeader");
+}
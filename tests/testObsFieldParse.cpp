@@ -0,0 +1,86 @@
+/** @file testObsFieldParse.cpp
+ * Checks that RinexData reads observables from their F14.3 fields without taking the following LLI and signal strength digits
+ * as part of the value, for V2.10 and V3.04 files, and that satellites and observables filtered out are not read.
+ *
+ *Copyright 2026 by Francisco Cancillo & Luis Cancillo
+ *<p>
+ *This file is part of the toRINEX tool.
+ *<p>
+ *<p>Ver.	|Date	|Reason for change
+ *<p>---------------------------------
+ *<p>V1.0	|10/2026|First release
+ */
+#include <math.h>
+
+#include "TestUtils.h"
+
+const string V2FILE("testObsFieldParse2.rnx");
+const string V3FILE("testObsFieldParse3.rnx");
+const string LOGFILE("testObsFieldParse.log");
+
+//@cond DUMMY
+const string v2Obs =
+	"     2.10           OBSERVATION DATA    G (GPS)             RINEX VERSION / TYPE\n"
+	"     2    C1    L1                                          # / TYPES OF OBSERV \n"
+	"                                                            END OF HEADER       \n"
+	" 20  4  5  0  0 10.0000000  0  2G01G02\n"
+	"  23619095.44979  23619095.449 9\n"
+	"  23619096.125    23619096.12501\n";
+const string v3Obs =
+	"     3.04           OBSERVATION DATA    M: Mixed            RINEX VERSION / TYPE\n"
+	"G    2 C1C L1C                                              SYS / # / OBS TYPES \n"
+	"                                                            END OF HEADER       \n"
+	"> 2020 04 05 00 00 10.0000000  0  2      0.000000000000\n"
+	"G01  23619095.44979  23619095.449 9\n"
+	"G02  23619096.125    23619096.12501\n";
+
+///reads the first epoch in the given file, applying the given filter, and checks the observables read
+void checkFile(const string &name, const string &content, RinexData::RINEXversion version) {
+	vector<string> selSat, selObs;
+	char sys;
+	int sat, lol, strg;
+	string obsType;
+	double value;
+	CHECK(writeTextFile(name, content))
+	Logger log(LOGFILE);
+	//no filter: all observables are read
+	RinexData rinex(version, &log);
+	FILE* input = fopen(name.c_str(), "r");
+	CHECK(input != NULL)
+	if (input == NULL) return;
+	CHECK(rinex.readRinexHeader(input))
+	CHECK(rinex.readObsEpoch(input) != 0)
+	CHECK(rinex.getObsData(sys, sat, obsType, value, lol, strg, 0))
+	CHECK((sys == 'G') && (sat == 1) && (obsType == "C1C"))
+	CHECK(fabs(value - 23619095.449) < 1E-6)
+	CHECK((lol == 7) && (strg == 9))
+	CHECK(rinex.getObsData(sys, sat, obsType, value, lol, strg, 1))
+	CHECK(fabs(value - 23619095.449) < 1E-6)
+	CHECK((lol == 0) && (strg == 9))
+	CHECK(rinex.getObsData(sys, sat, obsType, value, lol, strg, 3))
+	CHECK((sat == 2) && (fabs(value - 23619096.125) < 1E-6))
+	CHECK((lol == 0) && (strg == 1))
+	CHECK(!rinex.getObsData(sys, sat, obsType, value, lol, strg, 4))
+	fclose(input);
+	//filter: only L1C from G02 is read
+	RinexData filtered(version, &log);
+	input = fopen(name.c_str(), "r");
+	CHECK(filtered.readRinexHeader(input))
+	selSat.push_back("G02");
+	selObs.push_back("GL1C");
+	CHECK(filtered.setFilter(selSat, selObs))
+	CHECK(filtered.readObsEpoch(input) != 0)
+	CHECK(filtered.getObsData(sys, sat, obsType, value, lol, strg, 0))
+	CHECK((sat == 2) && (obsType == "L1C") && (fabs(value - 23619096.125) < 1E-6))
+	CHECK(!filtered.getObsData(sys, sat, obsType, value, lol, strg, 1))
+	fclose(input);
+	remove(name.c_str());
+}
+//@endcond
+
+int main() {
+	remove(LOGFILE.c_str());
+	checkFile(V2FILE, v2Obs, RinexData::V210);
+	checkFile(V3FILE, v3Obs, RinexData::V304);
+	return testResult("testObsFieldParse");
+}
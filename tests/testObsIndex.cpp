@@ -0,0 +1,86 @@
+/** @file testObsIndex.cpp
+ * Checks that buildObsEpochIndex loads the epoch index from its sidecar file only when it was built for an input file having the
+ * current size and modification time, and scans the input file again when other file with the same size replaces it.
+ *
+ *Copyright 2026 by Francisco Cancillo & Luis Cancillo
+ *<p>
+ *This file is part of the toRINEX tool.
+ *<p>
+ *<p>Ver.	|Date	|Reason for change
+ *<p>---------------------------------
+ *<p>V1.0	|10/2026|First release
+ */
+#include <utime.h>
+
+#include "TestUtils.h"
+
+const string OBSFILE("testObsIndex.rnx");
+const string IDXFILE("testObsIndex.idx");
+const string LOGFILE("testObsIndex.log");
+const time_t FILETIME = 1600000000;		//the modification time set to the input file
+
+//@cond DUMMY
+///a V3.04 observation file with three epochs
+const string v3Obs =
+	"     3.04           OBSERVATION DATA    G: GPS              RINEX VERSION / TYPE\n"
+	"G    1 C1C                                                  SYS / # / OBS TYPES \n"
+	"                                                            END OF HEADER       \n"
+	"> 2020 04 05 00 00 10.0000000  0  1\n"
+	"G01  20000001.125 7\n"
+	"> 2020 04 05 00 00 20.0000000  0  1\n"
+	"G01  20000002.125 7\n"
+	"> 2020 04 05 00 00 30.0000000  0  1\n"
+	"G01  20000003.125 7\n";
+//@endcond
+
+/**setFile writes the input file with the given content and modification time.
+ *
+ * @param content the content of the file
+ * @param mtime the modification time to set
+ */
+void setFile(const string &content, time_t mtime) {
+	struct utimbuf times;
+	times.actime = mtime;
+	times.modtime = mtime;
+	CHECK(writeTextFile(OBSFILE, content))
+	CHECK(utime(OBSFILE.c_str(), &times) == 0)
+}
+
+/**buildIndex builds the epoch index of the input file using the sidecar file.
+ *
+ * @param log the Logger to use
+ * @return the number of epochs in the index, or -1 if the input file cannot be read
+ */
+int buildIndex(Logger &log) {
+	RinexData rinex(RinexData::V304, &log);
+	FILE* input = fopen(OBSFILE.c_str(), "r");
+	CHECK(input != NULL)
+	if (input == NULL) return -1;
+	CHECK(rinex.readRinexHeader(input))
+	int nEpochs = rinex.buildObsEpochIndex(input, IDXFILE);
+	fclose(input);
+	return nEpochs;
+}
+
+int main() {
+	remove(LOGFILE.c_str());
+	remove(IDXFILE.c_str());
+	//the third epoch line is changed to a line out of an epoch: same size, one epoch less
+	string changedObs = v3Obs;
+	changedObs[changedObs.rfind('>')] = 'X';
+	{
+		Logger log(LOGFILE);
+		setFile(v3Obs, FILETIME);
+		CHECK(buildIndex(log) == 3)
+		//with the same size and time the sidecar index is used, even if the content is not the same
+		setFile(changedObs, FILETIME);
+		CHECK(buildIndex(log) == 3)
+		//with other time the input file is scanned again
+		setFile(changedObs, FILETIME + 1);
+		CHECK(buildIndex(log) == 2)
+		CHECK(buildIndex(log) == 2)
+	}
+	remove(OBSFILE.c_str());
+	remove(IDXFILE.c_str());
+	return testResult("testObsIndex");
+}
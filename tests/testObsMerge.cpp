@@ -0,0 +1,110 @@
+/** @file testObsMerge.cpp
+ * Checks that RinexData::mergeObsFiles delivers epochs of several observation files in time order, joining epochs with the
+ * same time and taking duplicated observables from the first file, and that setting SYS / # / OBS TYPES data for existing
+ * observables keeps the selection made with setFilter.
+ *
+ *Copyright 2026 by Francisco Cancillo & Luis Cancillo
+ *<p>
+ *This file is part of the toRINEX tool.
+ *<p>
+ *<p>Ver.	|Date	|Reason for change
+ *<p>---------------------------------
+ *<p>V1.0	|10/2026|First release
+ */
+#include "TestUtils.h"
+
+const string OBSFILE1("testObsMerge1.rnx");
+const string OBSFILE2("testObsMerge2.rnx");
+const string MERGEDFILE("testObsMerge.rnx");
+const string LOGFILE("testObsMerge.log");
+
+//@cond DUMMY
+///the first file to merge: GPS observables at 10 and 11 seconds
+const string v3Obs1 =
+	"     3.04           OBSERVATION DATA    M: Mixed            RINEX VERSION / TYPE\n"
+	"G    2 C1C L1C                                              SYS / # / OBS TYPES \n"
+	"                                                            END OF HEADER       \n"
+	"> 2020 04 05 00 00 10.0000000  0  2      0.000000000000\n"
+	"G01  20000001.125 7  20000001.125 7\n"
+	"G02  20000002.125 7  20000002.125 7\n"
+	"> 2020 04 05 00 00 11.0000000  0  2      0.000000000000\n"
+	"G01  20000011.125 7  20000011.125 7\n"
+	"G02  20000012.125 7  20000012.125 7\n";
+///the second file to merge: GPS and Galileo observables at 11 and 12 seconds, where G02 C1C at 11 is also in the first file
+const string v3Obs2 =
+	"     3.04           OBSERVATION DATA    M: Mixed            RINEX VERSION / TYPE\n"
+	"G    1 C1C                                                  SYS / # / OBS TYPES \n"
+	"E    1 C1X                                                  SYS / # / OBS TYPES \n"
+	"                                                            END OF HEADER       \n"
+	"> 2020 04 05 00 00 11.0000000  0  2      0.000000000000\n"
+	"G02  30000012.125 7\n"
+	"E05  30000015.125 7\n"
+	"> 2020 04 05 00 00 12.0000000  0  1      0.000000000000\n"
+	"E05  30000025.125 7\n";
+//@endcond
+
+/**checkMerge merges the two files and checks the epochs of the resulting file.
+ */
+void checkMerge() {
+	Logger log(LOGFILE);
+	RinexData merger(RinexData::V304, &log);
+	vector<FILE*> inputs;
+	inputs.push_back(fopen(OBSFILE1.c_str(), "r"));
+	inputs.push_back(fopen(OBSFILE2.c_str(), "r"));
+	FILE* out = fopen(MERGEDFILE.c_str(), "w");
+	CHECK((inputs[0] != NULL) && (inputs[1] != NULL) && (out != NULL))
+	CHECK(merger.mergeObsFiles(inputs, out) == 3)
+	fclose(inputs[0]);
+	fclose(inputs[1]);
+	fclose(out);
+	//read the merged file
+	RinexData rinex(RinexData::V304, &log);
+	FILE* input = fopen(MERGEDFILE.c_str(), "r");
+	CHECK(input != NULL)
+	CHECK(rinex.readRinexHeader(input))
+	string epochs;
+	int status;
+	while ((status = rinex.readObsEpoch(input)) != 0) epochs += dumpObsEpoch(rinex, status);
+	fclose(input);
+	CHECK(epochs ==
+		"st=1 w=2100 tow=10.0000000 flag=0:"
+		" G01 C1C 20000001.125 0 7 G01 L1C 20000001.125 0 7 G02 C1C 20000002.125 0 7 G02 L1C 20000002.125 0 7\n"
+		"st=1 w=2100 tow=11.0000000 flag=0:"
+		" G01 C1C 20000011.125 0 7 G01 L1C 20000011.125 0 7 G02 C1C 20000012.125 0 7 G02 L1C 20000012.125 0 7"
+		" E05 C1X 30000015.125 0 7\n"
+		"st=1 w=2100 tow=12.0000000 flag=0: E05 C1X 30000025.125 0 7\n")
+	if (testFailures != 0) fprintf(stderr, "%s", epochs.c_str());
+}
+
+/**checkFilterKept checks that observables not selected using setFilter are not selected again when they are set again
+ * in SYS / # / OBS TYPES data.
+ */
+void checkFilterKept() {
+	Logger log(LOGFILE);
+	RinexData rinex(RinexData::V304, &log);
+	vector<string> obsIds;
+	obsIds.push_back("C1C");
+	obsIds.push_back("L1C");
+	CHECK(rinex.setHdLnData(RinexData::SYS, 'G', obsIds))
+	vector<string> selSat;
+	vector<string> selObs;
+	selObs.push_back("GC1C");
+	CHECK(rinex.setFilter(selSat, selObs))
+	CHECK(rinex.setHdLnData(RinexData::SYS, 'G', obsIds))
+	char sys;
+	vector<string> selected;
+	CHECK(rinex.getHdLnData(RinexData::SYS, sys, selected, 0))
+	CHECK((selected.size() == 1) && (selected[0] == "C1C"))
+}
+
+int main() {
+	remove(LOGFILE.c_str());
+	CHECK(writeTextFile(OBSFILE1, v3Obs1))
+	CHECK(writeTextFile(OBSFILE2, v3Obs2))
+	checkMerge();
+	checkFilterKept();
+	remove(OBSFILE1.c_str());
+	remove(OBSFILE2.c_str());
+	remove(MERGEDFILE.c_str());
+	return testResult("testObsMerge");
+}
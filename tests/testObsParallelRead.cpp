@@ -0,0 +1,126 @@
+/** @file testObsParallelRead.cpp
+ * Checks that RinexData::readObsEpochsParallel delivers the same epochs as the sequential readObsEpoch, including epochs
+ * following an event with header records which modify the observables defined, that lines out of an epoch are logged, that an
+ * epoch with a wrong clock offset is read with error status, and that the file is left after the last epoch delivered when the
+ * consumer stops reading.
+ *
+ *Copyright 2026 by Francisco Cancillo & Luis Cancillo
+ *<p>
+ *This file is part of the toRINEX tool.
+ *<p>
+ *<p>Ver.	|Date	|Reason for change
+ *<p>---------------------------------
+ *<p>V1.0	|10/2026|First release
+ */
+#include "TestUtils.h"
+
+const string OBSFILE("testObsParallelRead.rnx");
+const string SEQLOG("testObsParallelRead_seq.log");
+const string PARLOG("testObsParallelRead_par.log");
+const string STRAYLINE("this line is out of any epoch");
+const int STOPEPOCHS = 3;	//the number of epochs delivered before stopping reading
+
+//@cond DUMMY
+///builds a V3.04 observation file where a flag 4 event adds the GLONASS system, a stray line precedes an epoch, and the third
+///epoch has a wrong clock offset
+string buildObsFile() {
+	char line[128];
+	string file = "     3.04           OBSERVATION DATA    M: Mixed            RINEX VERSION / TYPE\n"
+		"G    2 C1C L1C                                              SYS / # / OBS TYPES \n"
+		"                                                            END OF HEADER       \n";
+	for (int ep = 0; ep < 8; ep++) {
+		if (ep == 4) {
+			file += "> 2020 04 05 00 00  4.0000000  4  1\n"
+				"R    2 C1C L1C                                              SYS / # / OBS TYPES \n";
+		}
+		if (ep == 6) file += STRAYLINE + "\n";
+		snprintf(line, sizeof line, "> 2020 04 05 00 00 %2d.0000000  0 %2d      %s\n", ep + 10, ep < 4? 2 : 4,
+			ep == 2? "wrong.clock" : "0.000000000000");
+		file += line;
+		for (int sat = 1; sat <= 2; sat++) {
+			snprintf(line, sizeof line, "G%02d  2000%d00%d.12317  2000%d00%d.12317\n", sat, sat, ep, sat, ep);
+			file += line;
+		}
+		if (ep >= 4) for (int sat = 1; sat <= 2; sat++) {
+			snprintf(line, sizeof line, "R%02d  2100%d00%d.45616  2100%d00%d.45616\n", sat, sat, ep, sat, ep);
+			file += line;
+		}
+	}
+	return file;
+}
+
+///the consumer of epochs read in parallel: appends their dump to the string given as user data
+bool dumpConsumer(RinexData &rinex, int status, void* userData) {
+	*((string*) userData) += dumpObsEpoch(rinex, status);
+	return true;
+}
+
+///the consumer of epochs read in parallel which stops reading after STOPEPOCHS epochs: counts them in the int given as user data
+bool stopConsumer(RinexData &rinex, int status, void* userData) {
+	return ++*((int*) userData) < STOPEPOCHS;
+}
+
+///gives the line with the given index (from 0) in the given text
+string getLine(const string &text, int index) {
+	size_t start = 0;
+	while ((index-- > 0) && (start != string::npos)) if ((start = text.find('\n', start)) != string::npos) start++;
+	if (start == string::npos) return string();
+	return text.substr(start, text.find('\n', start) - start + 1);
+}
+//@endcond
+
+int main() {
+	string seqDump, parDump;
+	int nSeq = 0;
+	CHECK(writeTextFile(OBSFILE, buildObsFile()))
+	{	//read sequentially
+		remove(SEQLOG.c_str());
+		Logger log(SEQLOG);
+		RinexData rinex(RinexData::V304, &log);
+		FILE* input = fopen(OBSFILE.c_str(), "r");
+		CHECK(input != NULL)
+		CHECK(rinex.readRinexHeader(input))
+		int status;
+		while ((status = rinex.readObsEpoch(input)) != 0) {
+			seqDump += dumpObsEpoch(rinex, status);
+			nSeq++;
+		}
+		fclose(input);
+	}
+	for (unsigned int nThreads = 1; nThreads <= 4; nThreads++) {	//read in parallel
+		parDump.clear();
+		{
+			remove(PARLOG.c_str());
+			Logger log(PARLOG);
+			RinexData rinex(RinexData::V304, &log);
+			FILE* input = fopen(OBSFILE.c_str(), "r");
+			CHECK(input != NULL)
+			CHECK(rinex.readRinexHeader(input))
+			CHECK(rinex.readObsEpochsParallel(input, dumpConsumer, &parDump, nThreads) == nSeq)
+			fclose(input);
+		}
+		CHECK(parDump == seqDump)
+		CHECK(countText(readTextFile(PARLOG), STRAYLINE) == 1)
+		CHECK(countText(readTextFile(PARLOG), msgWrongClkOffs) == 1)
+	}
+	for (unsigned int nThreads = 1; nThreads <= 4; nThreads++) {	//stop reading in parallel, and go on sequentially
+		int nStop = 0;
+		Logger log(PARLOG);
+		RinexData rinex(RinexData::V304, &log);
+		FILE* input = fopen(OBSFILE.c_str(), "r");
+		CHECK(input != NULL)
+		CHECK(rinex.readRinexHeader(input))
+		CHECK(rinex.readObsEpochsParallel(input, stopConsumer, &nStop, nThreads) == STOPEPOCHS)
+		int status = rinex.readObsEpoch(input);
+		CHECK(dumpObsEpoch(rinex, status) == getLine(seqDump, STOPEPOCHS))
+		fclose(input);
+	}
+	//epochs after the event have GLONASS observables
+	CHECK(nSeq == 9)
+	CHECK(countText(seqDump, "st=4") == 1)
+	CHECK(countText(seqDump, " R01 C1C 21001007.456") == 1)
+	CHECK(countText(readTextFile(SEQLOG), STRAYLINE) == 1)
+	if (testFailures != 0) fprintf(stderr, "Sequential:\n%sParallel:\n%s", seqDump.c_str(), parDump.c_str());
+	remove(OBSFILE.c_str());
+	return testResult("testObsParallelRead");
+}
@@ -0,0 +1,78 @@
+/** @file testObsSplit.cpp
+ * Checks that RinexData::printObsEpochSplit prints each epoch in the file of its time window, and that a window whose file
+ * was closed (because too many files were open) gets its new epochs appended to the existing file.
+ *
+ *Copyright 2026 by Francisco Cancillo & Luis Cancillo
+ *<p>
+ *This file is part of the toRINEX tool.
+ *<p>
+ *<p>Ver.	|Date	|Reason for change
+ *<p>---------------------------------
+ *<p>V1.0	|10/2026|First release
+ */
+#include "TestUtils.h"
+
+const string OBSFILE("testObsSplit.rnx");
+const string LOGFILE("testObsSplit.log");
+const string HOUR0FILE("TEST096a00.20O");	//the names of the hourly files for 2020-04-05 00h and 01h
+const string HOUR1FILE("TEST096b00.20O");
+
+//@cond DUMMY
+///a V3.04 observation file with epochs in the first hour, then in the second one, and again in the first one
+const string v3Obs =
+	"     3.04           OBSERVATION DATA    M: Mixed            RINEX VERSION / TYPE\n"
+	"G    1 C1C                                                  SYS / # / OBS TYPES \n"
+	"                                                            END OF HEADER       \n"
+	"> 2020 04 05 00 00 10.0000000  0  1      0.000000000000\n"
+	"G01  20000001.125 7\n"
+	"> 2020 04 05 01 00 10.0000000  0  1      0.000000000000\n"
+	"G01  20000002.125 7\n"
+	"> 2020 04 05 00 00 20.0000000  0  1      0.000000000000\n"
+	"G01  20000003.125 7\n";
+//@endcond
+
+/**readEpochs reads the given observation file and describes its epochs.
+ *
+ * @param name the file name
+ * @param log the logger to use
+ * @return the description of the epochs, one line per epoch as per dumpObsEpoch
+ */
+string readEpochs(const string &name, Logger &log) {
+	string epochs;
+	int status;
+	RinexData rinex(RinexData::V210, &log);
+	FILE* input = fopen(name.c_str(), "r");
+	if (input == NULL) return epochs;
+	rinex.readRinexHeader(input);
+	while ((status = rinex.readObsEpoch(input)) != 0) epochs += dumpObsEpoch(rinex, status);
+	fclose(input);
+	return epochs;
+}
+
+int main() {
+	remove(LOGFILE.c_str());
+	remove(HOUR0FILE.c_str());
+	remove(HOUR1FILE.c_str());
+	CHECK(writeTextFile(OBSFILE, v3Obs))
+	Logger log(LOGFILE);
+	RinexData rinex(RinexData::V210, &log);
+	FILE* input = fopen(OBSFILE.c_str(), "r");
+	CHECK(input != NULL)
+	CHECK(rinex.readRinexHeader(input))
+	//only one file open at a time: the file of the first hour is closed when the second one is created
+	CHECK(rinex.openObsSplit(3600.0, "TEST", "---", "", 1))
+	while (rinex.readObsEpoch(input) != 0) CHECK(rinex.printObsEpochSplit());
+	rinex.closeObsSplit();
+	fclose(input);
+	string hour0 = readTextFile(HOUR0FILE);
+	CHECK(countText(hour0, "END OF HEADER") == 1)
+	CHECK(countText(hour0, "TIME OF FIRST OBS") == 1)
+	CHECK(readEpochs(HOUR0FILE, log) ==
+		"st=1 w=2100 tow=10.0000000 flag=0: G01 C1C 20000001.125 0 7\n"
+		"st=1 w=2100 tow=20.0000000 flag=0: G01 C1C 20000003.125 0 7\n")
+	CHECK(readEpochs(HOUR1FILE, log) == "st=1 w=2100 tow=3610.0000000 flag=0: G01 C1C 20000002.125 0 7\n")
+	remove(OBSFILE.c_str());
+	remove(HOUR0FILE.c_str());
+	remove(HOUR1FILE.c_str());
+	return testResult("testObsSplit");
+}
@@ -0,0 +1,68 @@
+/** @file testObsStore.cpp
+ * Checks that RinexData::readObsFile places in a RinexObsStore the observables of epochs read without errors, and that
+ * epochs with errors are not stored.
+ *
+ *Copyright 2026 by Francisco Cancillo & Luis Cancillo
+ *<p>
+ *This file is part of the toRINEX tool.
+ *<p>
+ *<p>Ver.	|Date	|Reason for change
+ *<p>---------------------------------
+ *<p>V1.0	|10/2026|First release
+ */
+#include "TestUtils.h"
+
+const string OBSFILE("testObsStore.rnx");
+const string LOGFILE("testObsStore.log");
+
+//@cond DUMMY
+///a V3.04 observation file where the second epoch has a wrong satellite line, and G03 has data only in this epoch
+const string v3Obs =
+	"     3.04           OBSERVATION DATA    M: Mixed            RINEX VERSION / TYPE\n"
+	"G    2 C1C L1C                                              SYS / # / OBS TYPES \n"
+	"                                                            END OF HEADER       \n"
+	"> 2020 04 05 00 00 10.0000000  0  2      0.000000000000\n"
+	"G01  20000001.12517  20000001.125 7\n"
+	"G02  20000002.12517  20000002.125 7\n"
+	"> 2020 04 05 00 00 11.0000000  0  3      0.000000000000\n"
+	"G01  20000011.12517  20000011.125 7\n"
+	"G03  20000013.12517  20000013.125 7\n"
+	"Gxx  20000012.12517  20000012.125 7\n"
+	"> 2020 04 05 00 00 12.0000000  0  2      0.000000000000\n"
+	"G01  20000021.12517  20000021.125 7\n"
+	"G02  20000022.12517  20000022.125 7\n";
+//@endcond
+
+int main() {
+	remove(LOGFILE.c_str());
+	CHECK(writeTextFile(OBSFILE, v3Obs))
+	Logger log(LOGFILE);
+	RinexData rinex(RinexData::V304, &log);
+	RinexObsStore store;
+	FILE* input = fopen(OBSFILE.c_str(), "r");
+	CHECK(input != NULL)
+	CHECK(rinex.readRinexHeader(input))
+	CHECK(rinex.readObsFile(input, store) == 2)
+	fclose(input);
+	CHECK(store.getNumEpochs() == 2)
+	if (store.getNumEpochs() == 2) {
+		CHECK(store.getTimes()[1] - store.getTimes()[0] == 2.0)
+	}
+	//only G01 and G02 series, with data in both epochs
+	CHECK(store.getNumSeries() == 4)
+	CHECK(store.findSeries('G', 3, "C1C") < 0)
+	int series = store.findSeries('G', 1, "C1C");
+	CHECK(series >= 0)
+	if (series >= 0) {
+		CHECK(store.getFirstEpoch(series) == 0)
+		CHECK(store.getSeriesSize(series) == 2)
+		CHECK(store.isPresent(series, 0) && store.isPresent(series, 1))
+		CHECK(store.getValues(series)[0] == 20000001.125)
+		CHECK(store.getValues(series)[1] == 20000021.125)
+		CHECK((store.getLLIs(series)[1] == 1) && (store.getSSIs(series)[1] == 7))
+	}
+	series = store.findSeries('G', 2, "L1C");
+	CHECK((series >= 0) && (store.getSeriesSize(series) == 2) && (store.getValues(series)[1] == 20000022.125))
+	remove(OBSFILE.c_str());
+	return testResult("testObsStore");
+}
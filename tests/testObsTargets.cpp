@@ -0,0 +1,77 @@
+/** @file testObsTargets.cpp
+ * Checks that printing observation data in several targets with other versions does not change the version, observables to
+ * print and print plans in use: epochs printed using printObsEpoch after printObsEpochTargets have the format of the version
+ * in use.
+ *
+ *Copyright 2026 by Francisco Cancillo & Luis Cancillo
+ *<p>
+ *This file is part of the toRINEX tool.
+ *<p>
+ *<p>Ver.	|Date	|Reason for change
+ *<p>---------------------------------
+ *<p>V1.0	|10/2026|First release
+ */
+#include "TestUtils.h"
+
+const string OBSFILE("testObsTargets.rnx");
+const string DIRECTFILE("testObsTargetsDirect.rnx");	//printed using printObsHeader and printObsEpoch
+const string V3FILE("testObsTargetsV3.rnx");			//printed in targets
+const string V2FILE("testObsTargetsV2.rnx");
+const string LOGFILE("testObsTargets.log");
+
+//@cond DUMMY
+///a V3.04 observation file with GPS and Galileo observables, some of them not printed in V2.10
+const string v3Obs =
+	"     3.04           OBSERVATION DATA    M: Mixed            RINEX VERSION / TYPE\n"
+	"G    3 C1C L1C C5Q                                          SYS / # / OBS TYPES \n"
+	"E    2 C1C C5Q                                              SYS / # / OBS TYPES \n"
+	"                                                            END OF HEADER       \n"
+	"> 2020 04 05 00 00 10.0000000  0  2      0.000000000000\n"
+	"G01  20000001.125 7 105100000.250 7  20000001.500 7\n"
+	"E02  21000001.125 7  21000001.500 7\n"
+	"> 2020 04 05 00 00 20.0000000  0  2      0.000000000000\n"
+	"G01  20000002.125 7 105100010.250 7  20000002.500 7\n"
+	"E02  21000002.125 7  21000002.500 7\n";
+//@endcond
+
+int main() {
+	remove(LOGFILE.c_str());
+	CHECK(writeTextFile(OBSFILE, v3Obs))
+	{
+		Logger log(LOGFILE);
+		RinexData rinex(RinexData::V304, &log);
+		FILE* input = fopen(OBSFILE.c_str(), "r");
+		FILE* direct = fopen(DIRECTFILE.c_str(), "w");
+		FILE* v3 = fopen(V3FILE.c_str(), "w");
+		FILE* v2 = fopen(V2FILE.c_str(), "w");
+		CHECK((input != NULL) && (direct != NULL) && (v3 != NULL) && (v2 != NULL))
+		if ((input == NULL) || (direct == NULL) || (v3 == NULL) || (v2 == NULL)) return testResult("testObsTargets");
+		CHECK(rinex.readRinexHeader(input))
+		rinex.printObsHeader(direct);
+		//the V2.10 target is the last one, to leave its print plans in use if they were not restored
+		CHECK(rinex.addObsTarget(v3, RinexData::V304))
+		CHECK(rinex.addObsTarget(v2, RinexData::V210))
+		rinex.printObsHeaderTargets();
+		//the first epoch is printed in the targets, and the second one using printObsEpoch
+		CHECK(rinex.readObsEpoch(input) != 0)
+		rinex.printObsEpochTargets();
+		CHECK(rinex.readObsEpoch(input) != 0)
+		rinex.printObsEpoch(direct);
+		rinex.endObsTargets();
+		fclose(input);
+		fclose(direct);
+		fclose(v3);
+		fclose(v2);
+	}
+	string directObs = readTextFile(DIRECTFILE);
+	CHECK(countText(readTextFile(V3FILE), "G01  20000001.125 7 105100000.250 7  20000001.500 7\n") == 1)
+	CHECK(countText(readTextFile(V2FILE), " 20000001.125 7") == 1)
+	CHECK(countText(directObs, "> 2020 04 05 00 00 20.0000000") == 1)
+	CHECK(countText(directObs, "G01  20000002.125 7 105100010.250 7  20000002.500 7\n") == 1)
+	CHECK(countText(directObs, "E02  21000002.125 7  21000002.500 7\n") == 1)
+	remove(OBSFILE.c_str());
+	remove(DIRECTFILE.c_str());
+	remove(V3FILE.c_str());
+	remove(V2FILE.c_str());
+	return testResult("testObsTargets");
+}